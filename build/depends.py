@@ -751,6 +751,7 @@ class MixxxCore(Feature):
                    "engine/enginevumeter.cpp",
                    "engine/enginesidechaincompressor.cpp",
                    "engine/sidechain/enginesidechain.cpp",
+                   "engine/sidechain/sidechainworkerthread.cpp",
                    "engine/sidechain/networkstreamworker.cpp",
                    "engine/enginexfader.cpp",
                    "engine/enginemicrophone.cpp",
@@ -777,6 +778,8 @@ class MixxxCore(Feature):
                    "analyzer/analyzerwaveform.cpp",
                    "analyzer/analyzergain.cpp",
                    "analyzer/analyzerebur128.cpp",
+                   "analyzer/analyzerfingerprint.cpp",
+                   "analyzer/analyzerpreviewintro.cpp",
 
                    "controllers/controller.cpp",
                    "controllers/controllerdebug.cpp",
@@ -848,6 +851,7 @@ class MixxxCore(Feature):
                    "widget/wsearchlineedit.cpp",
                    "widget/wpixmapstore.cpp",
                    "widget/paintable.cpp",
+                   "widget/svgrastercache.cpp",
                    "widget/wimagestore.cpp",
                    "widget/hexspinbox.cpp",
                    "widget/wtrackproperty.cpp",
@@ -891,8 +895,12 @@ class MixxxCore(Feature):
 
                    "library/trackcollection.cpp",
                    "library/basesqltablemodel.cpp",
+                   "library/sqlselectthread.cpp",
+                   "library/tracktagwriter.cpp",
                    "library/basetrackcache.cpp",
                    "library/columncache.cpp",
+                   "library/columnartracktable.cpp",
+                   "library/trackrecordstore.cpp",
                    "library/librarytablemodel.cpp",
                    "library/searchquery.cpp",
                    "library/searchqueryparser.cpp",
@@ -902,6 +910,7 @@ class MixxxCore(Feature):
                    "library/proxytrackmodel.cpp",
                    "library/coverart.cpp",
                    "library/coverartcache.cpp",
+                   "library/coverartthumbnailstore.cpp",
                    "library/coverartutils.cpp",
 
                    "library/crate/cratestorage.cpp",
@@ -909,9 +918,16 @@ class MixxxCore(Feature):
                    "library/crate/cratefeaturehelper.cpp",
                    "library/crate/cratetablemodel.cpp",
 
+                   "library/duplicates/duplicatefinder.cpp",
+                   "library/duplicates/duplicatesfeature.cpp",
+                   "library/duplicates/duplicatestablemodel.cpp",
+                   "library/duplicates/fingerprintindex.cpp",
+
                    "library/playlisttablemodel.cpp",
                    "library/libraryfeature.cpp",
                    "library/analysisfeature.cpp",
+                   "library/autodj/autodjcratesindex.cpp",
+                   "library/autodj/autodjtrackselector.cpp",
                    "library/autodj/autodjfeature.cpp",
                    "library/autodj/autodjprocessor.cpp",
                    "library/dao/directorydao.cpp",
@@ -971,6 +987,8 @@ class MixxxCore(Feature):
                    "library/dao/settingsdao.cpp",
                    "library/dao/analysisdao.cpp",
                    "library/dao/autodjcratesdao.cpp",
+                   "library/dao/searchindexdao.cpp",
+                   "library/dao/fingerprintdao.cpp",
 
                    "library/librarycontrol.cpp",
                    "library/songdownloader.cpp",
@@ -979,6 +997,7 @@ class MixxxCore(Feature):
                    "library/stareditor.cpp",
                    "library/bpmdelegate.cpp",
                    "library/previewbuttondelegate.cpp",
+                   "library/previewcache.cpp",
                    "library/coverartdelegate.cpp",
 
                    "library/treeitemmodel.cpp",
@@ -1046,6 +1065,7 @@ class MixxxCore(Feature):
                    "skin/imgcolor.cpp",
                    "skin/skinloader.cpp",
                    "skin/legacyskinparser.cpp",
+                   "skin/skintemplatecache.cpp",
                    "skin/colorschemeparser.cpp",
                    "skin/tooltips.cpp",
                    "skin/skincontext.cpp",
@@ -1119,6 +1139,7 @@ class MixxxCore(Feature):
                    "util/tapfilter.cpp",
                    "util/movinginterquartilemean.cpp",
                    "util/console.cpp",
+                   "util/compressedbitmap.cpp",
                    "util/db/dbconnection.cpp",
                    "util/db/dbconnectionpool.cpp",
                    "util/db/dbconnectionpooler.cpp",
@@ -1127,6 +1148,7 @@ class MixxxCore(Feature):
                    "util/db/fwdsqlquery.cpp",
                    "util/db/fwdsqlqueryselectresult.cpp",
                    "util/db/sqllikewildcardescaper.cpp",
+                   "util/db/sqlquerycache.cpp",
                    "util/db/sqlqueryfinisher.cpp",
                    "util/db/sqlstringformatter.cpp",
                    "util/db/sqltransaction.cpp",
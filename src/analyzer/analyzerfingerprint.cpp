@@ -0,0 +1,120 @@
+#include "analyzer/analyzerfingerprint.h"
+
+#include <QVector>
+
+#include <algorithm>
+#include <iterator>
+
+#include "library/dao/fingerprintdao.h"
+#include "library/duplicates/fingerprintindex.h"
+#include "util/logger.h"
+#include "util/sample.h"
+
+namespace {
+
+const mixxx::Logger kLogger("AnalyzerFingerprint");
+
+// The type of the raw fingerprint changed from void* to uint32_t*
+// in Chromaprint v1.4.0. See also musicbrainz/chromaprinter.cpp.
+#if (CHROMAPRINT_VERSION_MINOR > 3) || (CHROMAPRINT_VERSION_MAJOR > 1)
+typedef uint32_t* uint32_p;
+#else
+typedef void* uint32_p;
+#endif
+
+// Like the AcoustID fingerprints the fingerprint covers the first two
+// minutes of the track.
+const int kFingerprintDuration = 120; // in seconds
+const int kFingerprintChannels = 2;
+
+} // anonymous namespace
+
+// static
+bool AnalyzerFingerprint::isEnabled(const UserSettingsPointer& pConfig) {
+    return pConfig->getValue<bool>(
+            ConfigKey("[Library]", "EnableFingerprintAnalysis"), false);
+}
+
+AnalyzerFingerprint::AnalyzerFingerprint(FingerprintDao* pFingerprintDao)
+        : m_pFingerprintDao(pFingerprintDao),
+          m_pContext(nullptr),
+          m_remainingSamples(0) {
+    DEBUG_ASSERT(m_pFingerprintDao); // mandatory
+}
+
+AnalyzerFingerprint::~AnalyzerFingerprint() {
+    cleanup(TrackPointer());
+}
+
+bool AnalyzerFingerprint::initialize(TrackPointer tio, int sampleRate, int totalSamples) {
+    cleanup(tio);
+    if (totalSamples == 0 || isDisabledOrLoadStoredSuccess(tio)) {
+        return false;
+    }
+    m_pContext = chromaprint_new(CHROMAPRINT_ALGORITHM_DEFAULT);
+    if (!chromaprint_start(m_pContext, sampleRate, kFingerprintChannels)) {
+        kLogger.warning() << "Failed to start fingerprinting" << tio->getLocation();
+        cleanup(tio);
+        return false;
+    }
+    m_remainingSamples = kFingerprintDuration * sampleRate * kFingerprintChannels;
+    return true;
+}
+
+bool AnalyzerFingerprint::isDisabledOrLoadStoredSuccess(TrackPointer tio) const {
+    const TrackId trackId = tio->getId();
+    // Fingerprints can only be stored for tracks in the library
+    return !trackId.isValid() ||
+            m_pFingerprintDao->hasFingerprint(trackId, FingerprintIndex::kVersion);
+}
+
+void AnalyzerFingerprint::process(const CSAMPLE* pIn, const int iLen) {
+    if (!m_pContext || m_remainingSamples <= 0) {
+        return;
+    }
+    const int numSamples = std::min(iLen, m_remainingSamples);
+    m_samples.resize(numSamples);
+    SampleUtil::convertFloat32ToS16(m_samples.data(), pIn, numSamples);
+    if (!chromaprint_feed(m_pContext, m_samples.data(), numSamples)) {
+        kLogger.warning() << "Failed to feed samples";
+        m_remainingSamples = 0;
+        return;
+    }
+    m_remainingSamples -= numSamples;
+}
+
+void AnalyzerFingerprint::cleanup(TrackPointer tio) {
+    Q_UNUSED(tio);
+    if (m_pContext) {
+        chromaprint_free(m_pContext);
+        m_pContext = nullptr;
+    }
+    m_remainingSamples = 0;
+}
+
+void AnalyzerFingerprint::finalize(TrackPointer tio) {
+    if (!m_pContext) {
+        return;
+    }
+    QVector<quint32> fingerprint;
+    uint32_p pItems = nullptr;
+    int size = 0;
+    if (chromaprint_finish(m_pContext) &&
+            chromaprint_get_raw_fingerprint(m_pContext, &pItems, &size)) {
+        const quint32* pBegin = reinterpret_cast<const quint32*>(pItems);
+        fingerprint.reserve(size);
+        std::copy(pBegin, pBegin + size, std::back_inserter(fingerprint));
+        chromaprint_dealloc(pItems);
+    }
+    cleanup(tio);
+
+    if (fingerprint.isEmpty()) {
+        kLogger.warning() << "Failed to compute the fingerprint of" << tio->getLocation();
+        return;
+    }
+    m_pFingerprintDao->saveFingerprint(
+            tio->getId(),
+            FingerprintIndex::kVersion,
+            FingerprintIndex::signature(fingerprint),
+            FingerprintIndex::excerpt(fingerprint));
+}
@@ -0,0 +1,41 @@
+#ifndef ANALYZER_ANALYZERFINGERPRINT_H
+#define ANALYZER_ANALYZERFINGERPRINT_H
+
+#include <chromaprint.h>
+
+#include <vector>
+
+#include "analyzer/analyzer.h"
+#include "preferences/usersettings.h"
+
+class FingerprintDao;
+
+// Computes the Chromaprint fingerprint of the first two minutes of each
+// track for finding duplicates. See library/duplicates/fingerprintindex.h.
+//
+// Tracks without a fingerprint must be decoded again even if all other
+// analyses are stored, so fingerprinting needs to be enabled explicitly.
+class AnalyzerFingerprint : public Analyzer {
+  public:
+    // Returns true if fingerprints are computed when analyzing tracks.
+    // Disabled by default.
+    static bool isEnabled(const UserSettingsPointer& pConfig);
+
+    explicit AnalyzerFingerprint(FingerprintDao* pFingerprintDao);
+    ~AnalyzerFingerprint() override;
+
+    bool initialize(TrackPointer tio, int sampleRate, int totalSamples) override;
+    bool isDisabledOrLoadStoredSuccess(TrackPointer tio) const override;
+    void process(const CSAMPLE* pIn, const int iLen) override;
+    void cleanup(TrackPointer tio) override;
+    void finalize(TrackPointer tio) override;
+
+  private:
+    FingerprintDao* m_pFingerprintDao;
+    ChromaprintContext* m_pContext;
+    // The number of samples that are still needed
+    int m_remainingSamples;
+    std::vector<SAMPLE> m_samples;
+};
+
+#endif // ANALYZER_ANALYZERFINGERPRINT_H
@@ -0,0 +1,90 @@
+#include "analyzer/analyzerpreviewintro.h"
+
+#include "engine/cachingreaderchunk.h"
+#include "util/math.h"
+#include "util/sample.h"
+
+namespace {
+
+const SINT kChannels = mixxx::AudioSource::kChannelCountStereo;
+
+} // anonymous namespace
+
+AnalyzerPreviewIntro::AnalyzerPreviewIntro(UserSettingsPointer pConfig)
+        : m_previewCache(pConfig),
+          m_frameIndex(0) {
+}
+
+AnalyzerPreviewIntro::~AnalyzerPreviewIntro() {
+}
+
+// static
+SINT AnalyzerPreviewIntro::getIntroStartFrame(const Track& track) {
+    // The cue point is measured in stereo samples
+    const SINT cueFrame = static_cast<SINT>(
+            math_max(0.0, track.getCuePoint()) / kChannels);
+    return CachingReaderChunk::frameForIndex(
+            CachingReaderChunk::indexForFrame(cueFrame));
+}
+
+bool AnalyzerPreviewIntro::initialize(TrackPointer tio, int sampleRate, int totalSamples) {
+    cleanup(tio);
+    const TrackId trackId = tio->getId();
+    // Intros can only be stored for tracks in the library. The intro is
+    // stored again after the cue point has been moved to another chunk.
+    if (totalSamples == 0 || !trackId.isValid() ||
+            m_previewCache.hasIntro(trackId, getIntroStartFrame(*tio))) {
+        return false;
+    }
+    m_intro.sampleRate = sampleRate;
+    m_intro.frameCount = totalSamples / kChannels;
+    m_intro.startFrame = getIntroStartFrame(*tio);
+    if (m_intro.startFrame >= m_intro.frameCount) {
+        // The cue point is outside of the track
+        m_intro.startFrame = 0;
+    }
+    m_intro.samples.reserve(PreviewCache::kIntroFrameCount * kChannels);
+    // The intro is only stored if the track is analyzed anyway. Otherwise
+    // all tracks whose intros have been deleted from the size-limited
+    // cache would be decoded again whenever they are loaded.
+    return false;
+}
+
+bool AnalyzerPreviewIntro::isDisabledOrLoadStoredSuccess(TrackPointer tio) const {
+    Q_UNUSED(tio);
+    // See initialize()
+    return true;
+}
+
+void AnalyzerPreviewIntro::process(const CSAMPLE* pIn, const int iLen) {
+    if (m_intro.sampleRate <= 0) {
+        return;
+    }
+    const SINT frameCount = iLen / kChannels;
+    const SINT firstFrame = math_max(m_frameIndex, m_intro.startFrame);
+    const SINT lastFrame = math_min(m_frameIndex + frameCount,
+            m_intro.startFrame + PreviewCache::kIntroFrameCount);
+    if (firstFrame < lastFrame) {
+        const SINT sampleOffset = m_intro.samples.size();
+        const SINT sampleCount = (lastFrame - firstFrame) * kChannels;
+        m_intro.samples.resize(sampleOffset + sampleCount);
+        SampleUtil::convertFloat32ToS16(
+                &m_intro.samples[sampleOffset],
+                pIn + (firstFrame - m_frameIndex) * kChannels,
+                sampleCount);
+    }
+    m_frameIndex += frameCount;
+}
+
+void AnalyzerPreviewIntro::cleanup(TrackPointer tio) {
+    Q_UNUSED(tio);
+    m_intro = PreviewCache::Intro();
+    m_frameIndex = 0;
+}
+
+void AnalyzerPreviewIntro::finalize(TrackPointer tio) {
+    if (!m_intro.samples.empty()) {
+        m_previewCache.saveIntro(tio->getId(), m_intro);
+    }
+    cleanup(tio);
+}
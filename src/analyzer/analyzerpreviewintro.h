@@ -0,0 +1,33 @@
+#ifndef ANALYZER_ANALYZERPREVIEWINTRO_H
+#define ANALYZER_ANALYZERPREVIEWINTRO_H
+
+#include "analyzer/analyzer.h"
+#include "library/previewcache.h"
+#include "preferences/usersettings.h"
+
+// Stores the decoded samples at the cue point of analyzed tracks in the
+// PreviewCache, from where the preview decks start playing the track
+// before its audio source has been opened.
+class AnalyzerPreviewIntro : public Analyzer {
+  public:
+    explicit AnalyzerPreviewIntro(UserSettingsPointer pConfig);
+    ~AnalyzerPreviewIntro() override;
+
+    bool initialize(TrackPointer tio, int sampleRate, int totalSamples) override;
+    bool isDisabledOrLoadStoredSuccess(TrackPointer tio) const override;
+    void process(const CSAMPLE* pIn, const int iLen) override;
+    void cleanup(TrackPointer tio) override;
+    void finalize(TrackPointer tio) override;
+
+    // The preview starts at the cue point of the track. The intro starts
+    // at the beginning of the reader chunk that contains it.
+    static SINT getIntroStartFrame(const Track& track);
+
+  private:
+    PreviewCache m_previewCache;
+    PreviewCache::Intro m_intro;
+    // The index of the first frame of the next block of samples
+    SINT m_frameIndex;
+};
+
+#endif // ANALYZER_ANALYZERPREVIEWINTRO_H
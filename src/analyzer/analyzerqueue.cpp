@@ -6,8 +6,11 @@
 #endif
 #include "analyzer/analyzergain.h"
 #include "analyzer/analyzerebur128.h"
+#include "analyzer/analyzerfingerprint.h"
+#include "analyzer/analyzerpreviewintro.h"
 #include "analyzer/analyzerwaveform.h"
 #include "library/dao/analysisdao.h"
+#include "library/dao/fingerprintdao.h"
 #include "mixer/playerinfo.h"
 #include "sources/soundsourceproxy.h"
 #include "track/track.h"
@@ -27,7 +30,7 @@
 
 namespace {
 
-mixxx::Logger kLogger("AnalyzerQueue");
+const mixxx::Logger kLogger("AnalyzerQueue");
 
 // Analysis is done in blocks.
 // We need to use a smaller block size, because on Linux the AnalyzerQueue
@@ -58,6 +61,11 @@ AnalyzerQueue::AnalyzerQueue(
     }
     m_pAnalyzers.push_back(std::make_unique<AnalyzerGain>(pConfig));
     m_pAnalyzers.push_back(std::make_unique<AnalyzerEbur128>(pConfig));
+    if (AnalyzerFingerprint::isEnabled(pConfig)) {
+        m_pFingerprintDao = std::make_unique<FingerprintDao>();
+        m_pAnalyzers.push_back(std::make_unique<AnalyzerFingerprint>(m_pFingerprintDao.get()));
+    }
+    m_pAnalyzers.push_back(std::make_unique<AnalyzerPreviewIntro>(pConfig));
 #ifdef __VAMP__
     m_pAnalyzers.push_back(std::make_unique<AnalyzerBeats>(pConfig));
     m_pAnalyzers.push_back(std::make_unique<AnalyzerKey>(pConfig));
@@ -298,9 +306,10 @@ void AnalyzerQueue::execThread() {
     // independent of whether a database connection will be opened
     // or not.
     mixxx::DbConnectionPooler dbConnectionPooler;
-    // m_pAnalysisDao remains null if no analyzer needs database access.
-    // Currently only waveform analyses makes use of it.
-    if (m_pAnalysisDao) {
+    // m_pAnalysisDao remains null if waveforms are not analyzed and
+    // m_pFingerprintDao if fingerprints for finding duplicates are not
+    // computed.
+    if (m_pAnalysisDao || m_pFingerprintDao) {
         dbConnectionPooler = mixxx::DbConnectionPooler(m_pDbConnectionPool); // move assignment
         if (!dbConnectionPooler.isPooling()) {
             kLogger.warning()
@@ -310,7 +319,12 @@ void AnalyzerQueue::execThread() {
         // Obtain and use the newly created database connection within this thread
         QSqlDatabase dbConnection = mixxx::DbConnectionPooled(m_pDbConnectionPool);
         DEBUG_ASSERT(dbConnection.isOpen());
-        m_pAnalysisDao->initialize(dbConnection);
+        if (m_pAnalysisDao) {
+            m_pAnalysisDao->initialize(dbConnection);
+        }
+        if (m_pFingerprintDao) {
+            m_pFingerprintDao->initialize(dbConnection);
+        }
     }
 
     m_progressInfo.current_track.reset();
@@ -391,6 +405,9 @@ void AnalyzerQueue::execThread() {
         // that will be closed soon. Not necessary, just in case ;)
         m_pAnalysisDao->initialize(QSqlDatabase());
     }
+    if (m_pFingerprintDao) {
+        m_pFingerprintDao->initialize(QSqlDatabase());
+    }
 
     emit(queueEmpty()); // emit in case of exit;
 }
@@ -17,6 +17,7 @@
 
 class Analyzer;
 class AnalysisDao;
+class FingerprintDao;
 
 class AnalyzerQueue : public QThread {
     Q_OBJECT
@@ -62,6 +63,7 @@ class AnalyzerQueue : public QThread {
     mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
 
     std::unique_ptr<AnalysisDao> m_pAnalysisDao;
+    std::unique_ptr<FingerprintDao> m_pFingerprintDao;
 
     typedef std::unique_ptr<Analyzer> AnalyzerPtr;
     std::vector<AnalyzerPtr> m_pAnalyzers;
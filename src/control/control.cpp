@@ -59,7 +59,7 @@ void ControlDoublePrivate::initialize(double defaultValue) {
 
     if (m_bTrack) {
         // TODO(rryan): Make configurable.
-        m_trackKey = "control " + m_key.group + "," + m_key.item;
+        m_trackKey = "control " + m_key.group() + "," + m_key.item();
         Stat::track(m_trackKey, static_cast<Stat::StatType>(m_trackType),
                     static_cast<Stat::ComputeFlags>(m_trackFlags),
                     m_value.getValue());
@@ -68,7 +68,7 @@ void ControlDoublePrivate::initialize(double defaultValue) {
 
 ControlDoublePrivate::~ControlDoublePrivate() {
     s_qCOHashMutex.lock();
-    //qDebug() << "ControlDoublePrivate::s_qCOHash.remove(" << m_key.group << "," << m_key.item << ")";
+    //qDebug() << "ControlDoublePrivate::s_qCOHash.remove(" << m_key.group() << "," << m_key.item() << ")";
     s_qCOHash.remove(m_key);
     s_qCOHashMutex.unlock();
 
@@ -123,7 +123,7 @@ QSharedPointer<ControlDoublePrivate> ControlDoublePrivate::getControl(
         if (it != s_qCOHash.end()) {
             if (pCreatorCO) {
                 if (warn) {
-                    qDebug() << "ControlObject" << key.group << key.item << "already created";
+                    qDebug() << "ControlObject" << key.group() << key.item() << "already created";
                 }
             } else {
                 pControl = it.value();
@@ -137,11 +137,11 @@ QSharedPointer<ControlDoublePrivate> ControlDoublePrivate::getControl(
                     new ControlDoublePrivate(key, pCreatorCO, bIgnoreNops,
                                              bTrack, bPersist, defaultValue));
             MMutexLocker locker(&s_qCOHashMutex);
-            //qDebug() << "ControlDoublePrivate::s_qCOHash.insert(" << key.group << "," << key.item << ")";
+            //qDebug() << "ControlDoublePrivate::s_qCOHash.insert(" << key.group() << "," << key.item() << ")";
             s_qCOHash.insert(key, pControl);
         } else if (warn) {
             qWarning() << "ControlDoublePrivate::getControl returning NULL for ("
-                       << key.group << "," << key.item << ")";
+                       << key.group() << "," << key.item() << ")";
         }
     }
     return pControl;
@@ -70,7 +70,7 @@ void ControlObject::privateValueChanged(double dValue, QObject* pSender) {
 
 // static
 ControlObject* ControlObject::getControl(const ConfigKey& key, bool warn) {
-    //qDebug() << "ControlObject::getControl for (" << key.group << "," << key.item << ")";
+    //qDebug() << "ControlObject::getControl for (" << key.group() << "," << key.item() << ")";
     QSharedPointer<ControlDoublePrivate> pCDP = ControlDoublePrivate::getControl(key, warn);
     if (pCDP) {
         return pCDP->getCreatorCO();
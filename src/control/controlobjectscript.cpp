@@ -22,7 +22,7 @@ bool ControlObjectScript::addScriptConnection(const ScriptConnection& conn) {
         if (conn == priorConnection) {
             qWarning() << "Connection " + conn.id.toString() +
                           " already connected to (" +
-                          conn.key.group + ", " + conn.key.item +
+                          conn.key.group() + ", " + conn.key.item() +
                           "). Ignoring attempt to connect again.";
             return false;
         }
@@ -30,7 +30,7 @@ bool ControlObjectScript::addScriptConnection(const ScriptConnection& conn) {
 
     m_scriptConnections.append(conn);
     controllerDebug("Connected (" +
-                    conn.key.group + ", " + conn.key.item +
+                    conn.key.group() + ", " + conn.key.item() +
                     ") to connection " + conn.id.toString());
     return true;
 }
@@ -39,11 +39,11 @@ void ControlObjectScript::removeScriptConnection(const ScriptConnection& conn) {
     bool success = m_scriptConnections.removeOne(conn);
     if (success) {
         controllerDebug("Disconnected (" +
-                        conn.key.group + ", " + conn.key.item +
+                        conn.key.group() + ", " + conn.key.item() +
                         ") from connection " + conn.id.toString());
     } else {
         qWarning() << "Failed to disconnect (" +
-                      conn.key.group + ", " + conn.key.item +
+                      conn.key.group() + ", " + conn.key.item() +
                       ") from connection " + conn.id.toString();
     }
     if (m_scriptConnections.isEmpty()) {
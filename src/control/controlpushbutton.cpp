@@ -38,7 +38,7 @@ ControlPushButton::~ControlPushButton() {
 
 // Tell this PushButton how to act on rising and falling edges
 void ControlPushButton::setButtonMode(enum ButtonMode mode) {
-    //qDebug() << "Setting " << m_Key.group << m_Key.item << "as toggle";
+    //qDebug() << "Setting " << m_Key.group() << m_Key.item() << "as toggle";
     m_buttonMode = mode;
 
     if (m_pControl) {
@@ -747,13 +747,13 @@ QScriptValue ControllerEngine::makeConnection(QString group, QString name,
 void ScriptConnection::executeCallback(double value) const {
     QScriptValueList args;
     args << QScriptValue(value);
-    args << QScriptValue(key.group);
-    args << QScriptValue(key.item);
+    args << QScriptValue(key.group());
+    args << QScriptValue(key.item());
     QScriptValue func = callback; // copy function because QScriptValue::call is not const
     QScriptValue result = func.call(context, args);
     if (result.isError()) {
         qWarning() << "ControllerEngine: Invocation of connection " << id.toString()
-                   << "connected to (" + key.group + ", " + key.item + ") failed:"
+                   << "connected to (" + key.group() + ", " + key.item() + ") failed:"
                    << result.toString();
     }
 }
@@ -763,8 +763,8 @@ void ScriptConnection::executeCallback(double value) const {
    Input:   the ScriptConnection to disconnect
    -------- ------------------------------------------------------ */
 void ControllerEngine::removeScriptConnection(const ScriptConnection connection) {
-    ControlObjectScript* coScript = getControlObjectScript(connection.key.group,
-                                                           connection.key.item);
+    ControlObjectScript* coScript = getControlObjectScript(connection.key.group(),
+                                                           connection.key.item());
 
     if (m_pEngine == nullptr || coScript == nullptr) {
         return;
@@ -786,8 +786,8 @@ void ControllerEngine::triggerScriptConnection(const ScriptConnection connection
         return;
     }
 
-    ControlObjectScript* coScript = getControlObjectScript(connection.key.group,
-                                                           connection.key.item);
+    ControlObjectScript* coScript = getControlObjectScript(connection.key.group(),
+                                                           connection.key.item());
     if (coScript == nullptr) {
         return;
     }
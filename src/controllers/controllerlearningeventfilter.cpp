@@ -39,12 +39,12 @@ bool ControllerLearningEventFilter::eventFilter(QObject* pObject, QEvent* pEvent
         if (mouseEvent->button() & Qt::LeftButton) {
             if (info.leftClickControl) {
                 ConfigKey key = info.leftClickControl->getKey();
-                qDebug() << "Left-click maps MIDI to:" << key.group << key.item;
+                qDebug() << "Left-click maps MIDI to:" << key.group() << key.item();
                 emit(controlClicked(info.leftClickControl));
             } else if (info.clickControl) {
                 ConfigKey key = info.clickControl->getKey();
                 emit(controlClicked(info.clickControl));
-                qDebug() << "Default-click maps MIDI to:" << key.group << key.item;
+                qDebug() << "Default-click maps MIDI to:" << key.group() << key.item();
             } else {
                 qDebug() << "No control bound to left-click for" << pWidget;
             }
@@ -52,7 +52,7 @@ bool ControllerLearningEventFilter::eventFilter(QObject* pObject, QEvent* pEvent
         if (mouseEvent->button() & Qt::RightButton) {
             if (info.rightClickControl) {
                 ConfigKey key = info.rightClickControl->getKey();
-                qDebug() << "Right-click maps MIDI to:" << key.group << key.item;
+                qDebug() << "Right-click maps MIDI to:" << key.group() << key.item();
                 emit(controlClicked(info.rightClickControl));
             } else if (has_right_click_reset && (info.leftClickControl || info.clickControl)) {
                 // WKnob and WSliderComposed emits a reset signal on
@@ -64,15 +64,15 @@ bool ControllerLearningEventFilter::eventFilter(QObject* pObject, QEvent* pEvent
                     pControl = info.clickControl;
                 }
                 ConfigKey key = pControl->getKey();
-                key.item = key.item + "_set_default";
+                key.setItem(key.item() + "_set_default");
                 ControlObject* pResetControl = ControlObject::getControl(key);
                 if (pResetControl) {
-                    qDebug() << "Right-click reset maps MIDI to:" << key.group << key.item;
+                    qDebug() << "Right-click reset maps MIDI to:" << key.group() << key.item();
                     emit(controlClicked(pResetControl));
                 }
             } else if (info.clickControl) {
                 ConfigKey key = info.clickControl->getKey();
-                qDebug() << "Default-click maps MIDI to:" << key.group << key.item;
+                qDebug() << "Default-click maps MIDI to:" << key.group() << key.item();
                 emit(controlClicked(info.clickControl));
             } else {
                 qDebug() << "No control bound to right-click for" << pWidget;
@@ -171,7 +171,7 @@ QVariant ControllerOutputMappingTableModel::data(const QModelIndex& index,
             case MIDI_COLUMN_ACTION:
                 if (role == Qt::UserRole) {
                     // TODO(rryan): somehow get the delegate display text?
-                    return mapping.controlKey.group + "," + mapping.controlKey.item;
+                    return mapping.controlKey.group() + "," + mapping.controlKey.item();
                 }
                 return qVariantFromValue(mapping.controlKey);
             case MIDI_COLUMN_COMMENT:
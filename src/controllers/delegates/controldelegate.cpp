@@ -43,12 +43,12 @@ QString ControlDelegate::displayText(const QVariant& value,
     Q_UNUSED(locale);
     ConfigKey key = qVariantValue<ConfigKey>(value);
 
-    if (key.group.isEmpty() && key.item.isEmpty()) {
+    if (key.group().isEmpty() && key.item().isEmpty()) {
         return tr("No control chosen.");
     }
 
     if (m_bIsIndexScript) {
-        return tr("Script: %1(%2)").arg(key.item, key.group);
+        return tr("Script: %1(%2)").arg(key.item(), key.group());
     }
 
     QString description = m_pPicker->descriptionForConfigKey(key);
@@ -56,7 +56,7 @@ QString ControlDelegate::displayText(const QVariant& value,
         return description;
     }
 
-    return key.group + "," + key.item;
+    return key.group() + "," + key.item();
 }
 
 void ControlDelegate::setEditorData(QWidget* editor,
@@ -68,11 +68,11 @@ void ControlDelegate::setEditorData(QWidget* editor,
         return;
     }
 
-    if (key.group.isEmpty() && key.item.isEmpty()) {
+    if (key.group().isEmpty() && key.item().isEmpty()) {
         return;
     }
 
-    pLineEdit->setText(key.group + "," + key.item);
+    pLineEdit->setText(key.group() + "," + key.item());
 }
 
 void ControlDelegate::setModelData(QWidget* editor,
@@ -432,7 +432,7 @@ void DlgControllerLearning::loadControl(const ConfigKey& key,
     m_currentControl = key;
 
     if (description.isEmpty()) {
-        description = key.group + "," + key.item;
+        description = key.group() + "," + key.item();
     }
     comboBoxChosenControl->setEditText(title);
 
@@ -459,14 +459,14 @@ void DlgControllerLearning::controlClicked(ControlObject* pControl) {
     ConfigKey key = pControl->getKey();
     if (!m_controlPickerMenu.controlExists(key)) {
         qWarning() << "Mixxx UI element clicked for which there is no "
-                      "learnable control " << key.group << " " << key.item;
+                      "learnable control " << key.group() << " " << key.item();
         QMessageBox::warning(
                     this,
                     Version::applicationName(),
                     tr("The control you clicked in Mixxx is not learnable.\n"
                        "This could be because you are using an old skin"
                        " and this control is no longer supported.\n"
-                       "\nYou tried to learn: %1,%2").arg(key.group, key.item),
+                       "\nYou tried to learn: %1,%2").arg(key.group(), key.item()),
                     QMessageBox::Ok, QMessageBox::Ok);
         return;
     }
@@ -55,7 +55,7 @@ bool KeyboardEventFilter::eventFilter(QObject*, QEvent* e) {
                          m_keySequenceToControlHash.find(ksv);
                  it != m_keySequenceToControlHash.end() && it.key() == ksv; ++it) {
                 const ConfigKey& configKey = it.value();
-                if (configKey.group != "[KeyboardShortcuts]") {
+                if (configKey.group() != "[KeyboardShortcuts]") {
                     ControlObject* control = ControlObject::getControl(configKey);
                     if (control) {
                         //qDebug() << configKey << "MIDI_NOTE_ON" << 1;
@@ -69,7 +69,7 @@ bool KeyboardEventFilter::eventFilter(QObject*, QEvent* e) {
                         result = true;
                     } else {
                         qDebug() << "Warning: Keyboard key is configured for nonexistent control:"
-                                 << configKey.group << configKey.item;
+                                 << configKey.group() << configKey.item();
                     }
                 }
             }
@@ -220,7 +220,7 @@ MidiInputMappings LearningUtils::guessMidiInputMappings(
         // mapping has a reset control then we map the NOTE_ON messages to the
         // reset control.
         ConfigKey resetControl = control;
-        resetControl.item.append("_set_default");
+        resetControl.setItem(resetControl.item() + "_set_default");
         bool hasResetControl = ControlObject::getControl(resetControl) != NULL;
 
         // Find the CC control (based on the predicate one must exist) and add a
@@ -86,8 +86,8 @@ void MidiController::createOutputHandlers() {
 
         const MidiOutputMapping& mapping = outIt.value();
 
-        QString group = mapping.controlKey.group;
-        QString key = mapping.controlKey.item;
+        QString group = mapping.controlKey.group();
+        QString key = mapping.controlKey.item();
 
         unsigned char status = mapping.output.status;
         unsigned char control = mapping.output.control;
@@ -174,7 +174,7 @@ void MidiController::learnTemporaryInputMappings(const MidiInputMappings& mappin
                 QString("0x%1")
                 .arg(QString::number(mapping.key.status, 16).toUpper());
         qDebug() << "Set mapping for" << message << "to"
-                 << mapping.control.group << mapping.control.item;
+                 << mapping.control.group() << mapping.control.item();
     }
 }
 
@@ -243,11 +243,11 @@ void MidiController::processInputMapping(const MidiInputMapping& mapping,
             return;
         }
 
-        QScriptValue function = pEngine->wrapFunctionCode(mapping.control.item, 5);
+        QScriptValue function = pEngine->wrapFunctionCode(mapping.control.item(), 5);
         if (!pEngine->execute(function, channel, control, value, status,
-                              mapping.control.group, timestamp)) {
+                              mapping.control.group(), timestamp)) {
             qDebug() << "MidiController: Invalid script function"
-                     << mapping.control.item;
+                     << mapping.control.item();
         }
         return;
     }
@@ -490,10 +490,10 @@ void MidiController::processInputMapping(const MidiInputMapping& mapping,
         if (pEngine == NULL) {
             return;
         }
-        QScriptValue function = pEngine->wrapFunctionCode(mapping.control.item, 2);
+        QScriptValue function = pEngine->wrapFunctionCode(mapping.control.item(), 2);
         if (!pEngine->execute(function, data, timestamp)) {
             qDebug() << "MidiController: Invalid script function"
-                     << mapping.control.item;
+                     << mapping.control.item();
         }
         return;
     }
@@ -97,7 +97,7 @@ ControllerPresetPointer MidiControllerPresetFileHandler::load(const QDomElement
         // qDebug() << "New mapping:" << QString::number(mapping.key.key, 16).toUpper()
         //          << QString::number(mapping.key.status, 16).toUpper()
         //          << QString::number(mapping.key.control, 16).toUpper()
-        //          << mapping.control.group << mapping.control.item;
+        //          << mapping.control.group() << mapping.control.item();
 
         // Use insertMulti because we support multiple inputs mappings for the
         // same input MidiKey.
@@ -249,8 +249,8 @@ QDomElement MidiControllerPresetFileHandler::inputMappingToXML(
         QDomDocument* doc, const MidiInputMapping& mapping) const {
     QDomElement controlNode = doc->createElement("control");
 
-    controlNode.appendChild(makeTextElement(doc, "group", mapping.control.group));
-    controlNode.appendChild(makeTextElement(doc, "key", mapping.control.item));
+    controlNode.appendChild(makeTextElement(doc, "group", mapping.control.group()));
+    controlNode.appendChild(makeTextElement(doc, "key", mapping.control.item()));
     if (!mapping.description.isEmpty()) {
         controlNode.appendChild(
             makeTextElement(doc, "description", mapping.description));
@@ -344,8 +344,8 @@ QDomElement MidiControllerPresetFileHandler::outputMappingToXML(
         QDomDocument* doc, const MidiOutputMapping& mapping) const {
     QDomElement outputNode = doc->createElement("output");
 
-    outputNode.appendChild(makeTextElement(doc, "group", mapping.controlKey.group));
-    outputNode.appendChild(makeTextElement(doc, "key", mapping.controlKey.item));
+    outputNode.appendChild(makeTextElement(doc, "group", mapping.controlKey.group()));
+    outputNode.appendChild(makeTextElement(doc, "key", mapping.controlKey.item()));
     if (!mapping.description.isEmpty()) {
         outputNode.appendChild(
             makeTextElement(doc, "description", mapping.description));
@@ -25,7 +25,7 @@ MidiOutputHandler::MidiOutputHandler(MidiController* controller,
 MidiOutputHandler::~MidiOutputHandler() {
     ConfigKey cKey = m_cos.getKey();
     controllerDebug(QString("Destroying static MIDI output handler on %1 for %2,%3")
-                .arg(m_pController->getName(), cKey.group, cKey.item));
+                .arg(m_pController->getName(), cKey.group(), cKey.item()));
 }
 
 bool MidiOutputHandler::validate() {
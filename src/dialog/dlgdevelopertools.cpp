@@ -27,7 +27,7 @@ DlgDeveloperTools::DlgDeveloperTools(QWidget* pParent,
             ConfigKey aliasKey = controlAliases[pControl->getKey()];
             if (!aliasKey.isNull()) {
                 m_controlModel.addControl(aliasKey, pControl->name(),
-                                          "Alias for " + pControl->getKey().group + pControl->getKey().item);
+                                          "Alias for " + pControl->getKey().group() + pControl->getKey().item());
             }
         }
     }
@@ -137,8 +137,8 @@ void DlgDeveloperTools::slotControlDump() {
             controlsList.begin(); it != controlsList.end(); ++it) {
         const QSharedPointer<ControlDoublePrivate>& pControl = *it;
         if (pControl) {
-            QString line = pControl->getKey().group + "," +
-                           pControl->getKey().item + "," +
+            QString line = pControl->getKey().group() + "," +
+                           pControl->getKey().item() + "," +
                            QString::number(pControl->get()) + "\n";
             dumpFile.write(line.toLocal8Bit());
         }
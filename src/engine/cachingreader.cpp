@@ -3,6 +3,8 @@
 
 #include "engine/cachingreader.h"
 #include "control/controlobject.h"
+#include "library/previewcache.h"
+#include "mixer/playermanager.h"
 #include "track/track.h"
 #include "util/assert.h"
 #include "util/counter.h"
@@ -24,6 +26,11 @@ const SINT kDefaultHintFrames = 1024;
 //static
 const int CachingReader::maximumCachingReaderChunksInMemory = 80;
 
+// The cache holds the intro chunks of the current track while the worker
+// fills the other ones for the next track
+//static
+const int CachingReader::kIntroChunksCount = 2;
+
 CachingReader::CachingReader(QString group,
                              UserSettingsPointer config)
         : m_pConfig(config),
@@ -32,26 +39,11 @@ CachingReader::CachingReader(QString group,
           m_readerStatus(INVALID),
           m_mruCachingReaderChunk(nullptr),
           m_lruCachingReaderChunk(nullptr),
-          m_sampleBuffer(CachingReaderChunk::kSamples * maximumCachingReaderChunksInMemory),
           m_maxReadableFrameIndex(mixxx::AudioSource::getMinFrameIndex()),
+          m_bPlayIntros(PlayerManager::isPreviewDeckGroup(group)),
+          m_pIntroChunks(nullptr),
           m_worker(group, &m_chunkReadRequestFIFO, &m_readerStatusFIFO) {
 
-    m_allocatedCachingReaderChunks.reserve(maximumCachingReaderChunksInMemory);
-
-    CSAMPLE* bufferStart = m_sampleBuffer.data();
-
-    // Divide up the allocated raw memory buffer into total_chunks
-    // chunks. Initialize each chunk to hold nothing and add it to the free
-    // list.
-    for (int i = 0; i < maximumCachingReaderChunksInMemory; ++i) {
-        CachingReaderChunkForOwner* c = new CachingReaderChunkForOwner(bufferStart);
-
-        m_chunks.push_back(c);
-        m_freeChunks.push_back(c);
-
-        bufferStart += CachingReaderChunk::kSamples;
-    }
-
     // Forward signals from worker
     connect(&m_worker, SIGNAL(trackLoading()),
             this, SIGNAL(trackLoading()),
@@ -63,12 +55,52 @@ CachingReader::CachingReader(QString group,
             this, SIGNAL(trackLoadFailed(TrackPointer, QString)),
             Qt::DirectConnection);
 
-    m_worker.start(QThread::HighPriority);
+    // The chunk memory and the worker thread are only set up when the first
+    // track is loaded (see newTrack()). Most samplers and preview decks
+    // never load a track and shouldn't cost us 5 MiB and a thread each.
 }
 
 CachingReader::~CachingReader() {
     m_worker.quitWait();
     qDeleteAll(m_chunks);
+    qDeleteAll(m_introChunks);
+}
+
+void CachingReader::allocateChunks() {
+    if (!m_chunks.isEmpty()) {
+        return;
+    }
+
+    SampleBuffer(CachingReaderChunk::kSamples * maximumCachingReaderChunksInMemory)
+            .swap(m_sampleBuffer);
+    m_allocatedCachingReaderChunks.reserve(maximumCachingReaderChunksInMemory);
+    m_chunks.reserve(maximumCachingReaderChunksInMemory);
+
+    CSAMPLE* bufferStart = m_sampleBuffer.data();
+
+    // Divide up the allocated raw memory buffer into total_chunks
+    // chunks. Initialize each chunk to hold nothing and add it to the free
+    // list.
+    for (int i = 0; i < maximumCachingReaderChunksInMemory; ++i) {
+        CachingReaderChunkForOwner* c = new CachingReaderChunkForOwner(bufferStart);
+
+        m_chunks.push_back(c);
+        m_freeChunks.push_back(c);
+
+        bufferStart += CachingReaderChunk::kSamples;
+    }
+
+    if (m_bPlayIntros) {
+        DEBUG_ASSERT(PreviewCache::kIntroFrameCount % CachingReaderChunk::kFrames == 0);
+        const int introChunkCount =
+                PreviewCache::kIntroFrameCount / CachingReaderChunk::kFrames;
+        m_introChunks.reserve(kIntroChunksCount);
+        for (int i = 0; i < kIntroChunksCount; ++i) {
+            m_introChunks.push_back(new CachingReaderIntroChunks(introChunkCount));
+        }
+        // The worker has not been started yet
+        m_worker.enablePreviewIntros(m_pConfig, m_introChunks);
+    }
 }
 
 void CachingReader::freeChunk(CachingReaderChunkForOwner* pChunk) {
@@ -165,6 +197,21 @@ void CachingReader::freshenChunk(CachingReaderChunkForOwner* pChunk) {
     m_mruCachingReaderChunk = pChunk;
 }
 
+void CachingReader::takeIntroChunks(CachingReaderIntroChunks* pIntroChunks) {
+    if (m_pIntroChunks) {
+        // Allow the worker to fill them for another track
+        m_pIntroChunks->release();
+    }
+    m_pIntroChunks = pIntroChunks;
+}
+
+const CachingReaderChunkForIntro* CachingReader::lookupIntroChunk(SINT chunkIndex) const {
+    if (!m_pIntroChunks) {
+        return nullptr;
+    }
+    return m_pIntroChunks->lookupChunk(chunkIndex);
+}
+
 CachingReaderChunkForOwner* CachingReader::lookupChunkAndFreshen(SINT chunkIndex) {
     CachingReaderChunkForOwner* pChunk = lookupChunk(chunkIndex);
     if ((pChunk != nullptr) &&
@@ -175,7 +222,16 @@ CachingReaderChunkForOwner* CachingReader::lookupChunkAndFreshen(SINT chunkIndex
 }
 
 void CachingReader::newTrack(TrackPointer pTrack) {
+    if (pTrack) {
+        // The chunks must be allocated before the worker is told about the
+        // track. The engine thread only touches them after it has received
+        // TRACK_LOADED from the worker through m_readerStatusFIFO.
+        allocateChunks();
+    }
     m_worker.newTrack(pTrack);
+    if (pTrack && !m_worker.isRunning()) {
+        m_worker.start(QThread::HighPriority);
+    }
     m_worker.workReady();
 }
 
@@ -199,8 +255,11 @@ void CachingReader::process() {
         }
         if (status.status == TRACK_NOT_LOADED) {
             m_readerStatus = status.status;
+            takeIntroChunks(nullptr);
         } else if (status.status == TRACK_LOADED) {
             m_readerStatus = status.status;
+            // Replace the intro of the previous track
+            takeIntroChunks(status.introChunks);
             // Reset the max. readable frame index
             m_maxReadableFrameIndex = status.maxReadableFrameIndex;
             // Free all chunks with sample data from a previous track
@@ -294,9 +353,15 @@ SINT CachingReader::read(SINT startSample, SINT numSamples, bool reverse, CSAMPL
             SINT lastCachingReaderChunkIndex = CachingReaderChunk::indexForFrame(maxReadableFrameIndex - 1);
             for (SINT chunkIndex = firstCachingReaderChunkIndex; chunkIndex <= lastCachingReaderChunkIndex; ++chunkIndex) {
 
-                const CachingReaderChunkForOwner* const pChunk = lookupChunkAndFreshen(chunkIndex);
+                const CachingReaderChunkForOwner* const pCachedChunk = lookupChunkAndFreshen(chunkIndex);
+                const CachingReaderChunk* pChunk = pCachedChunk;
+                if (!pCachedChunk || (pCachedChunk->getState() != CachingReaderChunkForOwner::READY)) {
+                    // A preview deck reads from the intro until the chunk
+                    // has been read from the audio source
+                    pChunk = lookupIntroChunk(chunkIndex);
+                }
                 // If the chunk is not in cache, then we must return an error.
-                if (!pChunk || (pChunk->getState() != CachingReaderChunkForOwner::READY)) {
+                if (!pChunk) {
                     Counter("CachingReader::read(): Failed to read chunk on cache miss")++;
                     // Exit the loop and fill the remaining buffer with silence
                     break;
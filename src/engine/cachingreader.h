@@ -71,6 +71,10 @@ typedef QVarLengthArray<Hint, 512> HintVector;
 // least-recently-used list. When a chunk needs to be allocated and there are no
 // free chunks then the least recently used chunk is free'd (see
 // allocateChunkExpireLRU).
+//
+// Preview decks additionally start playing tracks from their intros in the
+// PreviewCache while the worker opens the audio source. Until a chunk has
+// been read from the audio source it is read from the intro chunks instead.
 class CachingReader : public QObject {
     Q_OBJECT
 
@@ -95,7 +99,9 @@ class CachingReader : public QObject {
 
     // Request that the CachingReader load a new track. These requests are
     // processed in the work thread, so the reader must be woken up via wake()
-    // for this to take effect.
+    // for this to take effect. The chunk memory and the worker thread are
+    // created on the first call with a valid track. Must be called from the
+    // thread that owns the reader (not the engine callback).
     virtual void newTrack(TrackPointer pTrack);
 
     void setScheduler(EngineWorkerScheduler* pScheduler) {
@@ -130,12 +136,24 @@ class CachingReader : public QObject {
     // Moves the provided chunk to the MRU position.
     void freshenChunk(CachingReaderChunkForOwner* pChunk);
 
+    // Allocates the raw sample memory and divides it into chunks. Does
+    // nothing if the chunks have already been allocated.
+    void allocateChunks();
+
     // Returns a CachingReaderChunk to the free list
     void freeChunk(CachingReaderChunkForOwner* pChunk);
 
     // Returns all allocated chunks to the free list
     void freeAllChunks();
 
+    // Takes over the intro chunks of a new track from the worker and
+    // releases those of the previous track.
+    void takeIntroChunks(CachingReaderIntroChunks* pIntroChunks);
+
+    // Returns the intro chunk with the given index or nullptr if the
+    // intro doesn't contain it.
+    const CachingReaderChunkForIntro* lookupIntroChunk(SINT chunkIndex) const;
+
     // Gets a chunk from the free list. Returns nullptr if none available.
     CachingReaderChunkForOwner* allocateChunk(SINT chunkIndex);
 
@@ -159,7 +177,8 @@ class CachingReader : public QObject {
     CachingReaderChunkForOwner* m_mruCachingReaderChunk;
     CachingReaderChunkForOwner* m_lruCachingReaderChunk;
 
-    // The raw memory buffer which is divided up into chunks.
+    // The raw memory buffer which is divided up into chunks. Empty until the
+    // first track is loaded.
     SampleBuffer m_sampleBuffer;
 
     // The maximum readable frame index as reported by the worker.
@@ -167,6 +186,15 @@ class CachingReader : public QObject {
     // frame with sample data.
     SINT m_maxReadableFrameIndex;
 
+    // Only preview decks play intros
+    static const int kIntroChunksCount;
+    const bool m_bPlayIntros;
+    // The intro chunks that are shared with the worker
+    QVector<CachingReaderIntroChunks*> m_introChunks;
+    // The intro chunks of the current track that have been passed from
+    // the worker along with TRACK_LOADED
+    CachingReaderIntroChunks* m_pIntroChunks;
+
     CachingReaderWorker m_worker;
 };
 
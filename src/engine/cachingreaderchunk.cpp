@@ -109,6 +109,16 @@ SINT CachingReaderChunk::readSampleFrames(
     return m_frameCount;
 }
 
+SINT CachingReaderChunk::convertSampleFramesS16(
+        const SAMPLE* sampleBuffer, SINT frameCount) {
+    DEBUG_ASSERT(0 <= frameCount);
+    DEBUG_ASSERT(frameCount <= kFrames);
+    SampleUtil::convertS16ToFloat32(
+            m_sampleBuffer, sampleBuffer, frames2samples(frameCount));
+    m_frameCount = frameCount;
+    return m_frameCount;
+}
+
 void CachingReaderChunk::copySamples(
         CSAMPLE* sampleBuffer, SINT sampleOffset, SINT sampleCount) const {
     DEBUG_ASSERT(0 <= sampleOffset);
@@ -192,3 +202,53 @@ void CachingReaderChunkForOwner::removeFromList(
         *ppTail = pPrev;
     }
 }
+
+CachingReaderChunkForIntro::CachingReaderChunkForIntro(
+        CSAMPLE* sampleBuffer)
+        : CachingReaderChunk(sampleBuffer) {
+}
+
+CachingReaderChunkForIntro::~CachingReaderChunkForIntro() {
+}
+
+SINT CachingReaderChunkForIntro::fill(
+        SINT index, const SAMPLE* sampleBuffer, SINT frameCount) {
+    init(index);
+    return convertSampleFramesS16(sampleBuffer, frameCount);
+}
+
+CachingReaderIntroChunks::CachingReaderIntroChunks(int chunkCount)
+        : m_sampleBuffer(CachingReaderChunk::kSamples * chunkCount),
+          m_acquired(0) {
+    m_chunks.reserve(chunkCount);
+    CSAMPLE* bufferStart = m_sampleBuffer.data();
+    for (int i = 0; i < chunkCount; ++i) {
+        m_chunks.push_back(new CachingReaderChunkForIntro(bufferStart));
+        bufferStart += CachingReaderChunk::kSamples;
+    }
+}
+
+CachingReaderIntroChunks::~CachingReaderIntroChunks() {
+    qDeleteAll(m_chunks);
+}
+
+const CachingReaderChunkForIntro* CachingReaderIntroChunks::lookupChunk(
+        SINT chunkIndex) const {
+    if (m_chunks.isEmpty()) {
+        return nullptr;
+    }
+    // The worker fills the intro chunks in order
+    const SINT firstChunkIndex = m_chunks.first()->getIndex();
+    if ((firstChunkIndex == CachingReaderChunk::kInvalidIndex) ||
+            (chunkIndex < firstChunkIndex) ||
+            (chunkIndex >= firstChunkIndex + m_chunks.size())) {
+        return nullptr;
+    }
+    const CachingReaderChunkForIntro* pChunk =
+            m_chunks[chunkIndex - firstChunkIndex];
+    if (pChunk->getIndex() != chunkIndex) {
+        // Beyond the end of the intro
+        return nullptr;
+    }
+    return pChunk;
+}
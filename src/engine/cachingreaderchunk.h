@@ -1,6 +1,9 @@
 #ifndef ENGINE_CACHINGREADERCHUNK_H
 #define ENGINE_CACHINGREADERCHUNK_H
 
+#include <QAtomicInt>
+#include <QVector>
+
 #include "sources/audiosource.h"
 
 // A Chunk is a memory-resident section of audio that has been cached.
@@ -93,6 +96,12 @@ protected:
 
     void init(SINT index);
 
+    // Convert frameCount sample frames with 16-bit stereo samples into
+    // the chunk's internal buffer and return the number of frames.
+    SINT convertSampleFramesS16(
+            const SAMPLE* sampleBuffer,
+            SINT frameCount);
+
 private:
     volatile SINT m_index;
 
@@ -154,5 +163,64 @@ private:
     CachingReaderChunkForOwner* m_pNext; // next item in double-linked list
 };
 
+// The intro of a track that is loaded into a preview deck is kept in
+// separate chunks (see PreviewCache). The cache reads from them until the
+// chunks with the same index have been read from the audio source.
+class CachingReaderChunkForIntro: public CachingReaderChunk {
+public:
+    explicit CachingReaderChunkForIntro(CSAMPLE* sampleBuffer);
+    virtual ~CachingReaderChunkForIntro();
+
+    void clear() {
+        init(kInvalidIndex);
+    }
+
+    // Fill the chunk with the given index from frameCount sample
+    // frames of the intro and return the number of frames.
+    SINT fill(
+            SINT index,
+            const SAMPLE* sampleBuffer,
+            SINT frameCount);
+};
+
+// Consecutive intro chunks of a single track, beginning with the chunk at
+// the start of the intro.
+//
+// Like the chunks of the cache they are handed over between the worker and
+// the cache, which read and write them without locking. The worker acquires
+// the intro chunks and fills them while loading a track. It passes them to
+// the cache along with TRACK_LOADED through the reader status FIFO. The
+// cache releases them again when it receives the status of the next track.
+// Until then they are read-only and the worker fills other intro chunks
+// for the next track.
+class CachingReaderIntroChunks {
+public:
+    explicit CachingReaderIntroChunks(int chunkCount);
+    ~CachingReaderIntroChunks();
+
+    // Called by the worker before filling the chunks. Fails while the
+    // chunks have not been released by the cache.
+    bool tryAcquire() {
+        return m_acquired.testAndSetAcquire(0, 1);
+    }
+    // Called by the cache if it doesn't read from the chunks anymore or
+    // by the worker if it didn't pass them to the cache.
+    void release() {
+        m_acquired.fetchAndStoreRelease(0);
+    }
+
+    const QVector<CachingReaderChunkForIntro*>& chunks() const {
+        return m_chunks;
+    }
+
+    // Returns the intro chunk with the given index or nullptr if the
+    // intro doesn't contain it.
+    const CachingReaderChunkForIntro* lookupChunk(SINT chunkIndex) const;
+
+private:
+    SampleBuffer m_sampleBuffer;
+    QVector<CachingReaderChunkForIntro*> m_chunks;
+    QAtomicInt m_acquired;
+};
 
 #endif // ENGINE_CACHINGREADERCHUNK_H
@@ -8,6 +8,7 @@
 #include "sources/soundsourceproxy.h"
 #include "util/compatibility.h"
 #include "util/event.h"
+#include "util/math.h"
 
 
 CachingReaderWorker::CachingReaderWorker(
@@ -31,6 +32,10 @@ ReaderStatusUpdate CachingReaderWorker::processReadRequest(
     CachingReaderChunk* pChunk = request.chunk;
     DEBUG_ASSERT(pChunk);
 
+    if (m_pPendingTrack) {
+        openPendingAudioSource();
+    }
+
     // Before trying to read any data we need to check if the audio source
     // is available and if any audio data that is needed by the chunk is
     // actually available.
@@ -62,6 +67,14 @@ ReaderStatusUpdate CachingReaderWorker::processReadRequest(
     return ReaderStatusUpdate(status, pChunk, m_maxReadableFrameIndex);
 }
 
+void CachingReaderWorker::enablePreviewIntros(
+        UserSettingsPointer pConfig,
+        const QVector<CachingReaderIntroChunks*>& introChunks) {
+    DEBUG_ASSERT(!isRunning());
+    m_pPreviewCache = std::make_unique<PreviewCache>(pConfig);
+    m_introChunks = introChunks;
+}
+
 // WARNING: Always called from a different thread (GUI)
 void CachingReaderWorker::newTrack(TrackPointer pTrack) {
     QMutexLocker locker(&m_newTrackMutex);
@@ -90,6 +103,8 @@ void CachingReaderWorker::run() {
             // Read the requested chunk and send the result
             const ReaderStatusUpdate update(processReadRequest(request));
             m_pReaderStatusFIFO->writeBlocking(&update, 1);
+        } else if (m_pPendingTrack) {
+            openPendingAudioSource();
         } else {
             Event::end(m_tag);
             m_semaRun.acquire();
@@ -114,6 +129,8 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
     // Emit that a new track is loading, stops the current track
     emit(trackLoading());
 
+    m_pPendingTrack.reset();
+
     ReaderStatusUpdate status;
     status.status = TRACK_NOT_LOADED;
 
@@ -137,6 +154,84 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
         return;
     }
 
+    // A preview deck starts playing from the intro of the track and the
+    // audio source is opened afterwards. Opening files on network storage
+    // may take a while.
+    PreviewCache::Intro intro;
+    CachingReaderIntroChunks* pIntroChunks = loadIntro(pTrack, &intro);
+    if (pIntroChunks) {
+        m_pAudioSource.reset();
+        m_pPendingTrack = pTrack;
+        m_maxReadableFrameIndex =
+                mixxx::AudioSource::getMinFrameIndex() + intro.frameCount;
+        notifyTrackLoaded(pTrack, intro.sampleRate, intro.frameCount,
+                pIntroChunks);
+        return;
+    }
+
+    if (!openAudioSource(pTrack)) {
+        return;
+    }
+    notifyTrackLoaded(pTrack,
+            m_pAudioSource->getSamplingRate(),
+            m_pAudioSource->getFrameCount());
+}
+
+CachingReaderIntroChunks* CachingReaderWorker::loadIntro(
+        const TrackPointer& pTrack, PreviewCache::Intro* pIntro) {
+    if (!m_pPreviewCache || !m_pPreviewCache->loadIntro(*pTrack, pIntro)) {
+        return nullptr;
+    }
+    const SINT firstChunkIndex = CachingReaderChunk::indexForFrame(pIntro->startFrame);
+    VERIFY_OR_DEBUG_ASSERT(CachingReaderChunk::frameForIndex(firstChunkIndex)
+            == pIntro->startFrame) {
+        return nullptr;
+    }
+
+    // The cache might still read from the intro chunks of the previous
+    // tracks if it has not processed their status updates yet. The track
+    // is then loaded without playing its intro.
+    CachingReaderIntroChunks* pIntroChunks = nullptr;
+    for (CachingReaderIntroChunks* pReleasedIntroChunks: m_introChunks) {
+        if (pReleasedIntroChunks->tryAcquire()) {
+            pIntroChunks = pReleasedIntroChunks;
+            break;
+        }
+    }
+    if (!pIntroChunks) {
+        qDebug() << m_group
+                 << "CachingReaderWorker::loadIntro() all intro chunks are in use";
+        return nullptr;
+    }
+
+    for (CachingReaderChunkForIntro* pIntroChunk: pIntroChunks->chunks()) {
+        pIntroChunk->clear();
+    }
+    const SINT introFrameCount = pIntro->getIntroFrameCount();
+    SINT frameOffset = 0;
+    SINT chunkIndex = firstChunkIndex;
+    for (CachingReaderChunkForIntro* pIntroChunk: pIntroChunks->chunks()) {
+        const SINT frameIndex = pIntro->startFrame + frameOffset;
+        const SINT frameCount = math_min(
+                CachingReaderChunk::kFrames, introFrameCount - frameOffset);
+        // Only the last chunk of the track may be incomplete
+        if ((frameCount <= 0) || ((frameCount < CachingReaderChunk::kFrames) &&
+                (frameIndex + frameCount < pIntro->frameCount))) {
+            break;
+        }
+        frameOffset += pIntroChunk->fill(chunkIndex,
+                &pIntro->samples[CachingReaderChunk::frames2samples(frameOffset)],
+                frameCount);
+        ++chunkIndex;
+    }
+    if (frameOffset <= 0) {
+        pIntroChunks->release();
+        return nullptr;
+    }
+    return pIntroChunks;
+}
+
+bool CachingReaderWorker::openAudioSource(const TrackPointer& pTrack) {
     mixxx::AudioSourceConfig audioSrcCfg;
     audioSrcCfg.setChannelCount(CachingReaderChunk::kChannels);
     m_pAudioSource = openAudioSourceForReading(pTrack, audioSrcCfg);
@@ -144,20 +239,45 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
         m_maxReadableFrameIndex = mixxx::AudioSource::getMinFrameIndex();
         // Must unlock before emitting to avoid deadlock
         qDebug() << m_group << "CachingReaderWorker::loadTrack() load failed for\""
-                 << filename << "\", file invalid, unlocked reader lock";
+                 << pTrack->getLocation() << "\", file invalid, unlocked reader lock";
+        const ReaderStatusUpdate status(TRACK_NOT_LOADED, nullptr,
+                m_maxReadableFrameIndex);
         m_pReaderStatusFIFO->writeBlocking(&status, 1);
         emit(trackLoadFailed(
-            pTrack, QString("The file '%1' could not be loaded.").arg(filename)));
-        return;
+            pTrack, QString("The file '%1' could not be loaded.")
+                    .arg(pTrack->getLocation())));
+        return false;
     }
 
     // Initially assume that the complete content offered by audio source
     // is available for reading. Later if read errors occur this value will
     // be decreased to avoid repeated reading of corrupt audio data.
     m_maxReadableFrameIndex = m_pAudioSource->getMaxFrameIndex();
+    return true;
+}
 
+void CachingReaderWorker::openPendingAudioSource() {
+    TrackPointer pTrack;
+    pTrack.swap(m_pPendingTrack);
+    const SINT maxReadableFrameIndex = m_maxReadableFrameIndex;
+    if (openAudioSource(pTrack)) {
+        // The engine has already been told about the length of the track
+        // from its intro. The adjusted max. readable frame index is sent
+        // along with the following chunks.
+        m_maxReadableFrameIndex = math_min(
+                m_maxReadableFrameIndex, maxReadableFrameIndex);
+    }
+}
+
+void CachingReaderWorker::notifyTrackLoaded(const TrackPointer& pTrack,
+        SINT sampleRate, SINT frameCount,
+        CachingReaderIntroChunks* pIntroChunks) {
+    ReaderStatusUpdate status;
     status.maxReadableFrameIndex = m_maxReadableFrameIndex;
     status.status = TRACK_LOADED;
+    // The worker doesn't touch the intro chunks until the cache releases
+    // them again
+    status.introChunks = pIntroChunks;
     m_pReaderStatusFIFO->writeBlocking(&status, 1);
 
     // Clear the chunks to read list.
@@ -171,9 +291,8 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
 
     // Emit that the track is loaded.
     const SINT sampleCount =
-            CachingReaderChunk::frames2samples(
-                    m_pAudioSource->getFrameCount());
-    emit(trackLoaded(pTrack, m_pAudioSource->getSamplingRate(), sampleCount));
+            CachingReaderChunk::frames2samples(frameCount);
+    emit(trackLoaded(pTrack, sampleRate, sampleCount));
 }
 
 void CachingReaderWorker::quitWait() {
@@ -6,12 +6,16 @@
 #include <QSemaphore>
 #include <QThread>
 #include <QString>
+#include <QVector>
 
 #include "engine/cachingreaderchunk.h"
 #include "track/track.h"
 #include "engine/engineworker.h"
+#include "library/previewcache.h"
+#include "preferences/usersettings.h"
 #include "sources/audiosource.h"
 #include "util/fifo.h"
+#include "util/memory.h"
 
 
 typedef struct CachingReaderChunkReadRequest {
@@ -36,10 +40,13 @@ typedef struct ReaderStatusUpdate {
     ReaderStatus status;
     CachingReaderChunk* chunk;
     SINT maxReadableFrameIndex;
+    // The intro of a track in a preview deck, passed along with TRACK_LOADED
+    CachingReaderIntroChunks* introChunks;
     ReaderStatusUpdate()
         : status(INVALID)
         , chunk(nullptr)
-        , maxReadableFrameIndex(mixxx::AudioSource::getMinFrameIndex()) {
+        , maxReadableFrameIndex(mixxx::AudioSource::getMinFrameIndex())
+        , introChunks(nullptr) {
     }
     ReaderStatusUpdate(
             ReaderStatus statusArg,
@@ -47,7 +54,8 @@ typedef struct ReaderStatusUpdate {
             SINT maxReadableFrameIndexArg)
         : status(statusArg)
         , chunk(chunkArg)
-        , maxReadableFrameIndex(maxReadableFrameIndexArg) {
+        , maxReadableFrameIndex(maxReadableFrameIndexArg)
+        , introChunks(nullptr) {
     }
 } ReaderStatusUpdate;
 
@@ -64,6 +72,13 @@ class CachingReaderWorker : public EngineWorker {
     // Request to load a new track. wake() must be called afterwards.
     virtual void newTrack(TrackPointer pTrack);
 
+    // Start playing tracks from their intros in the PreviewCache, which
+    // are read into any of the given intro chunks that have been released
+    // by the cache. Must be called before the worker is started.
+    void enablePreviewIntros(
+            UserSettingsPointer pConfig,
+            const QVector<CachingReaderIntroChunks*>& introChunks);
+
     // Run upkeep operations like loading tracks and reading from file. Run by a
     // thread pool via the EngineWorkerScheduler.
     virtual void run();
@@ -94,12 +109,36 @@ class CachingReaderWorker : public EngineWorker {
     // Internal method to load a track. Emits trackLoaded when finished.
     void loadTrack(const TrackPointer& pTrack);
 
+    // Reads the intro of the track into intro chunks that are not in use
+    // by the cache. Returns the acquired chunks or nullptr if no chunks
+    // have been filled.
+    CachingReaderIntroChunks* loadIntro(
+            const TrackPointer& pTrack, PreviewCache::Intro* pIntro);
+
+    // Emits trackLoadFailed on failure.
+    bool openAudioSource(const TrackPointer& pTrack);
+    // Opens the audio source of a track that has been loaded from its intro
+    void openPendingAudioSource();
+
+    // Passes the intro chunks, if any, to the cache
+    void notifyTrackLoaded(const TrackPointer& pTrack,
+            SINT sampleRate, SINT frameCount,
+            CachingReaderIntroChunks* pIntroChunks = nullptr);
+
     ReaderStatusUpdate processReadRequest(
             const CachingReaderChunkReadRequest& request);
 
     // The current audio source of the track loaded
     mixxx::AudioSourcePointer m_pAudioSource;
 
+    // Only available for preview decks
+    std::unique_ptr<PreviewCache> m_pPreviewCache;
+    QVector<CachingReaderIntroChunks*> m_introChunks;
+
+    // The track that is played from its intro while the audio source
+    // has not been opened yet
+    TrackPointer m_pPendingTrack;
+
     // The maximum readable frame index of the AudioSource. Might
     // be adjusted when decoding errors occur to prevent reading
     // the same chunk(s) over and over again.
@@ -20,7 +20,9 @@
 // to increase the amount of time the CPU has to do whatever work needs to
 // be done, and that work is executed in a separate thread. (Threading
 // allows the next buffer to be filled while processing a buffer that's is
-// already full.)
+// already full.) Each worker runs on its own SideChainWorkerThread, which is
+// fed from this thread through a bounded queue, so that a slow worker can't
+// hold up the other ones.
 
 #include "engine/sidechain/enginesidechain.h"
 
@@ -28,6 +30,7 @@
 #include <QMutexLocker>
 
 #include "engine/sidechain/sidechainworker.h"
+#include "engine/sidechain/sidechainworkerthread.h"
 #include "util/counter.h"
 #include "util/event.h"
 #include "util/sample.h"
@@ -35,6 +38,9 @@
 #include "util/trace.h"
 
 #define SIDECHAIN_BUFFER_SIZE 65536
+// Each worker may fall behind by this many samples (~3 s of stereo audio at
+// 44.1 kHz) before samples are dropped for that worker.
+#define SIDECHAIN_WORKER_QUEUE_SIZE (4 * SIDECHAIN_BUFFER_SIZE)
 
 EngineSideChain::EngineSideChain(UserSettingsPointer pConfig)
         : m_pConfig(pConfig),
@@ -61,8 +67,12 @@ EngineSideChain::~EngineSideChain() {
 
     MMutexLocker locker(&m_workerLock);
     while (!m_workers.empty()) {
-        SideChainWorker* pWorker = m_workers.takeLast();
+        SideChainWorkerThread* pWorkerThread = m_workers.takeLast();
+        // Lets the worker process what is left in its queue.
+        pWorkerThread->stop();
+        SideChainWorker* pWorker = pWorkerThread->worker();
         pWorker->shutdown();
+        delete pWorkerThread;
         delete pWorker;
     }
     locker.unlock();
@@ -72,7 +82,18 @@ EngineSideChain::~EngineSideChain() {
 
 void EngineSideChain::addSideChainWorker(SideChainWorker* pWorker) {
     MMutexLocker locker(&m_workerLock);
-    m_workers.append(pWorker);
+    m_workers.append(new SideChainWorkerThread(
+            pWorker, SIDECHAIN_WORKER_QUEUE_SIZE, m_workers.size() + 1));
+}
+
+int EngineSideChain::droppedSamples(SideChainWorker* pWorker) {
+    MMutexLocker locker(&m_workerLock);
+    for (SideChainWorkerThread* pWorkerThread : m_workers) {
+        if (pWorkerThread->worker() == pWorker) {
+            return pWorkerThread->droppedSamples();
+        }
+    }
+    return -1;
 }
 
 void EngineSideChain::writeSamples(const CSAMPLE* newBuffer, int buffer_size) {
@@ -111,8 +132,13 @@ void EngineSideChain::run() {
                                                  SIDECHAIN_BUFFER_SIZE))) {
             Trace process("EngineSideChain::process");
             MMutexLocker locker(&m_workerLock);
-            foreach (SideChainWorker* pWorker, m_workers) {
-                pWorker->process(m_pWorkBuffer, samples_read);
+            for (SideChainWorkerThread* pWorkerThread : m_workers) {
+                // The worker can't keep up. Drop the samples for this worker
+                // only instead of blocking everyone else.
+                if (pWorkerThread->writeSamples(m_pWorkBuffer, samples_read) > 0) {
+                    Counter("EngineSideChain::run worker queue overrun").increment();
+                }
+                pWorkerThread->wake();
             }
         }
 
@@ -28,6 +28,8 @@
 #include "util/mutex.h"
 #include "util/types.h"
 
+class SideChainWorkerThread;
+
 class EngineSideChain : public QThread {
     Q_OBJECT
   public:
@@ -39,9 +41,16 @@ class EngineSideChain : public QThread {
     // the engine callback).
     void writeSamples(const CSAMPLE* buffer, int buffer_size);
 
-    // Thread-safe, blocking.
+    // Thread-safe, blocking. Takes ownership of pWorker and runs it on a
+    // dedicated thread.
     void addSideChainWorker(SideChainWorker* pWorker);
 
+    // Thread-safe, blocking. The number of samples that were dropped for
+    // pWorker so far because it could not keep up with the engine, or -1 if
+    // pWorker has not been added. May be polled while the worker is running,
+    // e.g. to warn about an incomplete recording or broadcast.
+    int droppedSamples(SideChainWorker* pWorker);
+
   private:
     void run();
 
@@ -57,9 +66,9 @@ class EngineSideChain : public QThread {
     // Allows sleeping until we have samples to process.
     QWaitCondition m_waitForSamples;
 
-    // Sidechain workers registered with EngineSideChain.
+    // Threads running the sidechain workers registered with EngineSideChain.
     MMutex m_workerLock;
-    QList<SideChainWorker*> m_workers GUARDED_BY(m_workerLock);
+    QList<SideChainWorkerThread*> m_workers GUARDED_BY(m_workerLock);
 };
 
 #endif
@@ -0,0 +1,97 @@
+#include "engine/sidechain/sidechainworkerthread.h"
+
+#include <QMutexLocker>
+#include <QtDebug>
+
+#include "engine/sidechain/sidechainworker.h"
+#include "util/compatibility.h"
+#include "util/counter.h"
+#include "util/event.h"
+#include "util/sample.h"
+#include "util/trace.h"
+
+namespace {
+
+// The size of the chunks handed to SideChainWorker::process().
+const int kWorkBufferSize = 16384;
+
+}  // anonymous namespace
+
+SideChainWorkerThread::SideChainWorkerThread(SideChainWorker* pWorker,
+                                             int queueSize, int id)
+        : m_pWorker(pWorker),
+          m_id(id),
+          m_sampleFifo(queueSize),
+          m_pWorkBuffer(SampleUtil::alloc(kWorkBufferSize)),
+          m_workBufferSize(kWorkBufferSize),
+          m_droppedSamples(0),
+          m_bStopThread(false) {
+    // Same reasoning as for EngineSideChain: encoding has semi-realtime
+    // requirements and must not be starved by the GUI or analysis.
+    start(QThread::HighPriority);
+}
+
+SideChainWorkerThread::~SideChainWorkerThread() {
+    stop();
+    SampleUtil::free(m_pWorkBuffer);
+}
+
+int SideChainWorkerThread::writeSamples(const CSAMPLE* pBuffer, int iBufferSize) {
+    const int samplesWritten = m_sampleFifo.write(pBuffer, iBufferSize);
+    const int samplesDropped = iBufferSize - samplesWritten;
+    if (samplesDropped > 0) {
+        m_droppedSamples.fetchAndAddRelaxed(samplesDropped);
+    }
+    return samplesDropped;
+}
+
+void SideChainWorkerThread::wake() {
+    QMutexLocker locker(&m_waitLock);
+    m_waitForSamples.wakeAll();
+}
+
+void SideChainWorkerThread::stop() {
+    m_waitLock.lock();
+    m_bStopThread = true;
+    m_waitForSamples.wakeAll();
+    m_waitLock.unlock();
+    wait();
+}
+
+int SideChainWorkerThread::droppedSamples() const {
+    return load_atomic(m_droppedSamples);
+}
+
+void SideChainWorkerThread::run() {
+    const QString tag = QString("SideChainWorkerThread %1").arg(m_id);
+    QThread::currentThread()->setObjectName(tag);
+
+    Event::start(tag);
+    while (true) {
+        int samplesRead;
+        while ((samplesRead = m_sampleFifo.read(m_pWorkBuffer,
+                                                m_workBufferSize))) {
+            Trace process("SideChainWorkerThread::process");
+            m_pWorker->process(m_pWorkBuffer, samplesRead);
+        }
+
+        QMutexLocker locker(&m_waitLock);
+        if (m_bStopThread) {
+            break;
+        }
+        // Samples may have arrived since we emptied the queue.
+        if (m_sampleFifo.readAvailable() > 0) {
+            continue;
+        }
+        Event::end(tag);
+        m_waitForSamples.wait(&m_waitLock);
+        Event::start(tag);
+    }
+    Event::end(tag);
+
+    const int samplesDropped = droppedSamples();
+    if (samplesDropped > 0) {
+        qWarning() << tag << "dropped" << samplesDropped
+                   << "samples because the worker could not keep up";
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef SIDECHAINWORKERTHREAD_H
+#define SIDECHAINWORKERTHREAD_H
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "util/fifo.h"
+#include "util/types.h"
+
+class SideChainWorker;
+
+// Runs a single SideChainWorker on its own thread. EngineSideChain fans the
+// master signal out to one SideChainWorkerThread per worker through a bounded
+// FIFO, so a worker that falls behind (e.g. a blocking file or network write
+// in an encoder callback) only drops its own samples instead of stalling the
+// other workers.
+class SideChainWorkerThread : public QThread {
+  public:
+    SideChainWorkerThread(SideChainWorker* pWorker, int queueSize, int id);
+    virtual ~SideChainWorkerThread();
+
+    // Wait-free. Queues samples for the worker and returns the number of
+    // samples that did not fit into the queue and were dropped. Must only be
+    // called from a single writer thread (the EngineSideChain thread).
+    int writeSamples(const CSAMPLE* pBuffer, int iBufferSize);
+
+    // Wakes the worker thread if samples are queued.
+    void wake();
+
+    // Blocks until the thread has processed all queued samples and exited.
+    // Logs the number of dropped samples, if any.
+    void stop();
+
+    SideChainWorker* worker() const {
+        return m_pWorker;
+    }
+
+    // Thread-safe. The number of samples dropped so far because the queue
+    // was full. Also logged when the thread is stopped.
+    int droppedSamples() const;
+
+  private:
+    void run() override;
+
+    SideChainWorker* const m_pWorker;
+    const int m_id;
+    FIFO<CSAMPLE> m_sampleFifo;
+    CSAMPLE* m_pWorkBuffer;
+    const int m_workBufferSize;
+    QAtomicInt m_droppedSamples;
+
+    QMutex m_waitLock;
+    QWaitCondition m_waitForSamples;
+    bool m_bStopThread;
+};
+
+#endif /* SIDECHAINWORKERTHREAD_H */
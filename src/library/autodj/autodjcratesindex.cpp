@@ -0,0 +1,199 @@
+#include "library/autodj/autodjcratesindex.h"
+
+#include <algorithm>
+
+#include "util/assert.h"
+
+AutoDJCratesIndex::AutoDJCratesIndex()
+        : m_activeTrackCount(0),
+          m_unplayedActiveTrackCount(0),
+          m_queuedTrackCount(0),
+          m_bUseIgnoreTime(false) {
+}
+
+void AutoDJCratesIndex::clear() {
+    m_entries.clear();
+    m_buckets.clear();
+    m_activeTrackCount = 0;
+    m_unplayedActiveTrackCount = 0;
+    m_queuedTrackCount = 0;
+}
+
+void AutoDJCratesIndex::setUseIgnoreTime(bool bUseIgnoreTime) {
+    if (m_bUseIgnoreTime == bUseIgnoreTime) {
+        return;
+    }
+    m_bUseIgnoreTime = bUseIgnoreTime;
+
+    // The buckets are keyed differently now
+    m_buckets.clear();
+    m_activeTrackCount = 0;
+    m_unplayedActiveTrackCount = 0;
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        activate(it.key(), it.value());
+    }
+}
+
+bool AutoDJCratesIndex::lessThan(TrackId trackId1, TrackId trackId2) const {
+    const QString& lastPlayed1 = m_entries.constFind(trackId1).value().lastPlayed;
+    const QString& lastPlayed2 = m_entries.constFind(trackId2).value().lastPlayed;
+    if (lastPlayed1 != lastPlayed2) {
+        return lastPlayed1 < lastPlayed2;
+    }
+    return trackId1 < trackId2;
+}
+
+void AutoDJCratesIndex::activate(TrackId trackId, const Entry& entry) {
+    if (entry.autoDjRefs > 0) {
+        return;
+    }
+    Bucket& bucket = m_buckets[bucketKey(entry)];
+    auto it = std::lower_bound(bucket.begin(), bucket.end(), trackId,
+            [this](TrackId trackId1, TrackId trackId2) {
+                return lessThan(trackId1, trackId2);
+            });
+    bucket.insert(it, trackId);
+    ++m_activeTrackCount;
+    if (entry.timesPlayed == 0) {
+        ++m_unplayedActiveTrackCount;
+    }
+}
+
+void AutoDJCratesIndex::deactivate(TrackId trackId, const Entry& entry) {
+    if (entry.autoDjRefs > 0) {
+        return;
+    }
+    auto bucketIt = m_buckets.find(bucketKey(entry));
+    VERIFY_OR_DEBUG_ASSERT(bucketIt != m_buckets.end()) {
+        return;
+    }
+    Bucket& bucket = bucketIt.value();
+    auto it = std::lower_bound(bucket.begin(), bucket.end(), trackId,
+            [this](TrackId trackId1, TrackId trackId2) {
+                return lessThan(trackId1, trackId2);
+            });
+    VERIFY_OR_DEBUG_ASSERT(it != bucket.end() && *it == trackId) {
+        return;
+    }
+    bucket.erase(it);
+    if (bucket.isEmpty()) {
+        m_buckets.erase(bucketIt);
+    }
+    --m_activeTrackCount;
+    if (entry.timesPlayed == 0) {
+        --m_unplayedActiveTrackCount;
+    }
+}
+
+void AutoDJCratesIndex::addTrack(TrackId trackId, int timesPlayed) {
+    if (contains(trackId)) {
+        addCrateReference(trackId);
+        return;
+    }
+    Entry entry;
+    entry.crateRefs = 1;
+    entry.timesPlayed = timesPlayed;
+    m_entries.insert(trackId, entry);
+    activate(trackId, entry);
+}
+
+void AutoDJCratesIndex::addCrateReference(TrackId trackId) {
+    auto it = m_entries.find(trackId);
+    if (it != m_entries.end()) {
+        ++it.value().crateRefs;
+    }
+}
+
+void AutoDJCratesIndex::removeCrateReference(TrackId trackId) {
+    auto it = m_entries.find(trackId);
+    if (it == m_entries.end()) {
+        return;
+    }
+    Entry& entry = it.value();
+    if (--entry.crateRefs > 0) {
+        return;
+    }
+    deactivate(trackId, entry);
+    if (entry.autoDjRefs > 0) {
+        --m_queuedTrackCount;
+    }
+    m_entries.erase(it);
+}
+
+void AutoDJCratesIndex::addAutoDjReference(TrackId trackId) {
+    auto it = m_entries.find(trackId);
+    if (it == m_entries.end()) {
+        return;
+    }
+    Entry& entry = it.value();
+    if (entry.autoDjRefs == 0) {
+        deactivate(trackId, entry);
+        ++m_queuedTrackCount;
+    }
+    ++entry.autoDjRefs;
+}
+
+void AutoDJCratesIndex::removeAutoDjReference(TrackId trackId) {
+    auto it = m_entries.find(trackId);
+    if (it == m_entries.end() || it.value().autoDjRefs == 0) {
+        return;
+    }
+    Entry& entry = it.value();
+    if (--entry.autoDjRefs == 0) {
+        --m_queuedTrackCount;
+        activate(trackId, entry);
+    }
+}
+
+int AutoDJCratesIndex::autoDjReferences(TrackId trackId) const {
+    return m_entries.value(trackId).autoDjRefs;
+}
+
+bool AutoDJCratesIndex::isActive(TrackId trackId) const {
+    auto it = m_entries.constFind(trackId);
+    return it != m_entries.constEnd() && it.value().autoDjRefs == 0;
+}
+
+void AutoDJCratesIndex::setTimesPlayed(TrackId trackId, int timesPlayed) {
+    auto it = m_entries.find(trackId);
+    if (it == m_entries.end() || it.value().timesPlayed == timesPlayed) {
+        return;
+    }
+    deactivate(trackId, it.value());
+    it.value().timesPlayed = timesPlayed;
+    activate(trackId, it.value());
+}
+
+void AutoDJCratesIndex::setLastPlayed(TrackId trackId, const QString& lastPlayed) {
+    auto it = m_entries.find(trackId);
+    if (it == m_entries.end() || it.value().lastPlayed == lastPlayed) {
+        return;
+    }
+    deactivate(trackId, it.value());
+    it.value().lastPlayed = lastPlayed;
+    activate(trackId, it.value());
+}
+
+int AutoDJCratesIndex::activeTrackCountPlayedBefore(const QString& lastPlayed) const {
+    int count = 0;
+    for (const Bucket& bucket : m_buckets) {
+        auto it = std::partition_point(bucket.begin(), bucket.end(),
+                [this, &lastPlayed](TrackId trackId) {
+                    return m_entries.constFind(trackId).value().lastPlayed < lastPlayed;
+                });
+        count += it - bucket.begin();
+    }
+    return count;
+}
+
+TrackId AutoDJCratesIndex::activeTrack(int index) const {
+    DEBUG_ASSERT(index >= 0);
+    for (const Bucket& bucket : m_buckets) {
+        if (index < bucket.size()) {
+            return bucket[index];
+        }
+        index -= bucket.size();
+    }
+    DEBUG_ASSERT(false); // index out of range
+    return TrackId();
+}
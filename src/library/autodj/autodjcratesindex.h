@@ -0,0 +1,115 @@
+#ifndef AUTODJCRATESINDEX_H
+#define AUTODJCRATESINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+#include "track/trackid.h"
+
+// The tracks of the auto-DJ crates, from which Auto DJ picks random tracks.
+//
+// A track is active while it is neither queued in the auto-DJ playlist nor
+// loaded into a deck. The active tracks are partitioned into buckets by the
+// number of times they have been played, and each bucket is sorted by the
+// date/time the track was last played. Together the buckets form the order
+// in which tracks are preferred, least played and longest ago first. The
+// n-th active track is found by skipping whole buckets, so the cost of a
+// random pick only depends on the number of distinct play counts.
+//
+// When tracks that haven't been played in a while are preferred, all active
+// tracks share a single bucket that is only sorted by the last-played
+// date/time.
+//
+// The last-played date/time is the string stored by SQLite, so that it
+// compares like in the database. An empty string means never played.
+class AutoDJCratesIndex {
+  public:
+    AutoDJCratesIndex();
+
+    void clear();
+
+    bool useIgnoreTime() const {
+        return m_bUseIgnoreTime;
+    }
+    void setUseIgnoreTime(bool bUseIgnoreTime);
+
+    bool contains(TrackId trackId) const {
+        return m_entries.contains(trackId);
+    }
+    QList<TrackId> trackIds() const {
+        return m_entries.keys();
+    }
+
+    // Adds a track with a single crate reference. It is active until an
+    // auto-DJ reference is added.
+    void addTrack(TrackId trackId, int timesPlayed);
+    void addCrateReference(TrackId trackId);
+    // The track is removed with its last crate reference
+    void removeCrateReference(TrackId trackId);
+
+    // References by the auto-DJ playlist or a deck. Ignored for tracks that
+    // are not in the index.
+    void addAutoDjReference(TrackId trackId);
+    void removeAutoDjReference(TrackId trackId);
+    int autoDjReferences(TrackId trackId) const;
+    // True if the track is in the index without auto-DJ references
+    bool isActive(TrackId trackId) const;
+
+    void setTimesPlayed(TrackId trackId, int timesPlayed);
+    void setLastPlayed(TrackId trackId, const QString& lastPlayed);
+
+    int activeTrackCount() const {
+        return m_activeTrackCount;
+    }
+    int unplayedActiveTrackCount() const {
+        return m_unplayedActiveTrackCount;
+    }
+    // The number of active tracks that have not been played since the
+    // given date/time.
+    int activeTrackCountPlayedBefore(const QString& lastPlayed) const;
+    // Returns the active track at the given index in order of preference.
+    TrackId activeTrack(int index) const;
+
+    // The number of tracks with auto-DJ references
+    int queuedTrackCount() const {
+        return m_queuedTrackCount;
+    }
+
+  private:
+    struct Entry {
+        Entry()
+                : crateRefs(0),
+                  autoDjRefs(0),
+                  timesPlayed(0) {
+        }
+        int crateRefs;
+        int autoDjRefs;
+        int timesPlayed;
+        QString lastPlayed;
+    };
+    typedef QVector<TrackId> Bucket;
+
+    int bucketKey(const Entry& entry) const {
+        return m_bUseIgnoreTime ? 0 : entry.timesPlayed;
+    }
+    bool lessThan(TrackId trackId1, TrackId trackId2) const;
+
+    // An entry must be deactivated before the fields that sort it are
+    // modified and activated again afterwards.
+    void activate(TrackId trackId, const Entry& entry);
+    void deactivate(TrackId trackId, const Entry& entry);
+
+    QHash<TrackId, Entry> m_entries;
+    QMap<int, Bucket> m_buckets;
+
+    int m_activeTrackCount;
+    int m_unplayedActiveTrackCount;
+    int m_queuedTrackCount;
+
+    bool m_bUseIgnoreTime;
+};
+
+#endif // AUTODJCRATESINDEX_H
@@ -219,15 +219,23 @@ void AutoDJFeature::slotAddRandomTrack() {
                 !pRandomTrack && (failedRetrieveAttempts < 2 * kMaxRetrieveAttempts); // 2 rounds
                 ++failedRetrieveAttempts) {
             TrackId randomTrackId;
-            if (m_crateList.isEmpty()) {
-                // Fetch Track from Library since we have no assigned crates
-                randomTrackId = m_autoDjCratesDao.getRandomTrackIdFromLibrary(
-                        m_iAutoDJPlaylistId);
-            } else {
-                // Fetch track from crates.
-                // We do not fall back to Library if this fails because this
-                // may add banned tracks
-                randomTrackId = m_autoDjCratesDao.getRandomTrackId();
+            if (failedRetrieveAttempts == 0 && m_pConfig->getValue(
+                    ConfigKey("[Auto DJ]", "RandomQueueMatching"), false)) {
+                // Prefer a track that mixes well with the previous one
+                randomTrackId = m_autoDjCratesDao.getMatchingTrackId(
+                        !m_crateList.isEmpty());
+            }
+            if (!randomTrackId.isValid()) {
+                if (m_crateList.isEmpty()) {
+                    // Fetch Track from Library since we have no assigned crates
+                    randomTrackId = m_autoDjCratesDao.getRandomTrackIdFromLibrary(
+                            m_iAutoDJPlaylistId);
+                } else {
+                    // Fetch track from crates.
+                    // We do not fall back to Library if this fails because this
+                    // may add banned tracks
+                    randomTrackId = m_autoDjCratesDao.getRandomTrackId();
+                }
             }
 
             if (randomTrackId.isValid()) {
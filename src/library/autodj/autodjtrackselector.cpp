@@ -0,0 +1,173 @@
+#include "library/autodj/autodjtrackselector.h"
+
+#include <QPair>
+#include <QtGlobal>
+
+#include "track/keyutils.h"
+#include "track/replaygain.h"
+#include "util/assert.h"
+#include "util/math.h"
+
+namespace {
+
+// The distances are scaled such that a single step on the Circle of Fifths
+// weighs as much as a BPM difference of 4% or a loudness difference of 4 dB.
+const double kUnknownKeyDistance = 2.0;
+const double kDistancePerBpmPercent = 0.25;
+const double kUnknownBpmDistance = 2.0;
+const double kDistancePerLoudnessDb = 0.25;
+const double kUnknownLoudnessDistance = 1.0;
+
+double loudnessDbFromReplayGainRatio(double replayGainRatio) {
+    if (!mixxx::ReplayGain::isValidRatio(replayGainRatio)) {
+        return 0.0;
+    }
+    // The louder a track, the less gain it needs.
+    return -ratio2db(replayGainRatio);
+}
+
+} // anonymous namespace
+
+AutoDJTrackSelector::AutoDJTrackSelector()
+        : m_randomGenerator(std::random_device()()) {
+}
+
+void AutoDJTrackSelector::clear() {
+    m_rows.clear();
+    m_trackIds.clear();
+    m_bpms.clear();
+    m_keys.clear();
+    m_loudnessDbs.clear();
+    m_replayGainRatios.clear();
+}
+
+AutoDJTrackSelector::Features AutoDJTrackSelector::getFeatures(
+        TrackId trackId) const {
+    auto it = m_rows.constFind(trackId);
+    if (it == m_rows.constEnd()) {
+        return Features();
+    }
+    const int row = it.value();
+    return Features(m_bpms[row], m_keys[row], m_replayGainRatios[row]);
+}
+
+void AutoDJTrackSelector::setTrack(TrackId trackId, const Features& features) {
+    DEBUG_ASSERT(trackId.isValid());
+    auto it = m_rows.constFind(trackId);
+    int row;
+    if (it == m_rows.constEnd()) {
+        row = m_trackIds.size();
+        m_rows.insert(trackId, row);
+        m_trackIds.append(trackId);
+        m_bpms.append(0.0);
+        m_keys.append(mixxx::track::io::key::INVALID);
+        m_loudnessDbs.append(0.0);
+        m_replayGainRatios.append(0.0);
+    } else {
+        row = it.value();
+    }
+    m_bpms[row] = features.bpm;
+    m_keys[row] = features.key;
+    m_loudnessDbs[row] = loudnessDbFromReplayGainRatio(features.replayGainRatio);
+    m_replayGainRatios[row] = features.replayGainRatio;
+}
+
+void AutoDJTrackSelector::removeTrack(TrackId trackId) {
+    auto it = m_rows.find(trackId);
+    if (it == m_rows.end()) {
+        return;
+    }
+    // Move the last row into the gap
+    const int row = it.value();
+    m_rows.erase(it);
+    const int lastRow = m_trackIds.size() - 1;
+    if (row != lastRow) {
+        m_trackIds[row] = m_trackIds[lastRow];
+        m_bpms[row] = m_bpms[lastRow];
+        m_keys[row] = m_keys[lastRow];
+        m_loudnessDbs[row] = m_loudnessDbs[lastRow];
+        m_replayGainRatios[row] = m_replayGainRatios[lastRow];
+        m_rows[m_trackIds[row]] = row;
+    }
+    m_trackIds.removeLast();
+    m_bpms.removeLast();
+    m_keys.removeLast();
+    m_loudnessDbs.removeLast();
+    m_replayGainRatios.removeLast();
+}
+
+TrackId AutoDJTrackSelector::selectTrack(
+        const Features& reference,
+        const std::function<bool(TrackId)>& isCandidate) {
+    const double referenceLoudnessDb =
+            loudnessDbFromReplayGainRatio(reference.replayGainRatio);
+
+    // The best candidates so far, ordered by their distance
+    QVector<QPair<double, TrackId> > candidates;
+    candidates.reserve(kMaxCandidates + 1);
+    for (int row = 0; row < m_trackIds.size(); ++row) {
+        const double rowDistance = distance(reference, referenceLoudnessDb,
+                m_bpms[row], m_keys[row], m_replayGainRatios[row],
+                m_loudnessDbs[row]);
+        if (candidates.size() == kMaxCandidates &&
+                rowDistance >= candidates.last().first) {
+            continue;
+        }
+        if (!isCandidate(m_trackIds[row])) {
+            continue;
+        }
+        int i = candidates.size();
+        while (i > 0 && candidates[i - 1].first > rowDistance) {
+            --i;
+        }
+        candidates.insert(i, qMakePair(rowDistance, m_trackIds[row]));
+        if (candidates.size() > kMaxCandidates) {
+            candidates.removeLast();
+        }
+    }
+    if (candidates.isEmpty()) {
+        return TrackId();
+    }
+    std::uniform_int_distribution<int> distribution(0, candidates.size() - 1);
+    return candidates[distribution(m_randomGenerator)].second;
+}
+
+// static
+double AutoDJTrackSelector::distance(const Features& reference,
+                                     const Features& candidate) {
+    return distance(reference,
+            loudnessDbFromReplayGainRatio(reference.replayGainRatio),
+            candidate.bpm, candidate.key, candidate.replayGainRatio,
+            loudnessDbFromReplayGainRatio(candidate.replayGainRatio));
+}
+
+// static
+double AutoDJTrackSelector::distance(const Features& reference,
+                                     double referenceLoudnessDb,
+                                     double bpm,
+                                     mixxx::track::io::key::ChromaticKey key,
+                                     double replayGainRatio,
+                                     double loudnessDb) {
+    double result = 0.0;
+
+    const int keySteps = KeyUtils::circleOfFifthsDistance(reference.key, key);
+    result += keySteps < 0 ? kUnknownKeyDistance : keySteps;
+
+    if (reference.bpm > 0.0 && bpm > 0.0) {
+        // Tracks at half or double time mix as well
+        const double ratio = bpm / reference.bpm;
+        const double deviation = math_min(fabs(ratio - 1.0),
+                math_min(fabs(2.0 * ratio - 1.0), fabs(0.5 * ratio - 1.0)));
+        result += deviation * 100.0 * kDistancePerBpmPercent;
+    } else {
+        result += kUnknownBpmDistance;
+    }
+
+    if (mixxx::ReplayGain::isValidRatio(reference.replayGainRatio) &&
+            mixxx::ReplayGain::isValidRatio(replayGainRatio)) {
+        result += fabs(referenceLoudnessDb - loudnessDb) * kDistancePerLoudnessDb;
+    } else {
+        result += kUnknownLoudnessDistance;
+    }
+    return result;
+}
@@ -0,0 +1,93 @@
+#ifndef AUTODJTRACKSELECTOR_H
+#define AUTODJTRACKSELECTOR_H
+
+#include <functional>
+#include <random>
+
+#include <QHash>
+#include <QVector>
+
+#include "proto/keys.pb.h"
+#include "track/trackid.h"
+
+// The musical features of the library tracks, from which Auto DJ selects
+// a track that mixes well with a reference track.
+//
+// A candidate is ranked by the distance of its key on the Circle of Fifths,
+// the difference of its BPM (allowing for half and double time) and the
+// difference of its loudness. The loudness is derived from the ReplayGain
+// ratio, i.e. a track that needs less gain is louder.
+//
+// The features are kept in flat arrays, so that selecting a track is a
+// single linear scan over the library (see BM_SelectTrack).
+class AutoDJTrackSelector {
+  public:
+    // The number of best-ranked candidates that are chosen from at random,
+    // so that Auto DJ doesn't play the same sequence of tracks every time.
+    static const int kMaxCandidates = 8;
+
+    struct Features {
+        Features()
+                : bpm(0.0),
+                  key(mixxx::track::io::key::INVALID),
+                  replayGainRatio(0.0) {
+        }
+        Features(double bpm,
+                 mixxx::track::io::key::ChromaticKey key,
+                 double replayGainRatio)
+                : bpm(bpm),
+                  key(key),
+                  replayGainRatio(replayGainRatio) {
+        }
+        // 0 if unknown
+        double bpm;
+        mixxx::track::io::key::ChromaticKey key;
+        // 0 if unknown
+        double replayGainRatio;
+    };
+
+    AutoDJTrackSelector();
+
+    void clear();
+
+    int trackCount() const {
+        return m_trackIds.size();
+    }
+    bool contains(TrackId trackId) const {
+        return m_rows.contains(trackId);
+    }
+    // Returns the default features if the track is unknown.
+    Features getFeatures(TrackId trackId) const;
+
+    void setTrack(TrackId trackId, const Features& features);
+    void removeTrack(TrackId trackId);
+
+    // Returns a random track among the kMaxCandidates tracks that are
+    // closest to the reference and for which isCandidate returns true, or
+    // an invalid id if there is no such track. isCandidate is only invoked
+    // for tracks that rank among the best so far.
+    TrackId selectTrack(const Features& reference,
+                        const std::function<bool(TrackId)>& isCandidate);
+
+    // The distance between two tracks. 0 for a perfect match, every
+    // step on the Circle of Fifths adds 1.
+    static double distance(const Features& reference, const Features& candidate);
+
+  private:
+    static double distance(const Features& reference, double referenceLoudnessDb,
+                           double bpm, mixxx::track::io::key::ChromaticKey key,
+                           double replayGainRatio, double loudnessDb);
+
+    QHash<TrackId, int> m_rows;
+    QVector<TrackId> m_trackIds;
+    QVector<double> m_bpms;
+    QVector<mixxx::track::io::key::ChromaticKey> m_keys;
+    QVector<double> m_replayGainRatios;
+    // Derived from the ReplayGain ratio, only valid if that is known
+    QVector<double> m_loudnessDbs;
+
+    // Seeded differently in every session
+    std::mt19937 m_randomGenerator;
+};
+
+#endif // AUTODJTRACKSELECTOR_H
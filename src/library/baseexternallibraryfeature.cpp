@@ -1,8 +1,31 @@
 #include "library/baseexternallibraryfeature.h"
 
+#include <QDateTime>
+#include <QFileInfo>
 #include <QMenu>
+#include <QSqlQuery>
+#include <QThreadPool>
 
 #include "library/basesqltablemodel.h"
+#include "library/queryutil.h"
+#include "library/trackcollection.h"
+#include "library/treeitem.h"
+#include "library/treeitemmodel.h"
+#include "sources/soundsourceproxy.h"
+
+namespace {
+
+// Usually the global thread pool has more threads than that, but within
+// VirtualBox it may only have a single thread. The import would then only
+// start after all other tasks have finished, e.g. on Mixxx shutdown.
+const int kMinGlobalThreadCount = 4;
+
+}  // anonymous namespace
+
+// static
+const int BaseExternalLibraryFeature::kTracksPerImportTransaction = 2000;
+// static
+const int BaseExternalLibraryFeature::kPlaylistsPerImportTransaction = 20;
 
 BaseExternalLibraryFeature::BaseExternalLibraryFeature(QObject* pParent,
                                                        TrackCollection* pCollection)
@@ -118,24 +141,111 @@ void BaseExternalLibraryFeature::appendTrackIdsFromRightClickIndex(QList<TrackId
             ColumnCache::COLUMN_PLAYLISTTRACKSTABLE_POSITION), Qt::AscendingOrder);
     pPlaylistModelToAdd->select();
 
-    // Copy Tracks
+    // Copy Tracks. All tracks that are not in the library yet are added at
+    // once, which is a lot faster than adding them one by one.
+    TrackDAO& trackDao = m_pTrackCollection->getTrackDAO();
+    const int locationColumn = pPlaylistModelToAdd->fieldIndex("location");
+    const int artistColumn = pPlaylistModelToAdd->fieldIndex("artist");
+    const int titleColumn = pPlaylistModelToAdd->fieldIndex("title");
+    const int albumColumn = pPlaylistModelToAdd->fieldIndex("album");
+    const int yearColumn = pPlaylistModelToAdd->fieldIndex("year");
+    const int genreColumn = pPlaylistModelToAdd->fieldIndex("genre");
+    const int bpmColumn = pPlaylistModelToAdd->fieldIndex("bpm");
+    QVector<TrackDAO::NewTrack> newTracks;
     int rows = pPlaylistModelToAdd->rowCount();
     for (int i = 0; i < rows; ++i) {
-        QModelIndex index = pPlaylistModelToAdd->index(i,0);
-        if (index.isValid()) {
-            qDebug() << pPlaylistModelToAdd->getTrackLocation(index);
-            TrackPointer track = pPlaylistModelToAdd->getTrack(index);
-            if (!track) {
-                continue;
-            }
-
-            TrackId trackId(track->getId());
-            if (!trackId.isValid()) {
-                continue;
+        QModelIndex index = pPlaylistModelToAdd->index(i, locationColumn);
+        if (!index.isValid()) {
+            continue;
+        }
+        const QString location = index.data().toString();
+        if (location.isEmpty()) {
+            // Track is lost
+            continue;
+        }
+        TrackDAO::NewTrack newTrack;
+        newTrack.fileInfo = QFileInfo(location);
+        if (!trackDao.trackExistsInDatabase(newTrack.fileInfo.absoluteFilePath())) {
+            // Like BaseExternalPlaylistModel::getTrack() new tracks are
+            // saved with the metadata from the file overwritten by the
+            // metadata from the external library.
+            if (SoundSourceProxy::isFileSupported(newTrack.fileInfo)) {
+                newTrack.headerParsed =
+                        SoundSourceProxy(Track::newTemporary(newTrack.fileInfo))
+                        .parseTrackMetadata(&newTrack.trackMetadata) ==
+                        OK;
             }
+            newTrack.trackMetadata.setArtist(
+                    index.sibling(i, artistColumn).data().toString());
+            newTrack.trackMetadata.setTitle(
+                    index.sibling(i, titleColumn).data().toString());
+            newTrack.trackMetadata.setAlbum(
+                    index.sibling(i, albumColumn).data().toString());
+            newTrack.trackMetadata.setYear(
+                    index.sibling(i, yearColumn).data().toString());
+            newTrack.trackMetadata.setGenre(
+                    index.sibling(i, genreColumn).data().toString());
+            newTrack.trackMetadata.setBpm(mixxx::Bpm(
+                    index.sibling(i, bpmColumn).data().toString().toFloat()));
+        }
+        newTracks.append(newTrack);
+    }
 
+    for (const auto& trackId: trackDao.addTracksBulk(newTracks, true)) {
+        if (trackId.isValid()) {
             trackIds->append(trackId);
         }
     }
 }
 
+// static
+QString BaseExternalLibraryFeature::sourceFilesVersion(const QStringList& filePaths) {
+    QStringList parts;
+    for (const auto& filePath: filePaths) {
+        QFileInfo fileInfo(filePath);
+        if (fileInfo.exists()) {
+            parts << QString("%1|%2|%3").arg(
+                    fileInfo.absoluteFilePath(),
+                    QString::number(fileInfo.size()),
+                    QString::number(fileInfo.lastModified().toMSecsSinceEpoch()));
+        } else {
+            parts << fileInfo.absoluteFilePath();
+        }
+    }
+    return parts.join(";");
+}
+
+TreeItem* BaseExternalLibraryFeature::loadImportedPlaylists(
+        QSqlDatabase database, const QString& playlistsTable) {
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    if (!query.exec(QString("SELECT name FROM %1 ORDER BY id").arg(playlistsTable))) {
+        LOG_FAILED_QUERY(query);
+        return NULL;
+    }
+    TreeItem* rootItem = new TreeItem(this);
+    while (query.next()) {
+        rootItem->appendChild(query.value(0).toString());
+    }
+    return rootItem;
+}
+
+void BaseExternalLibraryFeature::slotPlaylistsImported(QStringList playlists) {
+    TreeItemModel* pChildModel = getChildModel();
+    QList<TreeItem*> items;
+    for (const auto& playlist: playlists) {
+        items << new TreeItem(this, playlist);
+    }
+    pChildModel->insertTreeItemRows(
+            items, pChildModel->getRootItem()->childRows());
+}
+
+// static
+void BaseExternalLibraryFeature::reserveImportThread() {
+    // Only grow the pool. Shrinking it would slow down all other users of
+    // the global thread pool on machines with many cores.
+    QThreadPool* pPool = QThreadPool::globalInstance();
+    if (pPool->maxThreadCount() < kMinGlobalThreadCount) {
+        pPool->setMaxThreadCount(kMinGlobalThreadCount);
+    }
+}
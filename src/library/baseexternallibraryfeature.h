@@ -3,11 +3,14 @@
 
 #include <QAction>
 #include <QModelIndex>
+#include <QSqlDatabase>
+#include <QStringList>
 
 #include "library/libraryfeature.h"
 
 class BaseSqlTableModel;
 class TrackCollection;
+class TreeItem;
 
 class BaseExternalLibraryFeature : public LibraryFeature {
     Q_OBJECT
@@ -19,6 +22,11 @@ class BaseExternalLibraryFeature : public LibraryFeature {
     virtual void onRightClick(const QPoint& globalPos);
     virtual void onRightClickChild(const QPoint& globalPos, QModelIndex index);
 
+  protected slots:
+    // Appends the playlists that have been committed by the import thread
+    // to the child model.
+    virtual void slotPlaylistsImported(QStringList playlists);
+
   protected:
     // Must be implemented by external Libraries copied to Mixxx DB
     virtual BaseSqlTableModel* getPlaylistModelForPlaylist(QString playlist) {
@@ -28,6 +36,28 @@ class BaseExternalLibraryFeature : public LibraryFeature {
     // Must be implemented by external Libraries not copied to Mixxx DB
     virtual void appendTrackIdsFromRightClickIndex(QList<TrackId>* trackIds, QString* pPlaylist);
 
+    // Returns a string that identifies the current content of the files
+    // from which an external library is imported. It changes whenever one
+    // of the files is modified, replaced or removed. An importer stores it
+    // after a complete import and skips parsing as long as it is unchanged.
+    static QString sourceFilesVersion(const QStringList& filePaths);
+
+    // Builds the child model from the names of the playlists in the given
+    // table that have been stored by the last import. Returns NULL on
+    // failure.
+    TreeItem* loadImportedPlaylists(QSqlDatabase database,
+                                    const QString& playlistsTable);
+
+    // Makes sure that the global thread pool has enough threads to run the
+    // import in the background without waiting for other tasks.
+    static void reserveImportThread();
+
+    // Commit the rows of an import after this many tracks or playlists, so
+    // that the database is not locked for the whole import and the imported
+    // playlists can be shown while parsing continues.
+    static const int kTracksPerImportTransaction;
+    static const int kPlaylistsPerImportTransaction;
+
     QModelIndex m_lastRightClickedIndex;
 
     TrackCollection* const m_pTrackCollection;
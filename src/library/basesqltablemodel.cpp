@@ -20,6 +20,7 @@
 #include "util/duration.h"
 #include "util/dnd.h"
 #include "util/assert.h"
+#include "util/math.h"
 #include "util/performancetimer.h"
 
 static const bool sDebug = false;
@@ -33,6 +34,10 @@ static const int kMaxSortColumns = 3;
 // Constant for getModelSetting(name)
 static const char* COLUMNS_SORTING = "ColumnsSorting";
 
+// The number of rows above and below the visible rows that are formatted
+// in advance, so that scrolling by a page doesn't need to fetch rows.
+static const int kPrefetchMarginRows = 64;
+
 BaseSqlTableModel::BaseSqlTableModel(QObject* pParent,
                                      TrackCollection* pTrackCollection,
                                      const char* settingsNamespace)
@@ -42,6 +47,9 @@ BaseSqlTableModel::BaseSqlTableModel(QObject* pParent,
           m_database(pTrackCollection->database()),
           m_previewDeckGroup(PlayerManager::groupForPreviewDeck(0)),
           m_bInitialized(false),
+          m_pendingSelectId(-1),
+          m_filterGeneration(0),
+          m_pendingFilterGeneration(-1),
           m_currentSearch("") {
     DEBUG_ASSERT(m_pTrackCollection);
     connect(&PlayerInfo::instance(), SIGNAL(trackLoaded(QString, TrackPointer)),
@@ -49,9 +57,25 @@ BaseSqlTableModel::BaseSqlTableModel(QObject* pParent,
     connect(&m_pTrackCollection->getTrackDAO(), SIGNAL(forceModelUpdate()),
             this, SLOT(select()));
     trackLoaded(m_previewDeckGroup, PlayerInfo::instance().getTrackInfo(m_previewDeckGroup));
+    // Also the subclasses announce changed rows with dataChanged(). Connected
+    // here, before any view, so that views never see stale display values.
+    connect(this, SIGNAL(dataChanged(const QModelIndex&, const QModelIndex&)),
+            this, SLOT(slotDisplayValuesChanged(const QModelIndex&, const QModelIndex&)));
+    // The key column is formatted with the key notation
+    m_pKeyNotationCP = new ControlProxy("[Library]", "key_notation", this);
+    m_pKeyNotationCP->connectValueChanged(SLOT(clearDisplayValues()));
+    SqlSelectThread* pSelectThread = m_pTrackCollection->getSelectThread();
+    if (pSelectThread) {
+        connect(pSelectThread,
+                SIGNAL(selectFinished(int, SqlSelectThread::ResultPointer)),
+                this,
+                SLOT(slotSelectFinished(int, SqlSelectThread::ResultPointer)),
+                Qt::QueuedConnection);
+    }
 }
 
 BaseSqlTableModel::~BaseSqlTableModel() {
+    cancelPendingSelect();
 }
 
 void BaseSqlTableModel::initHeaderData() {
@@ -189,6 +213,7 @@ void BaseSqlTableModel::clearRows() {
         beginRemoveRows(QModelIndex(), 0, m_rowInfo.size() - 1);
         m_rowInfo.clear();
         m_trackIdToRows.clear();
+        m_displayValues.clear();
         endRemoveRows();
     }
     DEBUG_ASSERT(m_rowInfo.isEmpty());
@@ -213,6 +238,7 @@ void BaseSqlTableModel::replaceRows(
         beginInsertRows(QModelIndex(), 0, rows.size() - 1);
         m_rowInfo = rows;
         m_trackIdToRows = trackIdToRows;
+        m_displayValues.clear();
         endInsertRows();
     }
 }
@@ -236,13 +262,13 @@ void BaseSqlTableModel::select() {
         qDebug() << this << "select()";
     }
 
+    // A synchronous select() supersedes a pending asynchronous one
+    cancelPendingSelect();
+
     PerformanceTimer time;
     time.start();
 
-    // Prepare query for id and all columns not in m_trackSource
-    QString queryString = QString("SELECT %1 FROM %2 %3")
-            .arg(m_tableColumnsJoined, m_tableName, m_tableOrderBy);
-
+    const QString queryString = selectQueryString();
     if (sDebug) {
         qDebug() << this << "select() executing:" << queryString;
     }
@@ -260,27 +286,15 @@ void BaseSqlTableModel::select() {
         return;
     }
 
-    // Remove all the rows from the table after(!) the query has been
-    // executed successfully. See Bug #1090888.
-    // TODO(rryan) we could edit the table in place instead of clearing it?
-    clearRows();
-
     // The size of the result set is not known in advance for a
     // forward-only query, so we cannot reserve memory for rows
     // in advance.
     QVector<RowInfo> rowInfo;
-    QSet<TrackId> trackIds;
     while (query.next()) {
-        TrackId trackId(query.value(kIdColumn));
-        trackIds.insert(trackId);
-
         RowInfo thisRowInfo;
-        thisRowInfo.trackId = trackId;
-        // save rows where this currently track id is located
-        thisRowInfo.order = rowInfo.size();
+        thisRowInfo.trackId = TrackId(query.value(kIdColumn));
         // Get all the table columns and store them in the hash for this
         // row-info section.
-
         thisRowInfo.metadata.reserve(m_tableColumns.size());
         for (int i = 0;  i < m_tableColumns.size(); ++i) {
             thisRowInfo.metadata << query.value(i);
@@ -288,6 +302,114 @@ void BaseSqlTableModel::select() {
         rowInfo.push_back(thisRowInfo);
     }
 
+    // Remove all the rows from the table after(!) the query has been
+    // executed successfully. See Bug #1090888.
+    updateRows(std::move(rowInfo), nullptr);
+
+    qDebug() << this << "select() took" << time.elapsed().debugMillisWithUnit()
+             << m_rowInfo.size();
+}
+
+void BaseSqlTableModel::selectAsync() {
+    if (!m_bInitialized) {
+        return;
+    }
+    SqlSelectThread* pSelectThread = m_pTrackCollection->getSelectThread();
+    if (!pSelectThread) {
+        select();
+        return;
+    }
+
+    if (sDebug) {
+        qDebug() << this << "selectAsync()";
+    }
+
+    // The track source is filtered on the select thread, too. Only the
+    // sorting in memory and the correction of dirty tracks remain for
+    // the GUI thread.
+    QString filterQuery;
+    if (m_trackSource) {
+        filterQuery = m_trackSource->formatFilterQuery(
+                QString("SELECT %1 FROM %2").arg(
+                        m_tableColumns.value(kIdColumn), m_tableName),
+                m_currentSearch,
+                m_currentSearchFilter,
+                m_trackSourceOrderBy,
+                m_sortColumns,
+                m_tableColumns.size() - 1);
+    }
+
+    // Replaces and cancels a pending select, e.g. while the user keeps typing
+    m_pendingSelectId = pSelectThread->submit(
+            this, m_database, selectQueryString(), filterQuery);
+    m_pendingFilterGeneration = m_filterGeneration;
+    m_pendingSelectTimer.start();
+}
+
+void BaseSqlTableModel::cancelPendingSelect() {
+    if (m_pendingSelectId < 0) {
+        return;
+    }
+    SqlSelectThread* pSelectThread = m_pTrackCollection->getSelectThread();
+    if (pSelectThread) {
+        pSelectThread->cancel(this);
+    }
+    m_pendingSelectId = -1;
+}
+
+void BaseSqlTableModel::slotSelectFinished(
+        int requestId, SqlSelectThread::ResultPointer pResult) {
+    if (requestId != m_pendingSelectId) {
+        // Not ours or superseded
+        return;
+    }
+    m_pendingSelectId = -1;
+    if (!pResult->ok) {
+        return;
+    }
+
+    PerformanceTimer time;
+    time.start();
+
+    QVector<RowInfo> rowInfo;
+    rowInfo.reserve(pResult->rows.size());
+    for (const auto& row: pResult->rows) {
+        RowInfo thisRowInfo;
+        thisRowInfo.trackId = TrackId(row.value(kIdColumn));
+        thisRowInfo.metadata = row;
+        rowInfo.push_back(thisRowInfo);
+    }
+    // The search or sorting might have been modified without selecting
+    // again. Then the track source needs to filter the rows itself.
+    const bool filterValid = pResult->filtered &&
+            m_pendingFilterGeneration == m_filterGeneration;
+    updateRows(std::move(rowInfo),
+            filterValid ? &pResult->filteredTrackIds : nullptr);
+
+    qDebug() << this << "selectAsync() took"
+             << m_pendingSelectTimer.elapsed().debugMillisWithUnit()
+             << m_rowInfo.size() << "of which"
+             << time.elapsed().debugMillisWithUnit() << "on the GUI thread";
+}
+
+QString BaseSqlTableModel::selectQueryString() const {
+    // Prepare query for id and all columns not in m_trackSource
+    return QString("SELECT %1 FROM %2 %3")
+            .arg(m_tableColumnsJoined, m_tableName, m_tableOrderBy);
+}
+
+void BaseSqlTableModel::updateRows(QVector<RowInfo> rowInfo,
+        const QVector<TrackId>* pFilteredTrackIds) {
+    // TODO(rryan) we could edit the table in place instead of clearing it?
+    clearRows();
+
+    QSet<TrackId> trackIds;
+    for (int i = 0; i < rowInfo.size(); ++i) {
+        trackIds.insert(rowInfo[i].trackId);
+        // save rows where this currently track id is located
+        rowInfo[i].order = i;
+    }
+
     if (sDebug) {
         qDebug() << "Rows actually received:" << rowInfo.size();
     }
@@ -298,7 +420,8 @@ void BaseSqlTableModel::select() {
                                      m_trackSourceOrderBy,
                                      m_sortColumns,
                                      m_tableColumns.size() - 1,
-                                     &m_trackSortOrder);
+                                     &m_trackSortOrder,
+                                     pFilteredTrackIds);
 
         // Re-sort the track IDs since filterAndSort can change their order or mark
         // them for removal (by setting their row to -1).
@@ -340,9 +463,6 @@ void BaseSqlTableModel::select() {
             std::move(trackIdToRows));
     // Both rowInfo and trackIdToRows (might) have been moved and
     // must not be used afterwards!
-
-    qDebug() << this << "select() took" << time.elapsed().debugMillisWithUnit()
-             << m_rowInfo.size();
 }
 
 void BaseSqlTableModel::setTable(const QString& tableName,
@@ -376,6 +496,8 @@ void BaseSqlTableModel::setTable(const QString& tableName,
 
     // Build a map from the column names to their indices, used by fieldIndex()
     m_tableColumnCache.setColumns(m_tableColumns);
+    m_displayValues.clear();
+    ++m_filterGeneration;
 
     initHeaderData();
 
@@ -402,6 +524,7 @@ void BaseSqlTableModel::setSearch(const QString& searchText, const QString& extr
 
     m_currentSearch = searchText;
     m_currentSearchFilter = extraFilter;
+    ++m_filterGeneration;
 }
 
 void BaseSqlTableModel::search(const QString& searchText, const QString& extraFilter) {
@@ -409,7 +532,7 @@ void BaseSqlTableModel::search(const QString& searchText, const QString& extraFi
         qDebug() << this << "search" << searchText;
     }
     setSearch(searchText, extraFilter);
-    select();
+    selectAsync();
 }
 
 void BaseSqlTableModel::setSort(int column, Qt::SortOrder order) {
@@ -548,6 +671,7 @@ void BaseSqlTableModel::setSort(int column, Qt::SortOrder order) {
             first = false;
         }
     }
+    ++m_filterGeneration;
 }
 
 void BaseSqlTableModel::sort(int column, Qt::SortOrder order) {
@@ -555,7 +679,7 @@ void BaseSqlTableModel::sort(int column, Qt::SortOrder order) {
         qDebug() << this << "sort()" << column << order;
     }
     setSort(column, order);
-    select();
+    selectAsync();
 }
 
 int BaseSqlTableModel::rowCount(const QModelIndex& parent) const {
@@ -620,12 +744,25 @@ QVariant BaseSqlTableModel::data(const QModelIndex& index, int role) const {
         return QVariant();
     }
 
-    int row = index.row();
-    int column = index.column();
+    // The preview column changes without dataChanged() when a track is
+    // loaded into the preview deck, so it is never cached.
+    if (role == Qt::DisplayRole &&
+            index.column() != fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_PREVIEW)) {
+        auto it = m_displayValues.constFind(index.row());
+        if (it != m_displayValues.constEnd()) {
+            return it.value().value(index.column());
+        }
+    }
 
     // This value is the value in its most raw form. It was looked up either
     // from the SQL table or from the cached track layer.
-    QVariant value = getBaseValue(index, role);
+    return formatValue(index, role, getBaseValue(index, role));
+}
+
+QVariant BaseSqlTableModel::formatValue(
+        const QModelIndex& index, int role, QVariant value) const {
+    int row = index.row();
+    int column = index.column();
 
     // Format the value based on whether we are in a tooltip, display, or edit
     // role
@@ -951,8 +1088,73 @@ void BaseSqlTableModel::setTrackValueForColumn(TrackPointer pTrack, int column,
     }
 }
 
+void BaseSqlTableModel::prefetchRows(int firstRow, int lastRow) {
+    firstRow = math_max(0, firstRow - kPrefetchMarginRows);
+    lastRow = math_min(m_rowInfo.size() - 1, lastRow + kPrefetchMarginRows);
+
+    // Forget the rows that have left the window
+    auto it = m_displayValues.begin();
+    while (it != m_displayValues.end()) {
+        if (it.key() < firstRow || it.key() > lastRow) {
+            it = m_displayValues.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    QVector<int> rows;
+    QVector<TrackId> trackIds;
+    QSet<TrackId> uncachedTrackIds;
+    for (int row = firstRow; row <= lastRow; ++row) {
+        if (m_displayValues.contains(row)) {
+            continue;
+        }
+        const TrackId trackId = m_rowInfo[row].trackId;
+        rows.append(row);
+        trackIds.append(trackId);
+        if (m_trackSource && !m_trackSource->isCached(trackId)) {
+            uncachedTrackIds.insert(trackId);
+        }
+    }
+    if (rows.isEmpty()) {
+        return;
+    }
+
+    QVector<QVector<QVariant> > records;
+    if (m_trackSource) {
+        if (!uncachedTrackIds.isEmpty()) {
+            m_trackSource->ensureCached(uncachedTrackIds);
+        }
+        records = m_trackSource->records(trackIds);
+    }
+
+    const int numColumns = columnCount();
+    for (int i = 0; i < rows.size(); ++i) {
+        QVector<QVariant> values(numColumns);
+        for (int column = 0; column < numColumns; ++column) {
+            const QModelIndex cellIndex = index(rows[i], column);
+            values[column] = formatValue(cellIndex, Qt::DisplayRole,
+                    getBaseValue(cellIndex, Qt::DisplayRole,
+                                 m_trackSource ? &records[i] : nullptr));
+        }
+        m_displayValues.insert(rows[i], values);
+    }
+}
+
+void BaseSqlTableModel::slotDisplayValuesChanged(const QModelIndex& topLeft,
+                                                 const QModelIndex& bottomRight) {
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        m_displayValues.remove(row);
+    }
+}
+
+void BaseSqlTableModel::clearDisplayValues() {
+    m_displayValues.clear();
+}
+
 QVariant BaseSqlTableModel::getBaseValue(
-    const QModelIndex& index, int role) const {
+    const QModelIndex& index, int role,
+    const QVector<QVariant>* pTrackRecord) const {
     if (role != Qt::DisplayRole &&
         role != Qt::ToolTipRole &&
         role != Qt::EditRole) {
@@ -996,6 +1198,9 @@ QVariant BaseSqlTableModel::getBaseValue(
         // Subtract table columns from index to get the track source column
         // number and add 1 to skip over the id column.
         int trackSourceColumn = column - m_tableColumns.size() + 1;
+        if (pTrackRecord) {
+            return pTrackRecord->value(trackSourceColumn);
+        }
         if (!m_trackSource->isCached(trackId)) {
             // Ideally Mixxx would have notified us of this via a signal, but in
             // the case that a track is not in the cache, we attempt to load it
@@ -4,13 +4,17 @@
 
 #include <QHash>
 #include <QtSql>
+#include <gtest/gtest_prod.h>
 
 #include "library/basetrackcache.h"
 #include "library/dao/trackdao.h"
 #include "library/trackcollection.h"
 #include "library/trackmodel.h"
 #include "library/columncache.h"
+#include "library/sqlselectthread.h"
+#include "control/controlproxy.h"
 #include "util/class.h"
+#include "util/performancetimer.h"
 
 // BaseSqlTableModel is a custom-written SQL-backed table which aggressively
 // caches the contents of the table and supports lightweight updates.
@@ -74,6 +78,10 @@ class BaseSqlTableModel : public QAbstractTableModel, public TrackModel {
     void search(const QString& searchText, const QString& extraFilter = QString()) override;
     const QString currentSearch() const override;
     QAbstractItemDelegate* delegateForColumn(const int i, QObject* pParent) override;
+    // Formats the display values of the rows and a margin around them at
+    // once, fetching the tracks from the track source in a single batch.
+    // The values are cached until the rows change or leave the window.
+    void prefetchRows(int firstRow, int lastRow) override;
 
     ///////////////////////////////////////////////////////////////////////////
     // Inherited from QAbstractItemModel
@@ -82,6 +90,10 @@ class BaseSqlTableModel : public QAbstractTableModel, public TrackModel {
 
   public slots:
     void select();
+    // Like select(), but runs the query on the select thread of the track
+    // collection and updates the rows when it has finished. Searching and
+    // sorting use this so the GUI stays responsive for large tables.
+    void selectAsync();
 
   protected:
     void setTable(const QString& tableName, const QString& trackIdColumn,
@@ -105,6 +117,10 @@ class BaseSqlTableModel : public QAbstractTableModel, public TrackModel {
     virtual void tracksChanged(QSet<TrackId> trackIds);
     virtual void trackLoaded(QString group, TrackPointer pTrack);
     void refreshCell(int row, int column);
+    void slotSelectFinished(int requestId, SqlSelectThread::ResultPointer pResult);
+    void slotDisplayValuesChanged(const QModelIndex& topLeft,
+                                  const QModelIndex& bottomRight);
+    void clearDisplayValues();
 
   private:
     // A simple helper function for initializing header title and width.  Note
@@ -112,7 +128,11 @@ class BaseSqlTableModel : public QAbstractTableModel, public TrackModel {
     // not the title string itself.
     void setHeaderProperties(ColumnCache::Column column, QString title, int defaultWidth);
     inline void setTrackValueForColumn(TrackPointer pTrack, int column, QVariant value);
-    QVariant getBaseValue(const QModelIndex& index, int role = Qt::DisplayRole) const;
+    // Returns the unformatted value. If the record of the track is given the
+    // value is taken from it instead of the track source.
+    QVariant getBaseValue(const QModelIndex& index, int role = Qt::DisplayRole,
+                          const QVector<QVariant>* pTrackRecord = nullptr) const;
+    QVariant formatValue(const QModelIndex& index, int role, QVariant value) const;
     // Set the columns used for searching. Names must correspond to the column
     // names in the table provided to setTable. Must be called after setTable is
     // called.
@@ -136,6 +156,14 @@ class BaseSqlTableModel : public QAbstractTableModel, public TrackModel {
 
     typedef QHash<TrackId, QLinkedList<int>> TrackId2Rows;
 
+    QString selectQueryString() const;
+    void cancelPendingSelect();
+    // Filters and sorts the rows of the table with the track source and
+    // replaces the current rows. The track source doesn't need to query
+    // SQLite if the matching track ids have been selected in advance.
+    void updateRows(QVector<RowInfo> rowInfo,
+                    const QVector<TrackId>* pFilteredTrackIds);
+
     void clearRows();
     void replaceRows(
             QVector<RowInfo>&& rows,
@@ -151,6 +179,14 @@ class BaseSqlTableModel : public QAbstractTableModel, public TrackModel {
     ColumnCache m_tableColumnCache;
     QList<SortColumn> m_sortColumns;
     bool m_bInitialized;
+    // The id of the pending selectAsync() request or -1
+    int m_pendingSelectId;
+    // Incremented whenever the search, the sorting or the table changes.
+    // The track ids that the select thread has filtered for an older
+    // generation are ignored.
+    int m_filterGeneration;
+    int m_pendingFilterGeneration;
+    PerformanceTimer m_pendingSelectTimer;
     QSqlRecord m_queryRecord;
     QHash<TrackId, int> m_trackSortOrder;
     TrackId2Rows m_trackIdToRows;
@@ -159,6 +195,14 @@ class BaseSqlTableModel : public QAbstractTableModel, public TrackModel {
     QVector<QHash<int, QVariant> > m_headerInfo;
     QString m_trackSourceOrderBy;
 
+    // The formatted values of Qt::DisplayRole for each column of the rows
+    // in the prefetch window
+    QHash<int, QVector<QVariant> > m_displayValues;
+    FRIEND_TEST(BaseSqlTableModelTest, PrefetchedRowsAreCached);
+    FRIEND_TEST(BaseSqlTableModelTest, DataChangedInvalidatesPrefetchedRows);
+    FRIEND_TEST(BaseSqlTableModelTest, ScrollPastPrefetchWindow);
+    ControlProxy* m_pKeyNotationCP;
+
     DISALLOW_COPY_AND_ASSIGN(BaseSqlTableModel);
 };
 
@@ -31,6 +31,8 @@ BaseTrackCache::BaseTrackCache(TrackCollection* pTrackCollection,
           m_columnCache(columns),
           m_bIndexBuilt(false),
           m_bIsCaching(isCaching),
+          m_trackRecords(m_columnCount),
+          m_columnarTable(m_columnCount),
           m_trackDAO(pTrackCollection->getTrackDAO()),
           m_database(pTrackCollection->database()),
           m_pQueryParser(new SearchQueryParser(pTrackCollection)) {
@@ -50,6 +52,31 @@ BaseTrackCache::BaseTrackCache(TrackCollection* pTrackCollection,
     for (int i = 0; i < m_searchColumns.size(); ++i) {
         m_searchColumnIndices[i] = m_columnCache.fieldIndex(m_searchColumns[i]);
     }
+
+    for (int i = 0; i < m_columnCount; ++i) {
+        switch (m_columnCache.columnSortTypeForFieldIndex(i)) {
+        case ColumnCache::SORT_NOCASE:
+            m_columnarTable.setCollation(i, ColumnarTrackTable::Collation::NoCase);
+            break;
+        case ColumnCache::SORT_INTEGER:
+            m_columnarTable.setCollation(i, ColumnarTrackTable::Collation::Integer);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Searches for crates and extra filters for playlists match other
+    // tracks when their members change
+    connect(pTrackCollection,
+            SIGNAL(crateTracksChanged(CrateId, QList<TrackId>, QList<TrackId>)),
+            this, SLOT(slotMembershipChanged()));
+    connect(pTrackCollection, SIGNAL(crateUpdated(CrateId)),
+            this, SLOT(slotMembershipChanged()));
+    connect(pTrackCollection, SIGNAL(crateDeleted(CrateId)),
+            this, SLOT(slotMembershipChanged()));
+    connect(&pTrackCollection->getPlaylistDAO(), SIGNAL(changed(int)),
+            this, SLOT(slotMembershipChanged()));
 }
 
 BaseTrackCache::~BaseTrackCache() {
@@ -85,6 +112,9 @@ void BaseTrackCache::slotTracksAdded(QSet<TrackId> trackIds) {
         updateTrackIds.insert(trackId);
     }
     updateTracksInIndex(updateTrackIds);
+    // The new tracks might match the last filter even if they could
+    // not be cached
+    invalidateLastFilterResult();
 }
 
 void BaseTrackCache::slotDbTrackAdded(TrackPointer pTrack) {
@@ -92,6 +122,7 @@ void BaseTrackCache::slotDbTrackAdded(TrackPointer pTrack) {
         qDebug() << this << "slotDbTrackAdded";
     }
     updateIndexWithTrackpointer(pTrack);
+    invalidateLastFilterResult();
 }
 
 void BaseTrackCache::slotTracksRemoved(QSet<TrackId> trackIds) {
@@ -99,8 +130,17 @@ void BaseTrackCache::slotTracksRemoved(QSet<TrackId> trackIds) {
         qDebug() << this << "slotTracksRemoved" << trackIds.size();
     }
     for (const auto& trackId : trackIds) {
-        m_trackInfo.remove(trackId);
+        m_trackRecords.removeRecord(trackId);
+        m_columnarTable.removeRow(trackId);
+    }
+    invalidateLastFilterResult();
+}
+
+void BaseTrackCache::slotMembershipChanged() {
+    if (sDebug) {
+        qDebug() << this << "slotMembershipChanged";
     }
+    invalidateLastFilterResult();
 }
 
 void BaseTrackCache::slotTrackDirty(TrackId trackId) {
@@ -128,7 +168,7 @@ void BaseTrackCache::slotTrackClean(TrackId trackId) {
 }
 
 bool BaseTrackCache::isCached(TrackId trackId) const {
-    return m_trackInfo.contains(trackId);
+    return m_trackRecords.contains(trackId);
 }
 
 void BaseTrackCache::ensureCached(TrackId trackId) {
@@ -139,10 +179,19 @@ void BaseTrackCache::ensureCached(QSet<TrackId> trackIds) {
     updateTracksInIndex(trackIds);
 }
 
+void BaseTrackCache::setSearchIndex(const SearchIndexDAO* pSearchIndex) {
+    m_pQueryParser->setSearchIndex(pSearchIndex);
+}
+
 void BaseTrackCache::setSearchColumns(const QStringList& columns) {
     m_searchColumns = columns;
 }
 
+void BaseTrackCache::invalidateLastFilterResult() {
+    // Also releases the memory of the stale result
+    m_lastFilterResult = FilterResult();
+}
+
 TrackPointer BaseTrackCache::lookupCachedTrack(TrackId trackId) const {
     // Only get the track from the TrackDAO if it's in the cache and marked as
     // dirty.
@@ -165,14 +214,14 @@ bool BaseTrackCache::updateIndexWithTrackpointer(TrackPointer pTrack) {
 
     TrackId trackId(pTrack->getId());
     if (trackId.isValid()) {
-        // m_trackInfo[id] will insert a QVector<QVariant> into the
-        // m_trackInfo HashTable with the key "id"
-        QVector<QVariant>& record = m_trackInfo[trackId];
         // prealocate memory for all columns at once
-        record.resize(numColumns);
+        QVector<QVariant> record(numColumns);
         for (int i = 0; i < numColumns; ++i) {
             getTrackValueForColumn(pTrack, i, record[i]);
         }
+        m_trackRecords.setRecord(trackId, record);
+        m_columnarTable.updateRow(trackId, record);
+        invalidateLastFilterResult();
     }
     return true;
 }
@@ -199,18 +248,18 @@ bool BaseTrackCache::updateIndexWithQuery(const QString& queryString) {
     int numColumns = columnCount();
     int idColumn = query.record().indexOf(m_idColumn);
 
+    // Reused for all rows, the values are copied into m_trackRecords
+    QVector<QVariant> record(numColumns);
     while (query.next()) {
         TrackId trackId(query.value(idColumn));
 
-        //m_trackInfo[id] will insert a QVector<QVariant> into the
-        //m_trackInfo HashTable with the key "id"
-        QVector<QVariant>& record = m_trackInfo[trackId];
-        record.resize(numColumns);
-
         for (int i = 0; i < numColumns; ++i) {
             record[i] = query.value(i);
         }
+        m_trackRecords.setRecord(trackId, record);
+        m_columnarTable.updateRow(trackId, record);
     }
+    invalidateLastFilterResult();
 
     qDebug() << this << "updateIndexWithQuery took" << timer.elapsed().debugMillisWithUnit();
     return true;
@@ -231,7 +280,8 @@ void BaseTrackCache::buildIndex() {
     // TODO(rryan) for very large tables, it probably makes more sense to NOT
     // clear the table, and keep track of what IDs we see, then delete the ones
     // we don't see.
-    m_trackInfo.clear();
+    m_trackRecords.clear();
+    m_columnarTable.clear();
 
     if (!updateIndexWithQuery(queryString)) {
         qDebug() << "buildIndex failed!";
@@ -360,12 +410,37 @@ QVariant BaseTrackCache::data(TrackId trackId, int column) const {
     // metadata. Currently the upper-levels will not delegate row-specific
     // columns to this method, but there should still be a check here I think.
     if (!result.isValid()) {
-        QHash<TrackId, QVector<QVariant> >::const_iterator it =
-                m_trackInfo.find(trackId);
-        if (it != m_trackInfo.end()) {
-            const QVector<QVariant>& fields = it.value();
-            result = fields.value(column, result);
+        result = m_trackRecords.value(trackId, column, result);
+    }
+    return result;
+}
+
+QVector<QVector<QVariant> > BaseTrackCache::records(
+        const QVector<TrackId>& trackIds) const {
+    QVector<QVector<QVariant> > result;
+    if (!m_bIndexBuilt) {
+        qDebug() << this << "ERROR index is not built for" << m_tableName;
+        result.resize(trackIds.size());
+        return result;
+    }
+
+    result.reserve(trackIds.size());
+    const int numColumns = columnCount();
+    for (const auto& trackId: trackIds) {
+        QVector<QVariant> record = m_trackRecords.record(trackId);
+        // Values of a dirty track take precedence over the cached values
+        TrackPointer pTrack = lookupCachedTrack(trackId);
+        if (pTrack) {
+            record.resize(numColumns);
+            for (int column = 0; column < numColumns; ++column) {
+                QVariant trackValue;
+                getTrackValueForColumn(pTrack, column, trackValue);
+                if (trackValue.isValid()) {
+                    record[column] = trackValue;
+                }
+            }
         }
+        result.append(record);
     }
     return result;
 }
@@ -376,7 +451,8 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
                                    const QString& orderByClause,
                                    const QList<SortColumn>& sortColumns,
                                    const int columnOffset,
-                                   QHash<TrackId, int>* trackToIndex) {
+                                   QHash<TrackId, int>* trackToIndex,
+                                   const QVector<TrackId>* pFilteredTrackIds) {
     // Skip processing if there are no tracks to filter or sort.
     if (trackIds.size() == 0) {
         return;
@@ -386,60 +462,82 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
         buildIndex();
     }
 
-    QStringList idStrings;
-    // TODO(rryan) consider making this the data passed in and a separate
-    // QVector for output
     QSet<TrackId> dirtyTracks;
     for (const auto& trackId: trackIds) {
-        idStrings << trackId.toString();
         if (m_dirtyTracks.contains(trackId)) {
             dirtyTracks.insert(trackId);
         }
     }
 
-    std::unique_ptr<QueryNode> pQuery(parseQuery(
-        searchQuery, extraFilter, idStrings));
-
-    QString filter = pQuery->toSql();
-    if (!filter.isEmpty()) {
-        filter.prepend("WHERE ");
-    }
-
-    QString queryString = QString("SELECT %1 FROM %2 %3 %4")
-            .arg(m_idColumn, m_tableName, filter, orderByClause);
+    QList<ColumnarTrackTable::SortKey> sortKeys;
+    const bool sortInMemory = getSortKeys(
+            sortColumns, columnOffset, orderByClause, &sortKeys);
 
-    if (sDebug) {
-        qDebug() << this << "select() executing:" << queryString;
-    }
-
-    QSqlQuery query(m_database);
-    // This causes a memory savings since QSqlCachedResult (what QtSQLite uses)
-    // won't allocate a giant in-memory table that we won't use at all.
-    query.setForwardOnly(true);
-    query.prepare(queryString);
-
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
+    if (sortInMemory && searchQuery.isEmpty() && extraFilter.isEmpty()) {
+        // Every cached track matches, no need to ask SQLite.
+        m_trackOrder.resize(0); // keeps alocated memory
+        m_trackOrder.reserve(trackIds.size());
+        for (const auto& trackId: trackIds) {
+            if (m_trackRecords.contains(trackId)) {
+                m_trackOrder.append(trackId);
+            }
+        }
+    } else if (pFilteredTrackIds) {
+        m_trackOrder = *pFilteredTrackIds;
+        if (sortInMemory) {
+            m_lastFilterResult.valid = true;
+            m_lastFilterResult.trackIds = trackIds;
+            m_lastFilterResult.searchQuery = searchQuery;
+            m_lastFilterResult.extraFilter = extraFilter;
+            m_lastFilterResult.trackOrder = m_trackOrder;
+        }
+    } else if (sortInMemory &&
+            m_lastFilterResult.valid &&
+            m_lastFilterResult.searchQuery == searchQuery &&
+            m_lastFilterResult.extraFilter == extraFilter &&
+            m_lastFilterResult.trackIds == trackIds) {
+        m_trackOrder = m_lastFilterResult.trackOrder;
+    } else if (sortInMemory &&
+            refineLastFilterResult(trackIds, searchQuery, extraFilter)) {
+        m_lastFilterResult.searchQuery = searchQuery;
+        m_lastFilterResult.trackOrder = m_trackOrder;
+    } else {
+        QStringList idStrings;
+        idStrings.reserve(trackIds.size());
+        for (const auto& trackId: trackIds) {
+            idStrings << trackId.toString();
+        }
+        std::unique_ptr<QueryNode> pIdQuery(parseQuery(
+            searchQuery, extraFilter, idStrings));
+        // SQLite doesn't need to sort if we sort in memory afterwards.
+        filterWithQuery(pIdQuery->toSql(),
+                sortInMemory ? QString() : orderByClause);
+        if (sortInMemory) {
+            m_lastFilterResult.valid = true;
+            m_lastFilterResult.trackIds = trackIds;
+            m_lastFilterResult.searchQuery = searchQuery;
+            m_lastFilterResult.extraFilter = extraFilter;
+            m_lastFilterResult.trackOrder = m_trackOrder;
+        }
     }
 
-    int idColumn = query.record().indexOf(m_idColumn);
-    int rows = query.size();
-
-    if (sDebug) {
-        qDebug() << "Rows returned:" << rows;
+    if (sortInMemory) {
+        if (sDebug) {
+            qDebug() << this << "sorting" << m_trackOrder.size()
+                     << "tracks in memory";
+        }
+        for (const auto& sortKey: sortKeys) {
+            if (!m_columnarTable.isMaterialized(sortKey.column)) {
+                m_columnarTable.materialize(sortKey.column, m_trackRecords);
+            }
+        }
+        m_trackOrder = m_columnarTable.sorted(m_trackOrder, sortKeys);
     }
 
-    m_trackOrder.resize(0); // keeps alocated memory
     trackToIndex->clear();
-    if (rows > 0) {
-        trackToIndex->reserve(rows);
-        m_trackOrder.reserve(rows);
-    }
-
-    while (query.next()) {
-        TrackId trackId(query.value(idColumn));
-        (*trackToIndex)[trackId] = m_trackOrder.size();
-        m_trackOrder.append(trackId);
+    trackToIndex->reserve(m_trackOrder.size());
+    for (int i = 0; i < m_trackOrder.size(); ++i) {
+        (*trackToIndex)[m_trackOrder[i]] = i;
     }
 
     // At this point, the original set of tracks have been divided into two
@@ -455,6 +553,10 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
         return;
     }
 
+    // The id filter is not needed for matching single tracks.
+    std::unique_ptr<QueryNode> pQuery(parseQuery(
+        searchQuery, extraFilter, QStringList()));
+
     for (TrackId trackId: dirtyTracks) {
         // Only get the track if it is in the cache.
         TrackPointer pTrack = lookupCachedTrack(trackId);
@@ -516,6 +618,172 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
     }
 }
 
+QString BaseTrackCache::formatFilterQuery(const QString& trackIdsQuery,
+                                         const QString& searchQuery,
+                                         const QString& extraFilter,
+                                         const QString& orderByClause,
+                                         const QList<SortColumn>& sortColumns,
+                                         const int columnOffset) {
+    QList<ColumnarTrackTable::SortKey> sortKeys;
+    const bool sortInMemory = getSortKeys(
+            sortColumns, columnOffset, orderByClause, &sortKeys);
+    if (sortInMemory && searchQuery.isEmpty() && extraFilter.isEmpty()) {
+        return QString();
+    }
+    // Same query as in filterAndSort(), but the track ids are selected
+    // by a subselect instead of being listed
+    std::unique_ptr<QueryNode> pIdQuery(parseQuery(
+            searchQuery, extraFilter, QStringList() << trackIdsQuery));
+    return formatSelectIdsQuery(pIdQuery->toSql(),
+            sortInMemory ? QString() : orderByClause);
+}
+
+QString BaseTrackCache::formatSelectIdsQuery(const QString& filter,
+                                             const QString& orderByClause) const {
+    return QString("SELECT %1 FROM %2 %3 %4")
+            .arg(m_idColumn, m_tableName,
+                 filter.isEmpty() ? QString() : "WHERE " + filter,
+                 orderByClause);
+}
+
+void BaseTrackCache::filterWithQuery(const QString& filter,
+                                     const QString& orderByClause) {
+    QString queryString = formatSelectIdsQuery(filter, orderByClause);
+
+    if (sDebug) {
+        qDebug() << this << "select() executing:" << queryString;
+    }
+
+    QSqlQuery query(m_database);
+    // This causes a memory savings since QSqlCachedResult (what QtSQLite uses)
+    // won't allocate a giant in-memory table that we won't use at all.
+    query.setForwardOnly(true);
+    query.prepare(queryString);
+
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+    }
+
+    int idColumn = query.record().indexOf(m_idColumn);
+    int rows = query.size();
+
+    if (sDebug) {
+        qDebug() << "Rows returned:" << rows;
+    }
+
+    m_trackOrder.resize(0); // keeps alocated memory
+    if (rows > 0) {
+        m_trackOrder.reserve(rows);
+    }
+
+    while (query.next()) {
+        m_trackOrder.append(TrackId(query.value(idColumn)));
+    }
+}
+
+bool BaseTrackCache::refineLastFilterResult(const QSet<TrackId>& trackIds,
+                                            const QString& searchQuery,
+                                            const QString& extraFilter) {
+    QString refinement;
+    if (!m_lastFilterResult.valid ||
+            m_lastFilterResult.extraFilter != extraFilter ||
+            m_lastFilterResult.trackIds != trackIds ||
+            !SearchQueryParser::isRefinement(
+                    m_lastFilterResult.searchQuery, searchQuery, &refinement)) {
+        return false;
+    }
+
+    PerformanceTimer timer;
+    timer.start();
+
+    // Only the additional terms need to be matched, the tracks of the last
+    // result already match the rest of the query.
+    std::unique_ptr<QueryNode> pQuery(parseQuery(
+            refinement, QString(), QStringList()));
+
+    TrackId currentTrackId;
+    bool missingColumn = false;
+    const TrackValueLookup lookup =
+            [this, &currentTrackId, &missingColumn](const QString& column) {
+        const int index = fieldIndex(column);
+        if (index < 0) {
+            missingColumn = true;
+            return QVariant();
+        }
+        return m_trackRecords.value(currentTrackId, index);
+    };
+
+    QVector<TrackId> trackOrder;
+    trackOrder.reserve(m_lastFilterResult.trackOrder.size());
+    for (const auto& trackId: m_lastFilterResult.trackOrder) {
+        if (!m_trackRecords.contains(trackId)) {
+            return false;
+        }
+        currentTrackId = trackId;
+        if (pQuery->matchValues(lookup)) {
+            trackOrder.append(trackId);
+        }
+        if (missingColumn) {
+            // The query needs a column that is not cached
+            return false;
+        }
+    }
+    m_trackOrder = trackOrder;
+
+    if (sDebug) {
+        qDebug() << this << "refined" << m_lastFilterResult.trackOrder.size()
+                 << "to" << m_trackOrder.size() << "tracks in"
+                 << timer.elapsed().debugMillisWithUnit();
+    }
+    return true;
+}
+
+bool BaseTrackCache::getSortKeys(const QList<SortColumn>& sortColumns,
+                                 const int columnOffset,
+                                 const QString& orderByClause,
+                                 QList<ColumnarTrackTable::SortKey>* pSortKeys) {
+    if (orderByClause.contains("RANDOM()")) {
+        return false;
+    }
+    // Same mapping of sort columns as in BaseSqlTableModel::setSort()
+    for (const auto& sc: sortColumns) {
+        int column;
+        if (sc.m_column <= columnOffset) {
+            if (sc.m_column != 0) {
+                // A column of the table model that is not cached
+                continue;
+            }
+            column = 0;
+        } else {
+            column = sc.m_column - columnOffset;
+        }
+        if (column < 0 || column >= m_columnCount) {
+            return false;
+        }
+
+        if (m_columnCache.columnSortTypeForFieldIndex(column) ==
+                ColumnCache::SORT_KEY) {
+            // Keys are sorted by their id in circle of fifths order
+            const int keyIdColumn = fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_KEY_ID);
+            if (keyIdColumn < 0) {
+                return false;
+            }
+            ColumnarTrackTable::SortKey sortKey(keyIdColumn, sc.m_order);
+            const KeyUtils::KeyNotation notation =
+                    KeyUtils::keyNotationFromNumericValue(m_pKeyNotationCP->get());
+            for (int i = 0; i <= 24; ++i) {
+                sortKey.valueOrder.append(KeyUtils::keyToCircleOfFifthsOrder(
+                        static_cast<mixxx::track::io::key::ChromaticKey>(i),
+                        notation));
+            }
+            pSortKeys->append(sortKey);
+        } else {
+            pSortKeys->append(ColumnarTrackTable::SortKey(column, sc.m_order));
+        }
+    }
+    return true;
+}
+
 std::unique_ptr<QueryNode> BaseTrackCache::parseQuery(QString query, QString extraFilter,
                                       QStringList idStrings) const {
     QStringList queryFragments;
@@ -562,7 +830,7 @@ int BaseTrackCache::findSortInsertionPoint(TrackPointer pTrack,
 
         // This should not happen, but it's a recoverable error so we should
         // only log it.
-        if (!m_trackInfo.contains(otherTrackId)) {
+        if (!m_trackRecords.contains(otherTrackId)) {
             qDebug() << "WARNING: track" << otherTrackId << "was not in index";
             //updateTrackInIndex(otherTrackId);
         }
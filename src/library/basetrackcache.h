@@ -16,11 +16,14 @@
 #include "control/controlproxy.h"
 #include "library/dao/trackdao.h"
 #include "library/columncache.h"
+#include "library/columnartracktable.h"
+#include "library/trackrecordstore.h"
 #include "track/track.h"
 #include "util/class.h"
 #include "util/memory.h"
 
 class SearchQueryParser;
+class SearchIndexDAO;
 class QueryNode;
 class TrackCollection;
 
@@ -59,22 +62,42 @@ class BaseTrackCache : public QObject {
     ////////////////////////////////////////////////////////////////////////////
 
     virtual QVariant data(TrackId trackId, int column) const;
+    // Returns the values of all columns for each of the tracks like data()
+    // does for a single column. The record of a track that is not cached is
+    // empty.
+    QVector<QVector<QVariant> > records(const QVector<TrackId>& trackIds) const;
     virtual int columnCount() const;
     virtual int fieldIndex(const QString& column) const;
     QString columnNameForFieldIndex(int index) const;
     QString columnSortForFieldIndex(int index) const;
     int fieldIndex(ColumnCache::Column column) const;
+    // If pFilteredTrackIds is given it contains the result of the query
+    // from formatFilterQuery() for the same arguments, which has already
+    // been executed, e.g. on another thread.
     virtual void filterAndSort(const QSet<TrackId>& trackIds,
                                const QString& query,
                                const QString& extraFilter,
                                const QString& orderByClause,
                                const QList<SortColumn>& sortColumns,
                                const int columnOffset,
-                               QHash<TrackId, int>* trackToIndex);
+                               QHash<TrackId, int>* trackToIndex,
+                               const QVector<TrackId>* pFilteredTrackIds = nullptr);
+    // Returns the query that filterAndSort() would execute for the tracks
+    // that are selected by the subselect trackIdsQuery, or an empty string
+    // if it doesn't need to query SQLite at all.
+    QString formatFilterQuery(const QString& trackIdsQuery,
+                              const QString& query,
+                              const QString& extraFilter,
+                              const QString& orderByClause,
+                              const QList<SortColumn>& sortColumns,
+                              const int columnOffset);
     virtual bool isCached(TrackId trackId) const;
     virtual void ensureCached(TrackId trackId);
     virtual void ensureCached(QSet<TrackId> trackIds);
     virtual void setSearchColumns(const QStringList& columns);
+    // Use the full-text search index for plain search terms. Only valid if
+    // the ids of the cached table are library track ids.
+    void setSearchIndex(const SearchIndexDAO* pSearchIndex);
 
   signals:
     void tracksChanged(QSet<TrackId> trackIds);
@@ -86,13 +109,36 @@ class BaseTrackCache : public QObject {
     void slotTrackClean(TrackId trackId);
     void slotTrackChanged(TrackId trackId);
     void slotDbTrackAdded(TrackPointer pTrack);
+    // The tracks of a crate or playlist have changed
+    void slotMembershipChanged();
 
   private:
     TrackPointer lookupCachedTrack(TrackId trackId) const;
+    // Must be called whenever tracks are added, removed or updated or
+    // their membership in crates or playlists changes
+    void invalidateLastFilterResult();
     bool updateIndexWithQuery(const QString& query);
     bool updateIndexWithTrackpointer(TrackPointer pTrack);
     void updateTrackInIndex(TrackId trackId);
     void updateTracksInIndex(QSet<TrackId> trackIds);
+    // Translates the sort columns of the table model into sort keys of the
+    // columnar table. Returns false if the order can only be computed by
+    // SQLite.
+    bool getSortKeys(const QList<SortColumn>& sortColumns,
+                     const int columnOffset,
+                     const QString& orderByClause,
+                     QList<ColumnarTrackTable::SortKey>* pSortKeys);
+    QString formatSelectIdsQuery(const QString& filter,
+                                 const QString& orderByClause) const;
+    // Fills m_trackOrder with the ids of all tracks that match the filter.
+    void filterWithQuery(const QString& filter,
+                         const QString& orderByClause);
+    // Fills m_trackOrder with the tracks of the last filter result that
+    // match the search query without asking SQLite. Only possible if the
+    // search query narrows the search query of the last filter result.
+    bool refineLastFilterResult(const QSet<TrackId>& trackIds,
+                                const QString& searchQuery,
+                                const QString& extraFilter);
     void getTrackValueForColumn(TrackPointer pTrack, int column,
                                 QVariant& trackValue) const;
 
@@ -130,7 +176,25 @@ class BaseTrackCache : public QObject {
 
     bool m_bIndexBuilt;
     bool m_bIsCaching;
-    QHash<TrackId, QVector<QVariant> > m_trackInfo;
+    // The cached rows of the table. Full Track objects are only looked up
+    // for dirty tracks.
+    TrackRecordStore m_trackRecords;
+    // Sort keys of m_trackRecords for sorting without SQLite
+    ColumnarTrackTable m_columnarTable;
+
+    // The unsorted result of the last filter query. Re-sorting the same
+    // result set does not need to query SQLite again.
+    struct FilterResult {
+        FilterResult()
+                : valid(false) {
+        }
+        bool valid;
+        QSet<TrackId> trackIds;
+        QString searchQuery;
+        QString extraFilter;
+        QVector<TrackId> trackOrder;
+    };
+    FilterResult m_lastFilterResult;
     TrackDAO& m_trackDAO;
     QSqlDatabase m_database;
     SearchQueryParser* m_pQueryParser;
@@ -0,0 +1,330 @@
+#include "library/columnartracktable.h"
+
+#include <QDateTime>
+
+#include <algorithm>
+#include <cmath>
+
+#include "library/trackrecordstore.h"
+#include "util/assert.h"
+
+namespace {
+
+bool isNumericType(const QVariant& value) {
+    switch (static_cast<QMetaType::Type>(value.type())) {
+    case QMetaType::Bool:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Float:
+    case QMetaType::Double:
+        return true;
+    default:
+        return false;
+    }
+}
+
+QString toText(const QVariant& value) {
+    if (value.type() == QVariant::DateTime) {
+        return value.toDateTime().toString(Qt::ISODate);
+    }
+    return value.toString();
+}
+
+// Converts text into an integer like cast(text as integer) in SQLite: the
+// longest prefix that is an integer, or 0 if there is none.
+double leadingInteger(const QString& text) {
+    int i = 0;
+    while (i < text.size() && text[i].isSpace()) {
+        ++i;
+    }
+    bool negative = false;
+    if (i < text.size() && (text[i] == '-' || text[i] == '+')) {
+        negative = text[i] == '-';
+        ++i;
+    }
+    double result = 0.0;
+    while (i < text.size() && text[i] >= '0' && text[i] <= '9') {
+        result = result * 10.0 + text[i].digitValue();
+        ++i;
+    }
+    return negative ? -result : result;
+}
+
+template<typename T>
+int compareValues(T value1, T value2) {
+    if (value1 < value2) {
+        return -1;
+    } else if (value2 < value1) {
+        return 1;
+    }
+    return 0;
+}
+
+}  // anonymous namespace
+
+ColumnarTrackTable::ColumnarTrackTable(int columnCount)
+        : m_columns(columnCount) {
+}
+
+void ColumnarTrackTable::clear() {
+    for (auto& column: m_columns) {
+        Column empty;
+        empty.collation = column.collation;
+        column = empty;
+    }
+    m_trackIds.clear();
+    m_rowByTrackId.clear();
+}
+
+void ColumnarTrackTable::setCollation(int column, Collation collation) {
+    VERIFY_OR_DEBUG_ASSERT(column >= 0 && column < m_columns.size()) {
+        return;
+    }
+    Column& target = m_columns[column];
+    if (target.collation != collation) {
+        target = Column();
+        target.collation = collation;
+    }
+}
+
+bool ColumnarTrackTable::isMaterialized(int column) const {
+    return column >= 0 && column < m_columns.size() &&
+            m_columns[column].materialized;
+}
+
+template<typename ValueLookup>
+void ColumnarTrackTable::materializeColumn(int column, ValueLookup lookup) {
+    VERIFY_OR_DEBUG_ASSERT(column >= 0 && column < m_columns.size()) {
+        return;
+    }
+    Column& target = m_columns[column];
+    const int rows = m_trackIds.size();
+    target.classes.fill(VALUE_NULL, rows);
+    target.numbers.fill(0.0, rows);
+    target.codes.fill(-1, rows);
+    for (int row = 0; row < rows; ++row) {
+        target.setValue(row, lookup(m_trackIds[row]));
+    }
+    target.materialized = true;
+}
+
+void ColumnarTrackTable::materialize(int column, const Records& records) {
+    materializeColumn(column, [&records, column](TrackId trackId) {
+        return records.value(trackId).value(column);
+    });
+}
+
+void ColumnarTrackTable::materialize(int column,
+                                     const TrackRecordStore& records) {
+    materializeColumn(column, [&records, column](TrackId trackId) {
+        return records.value(trackId, column);
+    });
+}
+
+void ColumnarTrackTable::updateRow(TrackId trackId,
+                                   const QVector<QVariant>& record) {
+    int row = m_rowByTrackId.value(trackId, -1);
+    if (row < 0) {
+        row = m_trackIds.size();
+        m_trackIds.append(trackId);
+        m_rowByTrackId.insert(trackId, row);
+        for (auto& column: m_columns) {
+            if (column.materialized) {
+                column.classes.append(VALUE_NULL);
+                column.numbers.append(0.0);
+                column.codes.append(-1);
+            }
+        }
+    }
+    for (int i = 0; i < m_columns.size(); ++i) {
+        if (m_columns[i].materialized) {
+            m_columns[i].setValue(row, record.value(i));
+        }
+    }
+}
+
+void ColumnarTrackTable::removeRow(TrackId trackId) {
+    const int row = m_rowByTrackId.value(trackId, -1);
+    if (row < 0) {
+        return;
+    }
+    // Move the last row into the gap
+    const int lastRow = m_trackIds.size() - 1;
+    if (row != lastRow) {
+        m_trackIds[row] = m_trackIds[lastRow];
+        m_rowByTrackId[m_trackIds[row]] = row;
+    }
+    m_trackIds.resize(lastRow);
+    m_rowByTrackId.remove(trackId);
+    for (auto& column: m_columns) {
+        if (column.materialized) {
+            column.removeRow(row);
+        }
+    }
+}
+
+QVector<TrackId> ColumnarTrackTable::sorted(
+        const QVector<TrackId>& trackIds,
+        const QList<SortKey>& sortKeys) const {
+    QVector<int> rows;
+    rows.reserve(trackIds.size());
+    QVector<TrackId> missingTrackIds;
+    for (const auto& trackId: trackIds) {
+        const int row = m_rowByTrackId.value(trackId, -1);
+        if (row < 0) {
+            missingTrackIds.append(trackId);
+        } else {
+            rows.append(row);
+        }
+    }
+
+    QList<SortKey> validSortKeys;
+    for (const auto& sortKey: sortKeys) {
+        VERIFY_OR_DEBUG_ASSERT(isMaterialized(sortKey.column)) {
+            continue;
+        }
+        m_columns[sortKey.column].updateRanks();
+        validSortKeys.append(sortKey);
+    }
+
+    std::sort(rows.begin(), rows.end(),
+            [this, &validSortKeys](int row1, int row2) {
+        for (const auto& sortKey: validSortKeys) {
+            const int result = m_columns[sortKey.column].compareRows(
+                    row1, row2, sortKey.valueOrder);
+            if (result != 0) {
+                return sortKey.order == Qt::AscendingOrder ?
+                        result < 0 : result > 0;
+            }
+        }
+        return m_trackIds[row1] < m_trackIds[row2];
+    });
+
+    QVector<TrackId> result;
+    result.reserve(trackIds.size());
+    for (int row: rows) {
+        result.append(m_trackIds[row]);
+    }
+    result += missingTrackIds;
+    return result;
+}
+
+int ColumnarTrackTable::Column::encodeText(const QString& text) {
+    auto it = codeByString.constFind(text);
+    if (it != codeByString.constEnd()) {
+        return it.value();
+    }
+    const int code = strings.size();
+    strings.append(text);
+    codeByString.insert(text, code);
+    ranksValid = false;
+    return code;
+}
+
+void ColumnarTrackTable::Column::setValue(int row, const QVariant& value) {
+    if (value.isNull()) {
+        classes[row] = VALUE_NULL;
+        return;
+    }
+    switch (collation) {
+    case Collation::Default:
+        if (isNumericType(value)) {
+            classes[row] = VALUE_NUMBER;
+            numbers[row] = value.toDouble();
+        } else {
+            classes[row] = VALUE_TEXT;
+            codes[row] = encodeText(toText(value));
+        }
+        break;
+    case Collation::NoCase:
+        classes[row] = VALUE_TEXT;
+        codes[row] = encodeText(toText(value));
+        break;
+    case Collation::Integer:
+        classes[row] = VALUE_NUMBER;
+        if (isNumericType(value)) {
+            numbers[row] = std::trunc(value.toDouble());
+        } else {
+            numbers[row] = leadingInteger(toText(value));
+        }
+        break;
+    }
+}
+
+void ColumnarTrackTable::Column::removeRow(int row) {
+    const int lastRow = classes.size() - 1;
+    classes[row] = classes[lastRow];
+    numbers[row] = numbers[lastRow];
+    codes[row] = codes[lastRow];
+    classes.resize(lastRow);
+    numbers.resize(lastRow);
+    codes.resize(lastRow);
+}
+
+void ColumnarTrackTable::Column::updateRanks() const {
+    if (ranksValid) {
+        return;
+    }
+    // Same as the lexicographical collation function for SQLite in
+    // DbConnection
+    QVector<QString> folded;
+    folded.reserve(strings.size());
+    for (const auto& string: strings) {
+        folded.append(string.toLower());
+    }
+    QVector<int> order(strings.size());
+    for (int i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&folded](int code1, int code2) {
+        return QString::localeAwareCompare(folded[code1], folded[code2]) < 0;
+    });
+    ranks.resize(strings.size());
+    int rank = 0;
+    for (int i = 0; i < order.size(); ++i) {
+        if (i > 0 && QString::localeAwareCompare(
+                folded[order[i - 1]], folded[order[i]]) != 0) {
+            ++rank;
+        }
+        ranks[order[i]] = rank;
+    }
+    ranksValid = true;
+}
+
+int ColumnarTrackTable::Column::compareRows(
+        int row1, int row2, const QVector<int>& valueOrder) const {
+    ValueClass class1 = classes[row1];
+    ValueClass class2 = classes[row2];
+    double number1 = numbers[row1];
+    double number2 = numbers[row2];
+    if (!valueOrder.isEmpty()) {
+        // Map integer values like the CASE ... WHEN expression of the key
+        // column does.
+        auto mapValue = [&valueOrder](ValueClass* pClass, double* pNumber) {
+            const int index = static_cast<int>(*pNumber);
+            if (*pClass != VALUE_NUMBER || index != *pNumber ||
+                    index < 0 || index >= valueOrder.size()) {
+                *pClass = VALUE_NULL;
+            } else {
+                *pNumber = valueOrder[index];
+            }
+        };
+        mapValue(&class1, &number1);
+        mapValue(&class2, &number2);
+    }
+
+    if (class1 != class2) {
+        return compareValues(class1, class2);
+    }
+    switch (class1) {
+    case VALUE_NUMBER:
+        return compareValues(number1, number2);
+    case VALUE_TEXT:
+        DEBUG_ASSERT(ranksValid);
+        return compareValues(ranks[codes[row1]], ranks[codes[row2]]);
+    default:
+        return 0;
+    }
+}
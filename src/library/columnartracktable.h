@@ -0,0 +1,125 @@
+#ifndef COLUMNARTRACKTABLE_H
+#define COLUMNARTRACKTABLE_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+#include "track/trackid.h"
+
+class TrackRecordStore;
+
+// A column-oriented copy of the sort keys of a track table. Each column is
+// stored in contiguous arrays and strings are dictionary encoded, so
+// sorting compares integers and doubles instead of QVariants. The collation
+// order of the dictionary is computed once per column and only recomputed
+// after new strings have been added.
+//
+// Columns are materialized on demand when they are sorted by for the first
+// time. The ordering matches the ORDER BY clauses from
+// ColumnCache::columnSortForFieldIndex(): NULL before numbers before text,
+// and text compared case insensitive and locale aware like the
+// lexicographical collation that is installed into SQLite.
+class ColumnarTrackTable {
+  public:
+    enum class Collation {
+        // Values are compared by their SQLite storage class
+        Default,
+        // All values are compared as case folded text
+        NoCase,
+        // All values are converted to integers like cast(x as integer)
+        Integer,
+    };
+
+    struct SortKey {
+        SortKey(int column, Qt::SortOrder order)
+                : column(column),
+                  order(order) {
+        }
+        int column;
+        Qt::SortOrder order;
+        // If not empty, the integer values of the column are replaced by the
+        // value at the corresponding position. Values that are out of range
+        // sort like NULL.
+        QVector<int> valueOrder;
+    };
+
+    typedef QHash<TrackId, QVector<QVariant>> Records;
+
+    explicit ColumnarTrackTable(int columnCount = 0);
+
+    void clear();
+
+    int rowCount() const {
+        return m_trackIds.size();
+    }
+    bool containsRow(TrackId trackId) const {
+        return m_rowByTrackId.contains(trackId);
+    }
+
+    void setCollation(int column, Collation collation);
+
+    bool isMaterialized(int column) const;
+    // Copies the values of the given column from all records into the table.
+    void materialize(int column, const Records& records);
+    void materialize(int column, const TrackRecordStore& records);
+
+    // Inserts or replaces a row. Only the materialized columns are stored.
+    void updateRow(TrackId trackId, const QVector<QVariant>& record);
+    void removeRow(TrackId trackId);
+
+    // Returns the given tracks ordered by the sort keys. All sort key columns
+    // must be materialized. Tracks that are equal for all keys are ordered by
+    // their id. Tracks that are not in the table are appended unsorted.
+    QVector<TrackId> sorted(const QVector<TrackId>& trackIds,
+                            const QList<SortKey>& sortKeys) const;
+
+  private:
+    template<typename ValueLookup>
+    void materializeColumn(int column, ValueLookup lookup);
+
+    enum ValueClass : quint8 {
+        VALUE_NULL,
+        VALUE_NUMBER,
+        VALUE_TEXT,
+    };
+
+    struct Column {
+        Column()
+                : collation(Collation::Default),
+                  materialized(false),
+                  ranksValid(false) {
+        }
+
+        int encodeText(const QString& text);
+        void setValue(int row, const QVariant& value);
+        void removeRow(int row);
+        void updateRanks() const;
+        int compareRows(int row1, int row2, const QVector<int>& valueOrder) const;
+
+        Collation collation;
+        bool materialized;
+
+        // Parallel arrays indexed by row
+        QVector<ValueClass> classes;
+        // The value of VALUE_NUMBER rows
+        QVector<double> numbers;
+        // The dictionary code of VALUE_TEXT rows
+        QVector<int> codes;
+
+        // String dictionary and the collation rank of each entry. Strings
+        // that are equal for the collation have the same rank.
+        QVector<QString> strings;
+        QHash<QString, int> codeByString;
+        mutable QVector<int> ranks;
+        mutable bool ranksValid;
+    };
+
+    QVector<Column> m_columns;
+    QVector<TrackId> m_trackIds;
+    QHash<TrackId, int> m_rowByTrackId;
+};
+
+#endif // COLUMNARTRACKTABLE_H
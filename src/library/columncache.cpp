@@ -101,6 +101,13 @@ void ColumnCache::setColumns(const QStringList& columns) {
     m_columnSortByIndex.insert(m_columnIndexByEnum[COLUMN_PLAYLISTTRACKSTABLE_ARTIST], sortNoCase);
     m_columnSortByIndex.insert(m_columnIndexByEnum[COLUMN_PLAYLISTTRACKSTABLE_TITLE], sortNoCase);
 
+    m_columnSortTypeByIndex.clear();
+    for (auto it = m_columnSortByIndex.constBegin();
+            it != m_columnSortByIndex.constEnd(); ++it) {
+        m_columnSortTypeByIndex.insert(it.key(),
+                it.value() == sortInt ? SORT_INTEGER : SORT_NOCASE);
+    }
+
     slotSetKeySortOrder(m_pKeyNotationCP->get());
 }
 
@@ -123,4 +130,5 @@ void ColumnCache::slotSetKeySortOrder(double notationValue) {
     keySortSQL.append("END");
 
     m_columnSortByIndex.insert(m_columnIndexByEnum[COLUMN_LIBRARYTABLE_KEY], keySortSQL);
+    m_columnSortTypeByIndex.insert(m_columnIndexByEnum[COLUMN_LIBRARYTABLE_KEY], SORT_KEY);
 }
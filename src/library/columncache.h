@@ -70,6 +70,14 @@ class ColumnCache : public QObject {
         NUM_COLUMNS
     };
 
+    // How the values of a column are ordered by columnSortForFieldIndex().
+    enum SortType {
+        SORT_DEFAULT,
+        SORT_NOCASE,   // lower(%1)
+        SORT_INTEGER,  // cast(%1 as integer)
+        SORT_KEY,      // circle of fifths order of the %1_id column
+    };
+
     explicit ColumnCache(const QStringList& columns = QStringList());
 
     void setColumns(const QStringList& columns);
@@ -102,8 +110,13 @@ class ColumnCache : public QObject {
         return format.arg(columnNameForFieldIndex(index));
     }
 
+    inline SortType columnSortTypeForFieldIndex(int index) const {
+        return m_columnSortTypeByIndex.value(index, SORT_DEFAULT);
+    }
+
     QStringList m_columnsByIndex;
     QMap<int, QString> m_columnSortByIndex;
+    QMap<int, SortType> m_columnSortTypeByIndex;
     QMap<QString, int> m_columnIndexByName;
     // A mapping from column enum to logical index.
     int m_columnIndexByEnum[NUM_COLUMNS];
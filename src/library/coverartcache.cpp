@@ -1,11 +1,14 @@
-#include <QFutureWatcher>
+#include <QMetaObject>
 #include <QPixmapCache>
+#include <QRunnable>
 #include <QStringBuilder>
 #include <QtConcurrentRun>
 #include <QtDebug>
 
 #include "library/coverartcache.h"
 #include "library/coverartutils.h"
+#include "util/assert.h"
+#include "util/compatibility.h"
 #include "util/logger.h"
 
 
@@ -18,6 +21,10 @@ QString pixmapCacheKey(quint16 hash, int width) {
             .arg(QString::number(hash)).arg(width);
 }
 
+// Decoding and scaling covers is CPU bound. Leave the remaining cores to
+// the GUI, the audio engine and the analysis.
+const int kMaxLoaderThreads = 2;
+
 // The transformation mode when scaling images
 const Qt::TransformationMode kTransformationMode = Qt::SmoothTransformation;
 
@@ -30,7 +37,50 @@ inline QImage resizeImageWidth(const QImage& image, int width) {
 
 const bool sDebug = false;
 
+class CoverArtCache::LoadCoverTask : public QRunnable {
+  public:
+    LoadCoverTask(CoverArtCache* pCache,
+                  const CoverInfo& info,
+                  const QObject* pRequestor,
+                  int desiredWidth,
+                  bool signalWhenDone,
+                  QSharedPointer<QAtomicInt> pCancelled)
+            : m_pCache(pCache),
+              m_info(info),
+              m_pRequestor(pRequestor),
+              m_desiredWidth(desiredWidth),
+              m_signalWhenDone(signalWhenDone),
+              m_pCancelled(pCancelled) {
+    }
+
+    void run() override {
+        // Requests for rows that have been scrolled out of view are
+        // cancelled while they wait in the queue of the pool.
+        if (load_atomic(*m_pCancelled)) {
+            return;
+        }
+        FutureResult res = m_pCache->loadCover(
+                m_info, m_pRequestor, m_desiredWidth, m_signalWhenDone);
+        res.pCancelled = m_pCancelled;
+        QMetaObject::invokeMethod(m_pCache, "coverLoaded",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(CoverArtCache::FutureResult, res));
+    }
+
+  private:
+    CoverArtCache* const m_pCache;
+    const CoverInfo m_info;
+    const QObject* const m_pRequestor;
+    const int m_desiredWidth;
+    const bool m_signalWhenDone;
+    const QSharedPointer<QAtomicInt> m_pCancelled;
+};
+
 CoverArtCache::CoverArtCache() {
+    qRegisterMetaType<CoverArtCache::FutureResult>(
+            "CoverArtCache::FutureResult");
+    m_loaderPool.setMaxThreadCount(kMaxLoaderThreads);
+
     // The initial QPixmapCache limit is 10MB.
     // But it is not used just by the coverArt stuff,
     // it is also used by Qt to handle other things behind the scenes.
@@ -43,6 +93,19 @@ CoverArtCache::CoverArtCache() {
 
 CoverArtCache::~CoverArtCache() {
     qDebug() << "~CoverArtCache()";
+    for (const auto& pCancelled: m_runningRequests) {
+        pCancelled->fetchAndStoreRelease(1);
+    }
+    m_runningRequests.clear();
+    m_loaderPool.waitForDone();
+}
+
+void CoverArtCache::openThumbnailStore(const QString& directory) {
+    DEBUG_ASSERT(m_runningRequests.isEmpty());
+    m_pThumbnailStore.reset(new CoverArtThumbnailStore(directory));
+    if (!m_pThumbnailStore->isOpen()) {
+        m_pThumbnailStore.reset();
+    }
 }
 
 QPixmap CoverArtCache::requestCover(const CoverInfo& requestInfo,
@@ -66,7 +129,7 @@ QPixmap CoverArtCache::requestCover(const CoverInfo& requestInfo,
 
     // keep a list of trackIds for which a future is currently running
     // to avoid loading the same picture again while we are loading it
-    QPair<const QObject*, quint16> requestId = qMakePair(pRequestor, requestInfo.hash);
+    RequestId requestId = qMakePair(pRequestor, requestInfo.hash);
     if (m_runningRequests.contains(requestId)) {
         return QPixmap();
     }
@@ -93,16 +156,26 @@ QPixmap CoverArtCache::requestCover(const CoverInfo& requestInfo,
         return QPixmap();
     }
 
-    m_runningRequests.insert(requestId);
-    QFutureWatcher<FutureResult>* watcher = new QFutureWatcher<FutureResult>(this);
-    QFuture<FutureResult> future = QtConcurrent::run(
-            this, &CoverArtCache::loadCover, requestInfo, pRequestor,
-            desiredWidth, signalWhenDone);
-    connect(watcher, SIGNAL(finished()), this, SLOT(coverLoaded()));
-    watcher->setFuture(future);
+    QSharedPointer<QAtomicInt> pCancelled(new QAtomicInt(0));
+    m_runningRequests.insert(requestId, pCancelled);
+    m_loaderPool.start(new LoadCoverTask(
+            this, requestInfo, pRequestor, desiredWidth, signalWhenDone,
+            pCancelled));
     return QPixmap();
 }
 
+void CoverArtCache::cancelRequests(const QObject* pRequestor) {
+    auto it = m_runningRequests.begin();
+    while (it != m_runningRequests.end()) {
+        if (it.key().first == pRequestor) {
+            it.value()->fetchAndStoreRelease(1);
+            it = m_runningRequests.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 //static
 void CoverArtCache::requestCover(const Track& track,
                          const QObject* pRequestor) {
@@ -123,6 +196,19 @@ CoverArtCache::FutureResult CoverArtCache::loadCover(
                  << info << desiredWidth << signalWhenDone;
     }
 
+    // Scaled covers are stored on disk, so the original image doesn't need
+    // to be decoded and scaled again after a restart.
+    if (m_pThumbnailStore && desiredWidth > 0) {
+        QImage thumbnail = m_pThumbnailStore->load(info, desiredWidth);
+        if (!thumbnail.isNull()) {
+            FutureResult res;
+            res.pRequestor = pRequestor;
+            res.cover = CoverArt(info, thumbnail, desiredWidth);
+            res.signalWhenDone = signalWhenDone;
+            return res;
+        }
+    }
+
     QImage image = CoverArtUtils::loadCover(info);
 
     // TODO(XXX) Should we re-hash here? If the cover file (or track metadata)
@@ -134,6 +220,9 @@ CoverArtCache::FutureResult CoverArtCache::loadCover(
     // efficiency.
     if (!image.isNull() && desiredWidth > 0) {
         image = resizeImageWidth(image, desiredWidth);
+        if (m_pThumbnailStore) {
+            m_pThumbnailStore->store(info, desiredWidth, image);
+        }
     }
 
     FutureResult res;
@@ -144,12 +233,8 @@ CoverArtCache::FutureResult CoverArtCache::loadCover(
     return res;
 }
 
-// watcher
-void CoverArtCache::coverLoaded() {
-    QFutureWatcher<FutureResult>* watcher;
-    watcher = reinterpret_cast<QFutureWatcher<FutureResult>*>(sender());
-    FutureResult res = watcher->result();
-
+// LoadCoverTask
+void CoverArtCache::coverLoaded(CoverArtCache::FutureResult res) {
     if (sDebug) {
         kLogger.debug() << "coverLoaded" << res.cover;
     }
@@ -172,7 +257,13 @@ void CoverArtCache::coverLoaded() {
         QPixmapCache::insert(cacheKey, pixmap);
     }
 
-    m_runningRequests.remove(qMakePair(res.pRequestor, res.cover.hash));
+    // A cancelled request may have been requested again in the meantime
+    RequestId requestId = qMakePair(res.pRequestor, res.cover.hash);
+    auto it = m_runningRequests.find(requestId);
+    if (it == m_runningRequests.end() || it.value() != res.pCancelled) {
+        return;
+    }
+    m_runningRequests.erase(it);
 
     if (res.signalWhenDone) {
         emit(coverFound(res.pRequestor, res.cover, pixmap, false));
@@ -1,16 +1,30 @@
 #ifndef COVERARTCACHE_H
 #define COVERARTCACHE_H
 
+#include <QAtomicInt>
+#include <QHash>
 #include <QObject>
 #include <QPixmap>
+#include <QScopedPointer>
+#include <QSharedPointer>
+#include <QThreadPool>
 
 #include "library/coverart.h"
+#include "library/coverartthumbnailstore.h"
 #include "util/singleton.h"
 #include "track/track.h"
 
+// Covers are looked up in two levels: scaled covers are kept in the
+// QPixmapCache and in a thumbnail store on disk that survives restarts.
+// Only if both miss the cover is decoded from its file and scaled. The
+// loading is done on a small thread pool of its own.
 class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
     Q_OBJECT
   public:
+    // Stores the scaled covers in the given directory. Must be called
+    // before the first cover is requested.
+    void openThumbnailStore(const QString& directory);
+
     /* This method is used to request a cover art pixmap.
      *
      * @param pRequestor : an arbitrary pointer (can be any number you'd like,
@@ -32,6 +46,10 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
     static void requestCover(const Track& track,
                              const QObject* pRequestor);
 
+    // Cancels all requests of the requestor that have not been finished
+    // yet. No coverFound signal is emitted for them.
+    void cancelRequests(const QObject* pRequestor);
+
     // Guesses the cover art for the provided tracks by searching the tracks'
     // metadata and folders for image files. All I/O is done in a separate
     // thread.
@@ -47,11 +65,13 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
         CoverArt cover;
         const QObject* pRequestor;
         bool signalWhenDone;
+        // Identifies the request among requests for the same cover
+        QSharedPointer<QAtomicInt> pCancelled;
     };
 
   public slots:
     // Called when loadCover is complete in the main thread.
-    void coverLoaded();
+    void coverLoaded(CoverArtCache::FutureResult res);
 
   signals:
     void coverFound(const QObject* requestor,
@@ -74,7 +94,18 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
     void guessCover(TrackPointer pTrack);
 
   private:
-    QSet<QPair<const QObject*, quint16> > m_runningRequests;
+    class LoadCoverTask;
+
+    typedef QPair<const QObject*, quint16> RequestId;
+    // The requests for which a task is currently queued or running, to avoid
+    // loading the same picture again while we are loading it. The flag is
+    // set to cancel the task.
+    QHash<RequestId, QSharedPointer<QAtomicInt> > m_runningRequests;
+
+    QThreadPool m_loaderPool;
+    QScopedPointer<CoverArtThumbnailStore> m_pThumbnailStore;
 };
 
+Q_DECLARE_METATYPE(CoverArtCache::FutureResult);
+
 #endif // COVERARTCACHE_H
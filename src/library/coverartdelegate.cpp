@@ -58,6 +58,23 @@ CoverArtDelegate::~CoverArtDelegate() {
 void CoverArtDelegate::slotOnlyCachedCoverArt(bool b) {
     m_bOnlyCachedCover = b;
 
+    // While scrolling, the rows of the requested covers may move out of
+    // view. Cancel the requests and treat them like cache misses, so that
+    // only the covers of the rows that are still visible after scrolling
+    // are requested again.
+    if (m_bOnlyCachedCover && !m_hashToRow.isEmpty()) {
+        CoverArtCache* pCache = CoverArtCache::instance();
+        if (pCache) {
+            pCache->cancelRequests(this);
+        }
+        foreach (const QLinkedList<int>& rows, m_hashToRow) {
+            foreach (int row, rows) {
+                m_cacheMissRows.append(row);
+            }
+        }
+        m_hashToRow.clear();
+    }
+
     // If we can request non-cache covers now, request updates for all rows that
     // were cache misses since the last time.
     if (!m_bOnlyCachedCover) {
@@ -0,0 +1,266 @@
+#include "library/coverartthumbnailstore.h"
+
+#include <QBuffer>
+#include <QDir>
+#include <QMutexLocker>
+
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("CoverArtThumbnailStore");
+
+const QString kIndexFileName = "thumbnails.idx";
+const QString kDataFileName = "thumbnails.dat";
+
+// "MXCT" and the version of the file format
+const quint32 kIndexMagic = 0x4d584354;
+const quint32 kIndexVersion = 1;
+
+struct IndexHeader {
+    quint32 magic;
+    quint32 version;
+};
+
+// The files are only read on the machine that wrote them, so the records
+// are stored in host byte order.
+struct IndexRecord {
+    qint64 offset;
+    quint32 size;
+    quint32 locationHash;
+    quint16 hash;
+    quint16 width;
+    quint32 reserved;
+};
+
+static_assert(sizeof(IndexHeader) == 8, "unexpected size of IndexHeader");
+static_assert(sizeof(IndexRecord) == 24, "unexpected size of IndexRecord");
+
+// Photos are much smaller as JPEG and decode faster. Only images with
+// transparency are stored as PNG.
+const int kJpegQuality = 90;
+
+QByteArray encodeImage(const QImage& image) {
+    QByteArray bytes;
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::WriteOnly);
+    if (image.hasAlphaChannel()) {
+        image.save(&buffer, "PNG");
+    } else {
+        image.save(&buffer, "JPG", kJpegQuality);
+    }
+    return bytes;
+}
+
+}  // anonymous namespace
+
+// static
+const qint64 CoverArtThumbnailStore::kDefaultMaxDataSize = 256 * 1024 * 1024;
+
+bool operator==(const CoverArtThumbnailStore::Key& key1,
+                const CoverArtThumbnailStore::Key& key2) {
+    return key1.hash == key2.hash &&
+            key1.width == key2.width &&
+            key1.locationHash == key2.locationHash;
+}
+
+uint qHash(const CoverArtThumbnailStore::Key& key) {
+    return (static_cast<uint>(key.hash) << 16 | key.width) ^ key.locationHash;
+}
+
+CoverArtThumbnailStore::CoverArtThumbnailStore(const QString& directory,
+                                               qint64 maxDataSize)
+        : m_maxDataSize(maxDataSize) {
+    QDir dir(directory);
+    if (!dir.mkpath(".")) {
+        kLogger.warning() << "Failed to create directory" << directory;
+        return;
+    }
+    m_indexFile.setFileName(dir.filePath(kIndexFileName));
+    m_dataFile.setFileName(dir.filePath(kDataFileName));
+    if (!m_indexFile.open(QIODevice::ReadWrite) ||
+            !m_dataFile.open(QIODevice::ReadWrite)) {
+        kLogger.warning() << "Failed to open the thumbnail files in"
+                          << directory;
+        m_indexFile.close();
+        m_dataFile.close();
+        return;
+    }
+    readIndex();
+}
+
+CoverArtThumbnailStore::~CoverArtThumbnailStore() {
+}
+
+bool CoverArtThumbnailStore::isOpen() const {
+    QMutexLocker locker(&m_mutex);
+    return m_indexFile.isOpen() && m_dataFile.isOpen();
+}
+
+int CoverArtThumbnailStore::thumbnailCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_entries.size();
+}
+
+// static
+CoverArtThumbnailStore::Key CoverArtThumbnailStore::makeKey(
+        const CoverInfo& info, int width) {
+    Key key;
+    key.hash = info.hash;
+    key.width = static_cast<quint16>(width);
+    key.locationHash = qHash(info.coverLocation + QChar('\0') +
+                             info.trackLocation);
+    return key;
+}
+
+void CoverArtThumbnailStore::readIndex() {
+    const qint64 indexSize = m_indexFile.size();
+    if (indexSize < static_cast<qint64>(sizeof(IndexHeader))) {
+        clearFiles();
+        return;
+    }
+    const uchar* pIndex = m_indexFile.map(0, indexSize);
+    if (pIndex == nullptr) {
+        kLogger.warning() << "Failed to map" << m_indexFile.fileName();
+        clearFiles();
+        return;
+    }
+    const IndexHeader* pHeader = reinterpret_cast<const IndexHeader*>(pIndex);
+    if (pHeader->magic != kIndexMagic || pHeader->version != kIndexVersion) {
+        m_indexFile.unmap(const_cast<uchar*>(pIndex));
+        clearFiles();
+        return;
+    }
+
+    // Records that point beyond the end of the data file and an incomplete
+    // last record are left over from an interrupted write.
+    const qint64 dataSize = m_dataFile.size();
+    const IndexRecord* pRecords = reinterpret_cast<const IndexRecord*>(
+            pIndex + sizeof(IndexHeader));
+    const qint64 recordCount =
+            (indexSize - sizeof(IndexHeader)) / sizeof(IndexRecord);
+    qint64 validCount = 0;
+    while (validCount < recordCount) {
+        const IndexRecord& record = pRecords[validCount];
+        if (record.offset < 0 || record.offset + record.size > dataSize) {
+            break;
+        }
+        Key key;
+        key.hash = record.hash;
+        key.width = record.width;
+        key.locationHash = record.locationHash;
+        Entry entry;
+        entry.offset = record.offset;
+        entry.size = record.size;
+        m_entries.insert(key, entry);
+        ++validCount;
+    }
+    m_indexFile.unmap(const_cast<uchar*>(pIndex));
+
+    const qint64 validSize =
+            sizeof(IndexHeader) + validCount * sizeof(IndexRecord);
+    if (validSize < indexSize) {
+        kLogger.warning() << "Discarding"
+                          << (recordCount - validCount)
+                          << "incomplete thumbnail records";
+        m_indexFile.resize(validSize);
+    }
+    kLogger.debug() << "Opened" << m_entries.size() << "thumbnails";
+}
+
+void CoverArtThumbnailStore::clear() {
+    QMutexLocker locker(&m_mutex);
+    if (m_indexFile.isOpen() && m_dataFile.isOpen()) {
+        clearFiles();
+    }
+}
+
+void CoverArtThumbnailStore::clearFiles() {
+    m_entries.clear();
+    m_dataFile.resize(0);
+    m_indexFile.resize(0);
+    IndexHeader header;
+    header.magic = kIndexMagic;
+    header.version = kIndexVersion;
+    m_indexFile.seek(0);
+    m_indexFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_indexFile.flush();
+}
+
+QImage CoverArtThumbnailStore::load(const CoverInfo& info, int width) {
+    const Key key = makeKey(info, width);
+    QByteArray bytes;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_entries.constFind(key);
+        if (it == m_entries.constEnd()) {
+            return QImage();
+        }
+        if (m_dataFile.seek(it.value().offset)) {
+            bytes = m_dataFile.read(it.value().size);
+        }
+    }
+
+    // Decode without holding the lock
+    QImage image;
+    if (!bytes.isEmpty()) {
+        image = QImage::fromData(bytes);
+    }
+    if (image.isNull()) {
+        kLogger.warning() << "Failed to read the thumbnail of" << info;
+        // Forget it, so that it is stored again
+        QMutexLocker locker(&m_mutex);
+        m_entries.remove(key);
+    }
+    return image;
+}
+
+void CoverArtThumbnailStore::store(const CoverInfo& info, int width,
+                                   const QImage& image) {
+    if (image.isNull() || width <= 0 || width > 0xffff) {
+        return;
+    }
+    const Key key = makeKey(info, width);
+    const QByteArray bytes = encodeImage(image);
+    if (bytes.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_indexFile.isOpen() || !m_dataFile.isOpen() ||
+            m_entries.contains(key)) {
+        return;
+    }
+    if (m_dataFile.size() + bytes.size() > m_maxDataSize) {
+        kLogger.debug() << "Clearing" << m_entries.size()
+                        << "thumbnails after reaching the size limit";
+        clearFiles();
+    }
+
+    // Write the data before the record that points to it
+    Entry entry;
+    entry.offset = m_dataFile.size();
+    entry.size = bytes.size();
+    if (!m_dataFile.seek(entry.offset) ||
+            m_dataFile.write(bytes) != bytes.size() ||
+            !m_dataFile.flush()) {
+        kLogger.warning() << "Failed to write" << m_dataFile.fileName();
+        return;
+    }
+
+    IndexRecord record;
+    record.offset = entry.offset;
+    record.size = entry.size;
+    record.locationHash = key.locationHash;
+    record.hash = key.hash;
+    record.width = key.width;
+    record.reserved = 0;
+    if (!m_indexFile.seek(m_indexFile.size()) ||
+            m_indexFile.write(reinterpret_cast<const char*>(&record),
+                              sizeof(record)) != sizeof(record) ||
+            !m_indexFile.flush()) {
+        kLogger.warning() << "Failed to write" << m_indexFile.fileName();
+        return;
+    }
+    m_entries.insert(key, entry);
+}
@@ -0,0 +1,75 @@
+#ifndef COVERARTTHUMBNAILSTORE_H
+#define COVERARTTHUMBNAILSTORE_H
+
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+
+#include "library/coverart.h"
+
+// Stores scaled cover art on disk, so that the cover column of the library
+// doesn't need to decode and scale the original images again after a
+// restart.
+//
+// The encoded thumbnails are appended to a data file. An index file holds a
+// fixed size record for each thumbnail with its key and position in the
+// data file. The index file is memory mapped and read when the store is
+// opened, new records are appended to it. When the data file exceeds the
+// maximum size the store is cleared.
+//
+// Thumbnails are keyed by the hash of the cover, the width they have been
+// scaled to and the location the cover was loaded from. The location is
+// included because the 16 bit cover hash alone collides too often for a
+// cache that persists.
+//
+// All methods are thread-safe.
+class CoverArtThumbnailStore {
+  public:
+    explicit CoverArtThumbnailStore(const QString& directory,
+                                    qint64 maxDataSize = kDefaultMaxDataSize);
+    virtual ~CoverArtThumbnailStore();
+
+    bool isOpen() const;
+
+    // Returns a null image if there is no thumbnail of the cover with the
+    // given width.
+    QImage load(const CoverInfo& info, int width);
+    void store(const CoverInfo& info, int width, const QImage& image);
+
+    void clear();
+
+    int thumbnailCount() const;
+
+    static const qint64 kDefaultMaxDataSize;
+
+  private:
+    struct Key {
+        quint16 hash;
+        quint16 width;
+        quint32 locationHash;
+    };
+    friend bool operator==(const Key& key1, const Key& key2);
+    friend uint qHash(const Key& key);
+
+    struct Entry {
+        qint64 offset;
+        quint32 size;
+    };
+
+    static Key makeKey(const CoverInfo& info, int width);
+
+    void readIndex();
+    void clearFiles();
+
+    const qint64 m_maxDataSize;
+
+    // You must hold m_mutex to touch the following members
+    mutable QMutex m_mutex;
+    QFile m_indexFile;
+    QFile m_dataFile;
+    QHash<Key, Entry> m_entries;
+};
+
+#endif // COVERARTTHUMBNAILSTORE_H
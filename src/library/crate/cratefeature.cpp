@@ -788,11 +788,13 @@ void CrateFeature::slotTrackSelected(TrackPointer pTrack) {
     std::vector<CrateId> sortedTrackCrates;
     if (pTrack) {
         selectedTrackId = pTrack->getId();
-        CrateTrackSelectResult trackCratesIter(
-                m_pTrackCollection->crates().selectTrackCratesSorted(selectedTrackId));
-        while (trackCratesIter.next()) {
-            sortedTrackCrates.push_back(trackCratesIter.crateId());
-        }
+        // Crate tracks are not indexed by track id in the database, so
+        // look them up in the in-memory index instead.
+        const QSet<CrateId> trackCrates =
+                m_pTrackCollection->crates().collectCrateIdsOfTracks(
+                        QList<TrackId>() << selectedTrackId);
+        sortedTrackCrates.assign(trackCrates.begin(), trackCrates.end());
+        std::sort(sortedTrackCrates.begin(), sortedTrackCrates.end());
     }
 
     // Set all crates the track is in bold (or if there is no track selected,
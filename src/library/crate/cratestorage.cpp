@@ -9,6 +9,7 @@
 #include "util/db/fwdsqlquery.h"
 
 #include "util/logger.h"
+#include "util/performancetimer.h"
 
 
 namespace {
@@ -212,7 +213,9 @@ void CrateStorage::repairDatabase(QSqlDatabase database) {
 
 void CrateStorage::connectDatabase(QSqlDatabase database) {
     m_database = database;
+    m_queryCache.setDatabase(database);
     createViews();
+    loadCrateTracks();
 }
 
 
@@ -220,6 +223,8 @@ void CrateStorage::disconnectDatabase() {
     // Ensure that we don't use the current database connection
     // any longer.
     m_database = QSqlDatabase();
+    m_queryCache.setDatabase(QSqlDatabase());
+    m_crateTrackIds.clear();
 }
 
 
@@ -231,6 +236,33 @@ void CrateStorage::createViews() {
 }
 
 
+void CrateStorage::loadCrateTracks() {
+    PerformanceTimer timer;
+    timer.start();
+    m_crateTrackIds.clear();
+    FwdSqlQuery query(m_database, QString(
+            "SELECT %1,%2 FROM %3").arg(
+                    CRATETRACKSTABLE_CRATEID,
+                    CRATETRACKSTABLE_TRACKID,
+                    CRATE_TRACKS_TABLE));
+    VERIFY_OR_DEBUG_ASSERT(query.execPrepared()) {
+        kLogger.critical()
+                << "Failed to load crate tracks!";
+        return;
+    }
+    CrateTrackSelectResult crateTracks(std::move(query));
+    int count = 0;
+    while (crateTracks.next()) {
+        m_crateTrackIds[crateTracks.crateId()].add(
+                crateTracks.trackId().toInt());
+        ++count;
+    }
+    kLogger.debug()
+            << "Loaded" << count << "tracks of" << m_crateTrackIds.size()
+            << "crates in" << timer.elapsed().debugMillisWithUnit();
+}
+
+
 uint CrateStorage::countCrates() const {
     FwdSqlQuery query(m_database, QString(
             "SELECT COUNT(*) FROM %1").arg(
@@ -246,7 +278,7 @@ uint CrateStorage::countCrates() const {
 
 
 bool CrateStorage::readCrateById(CrateId id, Crate* pCrate) const {
-    FwdSqlQuery query(m_database, QString(
+    FwdSqlQuery query(&m_queryCache, QString(
             "SELECT * FROM %1 WHERE %2=:id").arg(
                     CRATE_TABLE,
                     CRATETABLE_ID));
@@ -376,9 +408,13 @@ CrateSummarySelectResult CrateStorage::selectCrateSummaries() const {
 }
 
 bool CrateStorage::readCrateSummaryById(CrateId id, CrateSummary* pCrateSummary) const {
+    // Don't select from the view, which would aggregate the tracks
+    // of all crates before filtering the result.
     FwdSqlQuery query(m_database, QString(
-            "SELECT * FROM %1 WHERE %2=:id").arg(
-                    CRATE_SUMMARY_VIEW,
+            "%1 %2 WHERE %3.%4=:id GROUP BY %3.%4").arg(
+                    kCrateSummaryViewSelect,
+                    kLibraryTracksJoin,
+                    CRATE_TABLE,
                     CRATETABLE_ID));
     query.bindValue(":id", id);
     if (query.execPrepared()) {
@@ -399,18 +435,35 @@ bool CrateStorage::readCrateSummaryById(CrateId id, CrateSummary* pCrateSummary)
 
 
 uint CrateStorage::countCrateTracks(CrateId crateId) const {
+    return m_crateTrackIds.value(crateId).cardinality();
+}
+
+
+CompressedBitmap CrateStorage::getTrackIdsOfAnyCrate(
+        const QList<CrateId>& crateIds) const {
+    CompressedBitmap result;
+    for (const auto& crateId: crateIds) {
+        result |= m_crateTrackIds.value(crateId);
+    }
+    return result;
+}
+
+
+QList<CrateId> CrateStorage::collectCrateIdsByNameLike(
+        const QString& crateNameLike) const {
     FwdSqlQuery query(m_database, QString(
-            "SELECT COUNT(*) FROM %1 WHERE %2=:crateId").arg(
-                    CRATE_TRACKS_TABLE,
-                    CRATETRACKSTABLE_CRATEID));
-    query.bindValue(":crateId", crateId);
-    if (query.execPrepared() && query.next()) {
-        uint result = query.fieldValue(0).toUInt();
-        DEBUG_ASSERT(!query.next());
-        return result;
-    } else {
-        return 0;
+            "SELECT %1 FROM %2 WHERE %3 LIKE :crateNameLike").arg(
+                    CRATETABLE_ID,
+                    CRATE_TABLE,
+                    CRATETABLE_NAME));
+    query.bindValue(":crateNameLike", kSqlLikeMatchAll + crateNameLike + kSqlLikeMatchAll);
+    QList<CrateId> result;
+    if (query.execPrepared()) {
+        while (query.next()) {
+            result.append(CrateId(query.fieldValue(0)));
+        }
     }
+    return result;
 }
 
 
@@ -425,20 +478,6 @@ QString CrateStorage::formatSubselectQueryForCrateTrackIds(
 }
 
 
-//static
-QString CrateStorage::formatQueryForTrackIdsByCrateNameLike(
-        const QString& crateNameLike) {
-    return QString("SELECT DISTINCT %1 FROM %2 JOIN %3 ON %4=%5 WHERE %6 LIKE '%7' ORDER BY %1").arg(
-            CRATETRACKSTABLE_TRACKID,
-            CRATE_TRACKS_TABLE,
-            CRATE_TABLE,
-            CRATETRACKSTABLE_CRATEID,
-            CRATETABLE_ID,
-            CRATETABLE_NAME,
-            kSqlLikeMatchAll + crateNameLike + kSqlLikeMatchAll);
-}
-
-
 CrateTrackSelectResult CrateStorage::selectCrateTracksSorted(CrateId crateId) const {
     FwdSqlQuery query(m_database, QString(
             "SELECT * FROM %1 WHERE %2=:crateId ORDER BY %3").arg(
@@ -490,18 +529,13 @@ CrateTrackSelectResult CrateStorage::selectTracksSortedByCrateNameLike(const QSt
 
 
 QSet<CrateId> CrateStorage::collectCrateIdsOfTracks(const QList<TrackId>& trackIds) const {
-    // NOTE(uklotzde): One query per track id. This could be optimized
-    // by querying for chunks of track ids and collecting the results.
     QSet<CrateId> trackCrates;
-    for (const auto& trackId: trackIds) {
-        // NOTE(uklotzde): The query result does not need to be sorted by crate id
-        // here. But since the coresponding FK column is indexed the impact on the
-        // performance should be negligible. By reusing an existing query we reduce
-        // the amount of code and the number of prepared SQL queries.
-        CrateTrackSelectResult crateTracks(selectTrackCratesSorted(trackId));
-        while (crateTracks.next()) {
-            DEBUG_ASSERT(crateTracks.trackId() == trackId);
-            trackCrates.insert(crateTracks.crateId());
+    for (auto it = m_crateTrackIds.constBegin(); it != m_crateTrackIds.constEnd(); ++it) {
+        for (const auto& trackId: trackIds) {
+            if (it.value().contains(trackId.toInt())) {
+                trackCrates.insert(it.key());
+                break;
+            }
         }
     }
     return trackCrates;
@@ -516,7 +550,7 @@ bool CrateStorage::onInsertingCrate(
                 << "Cannot insert crate with a valid id:" << crate.getId();
         return false;
     }
-    FwdSqlQuery query(m_database, QString(
+    FwdSqlQuery query(&m_queryCache, QString(
             "INSERT INTO %1 (%2,%3,%4) VALUES (:name,:locked,:autoDjSource)").arg(
                     CRATE_TABLE,
                     CRATETABLE_NAME,
@@ -552,7 +586,7 @@ bool CrateStorage::onUpdatingCrate(
                 << "Cannot update crate without a valid id";
         return false;
     }
-    FwdSqlQuery query(m_database, QString(
+    FwdSqlQuery query(&m_queryCache, QString(
             "UPDATE %1 SET %2=:name,%3=:locked,%4=:autoDjSource WHERE %5=:id").arg(
                     CRATE_TABLE,
                     CRATETABLE_NAME,
@@ -592,7 +626,7 @@ bool CrateStorage::onDeletingCrate(
         return false;
     }
     {
-        FwdSqlQuery query(m_database, QString(
+        FwdSqlQuery query(&m_queryCache, QString(
                 "DELETE FROM %1 WHERE %2=:id").arg(
                         CRATE_TRACKS_TABLE,
                         CRATETRACKSTABLE_CRATEID));
@@ -609,7 +643,7 @@ bool CrateStorage::onDeletingCrate(
         }
     }
     {
-        FwdSqlQuery query(m_database, QString(
+        FwdSqlQuery query(&m_queryCache, QString(
                 "DELETE FROM %1 WHERE %2=:id").arg(
                         CRATE_TABLE,
                         CRATETABLE_ID));
@@ -638,7 +672,7 @@ bool CrateStorage::onDeletingCrate(
 bool CrateStorage::onAddingCrateTracks(
         CrateId crateId,
         const QList<TrackId>& trackIds) {
-    FwdSqlQuery query(m_database, QString(
+    FwdSqlQuery query(&m_queryCache, QString(
             "INSERT OR IGNORE INTO %1 (%2, %3) VALUES (:crateId,:trackId)").arg(
                     CRATE_TRACKS_TABLE,
                     CRATETRACKSTABLE_CRATEID,
@@ -670,7 +704,7 @@ bool CrateStorage::onRemovingCrateTracks(
         const QList<TrackId>& trackIds) {
     // NOTE(uklotzde): We remove tracks in a loop
     // analogously to adding tracks (see above).
-    FwdSqlQuery query(m_database, QString(
+    FwdSqlQuery query(&m_queryCache, QString(
             "DELETE FROM %1 WHERE %2=:crateId AND %3=:trackId").arg(
                     CRATE_TRACKS_TABLE,
                     CRATETRACKSTABLE_CRATEID,
@@ -702,7 +736,7 @@ bool CrateStorage::onPurgingTracks(
     // NOTE(uklotzde): Remove tracks from crates one-by-one.
     // This might be optimized by deleting multiple track ids
     // at once in chunks with a maximum size.
-    FwdSqlQuery query(m_database, QString(
+    FwdSqlQuery query(&m_queryCache, QString(
             "DELETE FROM %1 WHERE %2=:trackId").arg(
                     CRATE_TRACKS_TABLE,
                     CRATETRACKSTABLE_TRACKID));
@@ -717,3 +751,51 @@ bool CrateStorage::onPurgingTracks(
     }
     return true;
 }
+
+
+void CrateStorage::afterDeletingCrate(
+        CrateId crateId) {
+    m_crateTrackIds.remove(crateId);
+}
+
+
+void CrateStorage::afterAddingCrateTracks(
+        CrateId crateId,
+        const QList<TrackId>& trackIds) {
+    CompressedBitmap& crateTrackIds = m_crateTrackIds[crateId];
+    for (const auto& trackId: trackIds) {
+        crateTrackIds.add(trackId.toInt());
+    }
+}
+
+
+void CrateStorage::afterRemovingCrateTracks(
+        CrateId crateId,
+        const QList<TrackId>& trackIds) {
+    auto it = m_crateTrackIds.find(crateId);
+    if (it == m_crateTrackIds.end()) {
+        return;
+    }
+    for (const auto& trackId: trackIds) {
+        it.value().remove(trackId.toInt());
+    }
+    if (it.value().isEmpty()) {
+        m_crateTrackIds.erase(it);
+    }
+}
+
+
+void CrateStorage::afterPurgingTracks(
+        const QList<TrackId>& trackIds) {
+    auto it = m_crateTrackIds.begin();
+    while (it != m_crateTrackIds.end()) {
+        for (const auto& trackId: trackIds) {
+            it.value().remove(trackId.toInt());
+        }
+        if (it.value().isEmpty()) {
+            it = m_crateTrackIds.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
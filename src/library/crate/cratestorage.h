@@ -3,13 +3,17 @@
 
 
 #include <QObject>
+#include <QHash>
 #include <QList>
 #include <QSet>
 
 #include "library/crate/cratesummary.h"
 #include "track/trackid.h"
 
+#include "util/compressedbitmap.h"
+
 #include "util/db/fwdsqlqueryselectresult.h"
+#include "util/db/sqlquerycache.h"
 #include "util/db/sqlsubselectmode.h"
 #include "util/db/sqlstorage.h"
 
@@ -226,6 +230,20 @@ class CrateStorage: public virtual /*implements*/ SqlStorage {
     bool onPurgingTracks(
             const QList<TrackId>& trackIds);
 
+    void afterDeletingCrate(
+            CrateId crateId);
+
+    void afterAddingCrateTracks(
+            CrateId crateId,
+            const QList<TrackId>& trackIds);
+
+    void afterRemovingCrateTracks(
+            CrateId crateId,
+            const QList<TrackId>& trackIds);
+
+    void afterPurgingTracks(
+            const QList<TrackId>& trackIds);
+
 
     /////////////////////////////////////////////////////////////////////////
     // Crate read operations (read-only, const)
@@ -260,14 +278,22 @@ class CrateStorage: public virtual /*implements*/ SqlStorage {
     CrateSelectResult selectAutoDjCrates(bool autoDjSource = true) const;
 
     // Crate content, i.e. the crate's tracks referenced by id
-    uint countCrateTracks(CrateId crateId) const;
+    uint countCrateTracks(CrateId crateId) const; // no db access
+
+    // The track ids that are contained in any of the given crates from
+    // the in-memory index of all crate tracks. The index is loaded when
+    // connecting to the database and updated by the after...() operations.
+    CompressedBitmap getTrackIdsOfAnyCrate(
+            const QList<CrateId>& crateIds) const; // no db access
+
+    // The ids of all crates with a name that contains crateNameLike
+    QList<CrateId> collectCrateIdsByNameLike(
+            const QString& crateNameLike) const;
 
     // Format a subselect query for the tracks contained in crate.
     static QString formatSubselectQueryForCrateTrackIds(
             CrateId crateId); // no db access
 
-    static QString formatQueryForTrackIdsByCrateNameLike(
-            const QString& crateNameLike); // no db access
     // Select the track ids of a crate or the crate ids of a track respectively.
     // The results are sorted (ascending) by the target id, i.e. the id that is
     // not provided for filtering. This enables the caller to perform efficient
@@ -282,7 +308,7 @@ class CrateStorage: public virtual /*implements*/ SqlStorage {
     // Returns the set of crate ids for crates that contain any of the
     // provided track ids.
     QSet<CrateId> collectCrateIdsOfTracks(
-            const QList<TrackId>& trackIds) const;
+            const QList<TrackId>& trackIds) const; // no db access
 
 
     /////////////////////////////////////////////////////////////////////////
@@ -301,8 +327,14 @@ class CrateStorage: public virtual /*implements*/ SqlStorage {
 
   private:
     void createViews();
+    void loadCrateTracks();
 
     QSqlDatabase m_database;
+    // For the write operations that are repeated for each crate
+    // and track
+    mutable SqlQueryCache m_queryCache;
+
+    QHash<CrateId, CompressedBitmap> m_crateTrackIds;
 };
 
 
@@ -30,10 +30,9 @@ QList<AnalysisDao::AnalysisInfo> AnalysisDao::getAnalysesForTrack(TrackId trackI
         return QList<AnalysisInfo>();
     }
 
-    QSqlQuery query(m_db);
-    query.prepare(QString(
+    QSqlQuery query(m_queryCache.prepare(QString(
         "SELECT id, type, description, version, data_checksum FROM %1 "
-        "WHERE track_id=:trackId").arg(s_analysisTableName));
+        "WHERE track_id=:trackId").arg(s_analysisTableName)));
     query.bindValue(":trackId", trackId.toVariant());
 
     return loadAnalysesFromQuery(trackId, &query);
@@ -45,10 +44,9 @@ QList<AnalysisDao::AnalysisInfo> AnalysisDao::getAnalysesForTrackByType(
         return QList<AnalysisInfo>();
     }
 
-    QSqlQuery query(m_db);
-    query.prepare(QString(
+    QSqlQuery query(m_queryCache.prepare(QString(
         "SELECT id, type, description, version, data_checksum FROM %1 "
-        "WHERE track_id=:trackId AND type=:type").arg(s_analysisTableName));
+        "WHERE track_id=:trackId AND type=:type").arg(s_analysisTableName)));
     query.bindValue(":trackId", trackId.toVariant());
     query.bindValue(":type", type);
 
@@ -60,7 +58,7 @@ QList<AnalysisDao::AnalysisInfo> AnalysisDao::loadAnalysesFromQuery(TrackId trac
     PerformanceTimer time;
     time.start();
 
-    if (!query->exec()) {
+    if (!m_queryCache.exec(query)) {
         LOG_FAILED_QUERY(*query) << "couldn't get analyses for track" << trackId;
         return analyses;
     }
@@ -118,12 +116,11 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
     int checksum = qChecksum(compressedData.constData(),
                              compressedData.length());
 
-    QSqlQuery query(m_db);
     if (info->analysisId == -1) {
-        query.prepare(QString(
+        QSqlQuery query(m_queryCache.prepare(QString(
             "INSERT INTO %1 (track_id, type, description, version, data_checksum) "
             "VALUES (:trackId,:type,:description,:version,:data_checksum)")
-                      .arg(s_analysisTableName));
+                      .arg(s_analysisTableName)));
 
         QByteArray waveformBytes;
         query.bindValue(":trackId", info->trackId.toVariant());
@@ -132,20 +129,20 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
         query.bindValue(":version", info->version);
         query.bindValue(":data_checksum", checksum);
 
-        if (!query.exec()) {
+        if (!m_queryCache.exec(&query)) {
             LOG_FAILED_QUERY(query) << "couldn't save new analysis";
             return false;
         }
         info->analysisId = query.lastInsertId().toInt();
     } else {
-        query.prepare(QString(
+        QSqlQuery query(m_queryCache.prepare(QString(
             "UPDATE %1 SET "
             "track_id = :trackId,"
             "type = :type,"
             "description = :description,"
             "version = :version,"
             "data_checksum = :data_checksum "
-            "WHERE id = :analysisId").arg(s_analysisTableName));
+            "WHERE id = :analysisId").arg(s_analysisTableName)));
 
         query.bindValue(":analysisId", info->analysisId);
         query.bindValue(":trackId", info->trackId.toVariant());
@@ -154,7 +151,7 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
         query.bindValue(":version", info->version);
         query.bindValue(":data_checksum", checksum);
 
-        if (!query.exec()) {
+        if (!m_queryCache.exec(&query)) {
             LOG_FAILED_QUERY(query) << "couldn't update existing analysis";
             return false;
         }
@@ -179,12 +176,11 @@ bool AnalysisDao::deleteAnalysis(const int analysisId) {
     if (analysisId == -1) {
         return false;
     }
-    QSqlQuery query(m_db);
-    query.prepare(QString(
-        "DELETE FROM %1 WHERE id = :id").arg(s_analysisTableName));
+    QSqlQuery query(m_queryCache.prepare(QString(
+        "DELETE FROM %1 WHERE id = :id").arg(s_analysisTableName)));
     query.bindValue(":id", analysisId);
 
-    if (!query.exec()) {
+    if (!m_queryCache.exec(&query)) {
         LOG_FAILED_QUERY(query) << "couldn't delete analysis";
         return false;
     }
@@ -224,12 +220,11 @@ bool AnalysisDao::deleteAnalysesForTrack(TrackId trackId) {
     if (!trackId.isValid()) {
         return false;
     }
-    QSqlQuery query(m_db);
-    query.prepare(QString(
-        "SELECT id FROM %1 where track_id = :track_id").arg(s_analysisTableName));
+    QSqlQuery query(m_queryCache.prepare(QString(
+        "SELECT id FROM %1 where track_id = :track_id").arg(s_analysisTableName)));
     query.bindValue(":track_id", trackId.toVariant());
 
-    if (!query.exec()) {
+    if (!m_queryCache.exec(&query)) {
         LOG_FAILED_QUERY(query) << "couldn't delete analyses for track" << trackId;
         return false;
     }
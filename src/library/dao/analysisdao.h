@@ -7,6 +7,7 @@
 #include "preferences/usersettings.h"
 #include "library/dao/dao.h"
 #include "track/track.h"
+#include "util/db/sqlquerycache.h"
 
 class AnalysisDao : public DAO {
   public:
@@ -46,6 +47,7 @@ class AnalysisDao : public DAO {
 
     void initialize(const QSqlDatabase& database) override {
         m_db = database;
+        m_queryCache.setDatabase(database);
     }
 
     QList<AnalysisInfo> getAnalysesForTrackByType(TrackId trackId, AnalysisType type);
@@ -71,6 +73,7 @@ class AnalysisDao : public DAO {
 
     UserSettingsPointer m_pConfig;
     QSqlDatabase m_db;
+    SqlQueryCache m_queryCache;
 };
 
 #endif // ANALYSISDAO_H
@@ -1,6 +1,8 @@
 #include <QtDebug>
 #include <QtSql>
 
+#include <algorithm>
+
 #include "library/dao/autodjcratesdao.h"
 
 #include "mixer/playerinfo.h"
@@ -12,30 +14,26 @@
 #include "library/queryutil.h"
 #include "library/trackcollection.h"
 
-#define AUTODJCRATESTABLE_TRACKID "track_id"
-#define AUTODJCRATESTABLE_CRATEREFS "craterefs"
-#define AUTODJCRATESTABLE_TIMESPLAYED "timesplayed"
-#define AUTODJCRATESTABLE_AUTODJREFS "autodjrefs"
-#define AUTODJCRATESTABLE_LASTPLAYED "lastplayed"
-
-#define AUTODJCRATES_TABLE "temp_autodj_crates"
-// A table of all tracks that are assigned to the AutoDJ via a crate
-// Columns:
-// INTEGER AUTODJCRATESTABLE_TRACKID -> Tracks that are member of crate assigned to AutoDj
-// INTEGER AUTODJCRATESTABLE_CRATEREFS -> counts the occurrences of track in auto dj crates
-// INTEGER AUTODJCRATESTABLE_TIMESPLAYED -> library played counter
-// INTEGER AUTODJCRATESTABLE_AUTODJREFS -> counts the occurrences of the track in the AutoDj queue
-// DATETIME AUTODJCRATESTABLE_LASTPLAYED -> from the history feature
-
-#define AUTODJACTIVETRACKS_TABLE "temp_autodj_activetracks"
-// The same table like above, but of all tracks that not already queued into Auto DJ
-// ordered by TimesPlayed.
-
 namespace {
 // Percentage of most and least played tracks to ignore [0,50)
 const int kLeastPreferredPercent = 15;
 const int kLeastPreferredPercentMin = 0;
 const int kLeastPreferredPercentMax = 50;
+
+QString formatTrackIdList(const QList<TrackId>& trackIds) {
+    QStringList trackIdStrings;
+    for (const auto& trackId : trackIds) {
+        trackIdStrings.append(trackId.toString());
+    }
+    return trackIdStrings.join(",");
+}
+
+AutoDJTrackSelector::Features getTrackFeatures(const Track& track) {
+    return AutoDJTrackSelector::Features(
+            track.getBpm(),
+            track.getKey(),
+            track.getReplayGain().getRatio());
+}
 } // anonymous namespace
 
 AutoDJCratesDAO::AutoDJCratesDAO(
@@ -46,135 +44,32 @@ AutoDJCratesDAO::AutoDJCratesDAO(
           m_pTrackCollection(pTrackCollection),
           m_database(pTrackCollection->database()),
           m_pConfig(pConfig),
-          // The database has not been created yet.
-          m_bAutoDjCratesDbCreated(false),
-          // By default, active tracks are not tracks that haven't been played in
-          // a while.
-          m_bUseIgnoreTime(false) {
+          // The index has not been created yet.
+          m_bAutoDjCratesIndexCreated(false),
+          m_bTrackSelectorCreated(false),
+          m_randomGenerator(std::random_device()()) {
 }
 
 AutoDJCratesDAO::~AutoDJCratesDAO() {
 }
 
-// Create the temporary auto-DJ-crates table.
+// Create the auto-DJ-crates index.
 // Done the first time it's used, since the user might not even make
 // use of this feature.
-void AutoDJCratesDAO::createAndConnectAutoDjCratesDatabase() {
+void AutoDJCratesDAO::createAndConnectAutoDjCratesIndex() {
     // If the use of tracks that haven't been played in a while has changed,
-    // then the active-tracks view must be recreated.
-    bool bUseIgnoreTime = m_pConfig->getValue(
-            ConfigKey("[Auto DJ]", "UseIgnoreTime"), false);
-    if (m_bAutoDjCratesDbCreated) {
-        if (m_bUseIgnoreTime != bUseIgnoreTime) {
-            // Do all this in a single transaction.
-            ScopedTransaction oTransaction(m_database);
-
-            // Get rid of the old active-tracks view.
-            QSqlQuery oQuery(m_database);
-            oQuery.exec ("DROP VIEW IF EXISTS " AUTODJACTIVETRACKS_TABLE);
-            if (!oQuery.exec()) {
-                LOG_FAILED_QUERY(oQuery);
-                return;
-            }
-
-            // Create the new active-tracks view.
-            if (!createActiveTracksView(bUseIgnoreTime)) {
-                return;
-            }
-
-            // Remember the new setting.
-            m_bUseIgnoreTime = bUseIgnoreTime;
-
-            // Commit these changes.
-            oTransaction.commit();
-        }
-    } else {
-        m_bUseIgnoreTime = bUseIgnoreTime;
-    }
-
-    // If this database has already been created, skip this.
-    if (m_bAutoDjCratesDbCreated) {
-        return;
-    }
-
-    // Do all of this in a single transaction.
-    ScopedTransaction oTransaction(m_database);
-
-    // The auto-DJ-crates table contains the track ID, the number of references
-    // to that track ID in all of the auto-DJ crates, the number of times that
-    // track has been played, and the number of references to the track in the
-    // auto-DJ playlist (or in loaded decks).  It filters out tracks that have
-    // been deleted from the database (i.e. "hidden" tracks).
-
-    // Create an empty table.
-    QSqlQuery oQuery(m_database);
-    // CREATE TEMP TABLE temp_autodj_crates (track_id INTEGER UNIQUE, craterefs INTEGER, timesplayed INTEGER, autodjrefs INTEGER, lastplayed DATETIME);
-    //oQuery.exec ("DROP TABLE IF EXISTS " AUTODJCRATES_TABLE);
-    QString strQuery("CREATE TEMP TABLE " AUTODJCRATES_TABLE
-        " (" AUTODJCRATESTABLE_TRACKID " INTEGER UNIQUE, "
-        AUTODJCRATESTABLE_CRATEREFS " INTEGER, "
-        AUTODJCRATESTABLE_TIMESPLAYED " INTEGER, "
-        AUTODJCRATESTABLE_AUTODJREFS " INTEGER, "
-        AUTODJCRATESTABLE_LASTPLAYED " DATETIME)");
-    oQuery.prepare(strQuery);
-    if (!oQuery.exec()) {
-        LOG_FAILED_QUERY(oQuery);
-        return;
-    }
-
-    // Fill out the first three columns.
-    // Supply default values for the last two.
-    // INSERT INTO temp_autodj_crates (
-    //     track_id, craterefs, timesplayed, autodjrefs, lastplayed)
-    // SELECT crate_tracks.track_id, COUNT (*), library.timesplayed, 0, ""
-    // FROM crate_tracks, library
-    // WHERE crate_tracks.crate_id IN (
-    //     SELECT id
-    //     FROM crates
-    //     WHERE autodj = 1)
-    // AND crate_tracks.track_id = library.id
-    // AND library.mixxx_deleted = 0
-    // GROUP BY crate_tracks.track_id, library.timesplayed;
-    strQuery = QString("INSERT INTO " AUTODJCRATES_TABLE
-            " (" AUTODJCRATESTABLE_TRACKID ", " AUTODJCRATESTABLE_CRATEREFS ", "
-            AUTODJCRATESTABLE_TIMESPLAYED ", " AUTODJCRATESTABLE_AUTODJREFS ", "
-            AUTODJCRATESTABLE_LASTPLAYED ") SELECT " CRATE_TRACKS_TABLE
-            ".%1 , COUNT (*), " LIBRARY_TABLE ".%2, 0, \"\" FROM "
-            CRATE_TRACKS_TABLE ", " LIBRARY_TABLE " WHERE " CRATE_TRACKS_TABLE
-            ".%4 IN (SELECT %5 FROM " CRATE_TABLE " WHERE %6 = 1) AND "
-            CRATE_TRACKS_TABLE ".%1 = " LIBRARY_TABLE ".%7 AND " LIBRARY_TABLE
-            ".%3 == 0 GROUP BY " CRATE_TRACKS_TABLE ".%1, " LIBRARY_TABLE ".%2")
-                .arg(CRATETRACKSTABLE_TRACKID, // %1
-                     LIBRARYTABLE_TIMESPLAYED, // %2
-                     LIBRARYTABLE_MIXXXDELETED, // %3
-                     CRATETRACKSTABLE_CRATEID, // %4
-                     CRATETABLE_ID, // %5
-                     CRATETABLE_AUTODJ_SOURCE, // %6
-                     LIBRARYTABLE_ID); // %7
-    oQuery.prepare(strQuery);
-    if (!oQuery.exec()) {
-        LOG_FAILED_QUERY(oQuery);
-        return;
-    }
-
-    // Fill out the number of auto-DJ-playlist references.
-    if (!updateAutoDjPlaylistReferences()) {
-        return;
-    }
-
-    // Fill out the last-played date/time.
-    if (!updateLastPlayedDateTime()) {
-        return;
-    }
+    // then the active tracks are ordered differently.
+    m_autoDjCratesIndex.setUseIgnoreTime(m_pConfig->getValue(
+            ConfigKey("[Auto DJ]", "UseIgnoreTime"), false));
 
-    // Create the active-tracks view.
-    //oQuery.exec ("DROP VIEW IF EXISTS " AUTODJACTIVETRACKS_TABLE);
-    if (!createActiveTracksView (m_bUseIgnoreTime)) {
+    // If the index has already been created, skip this.
+    if (m_bAutoDjCratesIndexCreated) {
         return;
     }
 
     // Make a list of the IDs of every set-log playlist.
     // SELECT id FROM Playlists WHERE hidden = 2;
+    QSqlQuery oQuery(m_database);
     oQuery.prepare(QString("SELECT %1 FROM " PLAYLIST_TABLE " WHERE %2 = %3")
             .arg(PLAYLISTTABLE_ID, // %1
                  PLAYLISTTABLE_HIDDEN, // %2
@@ -187,15 +82,30 @@ void AutoDJCratesDAO::createAndConnectAutoDjCratesDatabase() {
         return;
     }
 
-    // Now the auto-DJ crates database is initialized.
-    // Externally-driven updates to the database from now on are driven by
+    // Load the tracks of every auto-DJ crate.
+    QList<CrateId> crateIds;
+    {
+        CrateSelectResult autoDjCrates(
+                m_pTrackCollection->crates().selectAutoDjCrates(true));
+        Crate crate;
+        while (autoDjCrates.populateNext(&crate)) {
+            crateIds.append(crate.getId());
+        }
+    }
+    for (const auto& crateId : crateIds) {
+        updateAutoDjCrate(crateId);
+    }
+
+    // Now the auto-DJ-crates index is initialized.
+    // Externally-driven updates to the index from now on are driven by
     // signals.
-    oTransaction.commit();
+    m_bAutoDjCratesIndexCreated = true;
 
     // Be notified when a track is modified.
     // We only care when the number of times it's been played changes.
+    // The track selector shares this connection.
     connect(&m_pTrackCollection->getTrackDAO(), SIGNAL(trackDirty(TrackId)),
-            this, SLOT(slotTrackDirty(TrackId)));
+            this, SLOT(slotTrackDirty(TrackId)), Qt::UniqueConnection);
 
     // Be notified when the status of crates changes.
     connect(m_pTrackCollection, SIGNAL(crateInserted(CrateId)),
@@ -229,307 +139,230 @@ void AutoDJCratesDAO::createAndConnectAutoDjCratesDatabase() {
     connect(&PlayerInfo::instance(),
             SIGNAL(trackUnloaded(QString,TrackPointer)),
             this, SLOT(slotPlayerInfoTrackUnloaded(QString,TrackPointer)));
+}
+
+// Create the track selector.
+// Done the first time it's used, since the user might not even make
+// use of this feature.
+void AutoDJCratesDAO::createAndConnectTrackSelector() {
+    if (m_bTrackSelectorCreated) {
+        return;
+    }
+    if (!loadTrackSelectorFeatures(QString())) {
+        m_trackSelector.clear();
+        return;
+    }
+    m_bTrackSelectorCreated = true;
+
+    // Be notified when the features of a track change. Changes that are
+    // made while a track is dirty only arrive when it is clean again.
+    connect(&m_pTrackCollection->getTrackDAO(), SIGNAL(trackDirty(TrackId)),
+            this, SLOT(slotTrackDirty(TrackId)), Qt::UniqueConnection);
+    connect(&m_pTrackCollection->getTrackDAO(), SIGNAL(trackClean(TrackId)),
+            this, SLOT(slotTrackDirty(TrackId)));
 
-    // Remember that the auto-DJ-crates database has been created.
-    m_bAutoDjCratesDbCreated = true;
+    // Be notified when tracks are added to or removed from the library.
+    connect(&m_pTrackCollection->getTrackDAO(), SIGNAL(tracksAdded(QSet<TrackId>)),
+            this, SLOT(slotTracksAdded(QSet<TrackId>)));
+    connect(&m_pTrackCollection->getTrackDAO(), SIGNAL(tracksRemoved(QSet<TrackId>)),
+            this, SLOT(slotTracksRemoved(QSet<TrackId>)));
 }
 
-// Create the active-tracks view.
-bool AutoDJCratesDAO::createActiveTracksView (bool a_bUseIgnoreTime) {
-    // Create the active-tracks view.  This is a list of all tracks loaded into
-    // the auto-DJ-crates database, excluding all tracks already in the auto-DJ
-    // playlist, sorted by the number of times the track has been played, and
-    // limited by either the active percentage or by the number of tracks that
-    // have never been played, whichever is larger.
-    //
-    // At one point, I hoped that I could create this table in a single SQL
-    // statement, with a "limit" clause that dynamically updated the size of the
-    // view as the state of the system changed.  Unfortunately, that limit
-    // clause is only evaluated once.  For posterity, though, here's the monster
-    // SQL query that attempted to create that version:
-    //
-    // CREATE TEMP VIEW temp_autodj_activetracks AS
-    //     SELECT * FROM temp_autodj_crates
-    //     WHERE autodjrefs = 0
-    //     ORDER BY timesplayed, lastplayed LIMIT (
-    //         SELECT MAX(count)
-    //         FROM (
-    //             SELECT COUNT(*) AS count
-    //             FROM temp_autodj_crates WHERE timesplayed = 0
-    //             UNION ALL SELECT (
-    //                 count * (
-    //                     SELECT value
-    //                     FROM settings WHERE
-    //                     name="mixxx.db.model.autodjcrates.active_percentage")
-    //                 / 100) AS count
-    //                 FROM (
-    //                     SELECT COUNT(*) AS count
-    //                     FROM temp_autodj_crates)));
-
-    // CREATE TEMP VIEW temp_autodj_activetracks AS
-    // SELECT *
-    // FROM temp_autodj_crates
-    // WHERE autodjrefs = 0
-    // ORDER BY timesplayed, lastplayed;
+// Load the features of the library tracks into the track selector.
+bool AutoDJCratesDAO::loadTrackSelectorFeatures(const QString& trackIdSubselect) {
+    // Hidden tracks and missing files are left out, like when picking a
+    // random track from the library.
+    // SELECT id, bpm, key_id, replaygain FROM library
+    // WHERE mixxx_deleted = 0 AND location NOT IN
+    // (SELECT id FROM track_locations WHERE fs_deleted = 1)
+    // [AND id IN (...)];
+    QString queryString = QString("SELECT %1, %2, %3, %4 FROM " LIBRARY_TABLE
+            " WHERE %5 = 0 AND %6 NOT IN"
+            " (SELECT %7 FROM track_locations WHERE %8 = 1)")
+            .arg(LIBRARYTABLE_ID, // %1
+                 LIBRARYTABLE_BPM, // %2
+                 LIBRARYTABLE_KEY_ID, // %3
+                 LIBRARYTABLE_REPLAYGAIN, // %4
+                 LIBRARYTABLE_MIXXXDELETED, // %5
+                 LIBRARYTABLE_LOCATION, // %6
+                 TRACKLOCATIONSTABLE_ID, // %7
+                 TRACKLOCATIONSTABLE_FSDELETED); // %8
+    if (!trackIdSubselect.isEmpty()) {
+        queryString += QString(" AND %1 IN (%2)").arg(
+                LIBRARYTABLE_ID, trackIdSubselect);
+    }
     QSqlQuery oQuery(m_database);
-    QString strTimesPlayed;
-    if (!a_bUseIgnoreTime) {
-        strTimesPlayed = AUTODJCRATESTABLE_TIMESPLAYED ", ";
-    }
-    oQuery.prepare(QString("CREATE TEMP VIEW " AUTODJACTIVETRACKS_TABLE
-            " AS SELECT * FROM " AUTODJCRATES_TABLE " WHERE "
-            AUTODJCRATESTABLE_AUTODJREFS " = 0 ORDER BY %1"
-            AUTODJCRATESTABLE_LASTPLAYED)
-            .arg(strTimesPlayed)); // %1
+    oQuery.setForwardOnly(true);
+    oQuery.prepare(queryString);
     if (!oQuery.exec()) {
         LOG_FAILED_QUERY(oQuery);
         return false;
     }
+    while (oQuery.next()) {
+        const int keyId = oQuery.value(2).toInt();
+        const auto key = mixxx::track::io::key::ChromaticKey_IsValid(keyId) ?
+                static_cast<mixxx::track::io::key::ChromaticKey>(keyId) :
+                mixxx::track::io::key::INVALID;
+        m_trackSelector.setTrack(TrackId(oQuery.value(0)),
+                AutoDJTrackSelector::Features(
+                        oQuery.value(1).toDouble(),
+                        key,
+                        oQuery.value(3).toDouble()));
+    }
     return true;
 }
 
-// Update the number of auto-DJ-playlist references to each track in the
-// auto-DJ-crates database.
-bool AutoDJCratesDAO::updateAutoDjPlaylistReferences() {
+// Add the given tracks of an auto-DJ crate to the index.
+void AutoDJCratesDAO::addAutoDjCrateTracks(CrateId crateId,
+                                           const QList<TrackId>& trackIds,
+                                           const QString& trackIdSubselect) {
+    QSet<TrackId>& crateTrackIds = m_autoDjCrateTrackIds[crateId];
+    QSet<TrackId> newTrackIds;
+    for (const auto& trackId : trackIds) {
+        if (crateTrackIds.contains(trackId)) {
+            continue;
+        }
+        crateTrackIds.insert(trackId);
+        if (m_autoDjCratesIndex.contains(trackId)) {
+            m_autoDjCratesIndex.addCrateReference(trackId);
+        } else {
+            newTrackIds.insert(trackId);
+        }
+    }
+    if (newTrackIds.isEmpty()) {
+        return;
+    }
+
+    // Load the tracks that weren't in the index already. Hidden tracks are
+    // left out.
+    // SELECT id, timesplayed FROM library
+    // WHERE id IN (...) AND mixxx_deleted = 0;
     QSqlQuery oQuery(m_database);
+    oQuery.prepare(QString("SELECT %1, %2 FROM " LIBRARY_TABLE
+            " WHERE %1 IN (%3) AND %4 = 0")
+            .arg(LIBRARYTABLE_ID, // %1
+                 LIBRARYTABLE_TIMESPLAYED, // %2
+                 trackIdSubselect, // %3
+                 LIBRARYTABLE_MIXXXDELETED)); // %4
+    if (!oQuery.exec()) {
+        LOG_FAILED_QUERY(oQuery);
+        return;
+    }
+    QSet<TrackId> loadedTrackIds;
+    while (oQuery.next()) {
+        TrackId trackId(oQuery.value(0));
+        if (newTrackIds.contains(trackId)) {
+            m_autoDjCratesIndex.addTrack(trackId, oQuery.value(1).toInt());
+            loadedTrackIds.insert(trackId);
+        }
+    }
+    if (loadedTrackIds.isEmpty()) {
+        return;
+    }
 
-    // Rebuild the auto-DJ-playlist reference count.
-    // INSERT OR REPLACE INTO temp_autodj_crates (
-    //     track_id, craterefs, timesplayed, autodjrefs)
-    // SELECT *
-    // FROM (
-    //     SELECT PlaylistTracks.track_id, craterefs, timesplayed, COUNT (*) AS newautodjrefs
-    //     FROM PlaylistTracks, temp_autodj_crates
-    //     WHERE PlaylistTracks.playlist_id IN (
-    //         SELECT id FROM Playlists WHERE hidden = PLHT_AUTO_DJ)
-    //     AND PlaylistTracks.track_id = temp_autodj_crates.track_id
-    //     GROUP BY PlaylistTracks.track_id)
-    // WHERE newautodjrefs > 0;
-    QString strHidden;
-    strHidden.setNum(PlaylistDAO::PLHT_AUTO_DJ);
-    QString strQuery(QString ("INSERT OR REPLACE INTO " AUTODJCRATES_TABLE
-            " (" AUTODJCRATESTABLE_TRACKID ", " AUTODJCRATESTABLE_CRATEREFS ", "
-            AUTODJCRATESTABLE_TIMESPLAYED ", " AUTODJCRATESTABLE_AUTODJREFS ")"
-            " SELECT * FROM (SELECT " PLAYLIST_TRACKS_TABLE ".%1, "
-            AUTODJCRATESTABLE_CRATEREFS ", " AUTODJCRATESTABLE_TIMESPLAYED
-            ", COUNT (*) AS new" AUTODJCRATESTABLE_AUTODJREFS " FROM "
-            PLAYLIST_TRACKS_TABLE ", " AUTODJCRATES_TABLE " WHERE "
-            PLAYLIST_TRACKS_TABLE ".%2 IN (SELECT %3 FROM " PLAYLIST_TABLE
-            " WHERE %4 = %5) AND " PLAYLIST_TRACKS_TABLE ".%1 = "
-            AUTODJCRATES_TABLE "." AUTODJCRATESTABLE_TRACKID " GROUP BY "
-            PLAYLIST_TRACKS_TABLE ".%1) WHERE new" AUTODJCRATESTABLE_AUTODJREFS
-            " > 0")
+    // Count the references to the loaded tracks in the auto-DJ playlist.
+    // SELECT track_id FROM PlaylistTracks
+    // WHERE playlist_id IN (SELECT id FROM Playlists WHERE hidden = 1)
+    // AND track_id IN (...);
+    oQuery.prepare(QString("SELECT %1 FROM " PLAYLIST_TRACKS_TABLE
+            " WHERE %2 IN (SELECT %3 FROM " PLAYLIST_TABLE " WHERE %4 = %5)"
+            " AND %1 IN (%6)")
             .arg(PLAYLISTTRACKSTABLE_TRACKID, // %1
                  PLAYLISTTRACKSTABLE_PLAYLISTID, // %2
                  PLAYLISTTABLE_ID, // %3
                  PLAYLISTTABLE_HIDDEN, // %4
-                 strHidden)); // %5
-    oQuery.prepare(strQuery);
+                 QString::number(PlaylistDAO::PLHT_AUTO_DJ), // %5
+                 trackIdSubselect)); // %6
     if (!oQuery.exec()) {
         LOG_FAILED_QUERY(oQuery);
-        return false;
+        return;
+    }
+    while (oQuery.next()) {
+        TrackId trackId(oQuery.value(0));
+        if (loadedTrackIds.contains(trackId)) {
+            m_autoDjCratesIndex.addAutoDjReference(trackId);
+        }
     }
 
     // Incorporate all tracks loaded into decks.
-    // Each track has to be done as a separate database query, in case the same
-    // track is loaded into multiple decks.
     int iDecks = (int) PlayerManager::numDecks();
     for (int i = 0; i < iDecks; ++i) {
         QString group = PlayerManager::groupForDeck(i);
         TrackPointer pTrack = PlayerInfo::instance().getTrackInfo(group);
-        if (pTrack) {
-            TrackId trackId(pTrack->getId());
-            // UPDATE temp_autodj_crates SET autodjrefs = autodjrefs + 1 WHERE track_id IN (:track_id);
-            oQuery.prepare("UPDATE " AUTODJCRATES_TABLE " SET "
-                    AUTODJCRATESTABLE_AUTODJREFS " = " AUTODJCRATESTABLE_AUTODJREFS
-                    " + 1 WHERE " AUTODJCRATESTABLE_TRACKID " IN (:track_id)");
-            oQuery.bindValue(":track_id", trackId.toVariant());
-            if (!oQuery.exec()) {
-                LOG_FAILED_QUERY(oQuery);
-                return false;
-            }
+        if (pTrack && loadedTrackIds.contains(pTrack->getId())) {
+            m_autoDjCratesIndex.addAutoDjReference(pTrack->getId());
         }
     }
-    return true;
-}
-
-// Update the number of auto-DJ-playlist references to the given track in the
-// auto-DJ-crates database.
-bool AutoDJCratesDAO::updateAutoDjPlaylistReferencesForTrack(TrackId trackId) {
-    QSqlQuery oQuery(m_database);
-
-    // INSERT OR REPLACE INTO temp_autodj_crates (
-    //     track_id, craterefs, timesplayed, autodjrefs)
-    // SELECT *
-    // FROM (
-    //     SELECT :track_id AS new_track_id, craterefs, timesplayed, COUNT (*) AS newautodjrefs
-    //     FROM PlaylistTracks, temp_autodj_crates
-    //     WHERE PlaylistTracks.playlist_id IN (
-    //         SELECT id
-    //         FROM Playlists
-    //         WHERE hidden = 1)
-    //     AND PlaylistTracks.track_id = :track_id
-    //     AND temp_autodj_crates.track_id = :track_id
-    //     GROUP BY new_track_id)
-    // WHERE newautodjrefs > 0;
-    QString strHidden;
-    strHidden.setNum(PlaylistDAO::PLHT_AUTO_DJ);
-    oQuery.prepare(QString("INSERT OR REPLACE INTO " AUTODJCRATES_TABLE " ("
-            AUTODJCRATESTABLE_TRACKID ", " AUTODJCRATESTABLE_CRATEREFS ", "
-            AUTODJCRATESTABLE_TIMESPLAYED ", " AUTODJCRATESTABLE_AUTODJREFS
-            ") SELECT * FROM (SELECT :track_id_1 AS new_track_id, "
-            AUTODJCRATESTABLE_CRATEREFS ", " AUTODJCRATESTABLE_TIMESPLAYED
-            ", COUNT (*) AS new" AUTODJCRATESTABLE_AUTODJREFS " FROM "
-            PLAYLIST_TRACKS_TABLE ", " AUTODJCRATES_TABLE " WHERE "
-            PLAYLIST_TRACKS_TABLE ".%1 IN (SELECT %4 FROM " PLAYLIST_TABLE
-            " WHERE %2 = %5) AND " PLAYLIST_TRACKS_TABLE ".%3 = :track_id_2 AND "
-            AUTODJCRATES_TABLE "." AUTODJCRATESTABLE_TRACKID
-            " = :track_id_3 GROUP BY new_track_id) WHERE new"
-            AUTODJCRATESTABLE_AUTODJREFS " > 0")
-            .arg(PLAYLISTTRACKSTABLE_PLAYLISTID, // %1
-                 PLAYLISTTABLE_HIDDEN, // %2
-                 PLAYLISTTRACKSTABLE_TRACKID, // %3
-                 PLAYLISTTABLE_ID, // %4
-                 strHidden)); // %5
-    oQuery.bindValue(":track_id_1", trackId.toVariant());
-    oQuery.bindValue(":track_id_2", trackId.toVariant());
-    oQuery.bindValue(":track_id_3", trackId.toVariant());
-    if (!oQuery.exec()) {
-        LOG_FAILED_QUERY(oQuery);
-        return false;
-    }
 
-    // The update was successful.
-    return true;
+    // Fill out the last-played date/time of the loaded tracks.
+    updateLastPlayedDateTime(trackIdSubselect, loadedTrackIds);
 }
 
-// Update the last-played date/time for each track in the auto-DJ-crates
-// database.
-bool AutoDJCratesDAO::updateLastPlayedDateTime() {
+// Update the last-played date/time of the given tracks from the set-log
+// playlists. trackIdSubselect selects (at least) the given tracks.
+bool AutoDJCratesDAO::updateLastPlayedDateTime(const QString& trackIdSubselect,
+                                               const QSet<TrackId>& trackIds) {
+    // SELECT track_id, MAX(pl_datetime_added) FROM PlaylistTracks
+    // WHERE playlist_id IN (SELECT id FROM Playlists WHERE hidden = PLHT_SET_LOG)
+    // AND track_id IN (...)
+    // GROUP BY track_id;
     QSqlQuery oQuery(m_database);
-
-    // Rebuild the auto-DJ-playlist last-played date/time.
-    // INSERT OR REPLACE INTO temp_autodj_crates (
-    //     track_id, craterefs, timesplayed, autodjrefs, lastplayed)
-    // SELECT *
-    // FROM (
-    //     SELECT PlaylistTracks.track_id, craterefs, timesplayed, autodjrefs, MAX(pl_datetime_added) AS newlastplayed
-    //     FROM PlaylistTracks, temp_autodj_crates
-    //     WHERE PlaylistTracks.playlist_id IN (
-    //         SELECT id FROM Playlists WHERE hidden = PLHT_SET_LOG)
-    //     AND PlaylistTracks.track_id = temp_autodj_crates.track_id
-    //     GROUP BY PlaylistTracks.track_id)
-    // WHERE newlastplayed != "";
-    QString strSetLog;
-    strSetLog.setNum(PlaylistDAO::PLHT_SET_LOG);
-    QString strQuery(QString ("INSERT OR REPLACE INTO " AUTODJCRATES_TABLE
-            " (" AUTODJCRATESTABLE_TRACKID ", " AUTODJCRATESTABLE_CRATEREFS ", "
-            AUTODJCRATESTABLE_TIMESPLAYED ", " AUTODJCRATESTABLE_AUTODJREFS ", "
-            AUTODJCRATESTABLE_LASTPLAYED ")"
-            " SELECT * FROM (SELECT " PLAYLIST_TRACKS_TABLE ".%1, "
-            AUTODJCRATESTABLE_CRATEREFS ", " AUTODJCRATESTABLE_TIMESPLAYED ", "
-            AUTODJCRATESTABLE_AUTODJREFS ", MAX(%3) AS new"
-            AUTODJCRATESTABLE_LASTPLAYED " FROM " PLAYLIST_TRACKS_TABLE ", "
-            AUTODJCRATES_TABLE " WHERE " PLAYLIST_TRACKS_TABLE
-            ".%2 IN (SELECT %4 FROM " PLAYLIST_TABLE " WHERE %5 = %6) AND "
-            PLAYLIST_TRACKS_TABLE ".%1 = " AUTODJCRATES_TABLE "."
-            AUTODJCRATESTABLE_TRACKID " GROUP BY " PLAYLIST_TRACKS_TABLE
-            ".%1) WHERE new" AUTODJCRATESTABLE_LASTPLAYED " != \"\"")
+    oQuery.prepare(QString("SELECT %1, MAX(%3) FROM " PLAYLIST_TRACKS_TABLE
+            " WHERE %2 IN (SELECT %4 FROM " PLAYLIST_TABLE " WHERE %5 = %6)"
+            " AND %1 IN (%7) GROUP BY %1")
             .arg(PLAYLISTTRACKSTABLE_TRACKID, // %1
                  PLAYLISTTRACKSTABLE_PLAYLISTID, // %2
                  PLAYLISTTRACKSTABLE_DATETIMEADDED, // %3
                  PLAYLISTTABLE_ID, // %4
                  PLAYLISTTABLE_HIDDEN, // %5
-                 strSetLog)); // %6
-    oQuery.prepare(strQuery);
+                 QString::number(PlaylistDAO::PLHT_SET_LOG), // %6
+                 trackIdSubselect)); // %7
     if (!oQuery.exec()) {
         LOG_FAILED_QUERY(oQuery);
         return false;
     }
+    QHash<TrackId, QString> lastPlayed;
+    while (oQuery.next()) {
+        lastPlayed.insert(TrackId(oQuery.value(0)), oQuery.value(1).toString());
+    }
 
+    // Tracks that are in no set-log playlist (any more) have never been
+    // played.
+    for (const auto& trackId : trackIds) {
+        m_autoDjCratesIndex.setLastPlayed(trackId, lastPlayed.value(trackId));
+    }
     return true;
 }
 
-// Update the last-played date/time for the given track in the auto-DJ-crates
-// database.
-bool AutoDJCratesDAO::updateLastPlayedDateTimeForTrack(TrackId trackId) {
-    QSqlQuery oQuery(m_database);
-
-    // Update the last-played date/time for this track.
-    // INSERT OR REPLACE INTO temp_autodj_crates (
-    //     track_id, craterefs, timesplayed, autodjrefs, lastplayed)
-    // SELECT *
-    // FROM (
-    //     SELECT PlaylistTracks.track_id, craterefs, timesplayed, autodjrefs, MAX(pl_datetime_added) AS newlastplayed
-    //     FROM PlaylistTracks, temp_autodj_crates
-    //     WHERE PlaylistTracks.playlist_id IN (
-    //         SELECT id FROM Playlists WHERE hidden = PLHT_SET_LOG)
-    //     AND PlaylistTracks.track_id = :track_id
-    //     AND PlaylistTracks.track_id = temp_autodj_crates.track_id
-    //     GROUP BY PlaylistTracks.track_id)
-    // WHERE newlastplayed != "";
-    QString strSetLog;
-    strSetLog.setNum(PlaylistDAO::PLHT_SET_LOG);
-    oQuery.prepare(QString ("INSERT OR REPLACE INTO " AUTODJCRATES_TABLE
-            " (" AUTODJCRATESTABLE_TRACKID ", " AUTODJCRATESTABLE_CRATEREFS ", "
-            AUTODJCRATESTABLE_TIMESPLAYED ", " AUTODJCRATESTABLE_AUTODJREFS ", "
-            AUTODJCRATESTABLE_LASTPLAYED ")"
-            " SELECT * FROM (SELECT " PLAYLIST_TRACKS_TABLE ".%1, "
-            AUTODJCRATESTABLE_CRATEREFS ", " AUTODJCRATESTABLE_TIMESPLAYED ", "
-            AUTODJCRATESTABLE_AUTODJREFS ", MAX(%3) AS new"
-            AUTODJCRATESTABLE_LASTPLAYED " FROM " PLAYLIST_TRACKS_TABLE ", "
-            AUTODJCRATES_TABLE " WHERE " PLAYLIST_TRACKS_TABLE
-            ".%2 IN (SELECT %4 FROM " PLAYLIST_TABLE " WHERE %5 = %6) AND "
-            PLAYLIST_TRACKS_TABLE ".%1 = :track_id AND " PLAYLIST_TRACKS_TABLE
-            ".%1 = " AUTODJCRATES_TABLE "." AUTODJCRATESTABLE_TRACKID
-            " GROUP BY " PLAYLIST_TRACKS_TABLE ".%1) WHERE new"
-            AUTODJCRATESTABLE_LASTPLAYED " != \"\"")
-            .arg(PLAYLISTTRACKSTABLE_TRACKID, // %1
-                 PLAYLISTTRACKSTABLE_PLAYLISTID, // %2
-                 PLAYLISTTRACKSTABLE_DATETIMEADDED, // %3
-                 PLAYLISTTABLE_ID, // %4
-                 PLAYLISTTABLE_HIDDEN, // %5
-                 strSetLog)); // %6
-    oQuery.bindValue(":track_id", trackId.toVariant());
-    if (!oQuery.exec()) {
-        LOG_FAILED_QUERY(oQuery);
-        return false;
+// Update the last-played date/time for each track in the index.
+bool AutoDJCratesDAO::updateLastPlayedDateTime() {
+    const QList<TrackId> trackIds = m_autoDjCratesIndex.trackIds();
+    if (trackIds.isEmpty()) {
+        return true;
     }
+    return updateLastPlayedDateTime(formatTrackIdList(trackIds),
+                                    QSet<TrackId>::fromList(trackIds));
+}
 
-    // The update was successful.
-    return true;
+// Update the last-played date/time for the given track in the index.
+bool AutoDJCratesDAO::updateLastPlayedDateTimeForTrack(TrackId trackId) {
+    if (!m_autoDjCratesIndex.contains(trackId)) {
+        return true;
+    }
+    return updateLastPlayedDateTime(trackId.toString(),
+                                    QSet<TrackId>() << trackId);
 }
 
 // Get the ID, i.e. one that references library.id, of a random track.
 // Returns an invalid track id if there was an error.
 TrackId AutoDJCratesDAO::getRandomTrackId() {
-    // If necessary, create the temporary auto-DJ-crates database.
-    createAndConnectAutoDjCratesDatabase();
+    // If necessary, create the auto-DJ-crates index.
+    createAndConnectAutoDjCratesIndex();
 
-    // Calculate the number of active-tracks that have never been played, and
-    // the total number of active-tracks.
-    QSqlQuery oQuery(m_database);
-    // SELECT COUNT(*) AS count
-    // FROM temp_autodj_activetracks
-    // WHERE timesplayed = 0
-    // UNION ALL SELECT COUNT(*) AS count
-    // FROM temp_autodj_activetracks;
-    oQuery.prepare("SELECT COUNT(*) AS count FROM " AUTODJACTIVETRACKS_TABLE
-        " WHERE " AUTODJCRATESTABLE_TIMESPLAYED
-        " = 0 UNION ALL SELECT COUNT(*) AS count FROM "
-        AUTODJACTIVETRACKS_TABLE);
-    VERIFY_OR_DEBUG_ASSERT(oQuery.exec()) {
-        LOG_FAILED_QUERY(oQuery);
-        return TrackId();
-    }
-    int iUnplayedTracks = 0;
-    int iTotalTracks = 0;
-    if (oQuery.next()) {
-        iUnplayedTracks = oQuery.value(0).toInt();
-        if (oQuery.next()) {
-            iTotalTracks = oQuery.value(0).toInt();
-        }
-    }
+    // The number of active-tracks that have never been played, and the total
+    // number of active-tracks.
+    int iUnplayedTracks = m_autoDjCratesIndex.unplayedActiveTrackCount();
+    int iTotalTracks = m_autoDjCratesIndex.activeTrackCount();
 
     // Get the active percentage (default 20%).
     int minimumAvailablePercentage = m_pConfig->getValue(
@@ -554,7 +387,7 @@ TrackId AutoDJCratesDAO::getRandomTrackId() {
 
     // The number of active-tracks might also be tracks that haven't been played
     // in a while.
-    if (m_bUseIgnoreTime) {
+    if (m_autoDjCratesIndex.useIgnoreTime()) {
         // Get the current time, in UTC (since that's what sqlite uses).
         QDateTime timeCurrent = QDateTime::currentDateTime().toUTC();
 
@@ -569,19 +402,8 @@ TrackId AutoDJCratesDAO::getRandomTrackId() {
         QString strDateTime = timeCurrent.toString("yyyy-MM-dd hh:mm:ss");
 
         // Count the number of tracks that haven't been played since this time.
-        // SELECT COUNT(*) FROM temp_autodj_activetracks WHERE lastplayed < :lastplayed;
-        int iIgnoreTimeTracks = 0;
-        oQuery.prepare("SELECT COUNT(*) FROM " AUTODJACTIVETRACKS_TABLE
-            " WHERE " AUTODJCRATESTABLE_LASTPLAYED " < :lastplayed");
-        oQuery.bindValue (":lastplayed", strDateTime);
-        if (oQuery.exec()) {
-            if (oQuery.next()) {
-                iIgnoreTimeTracks = oQuery.value(0).toInt();
-            }
-        } else {
-            LOG_FAILED_QUERY(oQuery);
-            return TrackId();
-        }
+        int iIgnoreTimeTracks =
+                m_autoDjCratesIndex.activeTrackCountPlayedBefore(strDateTime);
 
         // Allow that to be a new maximum.
         iActiveTracks = qMax(iActiveTracks, iIgnoreTimeTracks);
@@ -595,50 +417,104 @@ TrackId AutoDJCratesDAO::getRandomTrackId() {
         return TrackId();
     }
 
-    // Pick a random track.
-    // SELECT track_id
-    // FROM temp_autodj_activetracks LIMIT 1 OFFSET ABS (RANDOM() % :active);
-    oQuery.prepare("SELECT " AUTODJCRATESTABLE_TRACKID " FROM "
-        AUTODJACTIVETRACKS_TABLE " LIMIT 1 OFFSET ABS (RANDOM() % :active)");
-    oQuery.bindValue (":active", iActiveTracks);
-    VERIFY_OR_DEBUG_ASSERT(oQuery.exec()) {
+    // Pick a random track among the preferred ones.
+    return m_autoDjCratesIndex.activeTrack(randomIndex(iActiveTracks));
+}
+
+// Get the ID of a track that mixes well with the track that is played
+// before it. Returns an invalid track id if there is no such track.
+TrackId AutoDJCratesDAO::getMatchingTrackId(bool bFromCrates) {
+    if (bFromCrates) {
+        createAndConnectAutoDjCratesIndex();
+    }
+    createAndConnectTrackSelector();
+
+    // The new track follows the last track of the auto-DJ playlist.
+    // SELECT track_id FROM PlaylistTracks
+    // WHERE playlist_id = m_iAutoDjPlaylistId
+    // ORDER BY position DESC LIMIT 1;
+    QSqlQuery oQuery(m_database);
+    oQuery.prepare(QString("SELECT %1 FROM " PLAYLIST_TRACKS_TABLE
+            " WHERE %2 = :playlist_id ORDER BY %3 DESC LIMIT 1")
+            .arg(PLAYLISTTRACKSTABLE_TRACKID, // %1
+                 PLAYLISTTRACKSTABLE_PLAYLISTID, // %2
+                 PLAYLISTTRACKSTABLE_POSITION)); // %3
+    oQuery.bindValue(":playlist_id", m_iAutoDjPlaylistId);
+    if (!oQuery.exec()) {
         LOG_FAILED_QUERY(oQuery);
         return TrackId();
     }
+    AutoDJTrackSelector::Features reference;
     if (oQuery.next()) {
-        // Give our caller the randomly-selected track.
-        return TrackId(oQuery.value(0));
+        reference = m_trackSelector.getFeatures(TrackId(oQuery.value(0)));
     } else {
-        DEBUG_ASSERT(false); // We should have exit earlier
-        qDebug() << "No random track available for Auto DJ";
+        // If the queue is empty, it follows the playing track.
+        TrackPointer pTrack = PlayerInfo::instance().getCurrentPlayingTrack();
+        if (!pTrack) {
+            qDebug() << "No track to match for Auto DJ";
+            return TrackId();
+        }
+        reference = getTrackFeatures(*pTrack);
+    }
+    if (reference.bpm <= 0.0 &&
+            reference.key == mixxx::track::io::key::INVALID &&
+            !mixxx::ReplayGain::isValidRatio(reference.replayGainRatio)) {
+        qDebug() << "No features to match for Auto DJ";
         return TrackId();
     }
+
+    TrackId matchingTrackId;
+    if (bFromCrates) {
+        // Only active tracks, i.e. neither queued nor loaded into a deck.
+        matchingTrackId = m_trackSelector.selectTrack(reference,
+                [this](TrackId trackId) {
+                    return m_autoDjCratesIndex.isActive(trackId);
+                });
+    } else {
+        // Skip the tracks of the auto-DJ playlist and the decks.
+        QSet<TrackId> excludedTrackIds;
+        oQuery.prepare(QString("SELECT %1 FROM " PLAYLIST_TRACKS_TABLE
+                " WHERE %2 = :playlist_id")
+                .arg(PLAYLISTTRACKSTABLE_TRACKID, // %1
+                     PLAYLISTTRACKSTABLE_PLAYLISTID)); // %2
+        oQuery.bindValue(":playlist_id", m_iAutoDjPlaylistId);
+        if (!oQuery.exec()) {
+            LOG_FAILED_QUERY(oQuery);
+            return TrackId();
+        }
+        while (oQuery.next()) {
+            excludedTrackIds.insert(TrackId(oQuery.value(0)));
+        }
+        int iDecks = (int) PlayerManager::numDecks();
+        for (int i = 0; i < iDecks; ++i) {
+            QString group = PlayerManager::groupForDeck(i);
+            TrackPointer pTrack = PlayerInfo::instance().getTrackInfo(group);
+            if (pTrack) {
+                excludedTrackIds.insert(pTrack->getId());
+            }
+        }
+        matchingTrackId = m_trackSelector.selectTrack(reference,
+                [&excludedTrackIds](TrackId trackId) {
+                    return !excludedTrackIds.contains(trackId);
+                });
+    }
+    if (!matchingTrackId.isValid()) {
+        qDebug() << "No matching track available for Auto DJ";
+    }
+    return matchingTrackId;
 }
 
 TrackId AutoDJCratesDAO::getRandomTrackIdFromAutoDj(int percentActive) {
     // This function is called when all crate tracks are already in AutoDJ.
     // So now the percentage applies to the AutoDJ tracks as well.
-    if (percentActive == 0 || m_bUseIgnoreTime) {
+    if (percentActive == 0 || m_autoDjCratesIndex.useIgnoreTime()) {
         qDebug() << "All crate Tracks already added to Auto DJ";
         return TrackId();
     }
 
-    // Calculate the number of tracks in the AutoDJ playlist
-    // that are already queued up from the crates
-    QSqlQuery oQuery(m_database);
-    // SELECT COUNT(*) AS count
-    // FROM temp_autodj_crates
-    // WHERE autodjrefs > 0;
-    oQuery.prepare("SELECT COUNT(*) AS count FROM " AUTODJCRATES_TABLE
-        " WHERE " AUTODJCRATESTABLE_AUTODJREFS " > 0" );
-    VERIFY_OR_DEBUG_ASSERT(oQuery.exec()) {
-        LOG_FAILED_QUERY(oQuery);
-        return TrackId();
-    }
-    VERIFY_OR_DEBUG_ASSERT(oQuery.next()) {
-        return TrackId();
-    }
-    int queuedTracks = oQuery.value(0).toInt();
+    // The number of tracks in the AutoDJ playlist that are already queued
+    // up from the crates
+    int queuedTracks = m_autoDjCratesIndex.queuedTrackCount();
 
     // If there are no tracks, let our caller know.
     if (queuedTracks == 0) {
@@ -649,72 +525,94 @@ TrackId AutoDJCratesDAO::getRandomTrackIdFromAutoDj(int percentActive) {
     // Use the top percentage of the AutoDJ to re-add
     int iActiveTracks = qMax((queuedTracks * percentActive / 100), 1);
 
-    // Pick a random track.
-    // SELECT DISTINCT track_id
-    // FROM temp_autodj_crates INNER JOIN Playlists
-    // ON temp_autodj_crates.track_id = PlaylistsTracks.track_id
-    // AND PlaylistsTracks.playlist_id = m_iAutoDjPlaylistId
-    // ORDER BY temp_autodj_crates.autodjrefs, PlaylistsTracks.position
-    // LIMIT 1 OFFSET ABS (RANDOM() % :active);
-    oQuery.prepare(QString("SELECT DISTINCT " AUTODJCRATES_TABLE "."
-            AUTODJCRATESTABLE_TRACKID " FROM "
-            AUTODJCRATES_TABLE " INNER JOIN " PLAYLIST_TRACKS_TABLE
-            " ON " AUTODJCRATES_TABLE "." AUTODJCRATESTABLE_TRACKID
-            " = " PLAYLIST_TRACKS_TABLE ".%1"
-            " AND " PLAYLIST_TRACKS_TABLE ".%2 = %3"
-            " ORDER BY " AUTODJCRATES_TABLE "." AUTODJCRATESTABLE_AUTODJREFS ", "
-            PLAYLIST_TRACKS_TABLE ".%4"
-            " LIMIT 1 OFFSET ABS (RANDOM() % :active)")
+    // Collect the crate tracks in the AutoDJ playlist in order of their
+    // first position, least referenced first.
+    // SELECT track_id FROM PlaylistTracks
+    // WHERE playlist_id = m_iAutoDjPlaylistId
+    // ORDER BY position;
+    QSqlQuery oQuery(m_database);
+    oQuery.prepare(QString("SELECT %1 FROM " PLAYLIST_TRACKS_TABLE
+            " WHERE %2 = :playlist_id ORDER BY %3")
             .arg(PLAYLISTTRACKSTABLE_TRACKID, // %1
                  PLAYLISTTRACKSTABLE_PLAYLISTID, // %2
-                 QString::number(m_iAutoDjPlaylistId), // %3
-                 PLAYLISTTABLE_POSITION)); // %4
-    oQuery.bindValue (":active", iActiveTracks);
+                 PLAYLISTTRACKSTABLE_POSITION)); // %3
+    oQuery.bindValue(":playlist_id", m_iAutoDjPlaylistId);
     VERIFY_OR_DEBUG_ASSERT(oQuery.exec()) {
         LOG_FAILED_QUERY(oQuery);
         return TrackId();
     }
-    if (oQuery.next()) {
-        // Give our caller the randomly-selected track.
-        return TrackId(oQuery.value(0));
-    } else {
-        DEBUG_ASSERT(false); // We should have exit earlier
+    QList<TrackId> queuedTrackIds;
+    QSet<TrackId> seenTrackIds;
+    while (oQuery.next()) {
+        TrackId trackId(oQuery.value(0));
+        if (m_autoDjCratesIndex.contains(trackId) &&
+                !seenTrackIds.contains(trackId)) {
+            seenTrackIds.insert(trackId);
+            queuedTrackIds.append(trackId);
+        }
+    }
+    std::stable_sort(queuedTrackIds.begin(), queuedTrackIds.end(),
+            [this](TrackId trackId1, TrackId trackId2) {
+                return m_autoDjCratesIndex.autoDjReferences(trackId1) <
+                        m_autoDjCratesIndex.autoDjReferences(trackId2);
+            });
+    if (queuedTrackIds.isEmpty()) {
         qDebug() << "No random track available for Auto DJ";
         return TrackId();
     }
-}
 
+    // Pick a random track.
+    iActiveTracks = qMin(iActiveTracks, queuedTrackIds.size());
+    return queuedTrackIds.at(randomIndex(iActiveTracks));
+}
 
+int AutoDJCratesDAO::randomIndex(int count) {
+    DEBUG_ASSERT(count > 0);
+    std::uniform_int_distribution<int> distribution(0, count - 1);
+    return distribution(m_randomGenerator);
+}
 
 // Signaled by the track DAO when a track's information is updated.
 void AutoDJCratesDAO::slotTrackDirty(TrackId trackId) {
-    // Update our record of the number of times played, if that changed.
+    // Only tracks of auto-DJ crates and of the track selector are of
+    // interest.
+    const bool bInIndex = m_autoDjCratesIndex.contains(trackId);
+    const bool bInSelector = m_trackSelector.contains(trackId);
+    if (!bInIndex && !bInSelector) {
+        return;
+    }
+
     TrackPointer pTrack = m_pTrackCollection->getTrackDAO().getTrack(trackId);
     if (pTrack == NULL) {
         return;
     }
-    const PlayCounter playCounter(pTrack->getPlayCounter());
-    if (playCounter.getTimesPlayed() == 0) {
-        return;
+    if (bInIndex) {
+        // Update our record of the number of times played, if that changed.
+        const PlayCounter playCounter(pTrack->getPlayCounter());
+        m_autoDjCratesIndex.setTimesPlayed(trackId, playCounter.getTimesPlayed());
+    }
+    if (bInSelector) {
+        m_trackSelector.setTrack(trackId, getTrackFeatures(*pTrack));
     }
+}
 
-    // Update our record of how many times this track has been played.
-    // UPDATE temp_autodj_crates
-    // SET timesplayed = :newplayed
-    // WHERE track_id = :track_id
-    // AND timesplayed = :oldplayed;
-    QSqlQuery oQuery(m_database);
-    oQuery.prepare("UPDATE " AUTODJCRATES_TABLE " SET "
-            AUTODJCRATESTABLE_TIMESPLAYED " = :newplayed WHERE "
-            AUTODJCRATESTABLE_TRACKID " = :track_id AND "
-            AUTODJCRATESTABLE_TIMESPLAYED " = :oldplayed");
-    oQuery.bindValue(":track_id", trackId.toVariant());
-    oQuery.bindValue(":oldplayed", playCounter.getTimesPlayed() - 1);
-    oQuery.bindValue(":newplayed", playCounter.getTimesPlayed());
-    if (!oQuery.exec()) {
-        LOG_FAILED_QUERY(oQuery);
+void AutoDJCratesDAO::slotTracksAdded(QSet<TrackId> trackIds) {
+    if (trackIds.isEmpty()) {
         return;
     }
+    // Also signaled for tracks whose location changed, that might be
+    // missing now.
+    const QList<TrackId> trackIdList = trackIds.toList();
+    for (const auto& trackId : trackIdList) {
+        m_trackSelector.removeTrack(trackId);
+    }
+    loadTrackSelectorFeatures(formatTrackIdList(trackIdList));
+}
+
+void AutoDJCratesDAO::slotTracksRemoved(QSet<TrackId> trackIds) {
+    for (const auto& trackId : trackIds) {
+        m_trackSelector.removeTrack(trackId);
+    }
 }
 
 void AutoDJCratesDAO::slotCrateInserted(CrateId crateId) {
@@ -731,7 +629,10 @@ void AutoDJCratesDAO::slotCrateUpdated(CrateId crateId) {
     Crate crate;
     if (m_pTrackCollection->crates().readCrateById(crateId, &crate)) {
         if (crate.isAutoDjSource()) {
-            updateAutoDjCrate(crateId);
+            // Renaming an auto-DJ crate doesn't change its tracks
+            if (!m_autoDjCrateTrackIds.contains(crateId)) {
+                updateAutoDjCrate(crateId);
+            }
         } else {
             deleteAutoDjCrate(crateId);
         }
@@ -745,222 +646,47 @@ void AutoDJCratesDAO::slotCrateDeleted(CrateId crateId) {
 }
 
 void AutoDJCratesDAO::updateAutoDjCrate(CrateId crateId) {
-    // Handle a crate that's entered the auto-DJ queue differently than one that
-    // is leaving it.  (Obviously.)
-    ScopedTransaction oTransaction(m_database);
-
-    // Add a crate-reference to every track in this crate, if that track is
-    // already in the auto-DJ-crates table.
-    QSqlQuery oQuery(m_database);
-    // UPDATE temp_autodj_crates SET craterefs = craterefs + 1
-    // WHERE track_id IN (
-    //     SELECT temp_autodj_crates.track_id
-    //     FROM crate_tracks, temp_autodj_crates
-    //     WHERE crate_tracks.crate_id = :crate_id
-    //     AND crate_tracks.track_id = temp_autodj_crates.track_id);
-    oQuery.prepare(QString ("UPDATE " AUTODJCRATES_TABLE " SET "
-            AUTODJCRATESTABLE_CRATEREFS " = " AUTODJCRATESTABLE_CRATEREFS
-            " + 1 WHERE " AUTODJCRATESTABLE_TRACKID " IN (SELECT "
-            AUTODJCRATES_TABLE "." AUTODJCRATESTABLE_TRACKID " FROM "
-            CRATE_TRACKS_TABLE ", " AUTODJCRATES_TABLE " WHERE "
-            CRATE_TRACKS_TABLE ".%2 = :crate_id AND " CRATE_TRACKS_TABLE
-            ".%1 = " AUTODJCRATES_TABLE "." AUTODJCRATESTABLE_TRACKID ")")
-            .arg(CRATETRACKSTABLE_TRACKID, // %1
-                 CRATETRACKSTABLE_CRATEID)); // %2
-    oQuery.bindValue(":crate_id", crateId.toVariant());
-    if (!oQuery.exec()) {
-        LOG_FAILED_QUERY(oQuery);
-        return;
-    }
-
-    // Create an entry for all tracks that weren't in the auto-DJ-crates
-    // table already.
-    // The number of crate references is known to be 1 for such tracks.
-    // The number of references to each track in the auto-DJ playlist isn't
-    // set yet; it defaults to zero.
-    // If no records were modified by this query, then there's no reason to
-    // update the number of auto-DJ-playlist references to each track.
-
-    // INSERT INTO temp_autodj_crates (
-    //     track_id, craterefs, timesplayed, autodjrefs)
-    // SELECT crate_tracks.track_id, 1, library.timesplayed, 0
-    // FROM crate_tracks, library
-    // WHERE crate_tracks.crate_id = :crate_id
-    // AND crate_tracks.track_id NOT IN (
-    //     SELECT track_id FROM temp_autodj_crates)
-    // AND crate_tracks.track_id = library.id
-    // AND library.mixxx_deleted = 0;
-    oQuery.prepare(QString("INSERT INTO " AUTODJCRATES_TABLE " ("
-            AUTODJCRATESTABLE_TRACKID ", " AUTODJCRATESTABLE_CRATEREFS ", "
-            AUTODJCRATESTABLE_TIMESPLAYED ", " AUTODJCRATESTABLE_AUTODJREFS
-            ") SELECT " CRATE_TRACKS_TABLE ".%1, 1, " LIBRARY_TABLE
-            ".timesplayed, 0 FROM " CRATE_TRACKS_TABLE ", " LIBRARY_TABLE
-            " WHERE " CRATE_TRACKS_TABLE ".%2 = :crate_id AND "
-            CRATE_TRACKS_TABLE ".%1 NOT IN (SELECT " AUTODJCRATESTABLE_TRACKID
-            " FROM " AUTODJCRATES_TABLE" ) AND " CRATE_TRACKS_TABLE ".%1 = "
-            LIBRARY_TABLE ".%3 AND " LIBRARY_TABLE ".%4 = 0")
-            .arg(CRATETRACKSTABLE_TRACKID, // %1
-                 CRATETRACKSTABLE_CRATEID, // %2
-                 LIBRARYTABLE_ID, // %3
-                 LIBRARYTABLE_MIXXXDELETED)); // %4
-    oQuery.bindValue(":crate_id", crateId.toVariant());
-    if (!oQuery.exec()) {
-        LOG_FAILED_QUERY(oQuery);
-        return;
-    }
-    if (oQuery.numRowsAffected() == 0) {
-        oTransaction.commit();
-        return;
-    }
-
-    // Update the number of auto-DJ-playlist references to each track.
-    // There's no way to avoid updating the number of references to tracks
-    // that were already in the database, but the auto-DJ-playlist is likely
-    // to be small compared to the number of tracks in auto-DJ crates, so
-    // this isn't so bad.
-    if (!updateAutoDjPlaylistReferences()) {
-        return;
-    }
-
-    // Update the last-played date/time for each track.
-    // Similarly, there's no way to avoid updating the last-played date/time
-    // of tracks that were already in the database.
-    if (!updateLastPlayedDateTime()) {
-        return;
+    // Add a crate-reference to every track in this crate.
+    QList<TrackId> trackIds;
+    {
+        CrateTrackSelectResult crateTracks(
+                m_pTrackCollection->crates().selectCrateTracksSorted(crateId));
+        while (crateTracks.next()) {
+            trackIds.append(crateTracks.trackId());
+        }
     }
-
-    // The transaction was successful.
-    oTransaction.commit();
+    addAutoDjCrateTracks(crateId, trackIds,
+            CrateStorage::formatSubselectQueryForCrateTrackIds(crateId));
 }
 
 void AutoDJCratesDAO::deleteAutoDjCrate(CrateId crateId) {
-    // Handle a crate that's entered the auto-DJ queue differently than one that
-    // is leaving it.  (Obviously.)
-    ScopedTransaction oTransaction(m_database);
-
-    // Remove a crate-reference from every track in this crate.
-    QSqlQuery oQuery(m_database);
-    // UPDATE temp_autodj_crates SET craterefs = craterefs - 1
-    // WHERE track_id IN (
-    //     SELECT track_id
-    //     FROM crate_tracks
-    //     WHERE crate_tracks.crate_id = :crate_id);
-    oQuery.prepare(QString("UPDATE " AUTODJCRATES_TABLE " SET "
-            AUTODJCRATESTABLE_CRATEREFS " = " AUTODJCRATESTABLE_CRATEREFS
-            " - 1 WHERE " AUTODJCRATESTABLE_TRACKID " IN (SELECT %1 FROM "
-            CRATE_TRACKS_TABLE " WHERE " CRATE_TRACKS_TABLE ".%2 = :crate_id)")
-            .arg(CRATETRACKSTABLE_TRACKID, // %1
-                 CRATETRACKSTABLE_CRATEID)); // %2
-    oQuery.bindValue(":crate_id", crateId.toVariant());
-    if (!oQuery.exec()) {
-        LOG_FAILED_QUERY(oQuery);
-        return;
-    }
-
-    // Remove all tracks that no longer have crate references.
-    //DELETE FROM temp_autodj_crates WHERE craterefs = 0;
-    oQuery.prepare("DELETE FROM " AUTODJCRATES_TABLE " WHERE "
-        AUTODJCRATESTABLE_CRATEREFS " = 0");
-    if (!oQuery.exec()) {
-        LOG_FAILED_QUERY(oQuery);
-        return;
+    // Remove a crate-reference from every track in this crate. The tracks
+    // of the crate are remembered, because they are already gone from the
+    // database when the crate has been deleted.
+    const QSet<TrackId> trackIds = m_autoDjCrateTrackIds.take(crateId);
+    for (const auto& trackId : trackIds) {
+        m_autoDjCratesIndex.removeCrateReference(trackId);
     }
-
-    // The transaction was successful.
-    oTransaction.commit();
 }
 
 void AutoDJCratesDAO::slotCrateTracksChanged(
         CrateId crateId, const QList<TrackId>& addedTrackIds,
         const QList<TrackId>& removedTrackIds) {
     // Skip this if it's not an auto-DJ crate.
-    Crate crate;
-    if (!m_pTrackCollection->crates().readCrateById(crateId, &crate)
-            || !crate.isAutoDjSource()) {
+    auto it = m_autoDjCrateTrackIds.find(crateId);
+    if (it == m_autoDjCrateTrackIds.end()) {
         return;
     }
 
-    ScopedTransaction oTransaction(m_database);
-    QSqlQuery oQuery(m_database);
-    for (const auto& trackId: addedTrackIds) {
-        // Add a crate-reference to this track, if it's already in the
-        // auto-DJ-crates table (in which case, we're done).
-        // UPDATE temp_autodj_crates SET craterefs = craterefs + 1 WHERE track_id = :track_id;
-        QString strHidden;
-        strHidden.setNum(PlaylistDAO::PLHT_AUTO_DJ);
-        oQuery.prepare("UPDATE " AUTODJCRATES_TABLE " SET "
-            AUTODJCRATESTABLE_CRATEREFS " = " AUTODJCRATESTABLE_CRATEREFS
-            " + 1 WHERE " AUTODJCRATESTABLE_TRACKID " = :track_id");
-        oQuery.bindValue(":track_id", trackId.toVariant());
-        if (!oQuery.exec()) {
-            LOG_FAILED_QUERY(oQuery);
-            return;
-        }
-        if (oQuery.numRowsAffected() == 1) {
-            continue;
-        }
-
-        // Create an entry for the track.
-        // The number of crate references is known to be 1 for such tracks.
-        // The number of references to each track in the auto-DJ playlist isn't
-        // set yet; it defaults to zero.
-        // If no records were modified by this query (i.e. because the track's
-        // mixxx_deleted flag is set), then there's no reason to update the number
-        // of auto-DJ-playlist references to each track.
-        // INSERT INTO temp_autodj_crates (track_id, craterefs, timesplayed, autodjrefs) SELECT :track_id, 1, library.timesplayed, 0 FROM library WHERE :track_id = library.id AND library.mixxx_deleted = 0;
-        oQuery.prepare(QString("INSERT INTO " AUTODJCRATES_TABLE " ("
-                AUTODJCRATESTABLE_TRACKID ", " AUTODJCRATESTABLE_CRATEREFS ", "
-                AUTODJCRATESTABLE_TIMESPLAYED ", " AUTODJCRATESTABLE_AUTODJREFS
-                ") SELECT :track_id_1, 1, " LIBRARY_TABLE ".%1, 0 FROM " LIBRARY_TABLE
-                " WHERE :track_id_2 = " LIBRARY_TABLE ".%2 AND " LIBRARY_TABLE
-                ".%3 = 0")
-                .arg(LIBRARYTABLE_TIMESPLAYED, // %1
-                     LIBRARYTABLE_ID, // %2
-                     LIBRARYTABLE_MIXXXDELETED)); // %3
-        oQuery.bindValue(":track_id_1", trackId.toVariant());
-        oQuery.bindValue(":track_id_2", trackId.toVariant());
-        if (!oQuery.exec()) {
-            LOG_FAILED_QUERY(oQuery);
-            return;
-        }
-        if (oQuery.numRowsAffected() == 0) {
-            continue;
-        }
-
-        // Update the number of auto-DJ-playlist references to this track.
-        if (!updateAutoDjPlaylistReferencesForTrack(trackId)) {
-            return; // failure
-        }
-
-        // Update the last-played date/time for this track.
-        if (!updateLastPlayedDateTimeForTrack(trackId)) {
-            return; // failure
-        }
-    }
     for (const auto& trackId: removedTrackIds) {
-        // UPDATE temp_autodj_crates SET craterefs = craterefs - 1 WHERE track_id = :track_id;
-        oQuery.prepare("UPDATE " AUTODJCRATES_TABLE " SET "
-            AUTODJCRATESTABLE_CRATEREFS " = " AUTODJCRATESTABLE_CRATEREFS
-            " - 1 WHERE " AUTODJCRATESTABLE_TRACKID " = :track_id");
-        oQuery.bindValue(":track_id", trackId.toVariant());
-        if (!oQuery.exec()) {
-            LOG_FAILED_QUERY(oQuery);
-            return;
-        }
-
-        // Remove the track if it no longer has a crate reference.
-        //DELETE FROM temp_autodj_crates WHERE track_id = :track_id AND craterefs = 0;
-        oQuery.prepare("DELETE FROM " AUTODJCRATES_TABLE " WHERE "
-            AUTODJCRATESTABLE_TRACKID " = :track_id AND "
-            AUTODJCRATESTABLE_CRATEREFS " = 0");
-        oQuery.bindValue(":track_id", trackId.toVariant());
-        if (!oQuery.exec()) {
-            LOG_FAILED_QUERY(oQuery);
-            return;
+        if (it.value().remove(trackId)) {
+            m_autoDjCratesIndex.removeCrateReference(trackId);
         }
     }
-    // The transaction was successful.
-    oTransaction.commit();
+    if (!addedTrackIds.isEmpty()) {
+        addAutoDjCrateTracks(crateId, addedTrackIds,
+                formatTrackIdList(addedTrackIds));
+    }
 }
 
 // Signaled by the playlistDAO when a playlist is added.
@@ -988,22 +714,10 @@ void AutoDJCratesDAO::slotPlaylistTrackAdded(int playlistId, TrackId trackId,
                                              int /* a_iPosition */) {
     // Deal with changes to the auto-DJ playlist.
     if (playlistId == m_iAutoDjPlaylistId) {
-        QSqlQuery oQuery(m_database);
-        // UPDATE temp_autodj_crates SET autodjrefs = autodjrefs + 1
-        // WHERE track_id = :track_id;
-        oQuery.prepare("UPDATE " AUTODJCRATES_TABLE " SET "
-            AUTODJCRATESTABLE_AUTODJREFS " = " AUTODJCRATESTABLE_AUTODJREFS
-            " + 1 WHERE " AUTODJCRATESTABLE_TRACKID " = :track_id");
-        oQuery.bindValue(":track_id", trackId.toVariant());
-        if (!oQuery.exec()) {
-            LOG_FAILED_QUERY(oQuery);
-            return;
-        }
+        m_autoDjCratesIndex.addAutoDjReference(trackId);
     } else if (m_lstSetLogPlaylistIds.contains(playlistId)) {
         // Deal with changes to set-log playlists.
         // If this query doesn't succeed, it'll log a message.
-        // Do nothing special otherwise -- any change it makes can be part of
-        // any current transaction.
         updateLastPlayedDateTimeForTrack(trackId);
     }
 }
@@ -1014,21 +728,10 @@ void AutoDJCratesDAO::slotPlaylistTrackRemoved(int playlistId,
                                                int /* a_iPosition */) {
     // Deal with changes to the auto-DJ playlist.
     if (playlistId == m_iAutoDjPlaylistId) {
-        QSqlQuery oQuery(m_database);
-        // UPDATE temp_autodj_crates SET autodjrefs = autodjrefs - 1 WHERE track_id = :track_id;
-        oQuery.prepare("UPDATE " AUTODJCRATES_TABLE " SET "
-            AUTODJCRATESTABLE_AUTODJREFS " = " AUTODJCRATESTABLE_AUTODJREFS
-            " - 1 WHERE " AUTODJCRATESTABLE_TRACKID " = :track_id");
-        oQuery.bindValue(":track_id", trackId.toVariant());
-        if (!oQuery.exec()) {
-            LOG_FAILED_QUERY(oQuery);
-            return;
-        }
+        m_autoDjCratesIndex.removeAutoDjReference(trackId);
     } else if (m_lstSetLogPlaylistIds.contains(playlistId)) {
         // Deal with changes to set-log playlists.
         // If this query doesn't succeed, it'll log a message.
-        // Do nothing special otherwise -- any change it makes can be part of
-        // any current transaction.
         updateLastPlayedDateTimeForTrack(trackId);
     }
 }
@@ -1043,22 +746,10 @@ void AutoDJCratesDAO::slotPlayerInfoTrackLoaded(QString a_strGroup,
 
     // This counts as an auto-DJ reference.  The idea is to prevent tracks that
     // are loaded into a deck from being randomly chosen.
-    TrackId trackId(a_pTrack->getId());
     unsigned int numDecks = PlayerManager::numDecks();
     for (unsigned int i = 0; i < numDecks; ++i) {
         if (a_strGroup == PlayerManager::groupForDeck(i)) {
-            // Update the number of auto-DJ-playlist references to this track.
-            QSqlQuery oQuery(m_database);
-            // UPDATE temp_autodj_crates SET autodjrefs = autodjrefs + 1
-            // WHERE track_id = :track_id;
-            oQuery.prepare("UPDATE " AUTODJCRATES_TABLE " SET "
-                AUTODJCRATESTABLE_AUTODJREFS " = " AUTODJCRATESTABLE_AUTODJREFS
-                " + 1 WHERE " AUTODJCRATESTABLE_TRACKID " = :track_id");
-            oQuery.bindValue(":track_id", trackId.toVariant());
-            if (!oQuery.exec()) {
-                LOG_FAILED_QUERY(oQuery);
-                return;
-            }
+            m_autoDjCratesIndex.addAutoDjReference(a_pTrack->getId());
             return;
         }
     }
@@ -1069,22 +760,11 @@ void AutoDJCratesDAO::slotPlayerInfoTrackUnloaded(QString group,
                                                   TrackPointer pTrack) {
     // This counts as an auto-DJ reference.  The idea is to prevent tracks that
     // are loaded into a deck from being randomly chosen.
-    TrackId trackId(pTrack->getId());
     unsigned int numDecks = PlayerManager::numDecks();
     for (unsigned int i = 0; i < numDecks; ++i) {
         if (group == PlayerManager::groupForDeck(i)) {
             // Get rid of the ID of the track in this deck.
-            QSqlQuery oQuery(m_database);
-            // UPDATE temp_autodj_crates SET autodjrefs = autodjrefs - 1
-            // WHERE track_id = :track_id;
-            oQuery.prepare("UPDATE " AUTODJCRATES_TABLE " SET "
-                AUTODJCRATESTABLE_AUTODJREFS " = " AUTODJCRATESTABLE_AUTODJREFS
-                " - 1 WHERE " AUTODJCRATESTABLE_TRACKID " = :track_id");
-            oQuery.bindValue(":track_id", trackId.toVariant());
-            if (!oQuery.exec()) {
-                LOG_FAILED_QUERY(oQuery);
-                return;
-            }
+            m_autoDjCratesIndex.removeAutoDjReference(pTrack->getId());
             return;
         }
     }
@@ -1109,7 +789,6 @@ TrackId AutoDJCratesDAO::getRandomTrackIdFromLibrary(int iPlaylistId) {
     DEBUG_ASSERT(kLeastPreferredPercent >= kLeastPreferredPercentMin);
     DEBUG_ASSERT(kLeastPreferredPercent <= kLeastPreferredPercentMax);
 
-    // getRandomTrackId() would have already created the temporary auto-DJ-crates database.
     QSqlQuery oQuery(m_database);
     oQuery.prepare(" SELECT COUNT(*)"
                    " FROM library"
@@ -1,10 +1,16 @@
 #ifndef AUTODJCRATESDAO_H
 #define AUTODJCRATESDAO_H
 
+#include <QHash>
 #include <QObject>
+#include <QSet>
 #include <QSqlDatabase>
 
+#include <random>
+
 #include "preferences/usersettings.h"
+#include "library/autodj/autodjcratesindex.h"
+#include "library/autodj/autodjtrackselector.h"
 #include "library/crate/crateid.h"
 #include "track/track.h"
 #include "util/class.h"
@@ -26,36 +32,55 @@ class AutoDJCratesDAO : public QObject {
     // Get random track Id from library
     TrackId getRandomTrackIdFromLibrary(int iPlaylistId);
 
+    // Get the ID of a track that mixes well with the last track of the
+    // auto-DJ playlist, or with the playing track if the playlist is empty.
+    // The track is taken from the auto-DJ crates or from the whole library.
+    // Returns an invalid track id if there is no such track.
+    TrackId getMatchingTrackId(bool bFromCrates);
+
   private:
 
     // Disallow copy and assign.
     // (Isn't that normal for QObject subclasses?)
     DISALLOW_COPY_AND_ASSIGN(AutoDJCratesDAO);
 
-    // Create the temporary auto-DJ-crates database.
+    // Create the auto-DJ-crates index.
     // Done the first time it's used, since the user might not even make
     // use of this feature.
-    void createAndConnectAutoDjCratesDatabase();
-
-    // Create the active-tracks view.
-    bool createActiveTracksView(bool a_bUseIgnoreTime);
-
-    // Update the number of auto-DJ-playlist references to each track in the
-    // auto-DJ-crates database.  Returns true if successful.
-    bool updateAutoDjPlaylistReferences();
+    void createAndConnectAutoDjCratesIndex();
 
-    // Update the number of auto-DJ-playlist references to the given track
-    // in the auto-DJ-crates database.  Returns true if successful.
-    bool updateAutoDjPlaylistReferencesForTrack(TrackId trackId);
+    // Add the given tracks of an auto-DJ crate to the index. The tracks
+    // that are not in the index yet are loaded from the database.
+    // trackIdSubselect selects (at least) the given tracks.
+    void addAutoDjCrateTracks(CrateId crateId,
+                              const QList<TrackId>& trackIds,
+                              const QString& trackIdSubselect);
 
-    // Update the last-played date/time for each track in the
-    // auto-DJ-crates database.  Returns true if successful.
+    // Update the last-played date/time for each track in the index.
+    // Returns true if successful.
     bool updateLastPlayedDateTime();
 
-    // Update the last-played date/time for the given track in the
-    // auto-DJ-crates database.  Returns true if successful.
+    // Returns a uniformly distributed random index in [0, count).
+    int randomIndex(int count);
+
+    // Update the last-played date/time for the given track in the index.
+    // Returns true if successful.
     bool updateLastPlayedDateTimeForTrack(TrackId trackId);
 
+    // Update the last-played date/time for the given tracks, which are
+    // (at least) selected by trackIdSubselect. Returns true if successful.
+    bool updateLastPlayedDateTime(const QString& trackIdSubselect,
+                                  const QSet<TrackId>& trackIds);
+
+    // Create the track selector from the features of all library tracks.
+    // Done the first time it's used, like the auto-DJ-crates index.
+    void createAndConnectTrackSelector();
+
+    // Load the features of the library tracks into the track selector.
+    // trackIdSubselect restricts the tracks if not empty.
+    // Returns true if successful.
+    bool loadTrackSelectorFeatures(const QString& trackIdSubselect);
+
     // Calculates a random Track from AutoDJ,
     // This is used when all active tracks are already queued up.
     TrackId getRandomTrackIdFromAutoDj(int percentActive);
@@ -64,6 +89,11 @@ class AutoDJCratesDAO : public QObject {
     // Signaled by the track DAO when a track's information is updated.
     void slotTrackDirty(TrackId trackId);
 
+    // Signaled by the track DAO when tracks are added/unhidden and
+    // removed/hidden.
+    void slotTracksAdded(QSet<TrackId> trackIds);
+    void slotTracksRemoved(QSet<TrackId> trackIds);
+
     // Signaled by the crate DAO when a crate is added.
     void slotCrateInserted(CrateId crateId);
 
@@ -110,15 +140,29 @@ class AutoDJCratesDAO : public QObject {
     // The source of our configuration.
     UserSettingsPointer m_pConfig;
 
-    // True if the auto-DJ-crates database has been created.
-    bool m_bAutoDjCratesDbCreated;
+    // True if the auto-DJ-crates index has been created.
+    bool m_bAutoDjCratesIndexCreated;
+
+    // The tracks of the auto-DJ crates, from which random tracks are picked.
+    AutoDJCratesIndex m_autoDjCratesIndex;
 
-    // True if active tracks can be tracks that haven't been played in
-    // a while.
-    bool m_bUseIgnoreTime;
+    // The tracks of each auto-DJ crate. They are needed to remove the
+    // crate references when a crate is deleted.
+    QHash<CrateId, QSet<TrackId> > m_autoDjCrateTrackIds;
+
+    // True if the track selector has been created.
+    bool m_bTrackSelectorCreated;
+
+    // The features of the library tracks, from which matching tracks are
+    // selected.
+    AutoDJTrackSelector m_trackSelector;
 
     // The ID of every set-log playlist.
     QList<int> m_lstSetLogPlaylistIds;
+
+    // Picks the random tracks. Seeded differently in every session, like
+    // the RANDOM() function of SQLite that has been used before.
+    std::mt19937 m_randomGenerator;
 };
 
 #endif // AUTODJCRATESDAO_H
@@ -65,10 +65,10 @@ QList<CuePointer> CueDAO::getCuesForTrack(TrackId trackId) const {
     // than one cue has been assigned to a single hotcue id.
     QMap<int, QPair<int, CuePointer> > dupe_hotcues;
 
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM " CUE_TABLE " WHERE track_id = :id");
+    QSqlQuery query(m_queryCache.prepare(
+            "SELECT * FROM " CUE_TABLE " WHERE track_id = :id"));
     query.bindValue(":id", trackId.toVariant());
-    if (query.exec()) {
+    if (m_queryCache.exec(&query)) {
         const int idColumn = query.record().indexOf("id");
         const int hotcueIdColumn = query.record().indexOf("hotcue");
         while (query.next()) {
@@ -100,10 +100,10 @@ QList<CuePointer> CueDAO::getCuesForTrack(TrackId trackId) const {
 
 bool CueDAO::deleteCuesForTrack(TrackId trackId) {
     qDebug() << "CueDAO::deleteCuesForTrack" << QThread::currentThread() << m_database.connectionName();
-    QSqlQuery query(m_database);
-    query.prepare("DELETE FROM " CUE_TABLE " WHERE track_id = :track_id");
+    QSqlQuery query(m_queryCache.prepare(
+            "DELETE FROM " CUE_TABLE " WHERE track_id = :track_id"));
     query.bindValue(":track_id", trackId.toVariant());
-    if (query.exec()) {
+    if (m_queryCache.exec(&query)) {
         return true;
     } else {
         LOG_FAILED_QUERY(query);
@@ -137,8 +137,8 @@ bool CueDAO::saveCue(Cue* cue) {
     }
     if (cue->getId() == -1) {
         // New cue
-        QSqlQuery query(m_database);
-        query.prepare("INSERT INTO " CUE_TABLE " (track_id, type, position, length, hotcue, label, color) VALUES (:track_id, :type, :position, :length, :hotcue, :label, :color)");
+        QSqlQuery query(m_queryCache.prepare(
+                "INSERT INTO " CUE_TABLE " (track_id, type, position, length, hotcue, label, color) VALUES (:track_id, :type, :position, :length, :hotcue, :label, :color)"));
         query.bindValue(":track_id", cue->getTrackId().toVariant());
         query.bindValue(":type", cue->getType());
         query.bindValue(":position", cue->getPosition());
@@ -147,7 +147,7 @@ bool CueDAO::saveCue(Cue* cue) {
         query.bindValue(":label", cue->getLabel());
         query.bindValue(":color", cue->getColor().rgba());
 
-        if (query.exec()) {
+        if (m_queryCache.exec(&query)) {
             int id = query.lastInsertId().toInt();
             cue->setId(id);
             cue->setDirty(false);
@@ -156,8 +156,8 @@ bool CueDAO::saveCue(Cue* cue) {
         qDebug() << query.executedQuery() << query.lastError();
     } else {
         // Update cue
-        QSqlQuery query(m_database);
-        query.prepare("UPDATE " CUE_TABLE " SET "
+        QSqlQuery query(m_queryCache.prepare(
+                "UPDATE " CUE_TABLE " SET "
                         "track_id = :track_id,"
                         "type = :type,"
                         "position = :position,"
@@ -165,7 +165,7 @@ bool CueDAO::saveCue(Cue* cue) {
                         "hotcue = :hotcue,"
                         "label = :label,"
                         "color = :color"
-                        " WHERE id = :id");
+                        " WHERE id = :id"));
         query.bindValue(":id", cue->getId());
         query.bindValue(":track_id", cue->getTrackId().toVariant());
         query.bindValue(":type", cue->getType());
@@ -175,7 +175,7 @@ bool CueDAO::saveCue(Cue* cue) {
         query.bindValue(":label", cue->getLabel());
         query.bindValue(":color", cue->getColor().rgba());
 
-        if (query.exec()) {
+        if (m_queryCache.exec(&query)) {
             cue->setDirty(false);
             return true;
         } else {
@@ -188,10 +188,10 @@ bool CueDAO::saveCue(Cue* cue) {
 bool CueDAO::deleteCue(Cue* cue) {
     //qDebug() << "CueDAO::deleteCue" << QThread::currentThread() << m_database.connectionName();
     if (cue->getId() != -1) {
-        QSqlQuery query(m_database);
-        query.prepare("DELETE FROM " CUE_TABLE " WHERE id = :id");
+        QSqlQuery query(m_queryCache.prepare(
+                "DELETE FROM " CUE_TABLE " WHERE id = :id"));
         query.bindValue(":id", cue->getId());
-        if (query.exec()) {
+        if (m_queryCache.exec(&query)) {
             return true;
         } else {
             LOG_FAILED_QUERY(query);
@@ -9,6 +9,7 @@
 
 #include "track/track.h"
 #include "library/dao/dao.h"
+#include "util/db/sqlquerycache.h"
 
 #define CUE_TABLE "cues"
 
@@ -20,6 +21,7 @@ class CueDAO : public DAO {
 
     void initialize(const QSqlDatabase& database) override {
         m_database = database;
+        m_queryCache.setDatabase(database);
     }
 
     int cueCount();
@@ -36,6 +38,8 @@ class CueDAO : public DAO {
     CuePointer cueFromRow(const QSqlQuery& query) const;
 
     QSqlDatabase m_database;
+    // The cues of all tracks are saved with the same few statements
+    mutable SqlQueryCache m_queryCache;
     mutable QMap<int, CuePointer> m_cues;
 };
 
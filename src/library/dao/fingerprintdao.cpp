@@ -0,0 +1,182 @@
+#include "library/dao/fingerprintdao.h"
+
+#include <QSqlQuery>
+#include <QStringList>
+#include <QtEndian>
+
+#include "library/dao/trackschema.h"
+#include "library/queryutil.h"
+#include "util/assert.h"
+#include "util/db/sqltransaction.h"
+#include "util/logger.h"
+#include "util/performancetimer.h"
+
+const QString FingerprintDao::kTableName = "track_fingerprints";
+
+namespace {
+
+const mixxx::Logger kLogger("FingerprintDao");
+
+// Limits the length of the statements that select tracks by id
+const int kMaxTrackIdsPerQuery = 500;
+
+QByteArray toBlob(const QVector<quint32>& values) {
+    QByteArray blob(values.size() * sizeof(quint32), '\0');
+    uchar* pData = reinterpret_cast<uchar*>(blob.data());
+    for (const auto value: values) {
+        qToLittleEndian(value, pData);
+        pData += sizeof(quint32);
+    }
+    return blob;
+}
+
+QVector<quint32> fromBlob(const QByteArray& blob) {
+    QVector<quint32> values(blob.size() / sizeof(quint32));
+    const uchar* pData = reinterpret_cast<const uchar*>(blob.constData());
+    for (int i = 0; i < values.size(); ++i) {
+        values[i] = qFromLittleEndian<quint32>(pData);
+        pData += sizeof(quint32);
+    }
+    return values;
+}
+
+} // anonymous namespace
+
+bool FingerprintDao::hasFingerprint(TrackId trackId, int version) const {
+    QSqlQuery query(m_database);
+    query.prepare(QString(
+            "SELECT 1 FROM %1 WHERE track_id=:trackId AND version=:version")
+            .arg(kTableName));
+    query.bindValue(":trackId", trackId.toVariant());
+    query.bindValue(":version", version);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    return query.next();
+}
+
+bool FingerprintDao::saveFingerprint(TrackId trackId, int version,
+                                     const QVector<quint32>& signature,
+                                     const QVector<quint32>& excerpt) const {
+    QSqlQuery query(m_database);
+    // The duplicate group is reset, because it might not apply to the
+    // new fingerprint.
+    query.prepare(QString(
+            "INSERT OR REPLACE INTO %1 "
+            "(track_id,version,signature,fingerprint,duplicate_group) "
+            "VALUES (:trackId,:version,:signature,:fingerprint,NULL)")
+            .arg(kTableName));
+    query.bindValue(":trackId", trackId.toVariant());
+    query.bindValue(":version", version);
+    query.bindValue(":signature", toBlob(signature));
+    query.bindValue(":fingerprint", toBlob(excerpt));
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query) << "couldn't save fingerprint of track" << trackId;
+        return false;
+    }
+    return true;
+}
+
+bool FingerprintDao::deleteFingerprints(const QList<TrackId>& trackIds) const {
+    QStringList idList;
+    for (const auto& trackId: trackIds) {
+        idList << trackId.toString();
+    }
+    QSqlQuery query(m_database);
+    query.prepare(QString("DELETE FROM %1 WHERE track_id IN (%2)")
+            .arg(kTableName, idList.join(",")));
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query) << "couldn't delete fingerprints";
+        return false;
+    }
+    return true;
+}
+
+QList<FingerprintDao::TrackSignature> FingerprintDao::loadSignatures(int version) const {
+    PerformanceTimer timer;
+    timer.start();
+
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    query.prepare(QString(
+            "SELECT %1.track_id,library.%2,%1.signature FROM %1 "
+            "INNER JOIN library ON library.%3=%1.track_id "
+            "WHERE %1.version=:version AND library.%4=0")
+            .arg(kTableName,
+                 LIBRARYTABLE_DURATION,
+                 LIBRARYTABLE_ID,
+                 LIBRARYTABLE_MIXXXDELETED));
+    query.bindValue(":version", version);
+    QList<TrackSignature> result;
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return result;
+    }
+    while (query.next()) {
+        TrackSignature trackSignature;
+        trackSignature.trackId = TrackId(query.value(0));
+        trackSignature.duration = query.value(1).toDouble();
+        trackSignature.signature = fromBlob(query.value(2).toByteArray());
+        result.append(trackSignature);
+    }
+    kLogger.debug()
+            << "Loading" << result.size() << "signatures took"
+            << timer.elapsed().debugMillisWithUnit();
+    return result;
+}
+
+QHash<TrackId, QVector<quint32>> FingerprintDao::loadExcerpts(
+        const QList<TrackId>& trackIds) const {
+    QHash<TrackId, QVector<quint32>> result;
+    result.reserve(trackIds.size());
+    for (int first = 0; first < trackIds.size(); first += kMaxTrackIdsPerQuery) {
+        QStringList idList;
+        for (const auto& trackId: trackIds.mid(first, kMaxTrackIdsPerQuery)) {
+            idList << trackId.toString();
+        }
+        QSqlQuery query(m_database);
+        query.setForwardOnly(true);
+        query.prepare(QString(
+                "SELECT track_id,fingerprint FROM %1 WHERE track_id IN (%2)")
+                .arg(kTableName, idList.join(",")));
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+            continue;
+        }
+        while (query.next()) {
+            result.insert(TrackId(query.value(0)),
+                    fromBlob(query.value(1).toByteArray()));
+        }
+    }
+    return result;
+}
+
+bool FingerprintDao::storeDuplicateGroups(const QList<QList<TrackId>>& groups) const {
+    SqlTransaction transaction(m_database);
+    VERIFY_OR_DEBUG_ASSERT(transaction) {
+        return false;
+    }
+    QSqlQuery query(m_database);
+    query.prepare(QString(
+            "UPDATE %1 SET duplicate_group=NULL "
+            "WHERE duplicate_group IS NOT NULL").arg(kTableName));
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    query.prepare(QString(
+            "UPDATE %1 SET duplicate_group=:group WHERE track_id=:trackId")
+            .arg(kTableName));
+    for (int i = 0; i < groups.size(); ++i) {
+        for (const auto& trackId: groups[i]) {
+            query.bindValue(":group", i + 1);
+            query.bindValue(":trackId", trackId.toVariant());
+            if (!query.exec()) {
+                LOG_FAILED_QUERY(query);
+                return false;
+            }
+        }
+    }
+    return transaction.commit();
+}
@@ -0,0 +1,55 @@
+#ifndef FINGERPRINTDAO_H
+#define FINGERPRINTDAO_H
+
+#include <QHash>
+#include <QList>
+#include <QSqlDatabase>
+#include <QVector>
+
+#include "library/dao/dao.h"
+#include "track/trackid.h"
+
+// Stores the audio fingerprints of tracks and the groups of duplicate
+// tracks that have been found by comparing them in the table
+// "track_fingerprints". See library/duplicates/fingerprintindex.h.
+class FingerprintDao : public DAO {
+  public:
+    static const QString kTableName;
+
+    struct TrackSignature {
+        TrackSignature()
+                : duration(0.0) {
+        }
+        TrackId trackId;
+        double duration;
+        QVector<quint32> signature;
+    };
+
+    ~FingerprintDao() override {}
+
+    void initialize(const QSqlDatabase& database) override {
+        m_database = database;
+    }
+
+    // Returns true if a fingerprint of the given version is stored.
+    bool hasFingerprint(TrackId trackId, int version) const;
+    bool saveFingerprint(TrackId trackId, int version,
+                         const QVector<quint32>& signature,
+                         const QVector<quint32>& excerpt) const;
+    bool deleteFingerprints(const QList<TrackId>& trackIds) const;
+
+    // Loads the signatures of all tracks in the library that are not
+    // hidden with a single query.
+    QList<TrackSignature> loadSignatures(int version) const;
+    QHash<TrackId, QVector<quint32>> loadExcerpts(
+            const QList<TrackId>& trackIds) const;
+
+    // Replaces all previously stored groups. The tracks of the n-th
+    // group are assigned the group number n + 1.
+    bool storeDuplicateGroups(const QList<QList<TrackId>>& groups) const;
+
+  private:
+    QSqlDatabase m_database;
+};
+
+#endif // FINGERPRINTDAO_H
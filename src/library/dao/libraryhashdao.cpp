@@ -26,6 +26,46 @@ QHash<QString, int> LibraryHashDAO::getDirectoryHashes() {
     return hashes;
 }
 
+QHash<QString, qint64> LibraryHashDAO::getDirectoryModificationTimes() {
+    QSqlQuery query(m_database);
+    query.prepare("SELECT directory_path, mtime FROM LibraryHashes "
+                  "WHERE directory_deleted=0");
+    QHash<QString, qint64> mtimes;
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+    }
+
+    int directoryPathColumn = query.record().indexOf("directory_path");
+    int mtimeColumn = query.record().indexOf("mtime");
+    while (query.next()) {
+        mtimes[query.value(directoryPathColumn).toString()] =
+                query.value(mtimeColumn).toLongLong();
+    }
+
+    return mtimes;
+}
+
+QStringList LibraryHashDAO::getSubdirectories(const QString& dirPath) {
+    const QString prefix = dirPath.endsWith('/') ? dirPath : dirPath + '/';
+    QSqlQuery query(m_database);
+    // Compares the prefix exactly, LIKE would need escaping and ignores case
+    query.prepare("SELECT directory_path FROM LibraryHashes "
+                  "WHERE directory_deleted=0 "
+                  "AND substr(directory_path, 1, :length)=:prefix");
+    query.bindValue(":length", prefix.length());
+    query.bindValue(":prefix", prefix);
+    QStringList dirPaths;
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return dirPaths;
+    }
+
+    while (query.next()) {
+        dirPaths.append(query.value(0).toString());
+    }
+    return dirPaths;
+}
+
 int LibraryHashDAO::getDirectoryHash(const QString& dirPath) {
     //qDebug() << "LibraryHashDAO::getDirectoryHash" << QThread::currentThread() << m_database.connectionName();
     int hash = -1;
@@ -49,14 +89,16 @@ int LibraryHashDAO::getDirectoryHash(const QString& dirPath) {
     return hash;
 }
 
-void LibraryHashDAO::saveDirectoryHash(const QString& dirPath, const int hash) {
+void LibraryHashDAO::saveDirectoryHash(const QString& dirPath, const int hash,
+                                       const qint64 mtime) {
     //qDebug() << "LibraryHashDAO::saveDirectoryHash" << QThread::currentThread() << m_database.connectionName();
     QSqlQuery query(m_database);
-    query.prepare("INSERT INTO LibraryHashes (directory_path, hash, directory_deleted) "
-                    "VALUES (:directory_path, :hash, :directory_deleted)");
+    query.prepare("INSERT INTO LibraryHashes (directory_path, hash, directory_deleted, mtime) "
+                    "VALUES (:directory_path, :hash, :directory_deleted, :mtime)");
     query.bindValue(":directory_path", dirPath);
     query.bindValue(":hash", hash);
     query.bindValue(":directory_deleted", 0);
+    query.bindValue(":mtime", mtime);
 
     if (!query.exec()) {
         LOG_FAILED_QUERY(query) << "Creating new dirhash failed.";
@@ -66,17 +108,19 @@ void LibraryHashDAO::saveDirectoryHash(const QString& dirPath, const int hash) {
 
 void LibraryHashDAO::updateDirectoryHash(const QString& dirPath,
                                          const int newHash,
-                                         const int dir_deleted) {
+                                         const int dir_deleted,
+                                         const qint64 mtime) {
     //qDebug() << "LibraryHashDAO::updateDirectoryHash" << QThread::currentThread() << m_database.connectionName();
     QSqlQuery query(m_database);
     // By definition if we have calculated a new hash for a directory then it
     // exists and no longer needs verification.
     query.prepare("UPDATE LibraryHashes "
             "SET hash=:hash, directory_deleted=:directory_deleted, "
-            "needs_verification=0 "
+            "needs_verification=0, mtime=:mtime "
             "WHERE directory_path=:directory_path");
     query.bindValue(":hash", newHash);
     query.bindValue(":directory_deleted", dir_deleted);
+    query.bindValue(":mtime", mtime);
     query.bindValue(":directory_path", dirPath);
 
     if (!query.exec()) {
@@ -88,6 +132,19 @@ void LibraryHashDAO::updateDirectoryHash(const QString& dirPath,
     //qDebug() << getDirectoryHash(dirPath);
 }
 
+void LibraryHashDAO::updateDirectoryModificationTime(const QString& dirPath,
+                                                     const qint64 mtime) {
+    QSqlQuery query(m_database);
+    query.prepare("UPDATE LibraryHashes "
+            "SET mtime=:mtime "
+            "WHERE directory_path=:directory_path");
+    query.bindValue(":mtime", mtime);
+    query.bindValue(":directory_path", dirPath);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query) << "Updating directory modification time failed.";
+    }
+}
+
 void LibraryHashDAO::updateDirectoryStatuses(const QStringList& dirPaths,
                                              const bool deleted,
                                              const bool verified) {
@@ -134,6 +191,22 @@ void LibraryHashDAO::invalidateAllDirectories() {
     }
 }
 
+void LibraryHashDAO::invalidateDirectories(const QStringList& dirPaths) {
+    FieldEscaper escaper(m_database);
+    QStringList escapedDirPaths = escaper.escapeStrings(dirPaths);
+
+    QSqlQuery query(m_database);
+    query.prepare(
+        QString("UPDATE LibraryHashes "
+                "SET needs_verification=1 "
+                "WHERE directory_path IN (%1)")
+        .arg(escapedDirPaths.join(",")));
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query)
+                << "Couldn't mark directories as needing verification.";
+    }
+}
+
 void LibraryHashDAO::markUnverifiedDirectoriesAsDeleted() {
     //qDebug() << "LibraryHashDAO::markUnverifiedDirectoriesAsDeleted"
     //<< QThread::currentThread() << m_database.connectionName();
@@ -17,12 +17,22 @@ class LibraryHashDAO : public DAO {
     };
 
     QHash<QString, int> getDirectoryHashes();
+    // Returns the modification times of all directories that have not been
+    // deleted. See ScannerUtil::getDirectoryModificationTime().
+    QHash<QString, qint64> getDirectoryModificationTimes();
+    // Returns the paths of all directories below dirPath that have not been
+    // deleted, i.e. of its subdirectories at any depth.
+    QStringList getSubdirectories(const QString& dirPath);
     int getDirectoryHash(const QString& dirPath);
-    void saveDirectoryHash(const QString& dirPath, const int hash);
+    void saveDirectoryHash(const QString& dirPath, const int hash,
+                           const qint64 mtime);
     void updateDirectoryHash(const QString& dirPath, const int newHash,
-                             const int dir_deleted);
+                             const int dir_deleted, const qint64 mtime);
+    void updateDirectoryModificationTime(const QString& dirPath,
+                                         const qint64 mtime);
     void markAsExisting(const QString& dirPath);
     void invalidateAllDirectories();
+    void invalidateDirectories(const QStringList& dirPaths);
     void markUnverifiedDirectoriesAsDeleted();
     void removeDeletedDirectoryHashes();
     void updateDirectoryStatuses(const QStringList& dirPaths,
@@ -1,3 +1,5 @@
+#include <limits>
+
 #include <QtDebug>
 #include <QtSql>
 
@@ -6,15 +8,34 @@
 #include "library/queryutil.h"
 #include "library/trackcollection.h"
 #include "library/autodj/autodjprocessor.h"
+#include "util/db/sqlqueryfinisher.h"
 #include "util/math.h"
 
+namespace {
+
+// Shared by the functions that insert tracks into playlists
+const QString kInsertPlaylistTrack =
+        "INSERT INTO PlaylistTracks (playlist_id, track_id, position, pl_datetime_added)"
+        "VALUES (:playlist_id, :track_id, :position, CURRENT_TIMESTAMP)";
+const QString kShiftPlaylistTracks =
+        "UPDATE PlaylistTracks SET position=position+:count "
+        "WHERE playlist_id=:id AND position>=:position";
+const QString kShiftPlaylistTracksBetween =
+        "UPDATE PlaylistTracks SET position=position+:count "
+        "WHERE playlist_id=:id AND position BETWEEN :first AND :last";
+
+} // anonymous namespace
+
 PlaylistDAO::PlaylistDAO()
         : m_pAutoDJProcessor(nullptr) {
 }
 
 void PlaylistDAO::initialize(const QSqlDatabase& database) {
     m_database = database;
-    populatePlaylistMembershipCache();
+    m_queryCache.setDatabase(database);
+    if (m_database.isOpen()) {
+        populatePlaylistMembershipCache();
+    }
 }
 
 void PlaylistDAO::populatePlaylistMembershipCache() {
@@ -273,9 +294,7 @@ bool PlaylistDAO::appendTracksToPlaylist(const QList<TrackId>& trackIds, const i
     ++position;
 
     //Insert the song into the PlaylistTracks table
-    QSqlQuery query(m_database);
-    query.prepare("INSERT INTO PlaylistTracks (playlist_id, track_id, position, pl_datetime_added)"
-                  "VALUES (:playlist_id, :track_id, :position, CURRENT_TIMESTAMP)");
+    QSqlQuery query(m_queryCache.prepare(kInsertPlaylistTrack));
     query.bindValue(":playlist_id", playlistId);
 
 
@@ -283,7 +302,7 @@ bool PlaylistDAO::appendTracksToPlaylist(const QList<TrackId>& trackIds, const i
     for (const auto& trackId: trackIds) {
         query.bindValue(":track_id", trackId.toVariant());
         query.bindValue(":position", insertPosition++);
-        if (!query.exec()) {
+        if (!m_queryCache.exec(&query)) {
             LOG_FAILED_QUERY(query);
             return false;
         }
@@ -405,10 +424,11 @@ void PlaylistDAO::removeHiddenTracks(const int playlistId) {
         return;
     }
 
+    QList<int> positions;
     while (query.next()) {
-    	int position = query.value(query.record().indexOf("position")).toInt();
-    	removeTracksFromPlaylistInner(playlistId, position);
+        positions.append(query.value(query.record().indexOf("position")).toInt());
     }
+    removeTracksFromPlaylistInner(playlistId, positions);
 
     transaction.commit();
     emit(changed(playlistId));
@@ -418,23 +438,22 @@ void PlaylistDAO::removeHiddenTracks(const int playlistId) {
 void PlaylistDAO::removeTrackFromPlaylist(const int playlistId, const TrackId& trackId) {
     ScopedTransaction transaction(m_database);
 
-    QSqlQuery query(m_database);
-    query.prepare("SELECT position FROM PlaylistTracks WHERE playlist_id=:id "
-                "AND track_id=:track_id");
+    QSqlQuery query(m_queryCache.prepare(
+            "SELECT position FROM PlaylistTracks WHERE playlist_id=:id "
+            "AND track_id=:track_id"));
     query.bindValue(":id", playlistId);
     query.bindValue(":track_id", trackId.toVariant());
 
-    query.setForwardOnly(true);
-    if (!query.exec()) {
+    if (!m_queryCache.exec(&query)) {
         LOG_FAILED_QUERY(query);
         return;
     }
 
+    QList<int> positions;
     while (query.next()) {
-    	int position = query.value(query.record().indexOf("position")).toInt();
-        removeTracksFromPlaylistInner(playlistId, position);
-
+        positions.append(query.value(query.record().indexOf("position")).toInt());
     }
+    removeTracksFromPlaylistInner(playlistId, positions);
 
     transaction.commit();
     emit(changed(playlistId));
@@ -445,70 +464,116 @@ void PlaylistDAO::removeTrackFromPlaylist(const int playlistId, const int positi
     // qDebug() << "PlaylistDAO::removeTrackFromPlaylist"
     //          << QThread::currentThread() << m_database.connectionName();
     ScopedTransaction transaction(m_database);
-    removeTracksFromPlaylistInner(playlistId, position);
+    removeTracksFromPlaylistInner(playlistId, QList<int>() << position);
     transaction.commit();
     emit(changed(playlistId));
 }
 
 void PlaylistDAO::removeTracksFromPlaylist(const int playlistId, QList<int>& positions) {
-    // get positions in reversed order
-    qSort(positions.begin(), positions.end(), qGreater<int>());
-
     //qDebug() << "PlaylistDAO::removeTrackFromPlaylist"
     //         << QThread::currentThread() << m_database.connectionName();
     ScopedTransaction transaction(m_database);
-    QSqlQuery query(m_database);
-    foreach (int position , positions) {
-    	removeTracksFromPlaylistInner(playlistId, position);
-    }
+    removeTracksFromPlaylistInner(playlistId, positions);
     transaction.commit();
     emit(changed(playlistId));
 }
 
-void PlaylistDAO::removeTracksFromPlaylistInner(int playlistId, int position) {
+void PlaylistDAO::removeTracksFromPlaylistInner(int playlistId, QList<int> positions) {
+    if (positions.isEmpty()) {
+        return;
+    }
+    qSort(positions);
+    QStringList positionStrings;
+    for (int position : positions) {
+        positionStrings.append(QString::number(position));
+    }
+    const QString positionList = positionStrings.join(",");
+
     QSqlQuery query(m_database);
-    query.prepare("SELECT track_id FROM PlaylistTracks WHERE playlist_id=:id "
-                  "AND position=:position");
+    query.prepare(QString("SELECT position, track_id FROM PlaylistTracks "
+                          "WHERE playlist_id=:id AND position IN (%1) "
+                          "ORDER BY position DESC").arg(positionList));
     query.bindValue(":id", playlistId);
-    query.bindValue(":position", position);
-
     if (!query.exec()) {
         LOG_FAILED_QUERY(query);
         return;
     }
-
-    if (!query.next()) {
-        qDebug() << "removeTrackFromPlaylist no track exists at position:"
-                 << position << "in playlist:" << playlistId;
-        return;
-    }
-    TrackId trackId(query.value(query.record().indexOf("track_id")));
-
-    // Delete the track from the playlist.
-    query.prepare("DELETE FROM PlaylistTracks "
-                  "WHERE playlist_id=:id AND position= :position");
+    QList<QPair<int, TrackId> > removedTracks;
+    QList<int> removedPositions;
+    while (query.next()) {
+        removedTracks.append(qMakePair(
+                query.value(0).toInt(), TrackId(query.value(1))));
+        removedPositions.prepend(removedTracks.last().first);
+    }
+    if (removedTracks.size() < positions.size()) {
+        qDebug() << "removeTracksFromPlaylist"
+                 << (positions.size() - removedTracks.size())
+                 << "of the positions don't exist in playlist:" << playlistId;
+    }
+
+    // Delete all tracks at once and shift each range of tracks between the
+    // removed tracks only once instead of shifting the tail of the playlist
+    // for each removed track.
+    query.prepare(QString("DELETE FROM PlaylistTracks "
+                          "WHERE playlist_id=:id AND position IN (%1)")
+                          .arg(positionList));
     query.bindValue(":id", playlistId);
-    query.bindValue(":position", position);
-
     if (!query.exec()) {
         LOG_FAILED_QUERY(query);
         return;
     }
+    closePositionGaps(playlistId, removedPositions);
 
-    QString queryString;
-    queryString = QString("UPDATE PlaylistTracks SET position=position-1 "
-                          "WHERE position>=%1 AND "
-                          "playlist_id=%2").arg(QString::number(position),
-                                                QString::number(playlistId));
-    if (!query.exec(queryString)) {
-        LOG_FAILED_QUERY(query);
+    // The removed tracks are announced from the bottom up, so that each
+    // position is still valid for the receivers when it is announced.
+    for (const auto& removedTrack : removedTracks) {
+        m_playlistsTrackIsIn.remove(removedTrack.second, playlistId);
+        emit(trackRemoved(playlistId, removedTrack.second, removedTrack.first));
     }
-
-    m_playlistsTrackIsIn.remove(trackId, playlistId);
-    emit(trackRemoved(playlistId, trackId, position));
 }
 
+void PlaylistDAO::closePositionGaps(int playlistId,
+                                    const QList<int>& removedPositions) {
+    QSqlQuery query(m_queryCache.prepare(kShiftPlaylistTracksBetween));
+    query.bindValue(":id", playlistId);
+    for (int i = 0; i < removedPositions.size(); ++i) {
+        // The tracks after the i-th removed track move up by i + 1
+        const int first = removedPositions[i] + 1;
+        const int last = (i + 1 < removedPositions.size()) ?
+                removedPositions[i + 1] - 1 : std::numeric_limits<int>::max();
+        if (first > last) {
+            // Adjacent removed tracks
+            continue;
+        }
+        query.bindValue(":count", -(i + 1));
+        query.bindValue(":first", first);
+        query.bindValue(":last", last);
+        if (!m_queryCache.exec(&query)) {
+            LOG_FAILED_QUERY(query);
+            return;
+        }
+    }
+}
 
+bool PlaylistDAO::updateTrackPositions(const QList<QPair<int, int> >& rows,
+                                       int firstPosition) {
+    QSqlQuery query(m_queryCache.prepare(
+            "UPDATE PlaylistTracks SET position=:position WHERE id=:id"));
+    int position = firstPosition;
+    for (const auto& row : rows) {
+        // Only the rows that actually move are written
+        if (row.second != position) {
+            query.bindValue(":position", position);
+            query.bindValue(":id", row.first);
+            if (!m_queryCache.exec(&query)) {
+                LOG_FAILED_QUERY(query);
+                return false;
+            }
+        }
+        ++position;
+    }
+    return true;
+}
 
 bool PlaylistDAO::insertTrackIntoPlaylist(TrackId trackId, const int playlistId, int position) {
     if (playlistId < 0 || !trackId.isValid() || position < 0)
@@ -523,27 +588,23 @@ bool PlaylistDAO::insertTrackIntoPlaylist(TrackId trackId, const int playlistId,
     }
 
     // Move all the tracks in the playlist up by one
-    QString queryString =
-            QString("UPDATE PlaylistTracks SET position=position+1 "
-                    "WHERE position>=%1 AND "
-                    "playlist_id=%2").arg(QString::number(position),
-                                          QString::number(playlistId));
-
-    QSqlQuery query(m_database);
-    if (!query.exec(queryString)) {
+    QSqlQuery query(m_queryCache.prepare(kShiftPlaylistTracks));
+    query.bindValue(":count", 1);
+    query.bindValue(":id", playlistId);
+    query.bindValue(":position", position);
+    if (!m_queryCache.exec(&query)) {
         LOG_FAILED_QUERY(query);
         return false;
     }
 
     //Insert the song into the PlaylistTracks table
-    query.prepare("INSERT INTO PlaylistTracks (playlist_id, track_id, position, pl_datetime_added)"
-                  "VALUES (:playlist_id, :track_id, :position, CURRENT_TIMESTAMP)");
-    query.bindValue(":playlist_id", playlistId);
-    query.bindValue(":track_id", trackId.toVariant());
-    query.bindValue(":position", position);
+    QSqlQuery insertQuery(m_queryCache.prepare(kInsertPlaylistTrack));
+    insertQuery.bindValue(":playlist_id", playlistId);
+    insertQuery.bindValue(":track_id", trackId.toVariant());
+    insertQuery.bindValue(":position", position);
 
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
+    if (!m_queryCache.exec(&insertQuery)) {
+        LOG_FAILED_QUERY(insertQuery);
         return false;
     }
     transaction.commit();
@@ -569,47 +630,58 @@ int PlaylistDAO::insertTracksIntoPlaylist(const QList<TrackId>& trackIds,
         position = max_position;
     }
 
-    QSqlQuery insertQuery(m_database);
-    insertQuery.prepare("INSERT INTO PlaylistTracks (playlist_id, track_id, position)"
-                        "VALUES (:playlist_id, :track_id, :position)");
-    QSqlQuery query(m_database);
-    int insertPositon = position;
+    QList<TrackId> validTrackIds;
     for (const auto& trackId: trackIds) {
-        if (!trackId.isValid()) {
-            continue;
+        if (trackId.isValid()) {
+            validTrackIds.append(trackId);
         }
-        // Move all tracks in playlist up by 1.
-        // TODO(XXX) We could do this in one query before the for loop.
-        query.prepare(QString("UPDATE PlaylistTracks SET position=position+1 "
-                              "WHERE position>=%1 AND "
-                              "playlist_id=%2").arg(insertPositon).arg(playlistId));
+    }
+    if (validTrackIds.isEmpty()) {
+        return 0;
+    }
 
-        if (!query.exec()) {
-            LOG_FAILED_QUERY(query);
-            continue;
-        }
+    // Make room for all tracks with a single shift of the following tracks
+    QSqlQuery query(m_queryCache.prepare(kShiftPlaylistTracks));
+    query.bindValue(":count", validTrackIds.size());
+    query.bindValue(":id", playlistId);
+    query.bindValue(":position", position);
+    if (!m_queryCache.exec(&query)) {
+        LOG_FAILED_QUERY(query);
+        return 0;
+    }
 
+    QSqlQuery insertQuery(m_queryCache.prepare(kInsertPlaylistTrack));
+    QList<QPair<int, TrackId> > addedTracks;
+    int insertPositon = position;
+    for (const auto& trackId: validTrackIds) {
         // Insert the track at the given position
         insertQuery.bindValue(":playlist_id", playlistId);
         insertQuery.bindValue(":track_id", trackId.toVariant());
         insertQuery.bindValue(":position", insertPositon);
-        if (!insertQuery.exec()) {
+        if (!m_queryCache.exec(&insertQuery)) {
             LOG_FAILED_QUERY(insertQuery);
             continue;
         }
-
+        addedTracks.append(qMakePair(insertPositon, trackId));
         // Increment the insert position for the track.
         ++insertPositon;
         ++tracksAdded;
     }
+    if (tracksAdded < validTrackIds.size()) {
+        // Close the gap that is left by the tracks that failed to insert
+        query.bindValue(":count", tracksAdded - validTrackIds.size());
+        query.bindValue(":id", playlistId);
+        query.bindValue(":position", position + validTrackIds.size());
+        if (!m_queryCache.exec(&query)) {
+            LOG_FAILED_QUERY(query);
+        }
+    }
 
     transaction.commit();
 
-    insertPositon = position;
-    for (const auto& trackId: trackIds) {
-        m_playlistsTrackIsIn.insert(trackId, playlistId);
-        // TODO(XXX) The position is wrong if any track failed to insert.
-        emit(trackAdded(playlistId, trackId, insertPositon++));
+    for (const auto& addedTrack : addedTracks) {
+        m_playlistsTrackIsIn.insert(addedTrack.second, playlistId);
+        emit(trackAdded(playlistId, addedTrack.second, addedTrack.first));
     }
     emit(changed(playlistId));
     return tracksAdded;
@@ -731,13 +803,14 @@ bool PlaylistDAO::copyPlaylistTracks(const int sourcePlaylistID, const int targe
 int PlaylistDAO::getMaxPosition(const int playlistId) const {
     // Find out the highest position existing in the playlist so we know what
     // position this track should have.
-    QSqlQuery query(m_database);
-    query.prepare("SELECT max(position) as position FROM PlaylistTracks "
-                  "WHERE playlist_id = :id");
+    QSqlQuery query(m_queryCache.prepare(
+            "SELECT max(position) as position FROM PlaylistTracks "
+            "WHERE playlist_id = :id"));
     query.bindValue(":id", playlistId);
-    if (!query.exec()) {
+    if (!m_queryCache.exec(&query)) {
         LOG_FAILED_QUERY(query);
     }
+    SqlQueryFinisher finisher(query);
 
     // Get the position of the highest track in the playlist.
     int position = 0;
@@ -779,57 +852,57 @@ int PlaylistDAO::tracksInPlaylist(const int playlistId) const {
 }
 
 void PlaylistDAO::moveTrack(const int playlistId, const int oldPosition, const int newPosition) {
-    ScopedTransaction transaction(m_database);
-    QSqlQuery query(m_database);
+    // The track ends up at newPosition, i.e. in front of the track that is
+    // at newPosition after the moved track has been taken out.
+    moveTracks(playlistId, QList<int>() << oldPosition,
+               newPosition > oldPosition ? newPosition + 1 : newPosition);
+}
 
-    // Algorithm for code below
-    // Case 1: destination < source (newPositon < oldPosition)
-    //    1) Set position = -1 where pos=source -- Gives that track a dummy index to keep stuff simple.
-    //    2) Decrement position where pos >= dest AND pos < source
-    //    3) Set position = dest where pos=-1 -- Move track from dummy pos to final destination.
-
-     // Case 2: destination > source (newPos > oldPos)
-     //   1) Set position=-1 where pos=source -- Give track a dummy index again.
-     //   2) Decrement position where pos > source AND pos <= dest
-     //   3) Set postion=dest where pos=-1 -- Move that track from dummy pos to final destination
-
-    QString queryString;
-
-    // Move moved track to  dummy position -1
-    queryString = QString("UPDATE PlaylistTracks SET position=-1 "
-                          "WHERE position=%1 AND "
-                          "playlist_id=%2").arg(QString::number(oldPosition),
-                                                QString::number(playlistId));
-    query.exec(queryString);
-
-    if (newPosition < oldPosition) {
-        queryString = QString("UPDATE PlaylistTracks SET position=position+1 "
-                              "WHERE position >= %1 AND position < %2 AND "
-                              "playlist_id=%3").arg(QString::number(newPosition),
-                                                    QString::number(oldPosition),
-                                                    QString::number(playlistId));
-    } else {
-        queryString = QString("UPDATE PlaylistTracks SET position=position-1 "
-                              "WHERE position>%1 AND position<=%2 AND "
-                              "playlist_id=%3").arg(QString::number(oldPosition),
-                                                    QString::number(newPosition),
-                                                    QString::number(playlistId));
+void PlaylistDAO::moveTracks(const int playlistId, QList<int> positions,
+                             const int destPosition) {
+    if (positions.isEmpty()) {
+        return;
     }
-    query.exec(queryString);
-
-    queryString = QString("UPDATE PlaylistTracks SET position = %1 "
-                          "WHERE position=-1 AND "
-                          "playlist_id=%2").arg(QString::number(newPosition),
-                                                QString::number(playlistId));
-    query.exec(queryString);
+    qSort(positions);
 
-    transaction.commit();
+    // Only the tracks between the moved tracks and the destination change
+    // their position.
+    const int firstPosition = math_min(positions.first(), destPosition);
+    const int lastPosition = math_max(positions.last(), destPosition - 1);
 
-    // Print out any SQL error, if there was one.
-    if (query.lastError().isValid()) {
-        qDebug() << query.lastError();
+    ScopedTransaction transaction(m_database);
+    QSqlQuery query(m_database);
+    query.prepare("SELECT id, position FROM PlaylistTracks "
+                  "WHERE playlist_id=:id AND position>=:first AND position<=:last "
+                  "ORDER BY position");
+    query.bindValue(":id", playlistId);
+    query.bindValue(":first", firstPosition);
+    query.bindValue(":last", lastPosition);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return;
+    }
+    QList<QPair<int, int> > rowsBefore;
+    QList<QPair<int, int> > movedRows;
+    QList<QPair<int, int> > rowsAfter;
+    while (query.next()) {
+        const QPair<int, int> row(query.value(0).toInt(), query.value(1).toInt());
+        if (positions.contains(row.second)) {
+            movedRows.append(row);
+        } else if (row.second < destPosition) {
+            rowsBefore.append(row);
+        } else {
+            rowsAfter.append(row);
+        }
+    }
+    if (movedRows.isEmpty()) {
+        return;
     }
 
+    if (!updateTrackPositions(rowsBefore + movedRows + rowsAfter, firstPosition)) {
+        return;
+    }
+    transaction.commit();
     emit(changed(playlistId));
 }
 
@@ -2,6 +2,8 @@
 #define PLAYLISTDAO_H
 
 #include <QHash>
+#include <QList>
+#include <QPair>
 #include <QObject>
 #include <QSqlDatabase>
 #include <QSet>
@@ -9,6 +11,7 @@
 #include "library/dao/dao.h"
 #include "track/trackid.h"
 #include "util/class.h"
+#include "util/db/sqlquerycache.h"
 
 #define PLAYLIST_TABLE "Playlists"
 #define PLAYLIST_TRACKS_TABLE "PlaylistTracks"
@@ -112,6 +115,11 @@ class PlaylistDAO : public QObject, public virtual DAO {
     // moved Track to a new position
     void moveTrack(const int playlistId,
             const int oldPosition, const int newPosition);
+    // Moves the tracks at the given positions in front of the track at
+    // destPosition, keeping their order. A destPosition after the last track
+    // moves them to the end.
+    void moveTracks(const int playlistId, QList<int> positions,
+            const int destPosition);
     // shuffles all tracks in the position List
     void shuffleTracks(const int playlistId, const QList<int>& positions, const QHash<int,TrackId>& allIds);
     bool isTrackInPlaylist(TrackId trackId, const int playlistId) const;
@@ -132,7 +140,15 @@ class PlaylistDAO : public QObject, public virtual DAO {
 
   private:
     bool removeTracksFromPlaylist(const int playlistId, const int startIndex);
-    void removeTracksFromPlaylistInner(int playlistId, int position);
+    void removeTracksFromPlaylistInner(int playlistId, QList<int> positions);
+    // Closes the gaps that are left by the tracks that have been removed
+    // from the given positions in ascending order with one update for
+    // each range of tracks between them.
+    void closePositionGaps(int playlistId, const QList<int>& removedPositions);
+    // Assigns consecutive positions starting at firstPosition to the given
+    // (PlaylistTracks.id, position) rows.
+    bool updateTrackPositions(const QList<QPair<int, int> >& rows,
+                              int firstPosition);
     void searchForDuplicateTrack(const int fromPosition,
                                  const int toPosition,
                                  TrackId trackID,
@@ -143,6 +159,9 @@ class PlaylistDAO : public QObject, public virtual DAO {
     void populatePlaylistMembershipCache();
 
     QSqlDatabase m_database;
+    // For the statements that are executed for each track when editing
+    // playlists in bulk
+    mutable SqlQueryCache m_queryCache;
     QMultiHash<TrackId, int> m_playlistsTrackIsIn;
     AutoDJProcessor* m_pAutoDJProcessor;
     DISALLOW_COPY_AND_ASSIGN(PlaylistDAO);
@@ -0,0 +1,242 @@
+#include "library/dao/searchindexdao.h"
+
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QtDebug>
+
+#include "library/dao/trackschema.h"
+#include "library/queryutil.h"
+#include "util/db/sqltransaction.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("SearchIndexDAO");
+
+const QString kInsertTrigger = "library_fts_insert";
+const QString kUpdateTrigger = "library_fts_update";
+const QString kDeleteTrigger = "library_fts_delete";
+const QString kLocationTrigger = "library_fts_location_update";
+
+// The indexed columns of the library table. The track location from
+// track_locations is appended as the last column of the index.
+QStringList libraryColumns() {
+    return QStringList()
+            << LIBRARYTABLE_ARTIST
+            << LIBRARYTABLE_ALBUMARTIST
+            << LIBRARYTABLE_ALBUM
+            << LIBRARYTABLE_TITLE
+            << LIBRARYTABLE_GENRE
+            << LIBRARYTABLE_COMPOSER
+            << LIBRARYTABLE_GROUPING
+            << LIBRARYTABLE_COMMENT;
+}
+
+QString prefixed(const QString& prefix, const QStringList& columns) {
+    QStringList result;
+    for (const auto& column: columns) {
+        result << prefix + column;
+    }
+    return result.join(",");
+}
+
+bool execQuery(const QSqlDatabase& database, const QString& statement) {
+    QSqlQuery query(database);
+    if (!query.exec(statement)) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    return true;
+}
+
+// Indexes the rows of the library that are selected by the condition
+QString indexTracksStatement(const QString& condition) {
+    return QString(
+            "INSERT INTO %1(docid,%2) "
+            "SELECT library.%3,%4,track_locations.%5 FROM library "
+            "INNER JOIN track_locations ON library.%6=track_locations.%7%8")
+            .arg(SearchIndexDAO::kTableName,
+                 SearchIndexDAO::indexedColumns().join(","),
+                 LIBRARYTABLE_ID,
+                 prefixed("library.", libraryColumns()),
+                 TRACKLOCATIONSTABLE_LOCATION,
+                 LIBRARYTABLE_LOCATION,
+                 TRACKLOCATIONSTABLE_ID,
+                 condition.isEmpty() ? QString() : " WHERE " + condition);
+}
+
+bool createInsertTrigger(const QSqlDatabase& database, const QString& insertRow) {
+    return execQuery(database, QString(
+            "CREATE TRIGGER IF NOT EXISTS %1 AFTER INSERT ON library "
+            "BEGIN %2 END")
+            .arg(kInsertTrigger, insertRow));
+}
+
+QString insertRowStatement() {
+    return QString(
+            "INSERT INTO %1(docid,%2) SELECT new.%3,%4,"
+            "(SELECT %5 FROM track_locations WHERE %6=new.%7);")
+            .arg(SearchIndexDAO::kTableName,
+                 SearchIndexDAO::indexedColumns().join(","),
+                 LIBRARYTABLE_ID,
+                 prefixed("new.", libraryColumns()),
+                 TRACKLOCATIONSTABLE_LOCATION,
+                 TRACKLOCATIONSTABLE_ID,
+                 LIBRARYTABLE_LOCATION);
+}
+
+}  // anonymous namespace
+
+const QString SearchIndexDAO::kTableName = "library_fts";
+
+SearchIndexDAO::SearchIndexDAO()
+        : m_bAvailable(false) {
+}
+
+// static
+const QStringList& SearchIndexDAO::indexedColumns() {
+    static const QStringList columns =
+            libraryColumns() << TRACKLOCATIONSTABLE_LOCATION;
+    return columns;
+}
+
+// static
+bool SearchIndexDAO::coversColumns(const QStringList& columns) {
+    if (columns.isEmpty()) {
+        return false;
+    }
+    for (const auto& column: columns) {
+        if (!indexedColumns().contains(column)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SearchIndexDAO::initialize(const QSqlDatabase& database) {
+    m_database = database;
+    m_bAvailable = false;
+
+    QSqlQuery query(m_database);
+    query.prepare("SELECT 1 FROM sqlite_master WHERE type='table' AND name=:name");
+    query.bindValue(":name", kTableName);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return;
+    }
+    const bool exists = query.next();
+
+    if (exists) {
+        // Probe that the FTS4 module is available in this SQLite build. The
+        // database may have been written by a build that had it.
+        QSqlQuery probe(m_database);
+        if (!probe.exec(QString("SELECT docid FROM %1 LIMIT 1").arg(kTableName))) {
+            kLogger.warning()
+                    << "Full-text search is not supported by SQLite:"
+                    << probe.lastError();
+            // Without the module the triggers would make every write to the
+            // library fail.
+            dropTriggers();
+            return;
+        }
+        m_bAvailable = createTriggers();
+        return;
+    }
+
+    m_bAvailable = rebuild();
+}
+
+bool SearchIndexDAO::rebuild() {
+    SqlTransaction transaction(m_database);
+
+    dropTriggers();
+    if (!execQuery(m_database,
+            QString("DROP TABLE IF EXISTS %1").arg(kTableName))) {
+        return false;
+    }
+
+    QSqlQuery create(m_database);
+    if (!create.exec(QString(
+            "CREATE VIRTUAL TABLE %1 USING fts4(%2, tokenize=unicode61)")
+            .arg(kTableName, indexedColumns().join(",")))) {
+        kLogger.warning()
+                << "Full-text search is not supported by SQLite:"
+                << create.lastError();
+        return false;
+    }
+
+    if (!createTriggers()) {
+        return false;
+    }
+
+    if (!execQuery(m_database, indexTracksStatement(QString()))) {
+        return false;
+    }
+
+    // Merge the index segments created by the bulk insert.
+    execQuery(m_database, QString("INSERT INTO %1(%1) VALUES('optimize')")
+            .arg(kTableName));
+
+    return transaction.commit();
+}
+
+// static
+bool SearchIndexDAO::suspendIndexingOfInsertedTracks(const QSqlDatabase& database) {
+    QSqlQuery query(database);
+    query.prepare("SELECT 1 FROM sqlite_master WHERE type='trigger' AND name=:name");
+    query.bindValue(":name", kInsertTrigger);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    if (!query.next()) {
+        // The index is not available
+        return false;
+    }
+    return execQuery(database,
+            QString("DROP TRIGGER IF EXISTS %1").arg(kInsertTrigger));
+}
+
+// static
+bool SearchIndexDAO::resumeIndexingOfInsertedTracks(const QSqlDatabase& database,
+                                                    const QVariant& minTrackId) {
+    bool success = true;
+    if (minTrackId.isValid()) {
+        success = execQuery(database, indexTracksStatement(
+                QString("library.%1>=%2").arg(LIBRARYTABLE_ID,
+                                              minTrackId.toString())));
+    }
+    return createInsertTrigger(database, insertRowStatement()) && success;
+}
+
+bool SearchIndexDAO::createTriggers() {
+    const QString insertRow = insertRowStatement();
+
+    QStringList updateColumns = libraryColumns();
+    updateColumns << LIBRARYTABLE_LOCATION;
+
+    return createInsertTrigger(m_database, insertRow) &&
+            execQuery(m_database, QString(
+                    "CREATE TRIGGER IF NOT EXISTS %1 AFTER UPDATE OF %2 ON library "
+                    "BEGIN DELETE FROM %3 WHERE docid=old.%4; %5 END")
+                    .arg(kUpdateTrigger, updateColumns.join(","),
+                         kTableName, LIBRARYTABLE_ID, insertRow)) &&
+            execQuery(m_database, QString(
+                    "CREATE TRIGGER IF NOT EXISTS %1 AFTER DELETE ON library "
+                    "BEGIN DELETE FROM %2 WHERE docid=old.%3; END")
+                    .arg(kDeleteTrigger, kTableName, LIBRARYTABLE_ID)) &&
+            execQuery(m_database, QString(
+                    "CREATE TRIGGER IF NOT EXISTS %1 AFTER UPDATE OF %2 ON track_locations "
+                    "BEGIN UPDATE %3 SET %2=new.%2 WHERE docid IN "
+                    "(SELECT %4 FROM library WHERE %5=new.%6); END")
+                    .arg(kLocationTrigger, TRACKLOCATIONSTABLE_LOCATION,
+                         kTableName, LIBRARYTABLE_ID, LIBRARYTABLE_LOCATION,
+                         TRACKLOCATIONSTABLE_ID));
+}
+
+void SearchIndexDAO::dropTriggers() {
+    for (const auto& trigger: {kInsertTrigger, kUpdateTrigger,
+                               kDeleteTrigger, kLocationTrigger}) {
+        execQuery(m_database, QString("DROP TRIGGER IF EXISTS %1").arg(trigger));
+    }
+}
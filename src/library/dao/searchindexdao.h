@@ -0,0 +1,64 @@
+#ifndef SEARCHINDEXDAO_H
+#define SEARCHINDEXDAO_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+#include "library/dao/dao.h"
+
+// Maintains a full-text index (SQLite FTS4 table "library_fts") over the
+// text columns of the library that are searched from the search box.
+//
+// The index is kept up to date by triggers on the library and
+// track_locations tables, so every code path that writes these tables
+// updates it. Case and accent folding is done once when a row is indexed
+// by the "unicode61" tokenizer instead of on every search by the custom
+// like() function.
+//
+// FTS4 is an optional SQLite module. If it is not available the index is
+// disabled, its triggers are dropped and searches fall back to LIKE.
+class SearchIndexDAO : public DAO {
+  public:
+    static const QString kTableName;
+
+    SearchIndexDAO();
+    ~SearchIndexDAO() override {}
+
+    // Creates the index if it doesn't exist yet and fills it with all tracks
+    // from the library.
+    void initialize(const QSqlDatabase& database) override;
+
+    bool isAvailable() const {
+        return m_bAvailable;
+    }
+
+    // The columns of library_cache_view that are included in the index.
+    static const QStringList& indexedColumns();
+
+    // Returns true if all of the given columns are part of the index.
+    static bool coversColumns(const QStringList& columns);
+
+    // Drops and rebuilds the index from the library.
+    bool rebuild();
+
+    // For bulk inserts into the library: Instead of indexing each inserted
+    // row by the trigger, all new rows are indexed with a single statement.
+    // Both functions must be called within the transaction of the bulk
+    // insert. Returns false if there is no index.
+    static bool suspendIndexingOfInsertedTracks(const QSqlDatabase& database);
+    // Indexes all tracks with an id of at least minTrackId and restores the
+    // trigger.
+    static bool resumeIndexingOfInsertedTracks(const QSqlDatabase& database,
+                                               const QVariant& minTrackId);
+
+  private:
+    bool createTriggers();
+    void dropTriggers();
+
+    QSqlDatabase m_database;
+    bool m_bAvailable;
+};
+
+#endif // SEARCHINDEXDAO_H
@@ -8,6 +8,7 @@
 #include <QImage>
 #include <QRegExp>
 #include <QCoreApplication>
+#include <QTimer>
 #include <QChar>
 
 #include "sources/soundsourceproxy.h"
@@ -16,6 +17,7 @@
 #include "util/db/sqlstringformatter.h"
 #include "util/db/sqllikewildcards.h"
 #include "util/db/sqllikewildcardescaper.h"
+#include "util/db/sqlqueryfinisher.h"
 #include "util/db/sqltransaction.h"
 #include "library/coverart.h"
 #include "library/coverartutils.h"
@@ -25,7 +27,10 @@
 #include "library/dao/playlistdao.h"
 #include "library/dao/analysisdao.h"
 #include "library/dao/libraryhashdao.h"
+#include "library/dao/searchindexdao.h"
 #include "library/coverartcache.h"
+#include "library/tracktagwriter.h"
+#include "mixer/playerinfo.h"
 #include "track/beatfactory.h"
 #include "track/beats.h"
 #include "track/keyfactory.h"
@@ -35,6 +40,7 @@
 #include "util/file.h"
 #include "util/timer.h"
 #include "util/math.h"
+#include "util/performancetimer.h"
 
 QHash<TrackId, TrackWeakPointer> TrackDAO::m_sTracks;
 QMutex TrackDAO::m_sTracksMutex;
@@ -68,6 +74,11 @@ RecentTrackCacheItem::~RecentTrackCacheItem() {
 // expensive.
 const int kRecentTracksCacheSize = 5;
 
+// The delay before dirty tracks are saved. Saves of the same track within
+// this period are coalesced, e.g. while the BPM is adjusted or sync is
+// toggled, and all tracks are saved in a single transaction.
+const int kSaveDirtyTracksDelayMillis = 250;
+
 TrackDAO::TrackDAO(CueDAO& cueDao,
                    PlaylistDAO& playlistDao,
                    AnalysisDao& analysisDao,
@@ -82,6 +93,8 @@ TrackDAO::TrackDAO(CueDAO& cueDao,
           m_trackLocationIdColumn(UndefinedRecordIndex),
           m_queryLibraryIdColumn(UndefinedRecordIndex),
           m_queryLibraryMixxxDeletedColumn(UndefinedRecordIndex) {
+    connect(&PlayerInfo::instance(), SIGNAL(trackUnloaded(QString, TrackPointer)),
+            this, SLOT(slotTrackUnloaded(QString, TrackPointer)));
 }
 
 TrackDAO::~TrackDAO() {
@@ -123,6 +136,21 @@ void TrackDAO::finish() {
     // have an event loop running anymore.
     QCoreApplication::sendPostedEvents(this, 0);
 
+    // Save all pending tracks and wait until their tags have been written.
+    slotSaveDirtyTracks();
+    // The tags of tracks that are still loaded are written now
+    for (const auto& pWeakTrack: m_deferredTagWrites) {
+        TrackPointer pTrack(pWeakTrack);
+        if (pTrack) {
+            writeAudioTags(pTrack.get());
+        }
+    }
+    m_deferredTagWrites.clear();
+    if (m_pTagWriter) {
+        m_pTagWriter->stop();
+        m_pTagWriter.reset();
+    }
+
     // clear out played information on exit
     // crash prevention: if mixxx crashes, played information will be maintained
     qDebug() << "Clearing played information for this session";
@@ -158,10 +186,11 @@ TrackId TrackDAO::getTrackId(const QString& absoluteFilePath) {
 
     TrackId trackId;
 
-    QSqlQuery query(m_database);
-    query.prepare("SELECT library.id FROM library INNER JOIN track_locations ON library.location = track_locations.id WHERE track_locations.location=:location");
+    QSqlQuery query(m_queryCache.prepare(
+            "SELECT library.id FROM library INNER JOIN track_locations ON library.location = track_locations.id WHERE track_locations.location=:location"));
     query.bindValue(":location", absoluteFilePath);
-    if (query.exec()) {
+    if (m_queryCache.exec(&query)) {
+        SqlQueryFinisher finisher(query);
         if (query.next()) {
             trackId = TrackId(query.value(query.record().indexOf("id")));
         }
@@ -222,13 +251,13 @@ QSet<QString> TrackDAO::getTrackLocations() {
 QString TrackDAO::getTrackLocation(TrackId trackId) {
     qDebug() << "TrackDAO::getTrackLocation"
              << QThread::currentThread() << m_database.connectionName();
-    QSqlQuery query(m_database);
     QString trackLocation = "";
-    query.prepare("SELECT track_locations.location FROM track_locations "
-                  "INNER JOIN library ON library.location = track_locations.id "
-                  "WHERE library.id=:id");
+    QSqlQuery query(m_queryCache.prepare(
+            "SELECT track_locations.location FROM track_locations "
+            "INNER JOIN library ON library.location = track_locations.id "
+            "WHERE library.id=:id"));
     query.bindValue(":id", trackId.toVariant());
-    if (!query.exec()) {
+    if (!m_queryCache.exec(&query)) {
         LOG_FAILED_QUERY(query);
         return "";
     }
@@ -249,14 +278,78 @@ bool TrackDAO::trackExistsInDatabase(const QString& absoluteFilePath) {
 }
 
 void TrackDAO::saveTrack(const TrackPointer& pTrack) {
-    if (pTrack) {
+    if (!pTrack || !pTrack->isDirty()) {
+        return;
+    }
+    const TrackId trackId(pTrack->getId());
+    if (!trackId.isValid()) {
+        // Not added to the library yet
         saveTrack(pTrack.get());
+        return;
+    }
+    if (m_pendingSaves.isEmpty()) {
+        QTimer::singleShot(kSaveDirtyTracksDelayMillis,
+                this, SLOT(slotSaveDirtyTracks()));
+    }
+    m_pendingSaves.insert(trackId, pTrack);
+}
+
+void TrackDAO::slotSaveDirtyTracks() {
+    if (m_pendingSaves.isEmpty()) {
+        return;
+    }
+    // Take ownership of the pending tracks, because the signals that are
+    // emitted below might queue new saves.
+    QHash<TrackId, TrackPointer> pendingSaves;
+    pendingSaves.swap(m_pendingSaves);
+
+    qDebug() << "TrackDAO: Saving" << pendingSaves.size() << "dirty tracks";
+    QList<TrackPointer> updatedTracks;
+    SqlTransaction transaction(m_database);
+    for (const auto& pTrack: pendingSaves) {
+        // The track might have been saved in the meantime
+        if (pTrack->isDirty() && updateTrackInTransaction(pTrack.get())) {
+            updatedTracks.append(pTrack);
+        }
+    }
+    if (!transaction.commit()) {
+        qWarning() << "TrackDAO: Failed to save" << pendingSaves.size()
+                << "dirty tracks";
+        return;
+    }
+
+    for (const auto& pTrack: updatedTracks) {
+        pTrack->markClean();
+        emit(trackClean(pTrack->getId()));
+        // Don't touch the file while it is played. The tags are written
+        // when the track has been unloaded from all players or when its
+        // last reference expires.
+        if (PlayerInfo::instance().isTrackLoaded(pTrack)) {
+            m_deferredTagWrites.insert(pTrack->getId(), pTrack);
+        } else {
+            writeAudioTags(pTrack.get());
+        }
     }
 }
 
+void TrackDAO::slotTrackUnloaded(QString group, TrackPointer pTrack) {
+    Q_UNUSED(group);
+    if (!pTrack || !m_deferredTagWrites.contains(pTrack->getId())) {
+        return;
+    }
+    // The track might still be loaded in another player
+    if (PlayerInfo::instance().isTrackLoaded(pTrack)) {
+        return;
+    }
+    m_deferredTagWrites.remove(pTrack->getId());
+    writeAudioTags(pTrack.get());
+}
+
 void TrackDAO::saveTrack(Track* pTrack) {
     DEBUG_ASSERT(nullptr != pTrack);
 
+    // The tags might have been postponed while the track was loaded
+    bool writeTags = m_deferredTagWrites.remove(pTrack->getId()) > 0;
     if (pTrack->isDirty()) {
         // Only update the database if the track has already been added!
         const TrackId trackId(pTrack->getId());
@@ -268,21 +361,35 @@ void TrackDAO::saveTrack(Track* pTrack) {
             DEBUG_ASSERT(!pTrack->isDirty());
             emit(trackClean(trackId));
         }
-
-        // Write audio meta data, if enabled in the preferences.
-        //
-        // TODO(XXX): Only write tag if file metadata is dirty.
-        // Currently metadata will also be saved if for example
-        // cue points have been modified, even if this information
-        // is only stored in the database.
-        // TODO(uklotzde): We need to introduce separate flag for
-        // tracking changes of track metadata regarding file tags.
-        // Instead of another flag that needs to be managed we
-        // could alternatively store a second copy of TrackMetadata
-        // in Track.
-        if (m_pConfig && m_pConfig->getValueString(ConfigKey("[Library]","WriteAudioTags")).toInt() == 1) {
-            SoundSourceProxy::saveTrackMetadata(pTrack);
-        }
+        writeTags = true;
+    }
+    if (writeTags) {
+        writeAudioTags(pTrack);
+    }
+}
+
+void TrackDAO::writeAudioTags(Track* pTrack) {
+    // Write audio meta data, if enabled in the preferences.
+    //
+    // TODO(XXX): Only write tag if file metadata is dirty.
+    // Currently metadata will also be saved if for example
+    // cue points have been modified, even if this information
+    // is only stored in the database.
+    // TODO(uklotzde): We need to introduce separate flag for
+    // tracking changes of track metadata regarding file tags.
+    // Instead of another flag that needs to be managed we
+    // could alternatively store a second copy of TrackMetadata
+    // in Track.
+    if (!m_pConfig || m_pConfig->getValueString(ConfigKey("[Library]","WriteAudioTags")).toInt() != 1) {
+        return;
+    }
+    if (!m_pTagWriter) {
+        m_pTagWriter = std::make_unique<TrackTagWriter>();
+        m_pTagWriter->start(QThread::LowestPriority);
+    }
+    // The tags are written synchronously if the writer can't keep up
+    if (!m_pTagWriter->enqueue(*pTrack)) {
+        SoundSourceProxy::saveTrackMetadata(pTrack);
     }
 }
 
@@ -833,6 +940,297 @@ QList<TrackId> TrackDAO::addMultipleTracks(
     return trackIds;
 }
 
+namespace {
+    // SQLite limits the number of host parameters of a single statement to
+    // 999 by default.
+    const int kMaxHostParameters = 999;
+
+    // The number of track locations that are looked up with a single query
+    const int kLocationsPerQuery = 500;
+
+    // Below this number of tracks indexing each inserted row by the trigger
+    // of the search index is cheaper than dropping and recreating it.
+    const int kMinTracksForDeferredIndexing = 256;
+
+    const int kBulkTrackLocationParameters = 4;
+    const QString kBulkTrackLocationInsert =
+            "INSERT INTO track_locations "
+            "(location,directory,filename,filesize,fs_deleted,needs_verification) "
+            "VALUES ";
+    const QString kBulkTrackLocationRow = "(?,?,?,?,0,0)";
+
+    const int kBulkLibraryParameters = 26;
+    const QString kBulkLibraryInsert =
+            "INSERT INTO library "
+            "("
+            "artist,title,album,album_artist,year,genre,tracknumber,tracktotal,composer,"
+            "grouping,filetype,location,comment,duration,bitrate,samplerate,channels,"
+            "bpm,replaygain,replaygain_peak,key,key_id,keys,keys_version,keys_sub_version,"
+            "header_parsed,timesplayed,rating,cuepoint,bpm_lock,mixxx_deleted"
+            ") VALUES ";
+    const QString kBulkLibraryRow =
+            "(?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,0,0,0,0,0)";
+
+    // Inserts rowCount rows with multi-row INSERT statements. The statement
+    // is prepared once for all chunks of the maximum size. bindRow(pQuery,
+    // row, firstParameter) binds the parameters of a row starting at the
+    // given position.
+    template<typename BindRow>
+    bool insertRows(const QSqlDatabase& database,
+                    const QString& insert,
+                    const QString& valuesRow,
+                    int parametersPerRow,
+                    int rowCount,
+                    BindRow bindRow) {
+        const int maxRowsPerStatement = kMaxHostParameters / parametersPerRow;
+        QSqlQuery query(database);
+        int preparedRows = 0;
+        for (int firstRow = 0; firstRow < rowCount; firstRow += maxRowsPerStatement) {
+            const int rows = math_min(maxRowsPerStatement, rowCount - firstRow);
+            if (rows != preparedRows) {
+                QStringList values;
+                for (int i = 0; i < rows; ++i) {
+                    values << valuesRow;
+                }
+                if (!query.prepare(insert + values.join(","))) {
+                    LOG_FAILED_QUERY(query);
+                    return false;
+                }
+                preparedRows = rows;
+            }
+            for (int i = 0; i < rows; ++i) {
+                bindRow(&query, firstRow + i, i * parametersPerRow);
+            }
+            if (!query.exec()) {
+                LOG_FAILED_QUERY(query);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Looks up the ids of track locations and of the corresponding tracks.
+    bool selectTrackLocations(const QSqlDatabase& database,
+                              const QStringList& locations,
+                              QHash<QString, DbId>* pLocationIds,
+                              QHash<QString, TrackId>* pTrackIds,
+                              QList<TrackId>* pDeletedTrackIds) {
+        QSqlQuery query(database);
+        query.setForwardOnly(true);
+        for (int i = 0; i < locations.size(); i += kLocationsPerQuery) {
+            query.prepare(QString(
+                    "SELECT track_locations.id,track_locations.location,"
+                    "library.id,library.mixxx_deleted "
+                    "FROM track_locations "
+                    "LEFT JOIN library ON library.location=track_locations.id "
+                    "WHERE track_locations.location IN (%1)").arg(
+                            SqlStringFormatter::formatList(database,
+                                    locations.mid(i, kLocationsPerQuery))));
+            if (!query.exec()) {
+                LOG_FAILED_QUERY(query);
+                return false;
+            }
+            while (query.next()) {
+                const QString location = query.value(1).toString();
+                pLocationIds->insert(location, DbId(query.value(0)));
+                const TrackId trackId(query.value(2));
+                if (trackId.isValid()) {
+                    pTrackIds->insert(location, trackId);
+                    if (query.value(3).toBool()) {
+                        pDeletedTrackIds->append(trackId);
+                    }
+                }
+            }
+        }
+        return true;
+    }
+} // anonymous namespace
+
+QList<TrackId> TrackDAO::addTracksBulk(
+        const QVector<NewTrack>& newTracks,
+        bool unremove) {
+    VERIFY_OR_DEBUG_ASSERT(!m_pTransaction) {
+        qWarning() << "TrackDAO::addTracksBulk: Tracks are already being added";
+        return QList<TrackId>();
+    }
+    PerformanceTimer timer;
+    timer.start();
+
+    SqlTransaction transaction(m_database);
+
+    QStringList locations;
+    for (const auto& newTrack: newTracks) {
+        locations.append(newTrack.fileInfo.absoluteFilePath());
+    }
+
+    QHash<QString, DbId> locationIds;
+    QHash<QString, TrackId> trackIds;
+    QList<TrackId> deletedTrackIds;
+    if (!selectTrackLocations(m_database, locations,
+            &locationIds, &trackIds, &deletedTrackIds)) {
+        return QList<TrackId>();
+    }
+
+    // Insert the missing track locations. A file might be listed more than
+    // once.
+    QVector<int> newLocationIndexes;
+    QStringList newLocations;
+    QSet<QString> pendingLocations;
+    for (int i = 0; i < locations.size(); ++i) {
+        const QString& location = locations[i];
+        if (!locationIds.contains(location) && !pendingLocations.contains(location)) {
+            pendingLocations.insert(location);
+            newLocationIndexes.append(i);
+            newLocations.append(location);
+        }
+    }
+    if (!insertRows(m_database, kBulkTrackLocationInsert, kBulkTrackLocationRow,
+            kBulkTrackLocationParameters, newLocationIndexes.size(),
+            [&newTracks, &newLocationIndexes](QSqlQuery* pQuery, int row, int pos) {
+        const QFileInfo& fileInfo = newTracks[newLocationIndexes[row]].fileInfo;
+        pQuery->bindValue(pos++, fileInfo.absoluteFilePath());
+        pQuery->bindValue(pos++, fileInfo.absolutePath());
+        pQuery->bindValue(pos++, fileInfo.fileName());
+        pQuery->bindValue(pos++, fileInfo.size());
+    })) {
+        return QList<TrackId>();
+    }
+    if (!selectTrackLocations(m_database, newLocations,
+            &locationIds, &trackIds, &deletedTrackIds)) {
+        return QList<TrackId>();
+    }
+
+    // Insert the tracks of all locations that are not in the library yet
+    QVector<int> newTrackIndexes;
+    QStringList newTrackLocations;
+    pendingLocations.clear();
+    for (int i = 0; i < locations.size(); ++i) {
+        const QString& location = locations[i];
+        if (!trackIds.contains(location) && locationIds.contains(location) &&
+                !pendingLocations.contains(location)) {
+            pendingLocations.insert(location);
+            newTrackIndexes.append(i);
+            newTrackLocations.append(location);
+        }
+    }
+
+    const bool deferIndexing =
+            newTrackIndexes.size() >= kMinTracksForDeferredIndexing &&
+            SearchIndexDAO::suspendIndexingOfInsertedTracks(m_database);
+
+    if (!insertRows(m_database, kBulkLibraryInsert, kBulkLibraryRow,
+            kBulkLibraryParameters, newTrackIndexes.size(),
+            [&newTracks, &newTrackIndexes, &locations, &locationIds](
+                    QSqlQuery* pQuery, int row, int pos) {
+        const int index = newTrackIndexes[row];
+        const NewTrack& newTrack = newTracks[index];
+        const mixxx::TrackMetadata& trackMetadata = newTrack.trackMetadata;
+
+        // Same as Track::setKeyText()
+        QByteArray keysBlob;
+        QString keysVersion;
+        QString keysSubVersion;
+        QString keyText;
+        mixxx::track::io::key::ChromaticKey key = mixxx::track::io::key::INVALID;
+        const Keys keys(KeyFactory::makeBasicKeysFromText(
+                trackMetadata.getKey(), mixxx::track::io::key::FILE_METADATA));
+        if (keys.getGlobalKey() != mixxx::track::io::key::INVALID) {
+            keysBlob = keys.toByteArray();
+            keysVersion = keys.getVersion();
+            keysSubVersion = keys.getSubVersion();
+            key = keys.getGlobalKey();
+            keyText = KeyUtils::getGlobalKeyText(keys);
+        }
+
+        pQuery->bindValue(pos++, trackMetadata.getArtist());
+        pQuery->bindValue(pos++, trackMetadata.getTitle());
+        pQuery->bindValue(pos++, trackMetadata.getAlbum());
+        pQuery->bindValue(pos++, trackMetadata.getAlbumArtist());
+        pQuery->bindValue(pos++, trackMetadata.getYear());
+        pQuery->bindValue(pos++, trackMetadata.getGenre());
+        pQuery->bindValue(pos++, trackMetadata.getTrackNumber());
+        pQuery->bindValue(pos++, trackMetadata.getTrackTotal());
+        pQuery->bindValue(pos++, trackMetadata.getComposer());
+        pQuery->bindValue(pos++, trackMetadata.getGrouping());
+        pQuery->bindValue(pos++, SoundSource::getFileExtensionFromUrl(
+                QUrl::fromLocalFile(locations[index])));
+        pQuery->bindValue(pos++, locationIds.value(locations[index]).toVariant());
+        pQuery->bindValue(pos++, trackMetadata.getComment());
+        pQuery->bindValue(pos++, trackMetadata.getDuration());
+        pQuery->bindValue(pos++, trackMetadata.getBitrate());
+        pQuery->bindValue(pos++, trackMetadata.getSampleRate());
+        pQuery->bindValue(pos++, trackMetadata.getChannels());
+        pQuery->bindValue(pos++, trackMetadata.getBpm().getValue());
+        pQuery->bindValue(pos++, trackMetadata.getReplayGain().getRatio());
+        pQuery->bindValue(pos++, trackMetadata.getReplayGain().getPeak());
+        pQuery->bindValue(pos++, keyText);
+        pQuery->bindValue(pos++, static_cast<int>(key));
+        pQuery->bindValue(pos++, keysBlob);
+        pQuery->bindValue(pos++, keysVersion);
+        pQuery->bindValue(pos++, keysSubVersion);
+        pQuery->bindValue(pos++, newTrack.headerParsed ? 1 : 0);
+    })) {
+        return QList<TrackId>();
+    }
+    if (!selectTrackLocations(m_database, newTrackLocations,
+            &locationIds, &trackIds, &deletedTrackIds)) {
+        return QList<TrackId>();
+    }
+
+    QSet<TrackId> addedTrackIds;
+    TrackId minTrackId;
+    for (const auto& location: newTrackLocations) {
+        const TrackId trackId(trackIds.value(location));
+        if (trackId.isValid()) {
+            addedTrackIds.insert(trackId);
+            if (!minTrackId.isValid() || trackId < minTrackId) {
+                minTrackId = trackId;
+            }
+        }
+    }
+
+    if (deferIndexing &&
+            !SearchIndexDAO::resumeIndexingOfInsertedTracks(
+                    m_database, minTrackId.toVariant())) {
+        return QList<TrackId>();
+    }
+
+    if (unremove && !deletedTrackIds.isEmpty()) {
+        QStringList idStringList;
+        for (const auto& trackId: deletedTrackIds) {
+            idStringList.append(trackId.toString());
+        }
+        QSqlQuery query(m_database);
+        query.prepare(QString("UPDATE library SET mixxx_deleted=0 "
+                              "WHERE id in (%1) AND mixxx_deleted=1")
+                      .arg(idStringList.join(",")));
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+            return QList<TrackId>();
+        }
+        for (const auto& trackId: deletedTrackIds) {
+            addedTrackIds.insert(trackId);
+        }
+    }
+
+    if (!transaction.commit()) {
+        return QList<TrackId>();
+    }
+
+    qDebug() << "TrackDAO::addTracksBulk: Added" << newTrackIndexes.size()
+             << "of" << newTracks.size() << "tracks in"
+             << timer.elapsed().debugMillisWithUnit();
+
+    // results in a call of BaseTrackCache::updateTracksInIndex(trackIds);
+    emit(tracksAdded(addedTrackIds));
+
+    QList<TrackId> result;
+    for (const auto& location: locations) {
+        result.append(trackIds.value(location));
+    }
+    return result;
+}
+
 bool TrackDAO::onHidingTracks(
         const QList<TrackId>& trackIds) {
     QStringList idList;
@@ -993,10 +1391,8 @@ void TrackDAO::slotTrackReferenceExpired(Track* pTrack) {
     // though the track reference count can drop to zero in any thread this
     // handler runs in the main thread.
 
-    // Save the track if it is dirty.
-    if (pTrack->isDirty()) {
-        saveTrack(pTrack);
-    }
+    // Save the track if it is dirty or if its tags have been postponed.
+    saveTrack(pTrack);
 
     // Delete Track from weak reference cache
     m_sTracksMutex.lock();
@@ -1257,7 +1653,6 @@ TrackPointer TrackDAO::getTrackFromDB(TrackId trackId) const {
     }
 
     ScopedTimer t("TrackDAO::getTrackFromDB");
-    QSqlQuery query(m_database);
 
     ColumnPopulator columns[] = {
         // Location must be first.
@@ -1325,12 +1720,15 @@ TrackPointer TrackDAO::getTrackFromDB(TrackId trackId) const {
         columnsStr.append(columns[i].name);
     }
 
-    query.prepare(QString(
+    // The track id is bound, so that the same statement is reused for
+    // all tracks
+    QSqlQuery query(m_queryCache.prepare(QString(
             "SELECT %1 FROM Library "
             "INNER JOIN track_locations ON library.location = track_locations.id "
-            "WHERE library.id = %2").arg(columnsStr, trackId.toString()));
-
-    if (!query.exec() || !query.next()) {
+            "WHERE library.id = :id").arg(columnsStr)));
+    query.bindValue(":id", trackId.toVariant());
+    SqlQueryFinisher finisher(query);
+    if (!m_queryCache.exec(&query) || !query.next()) {
         LOG_FAILED_QUERY(query)
                 << QString("getTrack(%1)").arg(trackId.toString());
         return TrackPointer();
@@ -1518,20 +1916,31 @@ TrackPointer TrackDAO::getTrack(TrackId trackId, const bool cacheOnly) const {
 
 // Saves a track's info back to the database
 bool TrackDAO::updateTrack(Track* pTrack) {
+    SqlTransaction transaction(m_database);
+    if (!updateTrackInTransaction(pTrack)) {
+        return false;
+    }
+    transaction.commit();
+
+    //qDebug() << "Update track in database took: " << time.elapsed().formatMillisWithUnit();
+    //time.start();
+    pTrack->markClean();
+    //qDebug() << "Dirtying track took: " << time.elapsed().formatMillisWithUnit();
+    return true;
+}
+
+bool TrackDAO::updateTrackInTransaction(Track* pTrack) {
     const TrackId trackId(pTrack->getId());
     DEBUG_ASSERT(trackId.isValid());
 
-    SqlTransaction transaction(m_database);
     // PerformanceTimer time;
     // time.start();
     qDebug() << "TrackDAO:"
             << "Updating track in database"
             << pTrack->getLocation();
 
-    QSqlQuery query(m_database);
-
     // Update everything but "location", since that's what we identify the track by.
-    query.prepare("UPDATE library SET "
+    QSqlQuery query(m_queryCache.prepare("UPDATE library SET "
             "artist=:artist,"
             "title=:title,"
             "album=:album,"
@@ -1570,12 +1979,12 @@ bool TrackDAO::updateTrack(Track* pTrack) {
             "coverart_type=:coverart_type,"
             "coverart_location=:coverart_location,"
             "coverart_hash=:coverart_hash"
-            " WHERE id=:track_id");
+            " WHERE id=:track_id"));
 
     query.bindValue(":track_id", trackId.toVariant());
     bindTrackLibraryValues(&query, *pTrack);
 
-    if (!query.exec()) {
+    if (!m_queryCache.exec(&query)) {
         LOG_FAILED_QUERY(query);
         return false;
     }
@@ -1589,12 +1998,6 @@ bool TrackDAO::updateTrack(Track* pTrack) {
     //time.start();
     m_analysisDao.saveTrackAnalyses(*pTrack);
     m_cueDao.saveTrackCues(trackId, pTrack->getCuePoints());
-    transaction.commit();
-
-    //qDebug() << "Update track in database took: " << time.elapsed().formatMillisWithUnit();
-    //time.start();
-    pTrack->markClean();
-    //qDebug() << "Dirtying track took: " << time.elapsed().formatMillisWithUnit();
     return true;
 }
 
@@ -1613,6 +2016,20 @@ void TrackDAO::invalidateTrackLocationsInLibrary() {
     }
 }
 
+void TrackDAO::invalidateTrackLocationsInDirectories(const QStringList& directories) {
+    QSqlQuery query(m_database);
+    query.prepare(
+        QString("UPDATE track_locations "
+                "SET needs_verification=1 "
+                "WHERE directory IN (%1)").arg(
+                        SqlStringFormatter::formatList(m_database, directories)));
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query)
+                << "Couldn't mark tracks in" << directories.size()
+                << "directories as needing verification.";
+    }
+}
+
 void TrackDAO::markTrackLocationsAsVerified(const QStringList& locations) {
     //qDebug() << "TrackDAO::markTrackLocationsAsVerified" << QThread::currentThread() << m_database.connectionName();
 
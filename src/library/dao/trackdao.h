@@ -11,13 +11,18 @@
 #include <QWeakPointer>
 #include <QCache>
 #include <QString>
+#include <QVector>
 
 #include "preferences/usersettings.h"
 #include "library/dao/dao.h"
 #include "track/track.h"
+#include "track/trackmetadata.h"
 #include "util/class.h"
+#include "util/db/sqlquerycache.h"
 #include "util/memory.h"
 
+class TrackTagWriter;
+
 class SqlTransaction;
 class PlaylistDAO;
 class AnalysisDao;
@@ -64,6 +69,7 @@ class TrackDAO : public QObject, public virtual DAO {
 
     void initialize(const QSqlDatabase& database) override {
         m_database = database;
+        m_queryCache.setDatabase(database);
     }
     void finish();
 
@@ -88,6 +94,34 @@ class TrackDAO : public QObject, public virtual DAO {
     TrackId addTracksAddTrack(const TrackPointer& pTrack, bool unremove);
     void addTracksFinish(bool rollback = false);
 
+    // A file that is added by addTracksBulk() together with its metadata
+    struct NewTrack {
+        NewTrack()
+                : headerParsed(false) {
+        }
+        NewTrack(const QFileInfo& fileInfo,
+                 const mixxx::TrackMetadata& trackMetadata,
+                 bool headerParsed)
+                : fileInfo(fileInfo),
+                  trackMetadata(trackMetadata),
+                  headerParsed(headerParsed) {
+        }
+        QFileInfo fileInfo;
+        mixxx::TrackMetadata trackMetadata;
+        // If the metadata has been parsed from the file
+        bool headerParsed;
+    };
+
+    // Adds many tracks at once without parsing their files, e.g. when
+    // importing an external library. The tracks are inserted with
+    // multi-row INSERT statements in a single transaction and the search
+    // index is updated once at the end. Files that are already in the
+    // library are not modified, but unremoved if requested. Returns the ids
+    // of all given files in the same order. Ids of files that could not be
+    // added are invalid.
+    QList<TrackId> addTracksBulk(const QVector<NewTrack>& newTracks,
+                                 bool unremove);
+
     bool onHidingTracks(
             const QList<TrackId>& trackIds);
     void afterHidingTracks(
@@ -119,6 +153,7 @@ class TrackDAO : public QObject, public virtual DAO {
     void markTrackLocationsAsVerified(const QStringList& locations);
     void markTracksInDirectoriesAsVerified(const QStringList& directories);
     void invalidateTrackLocationsInLibrary();
+    void invalidateTrackLocationsInDirectories(const QStringList& directories);
     void markUnverifiedTracksAsDeleted();
     void markTrackLocationsAsDeleted(const QString& directory);
     bool detectMovedTracks(QSet<TrackId>* pTracksMovedSetOld,
@@ -149,6 +184,10 @@ class TrackDAO : public QObject, public virtual DAO {
     // have a guarantee that the track will not be deleted while we are working
     // on it. However, private parts of TrackDAO can use the raw saveTrack(TIO*)
     // call.
+    //
+    // Dirty tracks are not saved immediately. Repeated saves of the same track
+    // are coalesced and all pending tracks are saved in a single transaction
+    // shortly afterwards.
     void saveTrack(const TrackPointer& pTrack);
 
     // Clears the cached Tracks, which can be useful when the
@@ -166,14 +205,24 @@ class TrackDAO : public QObject, public virtual DAO {
     void slotTrackChanged(Track* pTrack);
     void slotTrackClean(Track* pTrack);
     void slotTrackReferenceExpired(Track* pTrack);
+    void slotSaveDirtyTracks();
+    void slotTrackUnloaded(QString group, TrackPointer pTrack);
 
   private:
     TrackPointer getTrackFromDB(TrackId trackId) const;
 
     void saveTrack(Track* pTrack);
     bool updateTrack(Track* pTrack);
+    // Updates the track within the current transaction without marking
+    // it clean.
+    bool updateTrackInTransaction(Track* pTrack);
+    // Writes the track's metadata into the file tags, if enabled in the
+    // preferences.
+    void writeAudioTags(Track* pTrack);
 
     QSqlDatabase m_database;
+    // For loading, looking up and updating single tracks
+    mutable SqlQueryCache m_queryCache;
 
     CueDAO& m_cueDao;
     PlaylistDAO& m_playlistDao;
@@ -211,6 +260,15 @@ class TrackDAO : public QObject, public virtual DAO {
 
     QSet<TrackId> m_tracksAddedSet;
 
+    // Dirty tracks that will be saved by slotSaveDirtyTracks()
+    QHash<TrackId, TrackPointer> m_pendingSaves;
+    // Saved tracks that are loaded into a player and whose tags will be
+    // written once they have been unloaded
+    QHash<TrackId, TrackWeakPointer> m_deferredTagWrites;
+
+    // Created on demand when the first tags are written
+    std::unique_ptr<TrackTagWriter> m_pTagWriter;
+
     DISALLOW_COPY_AND_ASSIGN(TrackDAO);
 };
 
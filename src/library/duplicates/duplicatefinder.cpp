@@ -0,0 +1,170 @@
+#include "library/duplicates/duplicatefinder.h"
+
+#include <QSet>
+
+#include <algorithm>
+#include <cmath>
+
+#include "library/dao/fingerprintdao.h"
+#include "library/duplicates/fingerprintindex.h"
+#include "util/db/dbconnectionpooled.h"
+#include "util/db/dbconnectionpooler.h"
+#include "util/logger.h"
+#include "util/performancetimer.h"
+
+namespace {
+
+const mixxx::Logger kLogger("DuplicateFinder");
+
+// Different edits of a recording, e.g. the radio edit and the extended
+// mix, may share their beginning but differ in duration.
+const double kMaxDurationDifference = 3.0; // in seconds
+
+// Disjoint sets of tracks with path compression
+class TrackSets {
+  public:
+    int find(int index) {
+        while (m_parents[index] != index) {
+            m_parents[index] = m_parents[m_parents[index]];
+            index = m_parents[index];
+        }
+        return index;
+    }
+
+    int add() {
+        m_parents.append(m_parents.size());
+        return m_parents.size() - 1;
+    }
+
+    void unite(int lhs, int rhs) {
+        const int lhsRoot = find(lhs);
+        const int rhsRoot = find(rhs);
+        if (lhsRoot != rhsRoot) {
+            m_parents[std::max(lhsRoot, rhsRoot)] = std::min(lhsRoot, rhsRoot);
+        }
+    }
+
+  private:
+    QVector<int> m_parents;
+};
+
+bool isDurationSimilar(
+        const QHash<TrackId, double>& durations,
+        TrackId lhs, TrackId rhs) {
+    const double lhsDuration = durations.value(lhs);
+    const double rhsDuration = durations.value(rhs);
+    if (lhsDuration <= 0.0 || rhsDuration <= 0.0) {
+        // Unknown
+        return true;
+    }
+    return std::fabs(lhsDuration - rhsDuration) <= kMaxDurationDifference;
+}
+
+bool trackListLessThan(const QList<TrackId>& lhs, const QList<TrackId>& rhs) {
+    return lhs.first() < rhs.first();
+}
+
+} // anonymous namespace
+
+DuplicateFinder::DuplicateFinder(mixxx::DbConnectionPoolPtr pDbConnectionPool)
+        : m_pDbConnectionPool(std::move(pDbConnectionPool)) {
+}
+
+DuplicateFinder::~DuplicateFinder() {
+    wait();
+}
+
+// static
+QList<QList<TrackId>> DuplicateFinder::groupDuplicates(
+        const QList<QPair<TrackId, TrackId>>& candidates,
+        const QHash<TrackId, QVector<quint32>>& excerpts,
+        const QHash<TrackId, double>& durations) {
+    QHash<TrackId, int> indices;
+    QVector<TrackId> trackIds;
+    TrackSets sets;
+    for (const auto& candidate: candidates) {
+        if (!isDurationSimilar(durations, candidate.first, candidate.second)) {
+            continue;
+        }
+        const auto lhs = excerpts.constFind(candidate.first);
+        const auto rhs = excerpts.constFind(candidate.second);
+        if (lhs == excerpts.constEnd() || rhs == excerpts.constEnd()) {
+            continue;
+        }
+        if (FingerprintIndex::similarity(lhs.value(), rhs.value()) <
+                FingerprintIndex::kMinSimilarity) {
+            continue;
+        }
+        int indexPair[2];
+        const TrackId trackIdPair[2] = {candidate.first, candidate.second};
+        for (int i = 0; i < 2; ++i) {
+            int index = indices.value(trackIdPair[i], -1);
+            if (index < 0) {
+                index = sets.add();
+                indices.insert(trackIdPair[i], index);
+                trackIds.append(trackIdPair[i]);
+            }
+            indexPair[i] = index;
+        }
+        sets.unite(indexPair[0], indexPair[1]);
+    }
+
+    QHash<int, QList<TrackId>> groupsByRoot;
+    for (int i = 0; i < trackIds.size(); ++i) {
+        groupsByRoot[sets.find(i)].append(trackIds[i]);
+    }
+    QList<QList<TrackId>> groups = groupsByRoot.values();
+    for (auto& group: groups) {
+        std::sort(group.begin(), group.end());
+    }
+    std::sort(groups.begin(), groups.end(), trackListLessThan);
+    return groups;
+}
+
+void DuplicateFinder::run() {
+    QThread::currentThread()->setObjectName("DuplicateFinder");
+
+    // Not read-only, because the groups of duplicates are stored
+    const mixxx::DbConnectionPooler dbConnectionPooler(m_pDbConnectionPool);
+    if (!dbConnectionPooler.isPooling()) {
+        kLogger.warning() << "Failed to open a database connection";
+        return;
+    }
+    FingerprintDao fingerprintDao;
+    fingerprintDao.initialize(mixxx::DbConnectionPooled(m_pDbConnectionPool));
+
+    PerformanceTimer timer;
+    timer.start();
+
+    const QList<FingerprintDao::TrackSignature> signatures =
+            fingerprintDao.loadSignatures(FingerprintIndex::kVersion);
+    FingerprintIndex index;
+    index.reserve(signatures.size());
+    QHash<TrackId, double> durations;
+    durations.reserve(signatures.size());
+    for (const auto& trackSignature: signatures) {
+        index.insert(trackSignature.trackId, trackSignature.signature);
+        durations.insert(trackSignature.trackId, trackSignature.duration);
+    }
+    const QList<QPair<TrackId, TrackId>> candidates = index.findCandidates();
+
+    // Only the excerpts of the candidates are needed
+    QSet<TrackId> candidateTrackIds;
+    for (const auto& candidate: candidates) {
+        candidateTrackIds.insert(candidate.first);
+        candidateTrackIds.insert(candidate.second);
+    }
+    const QHash<TrackId, QVector<quint32>> excerpts =
+            fingerprintDao.loadExcerpts(candidateTrackIds.toList());
+
+    const QList<QList<TrackId>> groups =
+            groupDuplicates(candidates, excerpts, durations);
+    fingerprintDao.storeDuplicateGroups(groups);
+
+    kLogger.info()
+            << "Found" << groups.size() << "groups of duplicates among"
+            << index.size() << "tracks with" << candidates.size()
+            << "candidate pairs in" << timer.elapsed().debugMillisWithUnit();
+
+    emit(duplicatesFound(groups.size()));
+}
@@ -0,0 +1,40 @@
+#ifndef MIXXX_LIBRARY_DUPLICATES_DUPLICATEFINDER_H
+#define MIXXX_LIBRARY_DUPLICATES_DUPLICATEFINDER_H
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QThread>
+#include <QVector>
+
+#include "track/trackid.h"
+#include "util/db/dbconnectionpool.h"
+
+// Searches the fingerprints of all tracks for duplicates on its own
+// database connection and stores the groups of duplicate tracks in the
+// database. The fingerprints are computed by AnalyzerFingerprint.
+class DuplicateFinder : public QThread {
+    Q_OBJECT
+  public:
+    explicit DuplicateFinder(mixxx::DbConnectionPoolPtr pDbConnectionPool);
+    ~DuplicateFinder() override;
+
+    // Groups the candidate pairs of duplicate tracks that are confirmed by
+    // comparing their fingerprint excerpts and durations. Each group is
+    // sorted by track id and the groups are sorted by their first track.
+    static QList<QList<TrackId>> groupDuplicates(
+            const QList<QPair<TrackId, TrackId>>& candidates,
+            const QHash<TrackId, QVector<quint32>>& excerpts,
+            const QHash<TrackId, double>& durations);
+
+  signals:
+    void duplicatesFound(int groupCount);
+
+  protected:
+    void run() override;
+
+  private:
+    const mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
+};
+
+#endif // MIXXX_LIBRARY_DUPLICATES_DUPLICATEFINDER_H
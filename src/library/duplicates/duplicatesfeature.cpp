@@ -0,0 +1,90 @@
+#include "library/duplicates/duplicatesfeature.h"
+
+#include <QMenu>
+
+#include "analyzer/analyzerfingerprint.h"
+#include "library/duplicates/duplicatefinder.h"
+#include "library/duplicates/duplicatestablemodel.h"
+#include "library/library.h"
+#include "library/trackcollection.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("DuplicatesFeature");
+
+} // anonymous namespace
+
+DuplicatesFeature::DuplicatesFeature(Library* pLibrary,
+                                     UserSettingsPointer pConfig,
+                                     TrackCollection* pTrackCollection)
+        : LibraryFeature(pConfig, pLibrary),
+          m_pDbConnectionPool(pLibrary->dbConnectionPool()),
+          m_pDuplicatesTableModel(new DuplicatesTableModel(this, pTrackCollection)),
+          m_pFindDuplicatesAction(new QAction(tr("Find Duplicates"), this)),
+          m_title(tr("Duplicates")),
+          m_bSearched(false) {
+    connect(m_pFindDuplicatesAction, SIGNAL(triggered()),
+            this, SLOT(slotFindDuplicates()));
+}
+
+DuplicatesFeature::~DuplicatesFeature() {
+    // Waits until a running search has finished
+    m_pDuplicateFinder.reset();
+}
+
+QVariant DuplicatesFeature::title() {
+    return m_title;
+}
+
+QIcon DuplicatesFeature::getIcon() {
+    return QIcon(":/images/library/ic_library_tracks.png");
+}
+
+TreeItemModel* DuplicatesFeature::getChildModel() {
+    return &m_childModel;
+}
+
+void DuplicatesFeature::activate() {
+    emit(showTrackModel(m_pDuplicatesTableModel));
+    emit(enableCoverArtDisplay(true));
+    if (!m_bSearched) {
+        slotFindDuplicates();
+    }
+}
+
+void DuplicatesFeature::onRightClick(const QPoint& globalPos) {
+    m_pFindDuplicatesAction->setEnabled(
+            !m_pDuplicateFinder || !m_pDuplicateFinder->isRunning());
+    QMenu menu;
+    menu.addAction(m_pFindDuplicatesAction);
+    menu.exec(globalPos);
+}
+
+void DuplicatesFeature::slotFindDuplicates() {
+    if (!m_pDuplicateFinder) {
+        m_pDuplicateFinder = std::make_unique<DuplicateFinder>(m_pDbConnectionPool);
+        connect(m_pDuplicateFinder.get(), SIGNAL(duplicatesFound(int)),
+                this, SLOT(slotDuplicatesFound(int)));
+    }
+    if (m_pDuplicateFinder->isRunning()) {
+        return;
+    }
+    m_bSearched = true;
+    if (!AnalyzerFingerprint::isEnabled(m_pConfig)) {
+        kLogger.info()
+                << "Only tracks that have been analyzed while fingerprinting"
+                << "was enabled are compared";
+    }
+    m_title = QString("%1 (%2)").arg(tr("Duplicates"), tr("searching"));
+    emit(featureIsLoading(this, false));
+    m_pDuplicateFinder->start(QThread::LowPriority);
+}
+
+void DuplicatesFeature::slotDuplicatesFound(int groupCount) {
+    kLogger.debug() << "Found" << groupCount << "groups of duplicates";
+    m_title = tr("Duplicates");
+    m_pDuplicatesTableModel->select();
+    // Only renames the feature without selecting it
+    emit(featureIsLoading(this, false));
+}
@@ -0,0 +1,54 @@
+#ifndef MIXXX_LIBRARY_DUPLICATES_DUPLICATESFEATURE_H
+#define MIXXX_LIBRARY_DUPLICATES_DUPLICATESFEATURE_H
+
+#include <QAction>
+#include <QIcon>
+#include <QVariant>
+
+#include "library/libraryfeature.h"
+#include "library/treeitemmodel.h"
+#include "preferences/usersettings.h"
+#include "util/db/dbconnectionpool.h"
+#include "util/memory.h"
+
+class Library;
+class TrackCollection;
+class DuplicateFinder;
+class DuplicatesTableModel;
+
+// Lists the tracks of the library that are duplicates of each other
+// according to their audio fingerprints. The search runs in the background
+// when the feature is first activated and can be repeated from its context
+// menu, e.g. after more tracks have been analyzed.
+class DuplicatesFeature : public LibraryFeature {
+    Q_OBJECT
+  public:
+    DuplicatesFeature(Library* pLibrary,
+                      UserSettingsPointer pConfig,
+                      TrackCollection* pTrackCollection);
+    ~DuplicatesFeature() override;
+
+    QVariant title() override;
+    QIcon getIcon() override;
+
+    TreeItemModel* getChildModel() override;
+
+  public slots:
+    void activate() override;
+    void onRightClick(const QPoint& globalPos) override;
+
+  private slots:
+    void slotFindDuplicates();
+    void slotDuplicatesFound(int groupCount);
+
+  private:
+    const mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
+    DuplicatesTableModel* m_pDuplicatesTableModel;
+    std::unique_ptr<DuplicateFinder> m_pDuplicateFinder;
+    QAction* m_pFindDuplicatesAction;
+    TreeItemModel m_childModel;
+    QString m_title;
+    bool m_bSearched;
+};
+
+#endif // MIXXX_LIBRARY_DUPLICATES_DUPLICATESFEATURE_H
@@ -0,0 +1,100 @@
+#include "library/duplicates/duplicatestablemodel.h"
+
+#include "library/dao/fingerprintdao.h"
+#include "library/dao/trackschema.h"
+#include "library/queryutil.h"
+#include "mixer/playermanager.h"
+
+namespace {
+
+const QString kTableName = "duplicate_tracks";
+
+} // anonymous namespace
+
+DuplicatesTableModel::DuplicatesTableModel(QObject* parent,
+                                           TrackCollection* pTrackCollection)
+        : BaseSqlTableModel(parent, pTrackCollection, "mixxx.db.model.duplicates") {
+    setTableModel();
+}
+
+DuplicatesTableModel::~DuplicatesTableModel() {
+}
+
+void DuplicatesTableModel::setTableModel(int id) {
+    Q_UNUSED(id);
+    // The group of duplicates is shown in the position column
+    QStringList columns;
+    columns << FingerprintDao::kTableName + ".track_id AS " + LIBRARYTABLE_ID
+            << FingerprintDao::kTableName + ".duplicate_group AS " + PLAYLISTTRACKSTABLE_POSITION
+            << "'' AS " + LIBRARYTABLE_PREVIEW
+            // For sorting the cover art column we give LIBRARYTABLE_COVERART
+            // the same value as the cover hash.
+            << LIBRARYTABLE_COVERART_HASH + " AS " + LIBRARYTABLE_COVERART;
+
+    QSqlQuery query(m_database);
+    query.prepare(QString(
+            "CREATE TEMPORARY VIEW IF NOT EXISTS %1 AS "
+            "SELECT %2 FROM %3 "
+            "INNER JOIN library ON library.%4=%3.track_id "
+            "WHERE %3.duplicate_group IS NOT NULL AND library.%5=0")
+            .arg(kTableName,
+                 columns.join(","),
+                 FingerprintDao::kTableName,
+                 LIBRARYTABLE_ID,
+                 LIBRARYTABLE_MIXXXDELETED));
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+    }
+
+    QStringList tableColumns;
+    tableColumns << LIBRARYTABLE_ID
+                 << PLAYLISTTRACKSTABLE_POSITION
+                 << LIBRARYTABLE_PREVIEW
+                 << LIBRARYTABLE_COVERART;
+    setTable(kTableName, LIBRARYTABLE_ID, tableColumns,
+             m_pTrackCollection->getTrackSource());
+    setSearch("");
+    setDefaultSort(fieldIndex(ColumnCache::COLUMN_PLAYLISTTRACKSTABLE_POSITION), Qt::AscendingOrder);
+    setSort(defaultSortColumn(), defaultSortOrder());
+}
+
+bool DuplicatesTableModel::isColumnInternal(int column) {
+    if (column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_ID) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_PLAYED) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_MIXXXDELETED) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_BPM_LOCK) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_KEY_ID)||
+            column == fieldIndex(ColumnCache::COLUMN_TRACKLOCATIONSTABLE_FSDELETED) ||
+            (PlayerManager::numPreviewDecks() == 0 &&
+             column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_PREVIEW)) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_COVERART_SOURCE) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_COVERART_TYPE) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_COVERART_LOCATION) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_COVERART_HASH)) {
+        return true;
+    }
+    return false;
+}
+
+bool DuplicatesTableModel::isColumnHiddenByDefault(int column) {
+    // The location tells the duplicates apart
+    if (column == fieldIndex(ColumnCache::COLUMN_PLAYLISTTRACKSTABLE_POSITION) ||
+            column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_LOCATION)) {
+        return false;
+    }
+    return BaseSqlTableModel::isColumnHiddenByDefault(column);
+}
+
+Qt::ItemFlags DuplicatesTableModel::flags(const QModelIndex& index) const {
+    return readOnlyFlags(index);
+}
+
+TrackModel::CapabilitiesFlags DuplicatesTableModel::getCapabilities() const {
+    return TRACKMODELCAPS_NONE
+            | TRACKMODELCAPS_ADDTOPLAYLIST
+            | TRACKMODELCAPS_ADDTOCRATE
+            | TRACKMODELCAPS_LOADTODECK
+            | TRACKMODELCAPS_LOADTOSAMPLER
+            | TRACKMODELCAPS_LOADTOPREVIEWDECK
+            | TRACKMODELCAPS_HIDE;
+}
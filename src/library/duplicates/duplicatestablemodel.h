@@ -0,0 +1,23 @@
+#ifndef MIXXX_LIBRARY_DUPLICATES_DUPLICATESTABLEMODEL_H
+#define MIXXX_LIBRARY_DUPLICATES_DUPLICATESTABLEMODEL_H
+
+#include "library/basesqltablemodel.h"
+
+// Shows the tracks that have been found to be duplicates of each other.
+// The "#" column contains the number of the group of duplicates and the
+// tracks are sorted by it.
+class DuplicatesTableModel : public BaseSqlTableModel {
+    Q_OBJECT
+  public:
+    DuplicatesTableModel(QObject* parent, TrackCollection* pTrackCollection);
+    ~DuplicatesTableModel() final;
+
+    void setTableModel(int id = -1);
+
+    bool isColumnInternal(int column) final;
+    bool isColumnHiddenByDefault(int column) final;
+    Qt::ItemFlags flags(const QModelIndex& index) const final;
+    CapabilitiesFlags getCapabilities() const final;
+};
+
+#endif // MIXXX_LIBRARY_DUPLICATES_DUPLICATESTABLEMODEL_H
@@ -0,0 +1,182 @@
+#include "library/duplicates/fingerprintindex.h"
+
+#include <QSet>
+
+#include <algorithm>
+#include <limits>
+
+#include "util/assert.h"
+
+// static
+const int FingerprintIndex::kVersion = 1;
+
+// static
+const int FingerprintIndex::kSignatureSize = 32;
+
+// static
+const double FingerprintIndex::kMinSimilarity = 0.8;
+
+namespace {
+
+// Chromaprint produces about 8 items per second. The excerpt covers 16 s
+// after skipping the first 30 s, which often contain a quiet intro.
+const int kExcerptOffset = 240;
+const int kExcerptSize = 128;
+
+// About 3 s in both directions
+const int kMaxOffset = 24;
+const int kMinOverlap = 64;
+
+// Buckets with more tracks are caused by items that are common to many
+// unrelated tracks, e.g. silence.
+const int kMaxBucketSize = 32;
+
+// The lowest bits are ignored to make the items of re-encoded tracks
+// match more often.
+const int kIgnoredItemBits = 4;
+
+// A bijective mix function (the finalizer of MurmurHash3). Combined with
+// a different seed for each element of the signature it approximates
+// independent random permutations of the items.
+inline quint32 mixBits(quint32 value) {
+    value ^= value >> 16;
+    value *= 0x85ebca6bU;
+    value ^= value >> 13;
+    value *= 0xc2b2ae35U;
+    value ^= value >> 16;
+    return value;
+}
+
+inline quint32 seed(int index) {
+    return mixBits(static_cast<quint32>(index) * 0x9e3779b9U + 1);
+}
+
+inline int countBits(quint32 word) {
+    word = word - ((word >> 1) & 0x55555555U);
+    word = (word & 0x33333333U) + ((word >> 2) & 0x33333333U);
+    word = (word + (word >> 4)) & 0x0F0F0F0FU;
+    return static_cast<int>((word * 0x01010101U) >> 24);
+}
+
+} // anonymous namespace
+
+// static
+QVector<quint32> FingerprintIndex::signature(const QVector<quint32>& fingerprint) {
+    if (fingerprint.isEmpty()) {
+        return QVector<quint32>();
+    }
+    QVector<quint32> seeds(kSignatureSize);
+    for (int i = 0; i < kSignatureSize; ++i) {
+        seeds[i] = seed(i);
+    }
+    QVector<quint32> result(kSignatureSize, std::numeric_limits<quint32>::max());
+    for (const auto item: fingerprint) {
+        const quint32 feature = item >> kIgnoredItemBits;
+        for (int i = 0; i < kSignatureSize; ++i) {
+            const quint32 hash = mixBits(feature ^ seeds[i]);
+            if (hash < result[i]) {
+                result[i] = hash;
+            }
+        }
+    }
+    return result;
+}
+
+// static
+QVector<quint32> FingerprintIndex::excerpt(const QVector<quint32>& fingerprint) {
+    if (fingerprint.size() <= kExcerptSize) {
+        return fingerprint;
+    }
+    const int offset = std::min(kExcerptOffset, fingerprint.size() - kExcerptSize);
+    return fingerprint.mid(offset, kExcerptSize);
+}
+
+// static
+double FingerprintIndex::similarity(const QVector<quint32>& lhs,
+                                    const QVector<quint32>& rhs) {
+    const int minOverlap = std::min(kMinOverlap, std::min(lhs.size(), rhs.size()));
+    if (minOverlap <= 0) {
+        return 0.0;
+    }
+    double result = 0.0;
+    for (int offset = -kMaxOffset; offset <= kMaxOffset; ++offset) {
+        // Compares lhs[i] with rhs[i + offset]
+        const int begin = std::max(0, -offset);
+        const int end = std::min(lhs.size(), rhs.size() - offset);
+        const int overlap = end - begin;
+        if (overlap < minOverlap) {
+            continue;
+        }
+        int bitErrors = 0;
+        for (int i = begin; i < end; ++i) {
+            bitErrors += countBits(lhs[i] ^ rhs[i + offset]);
+        }
+        const double similarity = 1.0 - bitErrors / (32.0 * overlap);
+        result = std::max(result, similarity);
+    }
+    return result;
+}
+
+void FingerprintIndex::reserve(int size) {
+    m_trackIds.reserve(size);
+    m_signatures.reserve(size * kSignatureSize);
+}
+
+void FingerprintIndex::insert(TrackId trackId, const QVector<quint32>& signature) {
+    if (!trackId.isValid() || signature.size() != kSignatureSize) {
+        return;
+    }
+    m_trackIds.append(trackId);
+    m_signatures += signature;
+}
+
+QList<QPair<TrackId, TrackId>> FingerprintIndex::findCandidates() const {
+    // Sorting the (bucket, track) entries groups the tracks of each bucket
+    // and needs far less memory than a hash table of buckets.
+    QVector<QPair<quint64, int>> entries;
+    entries.reserve(m_signatures.size());
+    for (int track = 0; track < m_trackIds.size(); ++track) {
+        for (int i = 0; i < kSignatureSize; ++i) {
+            const quint64 bucket = (quint64(i) << 32) |
+                    m_signatures[track * kSignatureSize + i];
+            entries.append(qMakePair(bucket, track));
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+
+    QSet<quint64> pairs;
+    int first = 0;
+    while (first < entries.size()) {
+        int last = first + 1;
+        while (last < entries.size() && entries[last].first == entries[first].first) {
+            ++last;
+        }
+        if (last - first <= kMaxBucketSize) {
+            for (int i = first; i < last; ++i) {
+                for (int j = i + 1; j < last; ++j) {
+                    // The tracks of a bucket are sorted
+                    DEBUG_ASSERT(entries[i].second < entries[j].second);
+                    pairs.insert((quint64(entries[i].second) << 32) |
+                            quint64(entries[j].second));
+                }
+            }
+        }
+        first = last;
+    }
+
+    QVector<quint64> sortedPairs;
+    sortedPairs.reserve(pairs.size());
+    for (const auto pair: pairs) {
+        sortedPairs.append(pair);
+    }
+    std::sort(sortedPairs.begin(), sortedPairs.end());
+
+    QList<QPair<TrackId, TrackId>> result;
+    result.reserve(sortedPairs.size());
+    for (const auto pair: sortedPairs) {
+        result.append(qMakePair(
+                m_trackIds[static_cast<int>(pair >> 32)],
+                m_trackIds[static_cast<int>(pair & 0xFFFFFFFF)]));
+    }
+    return result;
+}
@@ -0,0 +1,62 @@
+#ifndef MIXXX_LIBRARY_DUPLICATES_FINGERPRINTINDEX_H
+#define MIXXX_LIBRARY_DUPLICATES_FINGERPRINTINDEX_H
+
+#include <QList>
+#include <QPair>
+#include <QVector>
+
+#include "track/trackid.h"
+
+// Finds tracks with similar Chromaprint fingerprints, i.e. the same
+// recording in different encodings, among a large number of tracks.
+//
+// Comparing all pairs of fingerprints doesn't scale to large libraries.
+// Instead each fingerprint is reduced to a small MinHash signature: For
+// each of kSignatureSize hash functions the minimum hash over all items
+// of the fingerprint. Two fingerprints agree in an element of their
+// signatures with a probability that equals the share of items they
+// have in common. The index buckets the tracks by each element of their
+// signatures (locality-sensitive hashing) and only tracks that share a
+// bucket are candidates, which need to be verified by comparing their
+// fingerprint excerpts bit by bit.
+class FingerprintIndex {
+  public:
+    // Incremented whenever the signature or the excerpt are computed
+    // differently. Stored fingerprints of other versions are recomputed.
+    static const int kVersion;
+
+    static const int kSignatureSize;
+
+    // Tracks whose excerpts are at least this similar are duplicates.
+    static const double kMinSimilarity;
+
+    static QVector<quint32> signature(const QVector<quint32>& fingerprint);
+
+    // The part of the fingerprint that is kept for comparing tracks.
+    static QVector<quint32> excerpt(const QVector<quint32>& fingerprint);
+
+    // Returns the share of equal bits between two excerpts in the range
+    // [0, 1], where unrelated tracks have a similarity of about 0.5. The
+    // excerpts are compared at all offsets of up to a few seconds to
+    // compensate for differences in leading silence and encoder delay.
+    static double similarity(const QVector<quint32>& lhs,
+                             const QVector<quint32>& rhs);
+
+    void reserve(int size);
+    // Tracks with an empty or invalid signature are ignored
+    void insert(TrackId trackId, const QVector<quint32>& signature);
+    int size() const {
+        return m_trackIds.size();
+    }
+
+    // Returns each pair of tracks that share at least one bucket once.
+    // Overfull buckets, e.g. for silence, are skipped.
+    QList<QPair<TrackId, TrackId>> findCandidates() const;
+
+  private:
+    QVector<TrackId> m_trackIds;
+    // kSignatureSize elements per track
+    QVector<quint32> m_signatures;
+};
+
+#endif // MIXXX_LIBRARY_DUPLICATES_FINGERPRINTINDEX_H
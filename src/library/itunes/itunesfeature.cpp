@@ -19,6 +19,7 @@
 #include "util/sandbox.h"
 
 const QString ITunesFeature::ITDB_PATH_KEY = "mixxx.itunesfeature.itdbpath";
+const QString ITunesFeature::ITDB_VERSION_KEY = "mixxx.itunesfeature.itdbversion";
 
 QString localhost_token() {
 #if defined(__WINDOWS__)
@@ -75,6 +76,12 @@ ITunesFeature::ITunesFeature(QObject* parent, TrackCollection* pTrackCollection)
         qDebug() << "Failed to open database for iTunes scanner." << m_database.lastError();
     }
     connect(&m_future_watcher, SIGNAL(finished()), this, SLOT(onTrackCollectionLoaded()));
+    connect(this, SIGNAL(tracksImported()),
+            this, SLOT(slotTracksImported()),
+            Qt::QueuedConnection);
+    connect(this, SIGNAL(playlistsImported(QStringList)),
+            this, SLOT(slotPlaylistsImported(QStringList)),
+            Qt::QueuedConnection);
 }
 
 ITunesFeature::~ITunesFeature() {
@@ -156,17 +163,12 @@ void ITunesFeature::activate(bool forceReload) {
             settings.setValue(ITDB_PATH_KEY, m_dbfile);
         }
         m_isActivated =  true;
-        // Ususally the maximum number of threads
-        // is > 2 depending on the CPU cores
-        // Unfortunately, within VirtualBox
-        // the maximum number of allowed threads
-        // is 1 at all times We'll need to increase
-        // the number to > 1, otherwise importing the music collection
-        // takes place when the GUI threads terminates, i.e., on
-        // Mixxx shutdown.
-        QThreadPool::globalInstance()->setMaxThreadCount(4); //Tobias decided to use 4
+        // Playlists are added to the new root item while they are imported
+        m_childModel.setRootItem(std::make_unique<TreeItem>(this));
+        reserveImportThread();
         // Let a worker thread do the XML parsing
-        m_future = QtConcurrent::run(this, &ITunesFeature::importLibrary);
+        m_future = QtConcurrent::run(this, &ITunesFeature::importLibrary,
+                                     forceReload);
         m_future_watcher.setFuture(m_future);
         m_title = tr("(loading) iTunes");
         // calls a slot in the sidebar model such that 'iTunes (isLoading)' is displayed.
@@ -323,7 +325,7 @@ void ITunesFeature::guessMusicLibraryMountpoint(QXmlStreamReader &xml) {
 
 // This method is executed in a separate thread
 // via QtConcurrent::run
-TreeItem* ITunesFeature::importLibrary() {
+TreeItem* ITunesFeature::importLibrary(bool forceReload) {
     bool isTracksParsed=false;
     bool isMusicFolderLocatedAfterTracks=false;
   
@@ -331,8 +333,19 @@ TreeItem* ITunesFeature::importLibrary() {
     QThread* thisThread = QThread::currentThread();
     thisThread->setPriority(QThread::LowPriority);
 
+    // The tables still hold the result of the last complete import if the
+    // XML file has not been touched since then.
+    const QString sourceVersion = sourceFilesVersion(QStringList() << m_dbfile);
+    SettingsDAO settings(m_database);
+    if (!forceReload && settings.getValue(ITDB_VERSION_KEY) == sourceVersion) {
+        qDebug() << "iTunes music collection is unchanged since the last import";
+        return loadImportedPlaylists(m_database, "itunes_playlists");
+    }
+
     //Delete all table entries of iTunes feature
     ScopedTransaction transaction(m_database);
+    // The tables are incomplete until the import has finished
+    settings.setValue(ITDB_VERSION_KEY, QString());
     clearTable("itunes_playlist_tracks");
     clearTable("itunes_library");
     clearTable("itunes_playlists");
@@ -370,10 +383,10 @@ TreeItem* ITunesFeature::importLibrary() {
                         guessMusicLibraryMountpoint(xml);
                     }
                 } else if (key == "Tracks") {
-                    parseTracks(xml);
+                    parseTracks(xml, &transaction);
                     if (playlist_root != NULL)
                         delete playlist_root;
-                    playlist_root = parsePlaylists(xml);
+                    playlist_root = parsePlaylists(xml, &transaction);
                     isTracksParsed = true;
                 }
             }
@@ -407,11 +420,13 @@ TreeItem* ITunesFeature::importLibrary() {
         if (playlist_root)
             delete playlist_root;
         playlist_root = NULL;
+    } else if (playlist_root && !m_cancelImport) {
+        settings.setValue(ITDB_VERSION_KEY, sourceVersion);
     }
     return playlist_root;
 }
 
-void ITunesFeature::parseTracks(QXmlStreamReader &xml) {
+void ITunesFeature::parseTracks(QXmlStreamReader &xml, ScopedTransaction* pTransaction) {
     bool in_container_dictionary = false;
     bool in_track_dictionary = false;
     QSqlQuery query(m_database);
@@ -424,6 +439,7 @@ void ITunesFeature::parseTracks(QXmlStreamReader &xml) {
                   ":duration, :location," ":rating )");
 
     qDebug() << "Parse iTunes music collection";
+    int trackCount = 0;
 
     //read all sunsequent <dict> until we reach the closing ENTRY tag
     while (!xml.atEnd() && !m_cancelImport) {
@@ -439,6 +455,10 @@ void ITunesFeature::parseTracks(QXmlStreamReader &xml) {
                     in_track_dictionary = true;
                     //Parse track here
                     parseTrack(xml, query);
+                    if (++trackCount % kTracksPerImportTransaction == 0) {
+                        pTransaction->commit();
+                        pTransaction->transaction();
+                    }
                 }
             }
         }
@@ -450,6 +470,10 @@ void ITunesFeature::parseTracks(QXmlStreamReader &xml) {
             } else if (in_container_dictionary && !in_track_dictionary) {
                 // Done parsing tracks.
                 in_container_dictionary = false;
+                // Commit the tracks before the playlists that refer to them
+                pTransaction->commit();
+                pTransaction->transaction();
+                emit(tracksImported());
                 break;
             }
         }
@@ -604,7 +628,8 @@ void ITunesFeature::parseTrack(QXmlStreamReader &xml, QSqlQuery &query) {
     }
 }
 
-TreeItem* ITunesFeature::parsePlaylists(QXmlStreamReader &xml) {
+TreeItem* ITunesFeature::parsePlaylists(QXmlStreamReader &xml,
+                                        ScopedTransaction* pTransaction) {
     qDebug() << "Parse iTunes playlists";
     TreeItem* rootItem = new TreeItem(this);
     QSqlQuery query_insert_to_playlists(m_database);
@@ -616,14 +641,26 @@ TreeItem* ITunesFeature::parsePlaylists(QXmlStreamReader &xml) {
         "INSERT INTO itunes_playlist_tracks (playlist_id, track_id, position) "
         "VALUES (:playlist_id, :track_id, :position)");
 
+    // The playlists that have not been committed yet
+    QStringList newPlaylists;
     while (!xml.atEnd() && !m_cancelImport) {
         xml.readNext();
         //We process and iterate the <dict> tags holding playlist summary information here
         if (xml.isStartElement() && xml.name() == "dict") {
+            const int childRows = rootItem->childRows();
             parsePlaylist(xml,
                           query_insert_to_playlists,
                           query_insert_to_playlist_tracks,
                           rootItem);
+            if (rootItem->childRows() > childRows) {
+                newPlaylists << rootItem->child(childRows)->getLabel();
+            }
+            if (newPlaylists.size() >= kPlaylistsPerImportTransaction) {
+                pTransaction->commit();
+                pTransaction->transaction();
+                emit(playlistsImported(newPlaylists));
+                newPlaylists.clear();
+            }
             continue;
         }
         if (xml.isEndElement()) {
@@ -757,6 +794,12 @@ void ITunesFeature::clearTable(QString table_name) {
     }
 }
 
+void ITunesFeature::slotTracksImported() {
+    // Show the imported tracks while the playlists are being imported
+    m_trackSource->buildIndex();
+    emit(showTrackModel(m_pITunesTrackModel));
+}
+
 void ITunesFeature::onTrackCollectionLoaded() {
     std::unique_ptr<TreeItem> root(m_future.result());
     if (root) {
@@ -17,6 +17,7 @@
 
 class BaseExternalTrackModel;
 class BaseExternalPlaylistModel;
+class ScopedTransaction;
 
 class ITunesFeature : public BaseExternalLibraryFeature {
     Q_OBJECT
@@ -37,15 +38,26 @@ class ITunesFeature : public BaseExternalLibraryFeature {
     void onRightClick(const QPoint& globalPos);
     void onTrackCollectionLoaded();
 
+  signals:
+    // Emitted by the import thread after the tracks have been committed
+    void tracksImported();
+    // Emitted by the import thread after the given playlists have been
+    // committed
+    void playlistsImported(QStringList playlists);
+
+  private slots:
+    void slotTracksImported();
+
   private:
     virtual BaseSqlTableModel* getPlaylistModelForPlaylist(QString playlist);
     static QString getiTunesMusicPath();
     // returns the invisible rootItem for the sidebar model
-    TreeItem* importLibrary();
+    TreeItem* importLibrary(bool forceReload);
     void guessMusicLibraryMountpoint(QXmlStreamReader &xml);
-    void parseTracks(QXmlStreamReader &xml);
+    void parseTracks(QXmlStreamReader &xml, ScopedTransaction* pTransaction);
     void parseTrack(QXmlStreamReader &xml, QSqlQuery &query);
-    TreeItem* parsePlaylists(QXmlStreamReader &xml);
+    TreeItem* parsePlaylists(QXmlStreamReader &xml,
+                             ScopedTransaction* pTransaction);
     void parsePlaylist(QXmlStreamReader &xml, QSqlQuery &query1,
                        QSqlQuery &query2, TreeItem*);
     void clearTable(QString table_name);
@@ -72,6 +84,8 @@ class ITunesFeature : public BaseExternalLibraryFeature {
     QSharedPointer<BaseTrackCache> m_trackSource;
 
     static const QString ITDB_PATH_KEY;
+    // Identifies the XML file of the last complete import
+    static const QString ITDB_VERSION_KEY;
 };
 
 #endif // ITUNESFEATURE_H
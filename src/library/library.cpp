@@ -18,6 +18,7 @@
 #include "library/trackmodel.h"
 #include "library/browse/browsefeature.h"
 #include "library/crate/cratefeature.h"
+#include "library/duplicates/duplicatesfeature.h"
 #include "library/rhythmbox/rhythmboxfeature.h"
 #include "library/banshee/bansheefeature.h"
 #include "library/recording/recordingfeature.h"
@@ -89,6 +90,7 @@ Library::Library(
 
     kLogger.info() << "Connecting database";
     m_pTrackCollection->connectDatabase(dbConnection);
+    m_pTrackCollection->startSelectThread(m_pDbConnectionPool);
 
     qRegisterMetaType<Library::RemovalType>("Library::RemovalType");
 
@@ -130,6 +132,7 @@ Library::Library(
     connect(m_pCrateFeature, SIGNAL(analyzeTracks(QList<TrackId>)),
             m_pAnalysisFeature, SLOT(analyzeTracks(QList<TrackId>)));
     addFeature(m_pAnalysisFeature);
+    addFeature(new DuplicatesFeature(this, pConfig, m_pTrackCollection));
     //iTunes and Rhythmbox should be last until we no longer have an obnoxious
     //messagebox popup when you select them. (This forces you to reach for your
     //mouse or keyboard if you're using MIDI control and you scroll through them...)
@@ -100,6 +100,9 @@ class Library : public QObject {
     void scan() {
         m_scanner.scan();
     }
+    void scanModifiedDirectories() {
+        m_scanner.scanModifiedDirectories();
+    }
 
   signals:
     void showTrackModel(QAbstractItemModel* model);
@@ -90,6 +90,7 @@ MixxxLibraryFeature::MixxxLibraryFeature(Library* pLibrary,
 
     BaseTrackCache* pBaseTrackCache = new BaseTrackCache(
             pTrackCollection, tableName, LIBRARYTABLE_ID, columns, true);
+    pBaseTrackCache->setSearchIndex(&pTrackCollection->getSearchIndexDAO());
     connect(&m_trackDao, SIGNAL(trackDirty(TrackId)),
             pBaseTrackCache, SLOT(slotTrackDirty(TrackId)));
     connect(&m_trackDao, SIGNAL(trackClean(TrackId)),
@@ -166,6 +166,29 @@ void PlaylistTableModel::moveTrack(const QModelIndex& sourceIndex,
     m_pTrackCollection->getPlaylistDAO().moveTrack(m_iPlaylistId, oldPosition, newPosition);
 }
 
+void PlaylistTableModel::moveTracks(const QModelIndexList& sourceIndices,
+                                    const QModelIndex& destIndex) {
+    const int positionColumn = fieldIndex(ColumnCache::COLUMN_PLAYLISTTRACKSTABLE_POSITION);
+
+    QList<int> positions;
+    for (const QModelIndex& sourceIndex : sourceIndices) {
+        positions.append(sourceIndex.sibling(sourceIndex.row(), positionColumn).data().toInt());
+    }
+
+    int destPosition;
+    if (destIndex.isValid()) {
+        destPosition = destIndex.sibling(destIndex.row(), positionColumn).data().toInt();
+    } else {
+        // Dragged past the end of the rows
+        destPosition = m_pTrackCollection->getPlaylistDAO().getMaxPosition(m_iPlaylistId) + 1;
+    }
+    if (destPosition <= 0) {
+        return;
+    }
+
+    m_pTrackCollection->getPlaylistDAO().moveTracks(m_iPlaylistId, positions, destPosition);
+}
+
 bool PlaylistTableModel::isLocked() {
     return m_pTrackCollection->getPlaylistDAO().isPlaylistLocked(m_iPlaylistId);
 }
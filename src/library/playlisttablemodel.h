@@ -19,6 +19,8 @@ class PlaylistTableModel : public BaseSqlTableModel {
     bool appendTrack(TrackId trackId);
     void moveTrack(const QModelIndex& sourceIndex,
                    const QModelIndex& destIndex);
+    void moveTracks(const QModelIndexList& sourceIndices,
+                    const QModelIndex& destIndex) final;
     void removeTrack(const QModelIndex& index);
     void shuffleTracks(const QModelIndexList& shuffle, const QModelIndex& exclude);
 
@@ -0,0 +1,213 @@
+#include "library/previewcache.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutexLocker>
+#include <QWeakPointer>
+
+#include "util/logger.h"
+#include "util/math.h"
+
+namespace {
+
+const mixxx::Logger kLogger("PreviewCache");
+
+const quint32 kFileMagic = 0x4D585049; // "MXPI"
+const quint32 kFileVersion = 1;
+
+// Each intro takes 512 KiB, i.e. the default limit is sufficient for
+// about 2000 tracks.
+const int kDefaultMaxSizeMB = 1024;
+
+// More files than necessary are deleted when the limit is exceeded, so
+// that the directory doesn't need to be scanned again for each of the
+// next intros.
+const double kSizeRatioAfterDeletion = 0.9;
+
+// The duration of the audio source might slightly differ from the
+// duration in the metadata of the track.
+const double kMaxDurationDifference = 1.0; // in seconds
+
+} // anonymous namespace
+
+// static
+const SINT PreviewCache::kIntroFrameCount = 16 * 8192;
+
+PreviewCache::PreviewCache(const UserSettingsPointer& pConfig)
+        : m_storagePath(pConfig->getSettingsPath() + "/previews/"),
+          m_maxSizeBytes(qint64(pConfig->getValue(
+                  ConfigKey("[Library]", "PreviewCacheSizeMB"),
+                  kDefaultMaxSizeMB)) * 1024 * 1024),
+          m_pStorageSize(storageSize(m_storagePath.absolutePath())) {
+}
+
+// static
+QSharedPointer<PreviewCache::StorageSize> PreviewCache::storageSize(
+        const QString& storagePath) {
+    static QMutex mutex;
+    static QHash<QString, QWeakPointer<StorageSize>> storageSizes;
+    QMutexLocker locker(&mutex);
+    QSharedPointer<StorageSize> pStorageSize =
+            storageSizes.value(storagePath).toStrongRef();
+    if (!pStorageSize) {
+        pStorageSize = QSharedPointer<StorageSize>(new StorageSize());
+        storageSizes.insert(storagePath, pStorageSize);
+    }
+    return pStorageSize;
+}
+
+QString PreviewCache::getIntroFilePath(TrackId trackId) const {
+    return m_storagePath.absoluteFilePath(trackId.toString());
+}
+
+bool PreviewCache::readIntroHeader(QDataStream* pStream, Intro* pIntro) const {
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 sampleRate = 0;
+    qint64 frameCount = 0;
+    qint64 startFrame = 0;
+    *pStream >> magic >> version >> sampleRate >> frameCount >> startFrame;
+    if ((pStream->status() != QDataStream::Ok) ||
+            (magic != kFileMagic) || (version != kFileVersion) ||
+            (sampleRate <= 0) || (startFrame < 0) || (startFrame >= frameCount)) {
+        return false;
+    }
+    pIntro->sampleRate = sampleRate;
+    pIntro->frameCount = frameCount;
+    pIntro->startFrame = startFrame;
+    return true;
+}
+
+bool PreviewCache::hasIntro(TrackId trackId, SINT startFrame) const {
+    if (!trackId.isValid()) {
+        return false;
+    }
+    QFile file(getIntroFilePath(trackId));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    Intro intro;
+    return readIntroHeader(&stream, &intro) && (intro.startFrame == startFrame);
+}
+
+bool PreviewCache::loadIntro(const Track& track, Intro* pIntro) const {
+    DEBUG_ASSERT(pIntro);
+    const TrackId trackId = track.getId();
+    if (!trackId.isValid()) {
+        return false;
+    }
+    QFile file(getIntroFilePath(trackId));
+    if (!file.open(QIODevice::ReadOnly)) {
+        // The track has not been analyzed yet or its intro has been deleted
+        return false;
+    }
+    QDataStream stream(&file);
+    if (!readIntroHeader(&stream, pIntro)) {
+        kLogger.warning() << "Invalid intro" << file.fileName();
+        return false;
+    }
+    const double duration = double(pIntro->frameCount) / pIntro->sampleRate;
+    if ((pIntro->sampleRate != track.getSampleRate()) ||
+            (fabs(duration - track.getDuration()) > kMaxDurationDifference)) {
+        kLogger.debug() << "Ignoring outdated intro of" << track.getLocation();
+        return false;
+    }
+
+    qint64 sampleCount = (file.size() - file.pos()) / sizeof(SAMPLE);
+    sampleCount -= sampleCount % mixxx::AudioSource::kChannelCountStereo;
+    pIntro->samples.resize(sampleCount);
+    const int byteCount = sampleCount * sizeof(SAMPLE);
+    if ((byteCount <= 0) || (stream.readRawData(
+            reinterpret_cast<char*>(pIntro->samples.data()), byteCount) != byteCount)) {
+        kLogger.warning() << "Failed to read intro" << file.fileName();
+        pIntro->samples.clear();
+        return false;
+    }
+    return true;
+}
+
+bool PreviewCache::saveIntro(TrackId trackId, const Intro& intro) {
+    if (!trackId.isValid() || intro.samples.empty()) {
+        return false;
+    }
+    if (!QDir().mkpath(m_storagePath.absolutePath())) {
+        kLogger.warning() << "Failed to create directory"
+                << m_storagePath.absolutePath();
+        return false;
+    }
+
+    QFile file(getIntroFilePath(trackId));
+    const qint64 oldFileSize = file.size();
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        kLogger.warning() << "Failed to open" << file.fileName();
+        return false;
+    }
+    // The samples are written in native byte order, because the intros
+    // are only read on the same host.
+    QDataStream stream(&file);
+    stream << kFileMagic << kFileVersion
+           << qint32(intro.sampleRate)
+           << qint64(intro.frameCount)
+           << qint64(intro.startFrame);
+    const int byteCount = intro.samples.size() * sizeof(SAMPLE);
+    if ((stream.writeRawData(reinterpret_cast<const char*>(intro.samples.data()),
+                             byteCount) != byteCount) ||
+            (stream.status() != QDataStream::Ok)) {
+        kLogger.warning() << "Failed to write" << file.fileName();
+        file.remove();
+        return false;
+    }
+    file.close();
+
+    QMutexLocker locker(&m_pStorageSize->mutex);
+    if (m_pStorageSize->bytes < 0) {
+        m_pStorageSize->bytes = 0;
+        for (const auto& fileInfo: m_storagePath.entryInfoList(QDir::Files)) {
+            m_pStorageSize->bytes += fileInfo.size();
+        }
+    } else {
+        m_pStorageSize->bytes += file.size() - oldFileSize;
+    }
+    if (m_pStorageSize->bytes > m_maxSizeBytes) {
+        deleteOldestIntros();
+    }
+    return true;
+}
+
+void PreviewCache::deleteOldestIntros() {
+    m_storagePath.refresh();
+    // The files that have been modified first come first
+    const QFileInfoList fileInfos = m_storagePath.entryInfoList(
+            QDir::Files, QDir::Time | QDir::Reversed);
+    qint64 sizeBytes = 0;
+    for (const auto& fileInfo: fileInfos) {
+        sizeBytes += fileInfo.size();
+    }
+    const qint64 maxSizeBytes = m_maxSizeBytes * kSizeRatioAfterDeletion;
+    int deletedFiles = 0;
+    for (const auto& fileInfo: fileInfos) {
+        if (sizeBytes <= maxSizeBytes) {
+            break;
+        }
+        if (QFile::remove(fileInfo.absoluteFilePath())) {
+            sizeBytes -= fileInfo.size();
+            ++deletedFiles;
+        }
+    }
+    m_pStorageSize->bytes = sizeBytes;
+    kLogger.debug() << "Deleted" << deletedFiles << "intros";
+}
+
+void PreviewCache::deleteIntros(const QList<TrackId>& trackIds) const {
+    QMutexLocker locker(&m_pStorageSize->mutex);
+    for (const auto& trackId: trackIds) {
+        const QFileInfo fileInfo(getIntroFilePath(trackId));
+        const qint64 fileSize = fileInfo.size();
+        if (QFile::remove(fileInfo.absoluteFilePath()) &&
+                (m_pStorageSize->bytes >= 0)) {
+            m_pStorageSize->bytes -= fileSize;
+        }
+    }
+}
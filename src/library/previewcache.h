@@ -0,0 +1,90 @@
+#ifndef MIXXX_LIBRARY_PREVIEWCACHE_H
+#define MIXXX_LIBRARY_PREVIEWCACHE_H
+
+#include <QDataStream>
+#include <QDir>
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+
+#include <vector>
+
+#include "preferences/usersettings.h"
+#include "sources/audiosource.h"
+#include "track/track.h"
+#include "util/types.h"
+
+// Stores the decoded audio at the position where the preview of a track
+// starts, i.e. at its cue point, in small files next to the analyses. A
+// preview deck plays this intro immediately while the audio source of the
+// track is still being opened, which may take a while for files on network
+// storage. The intros are written during the analysis and the oldest files
+// are deleted when the cache exceeds its size limit.
+//
+// The analyzer, the caching readers and the track collection each own an
+// instance on their own thread. All instances with the same storage path
+// share the accounting of the size, so the limit applies to the directory
+// and not to each instance.
+class PreviewCache {
+  public:
+    // About 3 s at 44.1 kHz. The intros are read into the chunks of the
+    // CachingReader and their size must be a multiple of the chunk size.
+    static const SINT kIntroFrameCount;
+
+    struct Intro {
+        Intro()
+                : sampleRate(0),
+                  frameCount(0),
+                  startFrame(0) {
+        }
+
+        SINT getIntroFrameCount() const {
+            return samples.size() / mixxx::AudioSource::kChannelCountStereo;
+        }
+
+        // The audio source of the track
+        SINT sampleRate;
+        SINT frameCount;
+        // The first frame of the intro in the track
+        SINT startFrame;
+        // Interleaved stereo samples
+        std::vector<SAMPLE> samples;
+    };
+
+    explicit PreviewCache(const UserSettingsPointer& pConfig);
+
+    // Returns true if an intro that starts at the given frame is stored.
+    bool hasIntro(TrackId trackId, SINT startFrame) const;
+    // Only loads intros that match the sample rate and the duration of
+    // the track. Otherwise the file has been modified since it has been
+    // analyzed.
+    bool loadIntro(const Track& track, Intro* pIntro) const;
+    bool saveIntro(TrackId trackId, const Intro& intro);
+    void deleteIntros(const QList<TrackId>& trackIds) const;
+
+  private:
+    struct StorageSize {
+        StorageSize()
+                : bytes(-1) {
+        }
+
+        QMutex mutex;
+        // The size of all files, which is only calculated when the first
+        // intro is saved. Negative until then.
+        qint64 bytes;
+    };
+
+    // Returns the shared size of the storage path
+    static QSharedPointer<StorageSize> storageSize(const QString& storagePath);
+
+    QString getIntroFilePath(TrackId trackId) const;
+    bool readIntroHeader(QDataStream* pStream, Intro* pIntro) const;
+    // Must be called while the mutex of the storage size is locked
+    void deleteOldestIntros();
+
+    QDir m_storagePath;
+    const qint64 m_maxSizeBytes;
+    const QSharedPointer<StorageSize> m_pStorageSize;
+};
+
+#endif // MIXXX_LIBRARY_PREVIEWCACHE_H
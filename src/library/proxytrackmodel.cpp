@@ -87,6 +87,18 @@ void ProxyTrackModel::moveTrack(const QModelIndex& sourceIndex,
     }
 }
 
+void ProxyTrackModel::moveTracks(const QModelIndexList& sourceIndices,
+                                 const QModelIndex& destIndex) {
+    QModelIndexList translatedList;
+    for (const QModelIndex& sourceIndex : sourceIndices) {
+        translatedList.append(mapToSource(sourceIndex));
+    }
+    QModelIndex destIndexSource = mapToSource(destIndex);
+    if (m_pTrackModel) {
+        m_pTrackModel->moveTracks(translatedList, destIndexSource);
+    }
+}
+
 QAbstractItemDelegate* ProxyTrackModel::delegateForColumn(const int i, QObject* pParent) {
     return m_pTrackModel ? m_pTrackModel->delegateForColumn(i, pParent) : NULL;
 }
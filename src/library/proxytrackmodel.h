@@ -34,6 +34,7 @@ class ProxyTrackModel : public QSortFilterProxyModel, public TrackModel {
     bool isColumnHiddenByDefault(int column) final;
     void removeTracks(const QModelIndexList& indices) final;
     void moveTrack(const QModelIndex& sourceIndex, const QModelIndex& destIndex) final;
+    void moveTracks(const QModelIndexList& sourceIndices, const QModelIndex& destIndex) final;
     QAbstractItemDelegate* delegateForColumn(const int i, QObject* pParent) final;
     QString getModelSetting(QString name) final;
     bool setModelSetting(QString name, QVariant value) final;
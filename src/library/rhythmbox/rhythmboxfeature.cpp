@@ -7,9 +7,36 @@
 
 #include "library/baseexternaltrackmodel.h"
 #include "library/baseexternalplaylistmodel.h"
+#include "library/dao/settingsdao.h"
 #include "library/treeitem.h"
 #include "library/queryutil.h"
 
+namespace {
+
+// Identifies the database files of the last complete import
+const QString kDatabaseVersionKey = "mixxx.rhythmboxfeature.databaseversion";
+
+// The directories in which Rhythmbox stores its database files, the
+// preferred one first
+QStringList rhythmboxDirectories() {
+    return QStringList()
+            << QDir::homePath() + "/.gnome2/rhythmbox/"
+            << QDir::homePath() + "/.local/share/rhythmbox/";
+}
+
+// Returns the path of the given database file or an empty string if it
+// doesn't exist
+QString rhythmboxFilePath(const QString& fileName) {
+    for (const auto& directory: rhythmboxDirectories()) {
+        if (QFile::exists(directory + fileName)) {
+            return directory + fileName;
+        }
+    }
+    return QString();
+}
+
+}  // anonymous namespace
+
 RhythmboxFeature::RhythmboxFeature(QObject* parent, TrackCollection* pTrackCollection)
         : BaseExternalLibraryFeature(parent, pTrackCollection),
           m_pTrackCollection(pTrackCollection),
@@ -68,6 +95,12 @@ RhythmboxFeature::RhythmboxFeature(QObject* parent, TrackCollection* pTrackColle
     connect(&m_track_watcher, SIGNAL(finished()),
             this, SLOT(onTrackCollectionLoaded()),
             Qt::QueuedConnection);
+    connect(this, SIGNAL(tracksImported()),
+            this, SLOT(slotTracksImported()),
+            Qt::QueuedConnection);
+    connect(this, SIGNAL(playlistsImported(QStringList)),
+            this, SLOT(slotPlaylistsImported(QStringList)),
+            Qt::QueuedConnection);
 }
 
 RhythmboxFeature::~RhythmboxFeature() {
@@ -91,8 +124,7 @@ BaseSqlTableModel* RhythmboxFeature::getPlaylistModelForPlaylist(QString playlis
 }
 
 bool RhythmboxFeature::isSupported() {
-    return (QFile::exists(QDir::homePath() + "/.gnome2/rhythmbox/rhythmdb.xml") ||
-            QFile::exists(QDir::homePath() + "/.local/share/rhythmbox/rhythmdb.xml"));
+    return !rhythmboxFilePath("rhythmdb.xml").isEmpty();
 }
 
 QVariant RhythmboxFeature::title() {
@@ -112,15 +144,9 @@ void RhythmboxFeature::activate() {
 
     if (!m_isActivated) {
         m_isActivated =  true;
-        // Ususally the maximum number of threads
-        // is > 2 depending on the CPU cores
-        // Unfortunately, within VirtualBox
-        // the maximum number of allowed threads
-        // is 1 at all times We'll need to increase
-        // the number to > 1, otherwise importing the music collection
-        // takes place when the GUI threads terminates, i.e., on
-        // Mixxx shutdown.
-        QThreadPool::globalInstance()->setMaxThreadCount(4); //Tobias decided to use 4
+        // Playlists are added to the new root item while they are imported
+        m_childModel.setRootItem(std::make_unique<TreeItem>(this));
+        reserveImportThread();
         m_track_future = QtConcurrent::run(this, &RhythmboxFeature::importMusicCollection);
         m_track_watcher.setFuture(m_track_future);
         m_title = "(loading) Rhythmbox";
@@ -145,12 +171,23 @@ TreeItem* RhythmboxFeature::importMusicCollection() {
     qDebug() << "importMusicCollection Thread Id: " << QThread::currentThread();
      // Try and open the Rhythmbox DB. An API call which tells us where
      // the file is would be nice.
-    QFile db(QDir::homePath() + "/.gnome2/rhythmbox/rhythmdb.xml");
+    QFile db(rhythmboxFilePath("rhythmdb.xml"));
     if (!db.exists()) {
-        db.setFileName(QDir::homePath() + "/.local/share/rhythmbox/rhythmdb.xml");
-        if (!db.exists()) {
-            return NULL;
-        }
+        return NULL;
+    }
+
+    // The tables still hold the result of the last complete import if none
+    // of the database files has been touched since then.
+    QStringList sourceFiles;
+    for (const auto& directory: rhythmboxDirectories()) {
+        sourceFiles << directory + "rhythmdb.xml"
+                    << directory + "playlists.xml";
+    }
+    const QString sourceVersion = sourceFilesVersion(sourceFiles);
+    SettingsDAO settings(m_database);
+    if (settings.getValue(kDatabaseVersionKey) == sourceVersion) {
+        qDebug() << "Rhythmbox music collection is unchanged since the last import";
+        return loadImportedPlaylists(m_database, "rhythmbox_playlists");
     }
 
     if (!db.open(QIODevice::ReadOnly | QIODevice::Text))
@@ -158,6 +195,8 @@ TreeItem* RhythmboxFeature::importMusicCollection() {
 
     //Delete all table entries of Traktor feature
     ScopedTransaction transaction(m_database);
+    // The tables are incomplete until the import has finished
+    settings.setValue(kDatabaseVersionKey, QString());
     clearTable("rhythmbox_playlist_tracks");
     clearTable("rhythmbox_library");
     clearTable("rhythmbox_playlists");
@@ -173,6 +212,7 @@ TreeItem* RhythmboxFeature::importMusicCollection() {
 
 
     QXmlStreamReader xml(&db);
+    int trackCount = 0;
     while (!xml.atEnd() && !m_cancelImport) {
         xml.readNext();
         if (xml.isStartElement() && xml.name() == "entry") {
@@ -180,6 +220,10 @@ TreeItem* RhythmboxFeature::importMusicCollection() {
             //Check if we really parse a track and not album art information
             if (attr.value("type").toString() == "song") {
                 importTrack(xml, query);
+                if (++trackCount % kTracksPerImportTransaction == 0) {
+                    transaction.commit();
+                    transaction.transaction();
+                }
             }
         }
     }
@@ -196,21 +240,28 @@ TreeItem* RhythmboxFeature::importMusicCollection() {
     if (m_cancelImport) {
         return NULL;
     }
-    return importPlaylists();
+    // All tracks have been imported
+    emit(tracksImported());
+    TreeItem* rootItem = importPlaylists();
+    if (rootItem && !m_cancelImport) {
+        settings.setValue(kDatabaseVersionKey, sourceVersion);
+    }
+    return rootItem;
 }
 
 TreeItem* RhythmboxFeature::importPlaylists() {
-    QFile db(QDir::homePath() + "/.gnome2/rhythmbox/playlists.xml");
+    QFile db(rhythmboxFilePath("playlists.xml"));
     if (!db.exists()) {
-        db.setFileName(QDir::homePath() + "/.local/share/rhythmbox/playlists.xml");
-        if (!db.exists()) {
-            return NULL;
-        }
+        return NULL;
     }
     //Open file
      if (!db.open(QIODevice::ReadOnly | QIODevice::Text))
         return NULL;
 
+    ScopedTransaction transaction(m_database);
+    // The playlists that have not been committed yet
+    QStringList newPlaylists;
+
     QSqlQuery query_insert_to_playlists(m_database);
     query_insert_to_playlists.prepare("INSERT INTO rhythmbox_playlists (id, name) "
                                       "VALUES (:id, :name)");
@@ -249,9 +300,19 @@ TreeItem* RhythmboxFeature::importPlaylists() {
 
                 //Process playlist entries
                 importPlaylist(xml, query_insert_to_playlist_tracks, playlist_id);
+
+                newPlaylists << playlist_name;
+                if (newPlaylists.size() >= kPlaylistsPerImportTransaction) {
+                    transaction.commit();
+                    transaction.transaction();
+                    emit(playlistsImported(newPlaylists));
+                    newPlaylists.clear();
+                }
             }
         }
     }
+    // Even if an error occurred, commit the playlists that have been parsed
+    transaction.commit();
 
     if (xml.hasError()) {
         // do error handling
@@ -433,6 +494,12 @@ void RhythmboxFeature::clearTable(QString table_name) {
     }
 }
 
+void RhythmboxFeature::slotTracksImported() {
+    // Show the imported tracks while the playlists are being imported
+    m_trackSource->buildIndex();
+    emit(showTrackModel(m_pRhythmboxTrackModel));
+}
+
 void RhythmboxFeature::onTrackCollectionLoaded() {
     std::unique_ptr<TreeItem> root(m_track_future.result());
     if (root) {
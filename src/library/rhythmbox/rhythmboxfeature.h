@@ -39,6 +39,16 @@ class RhythmboxFeature : public BaseExternalLibraryFeature {
     void activateChild(const QModelIndex& index);
     void onTrackCollectionLoaded();
 
+  signals:
+    // Emitted by the import thread after the tracks have been committed
+    void tracksImported();
+    // Emitted by the import thread after the given playlists have been
+    // committed
+    void playlistsImported(QStringList playlists);
+
+  private slots:
+    void slotTracksImported();
+
   private:
     virtual BaseSqlTableModel* getPlaylistModelForPlaylist(QString playlist);
     // Removes all rows from a given table
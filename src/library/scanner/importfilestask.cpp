@@ -1,13 +1,22 @@
 #include "library/scanner/importfilestask.h"
 
 #include "library/scanner/libraryscanner.h"
+#include "sources/soundsourceproxy.h"
 #include "util/timer.h"
 
+namespace {
+
+// New tracks are passed to the library scanner in batches of this size
+const int kTrackBatchSize = 32;
+
+} // anonymous namespace
+
 ImportFilesTask::ImportFilesTask(LibraryScanner* pScanner,
                                  const ScannerGlobalPointer scannerGlobal,
                                  const QString& dirPath,
                                  const bool prevHashExists,
                                  const int newHash,
+                                 const qint64 mtime,
                                  const QLinkedList<QFileInfo>& filesToImport,
                                  const QLinkedList<QFileInfo>& possibleCovers,
                                  SecurityTokenPointer pToken)
@@ -15,6 +24,7 @@ ImportFilesTask::ImportFilesTask(LibraryScanner* pScanner,
           m_dirPath(dirPath),
           m_prevHashExists(prevHashExists),
           m_newHash(newHash),
+          m_mtime(mtime),
           m_filesToImport(filesToImport),
           m_possibleCovers(possibleCovers),
           m_pToken(pToken) {
@@ -22,6 +32,7 @@ ImportFilesTask::ImportFilesTask(LibraryScanner* pScanner,
 
 void ImportFilesTask::run() {
     ScopedTimer timer("ImportFilesTask::run");
+    QList<TrackPointer> newTracks;
     for (const QFileInfo& fileInfo: m_filesToImport) {
         // If a flag was raised telling us to cancel the library scan then stop.
         if (m_scannerGlobal->shouldCancel()) {
@@ -47,12 +58,60 @@ void ImportFilesTask::run() {
                         << filePath;
                 continue;
             }
-            qDebug() << "Importing track" << filePath;
+            if (!SoundSourceProxy::isFileSupported(fileInfo)) {
+                qWarning() << "ImportFilesTask: Skipping unsupported file"
+                        << filePath;
+                emit(trackSkipped(filePath));
+                continue;
+            }
+
+            if (!m_scannerGlobal->tryAcquirePendingTrack()) {
+                // The database is falling behind. Hand over the tracks
+                // parsed so far before waiting, otherwise the parser
+                // threads could block each other.
+                if (!newTracks.isEmpty()) {
+                    emit(addNewTracks(newTracks));
+                    newTracks.clear();
+                }
+                if (!m_scannerGlobal->acquirePendingTrack()) {
+                    setSuccess(false);
+                    return;
+                }
+            }
 
-            emit(addNewTrack(filePath));
+            qDebug() << "Importing track" << filePath;
+            newTracks.append(parseTrack(fileInfo));
+            m_scannerGlobal->trackParsed();
+            if (newTracks.size() >= kTrackBatchSize) {
+                emit(addNewTracks(newTracks));
+                newTracks.clear();
+            }
         }
     }
+    if (!newTracks.isEmpty()) {
+        emit(addNewTracks(newTracks));
+    }
     // Insert or update the hash in the database.
-    emit(directoryHashedAndScanned(m_dirPath, !m_prevHashExists, m_newHash));
+    emit(directoryHashedAndScanned(m_dirPath, !m_prevHashExists, m_newHash,
+                                   m_mtime));
     setSuccess(true);
 }
+
+TrackPointer ImportFilesTask::parseTrack(const QFileInfo& fileInfo) const {
+    TrackPointer pTrack(Track::newTemporary(fileInfo));
+    // The threads of the pool have no event loop for deleting the track
+    // later. Beats that are created while parsing follow the track into
+    // the library scanner thread.
+    pTrack->moveToThread(m_pScanner->thread());
+
+    // Initially load the metadata for the newly created track
+    // from the file.
+    SoundSourceProxy(pTrack).updateTrack();
+    if (!pTrack->isHeaderParsed()) {
+        qWarning() << "ImportFilesTask: Failed to parse track metadata from file"
+                << pTrack->getLocation();
+        // Continue with adding the track to the library, no matter
+        // if parsing the metadata from file succeeded or failed.
+    }
+    return pTrack;
+}
@@ -10,6 +10,10 @@
 
 // Import the provided files. Successful if the scan completed without being
 // cancelled. False if the scan was cancelled part-way through.
+//
+// The metadata of new files is parsed by this task, so that several parser
+// threads keep the library scanner thread busy with adding the tracks to
+// the database.
 class ImportFilesTask : public ScannerTask {
     Q_OBJECT
   public:
@@ -18,6 +22,7 @@ class ImportFilesTask : public ScannerTask {
                     const QString& dirPath,
                     const bool prevHashExists,
                     const int newHash,
+                    const qint64 mtime,
                     const QLinkedList<QFileInfo>& filesToImport,
                     const QLinkedList<QFileInfo>& possibleCovers,
                     SecurityTokenPointer pToken);
@@ -26,9 +31,12 @@ class ImportFilesTask : public ScannerTask {
     virtual void run();
 
   private:
+    TrackPointer parseTrack(const QFileInfo& fileInfo) const;
+
     const QString m_dirPath;
     const bool m_prevHashExists;
     const int m_newHash;
+    const qint64 m_mtime;
     const QLinkedList<QFileInfo> m_filesToImport;
     const QLinkedList<QFileInfo> m_possibleCovers;
     SecurityTokenPointer m_pToken;
@@ -10,6 +10,7 @@
 #include "util/logger.h"
 #include "util/trace.h"
 #include "util/file.h"
+#include "util/math.h"
 #include "util/timer.h"
 #include "library/scanner/scannerutil.h"
 #include "util/db/dbconnectionpooler.h"
@@ -20,6 +21,23 @@ namespace {
 // TODO(rryan) make configurable
 const int kScannerThreadPoolSize = 1;
 
+// Parsing metadata is mostly waiting for I/O, especially for libraries on
+// network shares, so use at least a few threads.
+const int kMinParserThreadPoolSize = 4;
+
+const mixxx::Duration kThroughputReportInterval =
+        mixxx::Duration::fromMillis(1000);
+
+// Delay between the last change notification of the file system watcher
+// and the start of the incremental scan.
+const int kChangedDirsDelayMillis = 2000;
+
+// Each watched directory consumes a kernel resource (an inotify watch on
+// Linux, a handle on Windows). Huge libraries are only checked at startup.
+const int kMaxWatchedDirectories = 16384;
+
+const ConfigKey kWatchDirectoriesConfigKey("[Library]", "WatchDirectories");
+
 mixxx::Logger kLogger("LibraryScanner");
 
 QAtomicInt s_instanceCounter(0);
@@ -31,28 +49,43 @@ LibraryScanner::LibraryScanner(
         TrackCollection* pTrackCollection,
         const UserSettingsPointer& pConfig)
         : m_pDbConnectionPool(std::move(pDbConnectionPool)),
+          m_pConfig(pConfig),
           m_pTrackCollection(pTrackCollection),
           m_analysisDao(pConfig),
           m_trackDao(m_cueDao, m_playlistDao,
                   m_analysisDao, m_libraryHashDao,
                   pConfig),
           m_stateSema(1), // only one transaction is possible at a time
-          m_state(IDLE) {
+          m_state(IDLE),
+          m_bScanModifiedDirs(false) {
     // Move LibraryScanner to its own thread so that our signals/slots will
     // queue to our event loop.
     kLogger.debug() << "Starting thread";
     moveToThread(this);
     m_pool.moveToThread(this);
+    m_parserPool.moveToThread(this);
+    m_changedDirsTimer.moveToThread(this);
 
     const int instanceId = s_instanceCounter.fetchAndAddAcquire(1) + 1;
     setObjectName(QString("LibraryScanner %1").arg(instanceId));
 
     m_pool.setMaxThreadCount(kScannerThreadPoolSize);
+    m_parserPool.setMaxThreadCount(
+            math_max(kMinParserThreadPoolSize, QThread::idealThreadCount()));
+
+    qRegisterMetaType<QList<TrackPointer>>("QList<TrackPointer>");
+
+    m_changedDirsTimer.setSingleShot(true);
+    m_changedDirsTimer.setInterval(kChangedDirsDelayMillis);
+    connect(&m_changedDirsTimer, SIGNAL(timeout()),
+            this, SLOT(slotScanPendingDirectories()));
 
     // Listen to signals from our public methods (invoked by other threads) and
     // connect them to our slots to run the command on the scanner thread.
     connect(this, SIGNAL(startScan()),
             this, SLOT(slotStartScan()));
+    connect(this, SIGNAL(startIncrementalScan()),
+            this, SLOT(slotStartIncrementalScan()));
 
     // Force the GUI thread's Track cache to be cleared when a library
     // scan is finished, because we might have modified the database directly
@@ -72,6 +105,8 @@ LibraryScanner::LibraryScanner(
             m_pProgressDlg.data(), SLOT(slotUpdate(QString)));
     connect(this, SIGNAL(progressHashing(QString)),
             m_pProgressDlg.data(), SLOT(slotUpdate(QString)));
+    connect(this, SIGNAL(progressThroughput(double, double, double)),
+            m_pProgressDlg.data(), SLOT(slotUpdateThroughput(double, double, double)));
     connect(this, SIGNAL(scanStarted()),
             m_pProgressDlg.data(), SLOT(slotScanStarted()));
     connect(this, SIGNAL(scanFinished()),
@@ -111,10 +146,23 @@ void LibraryScanner::run() {
         m_analysisDao.initialize(dbConnection);
         m_directoryDao.initialize(dbConnection);
 
+        updateWatchedDirectories();
+
         // Start the event loop.
         kLogger.debug() << "Event loop starting";
         exec();
         kLogger.debug() << "Event loop stopped";
+
+        // Both live in this thread
+        m_changedDirsTimer.stop();
+        m_pWatcher.reset();
+
+        // Release the cached prepared statements before the
+        // thread-local connection is closed
+        m_cueDao.initialize(QSqlDatabase());
+        m_trackDao.initialize(QSqlDatabase());
+        m_playlistDao.initialize(QSqlDatabase());
+        m_analysisDao.initialize(QSqlDatabase());
     }
     kLogger.debug() << "Exiting thread";
 }
@@ -133,21 +181,14 @@ void LibraryScanner::slotStartScan() {
     }
     changeScannerState(SCANNING);
 
-    QSet<QString> trackLocations = m_trackDao.getTrackLocations();
-    QHash<QString, int> directoryHashes = m_libraryHashDao.getDirectoryHashes();
-    QRegExp extensionFilter(SoundSourceProxy::getSupportedFileNamesRegex());
-    QRegExp coverExtensionFilter =
-            QRegExp(CoverArtUtils::supportedCoverArtExtensionsRegex(),
-                    Qt::CaseInsensitive);
-    QStringList directoryBlacklist = ScannerUtil::getDirectoryBlacklist();
-
-    m_scannerGlobal = ScannerGlobalPointer(
-            new ScannerGlobal(trackLocations, directoryHashes, extensionFilter,
-                              coverExtensionFilter, directoryBlacklist));
-
-    m_scannerGlobal->startTimer();
+    // A full scan covers all changes that have been reported so far.
+    {
+        QMutexLocker locker(&m_changedDirsMutex);
+        m_changedDirs.clear();
+        m_bScanModifiedDirs = false;
+    }
 
-    emit(scanStarted());
+    initScannerGlobal();
 
     // First, we're going to mark all the directories that we've previously
     // hashed as needing verification. As we search through the directory tree
@@ -194,6 +235,215 @@ void LibraryScanner::slotStartScan() {
     pWatcher->taskDone();
 }
 
+void LibraryScanner::slotStartIncrementalScan() {
+    kLogger.debug() << "slotStartIncrementalScan()";
+    DEBUG_ASSERT(m_state == STARTING);
+
+    m_libraryRootDirs = m_directoryDao.getDirs();
+    QSet<QString> changedDirPaths;
+    foreach (const QString& dirPath, takeChangedDirectories()) {
+        if (!isInLibraryRootDir(dirPath)) {
+            continue;
+        }
+        changedDirPaths.insert(dirPath);
+        // A watched directory that has been moved or deleted is reported
+        // without its subdirectories. They are gone too and their tracks
+        // must be marked as missing to detect moved tracks.
+        if (!QDir(dirPath).exists()) {
+            foreach (const QString& subdirPath,
+                    m_libraryHashDao.getSubdirectories(dirPath)) {
+                changedDirPaths.insert(subdirPath);
+            }
+        }
+    }
+    const QStringList dirPaths = changedDirPaths.toList();
+    if (dirPaths.isEmpty()) {
+        changeScannerState(IDLE);
+        return;
+    }
+    changeScannerState(SCANNING);
+
+    initScannerGlobal();
+
+    // Only the changed directories and the tracks in them need to be
+    // verified. Deleted directories are not scanned and will be marked as
+    // deleted together with their tracks when cleaning up.
+    m_libraryHashDao.invalidateDirectories(dirPaths);
+    m_trackDao.invalidateTrackLocationsInDirectories(dirPaths);
+
+    kLogger.debug() << "Scanning" << dirPaths.size() << "changed directories.";
+
+    m_trackDao.addTracksPrepare();
+
+    // There is no need for a second stage, because only new directories are
+    // scanned recursively.
+    TaskWatcher* pWatcher = &m_scannerGlobal->getTaskWatcher();
+    pWatcher->watchTask();
+    connect(pWatcher, SIGNAL(allTasksDone()),
+            this, SLOT(slotFinishUnhashedScan()));
+
+    foreach (const QString& dirPath, dirPaths) {
+        MDir dir(dirPath);
+        if (!dir.dir().exists()) {
+            continue;
+        }
+        if (!m_scannerGlobal->testAndMarkDirectoryScanned(dir.dir())) {
+            queueTask(new RecursiveScanDirectoryTask(this, m_scannerGlobal,
+                                                     dir.dir(),
+                                                     dir.token(),
+                                                     true,
+                                                     false));
+        }
+    }
+    pWatcher->taskDone();
+}
+
+QStringList LibraryScanner::takeChangedDirectories() {
+    QSet<QString> dirPaths;
+    bool bScanModifiedDirs;
+    {
+        QMutexLocker locker(&m_changedDirsMutex);
+        dirPaths.swap(m_changedDirs);
+        bScanModifiedDirs = m_bScanModifiedDirs;
+        m_bScanModifiedDirs = false;
+    }
+
+    if (bScanModifiedDirs) {
+        // The modification times stored by the last scan serve as the
+        // journal of what has already been scanned. Directories that no
+        // longer exist are included to mark them as deleted.
+        PerformanceTimer timer;
+        timer.start();
+        const QHash<QString, qint64> mtimes =
+                m_libraryHashDao.getDirectoryModificationTimes();
+        int modifiedDirs = 0;
+        for (auto it = mtimes.constBegin(); it != mtimes.constEnd(); ++it) {
+            if (ScannerUtil::getDirectoryModificationTime(it.key()) != it.value()) {
+                dirPaths.insert(it.key());
+                ++modifiedDirs;
+            }
+        }
+        kLogger.debug() << "Found" << modifiedDirs << "of" << mtimes.size()
+                        << "directories modified in"
+                        << timer.elapsed().debugMillisWithUnit();
+    }
+
+    return dirPaths.toList();
+}
+
+bool LibraryScanner::hasPendingChangedDirectories() {
+    QMutexLocker locker(&m_changedDirsMutex);
+    return !m_changedDirs.isEmpty() || m_bScanModifiedDirs;
+}
+
+bool LibraryScanner::isInLibraryRootDir(const QString& dirPath) const {
+    foreach (const QString& rootDirPath, m_libraryRootDirs) {
+        if (dirPath == rootDirPath) {
+            return true;
+        }
+        const QString prefix = rootDirPath.endsWith('/') ?
+                rootDirPath : rootDirPath + '/';
+        if (dirPath.startsWith(prefix)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void LibraryScanner::initScannerGlobal() {
+    QSet<QString> trackLocations = m_trackDao.getTrackLocations();
+    QHash<QString, int> directoryHashes = m_libraryHashDao.getDirectoryHashes();
+    QHash<QString, qint64> directoryModificationTimes =
+            m_libraryHashDao.getDirectoryModificationTimes();
+    QRegExp extensionFilter(SoundSourceProxy::getSupportedFileNamesRegex());
+    QRegExp coverExtensionFilter =
+            QRegExp(CoverArtUtils::supportedCoverArtExtensionsRegex(),
+                    Qt::CaseInsensitive);
+    QStringList directoryBlacklist = ScannerUtil::getDirectoryBlacklist();
+
+    m_scannerGlobal = ScannerGlobalPointer(
+            new ScannerGlobal(trackLocations, directoryHashes,
+                              directoryModificationTimes, extensionFilter,
+                              coverExtensionFilter, directoryBlacklist));
+
+    m_scannerGlobal->startTimer();
+    m_throughputTimer.start();
+
+    emit(scanStarted());
+}
+
+void LibraryScanner::updateWatchedDirectories() {
+    if (!m_pConfig->getValue<bool>(kWatchDirectoriesConfigKey, false)) {
+        m_pWatcher.reset();
+        return;
+    }
+
+    const QStringList dirPaths =
+            m_libraryHashDao.getDirectoryModificationTimes().keys();
+    if (dirPaths.size() > kMaxWatchedDirectories) {
+        kLogger.warning()
+                << "Not watching" << dirPaths.size()
+                << "library directories for changes. The limit is"
+                << kMaxWatchedDirectories;
+        m_pWatcher.reset();
+        return;
+    }
+
+    if (!m_pWatcher) {
+        m_pWatcher.reset(new QFileSystemWatcher());
+        connect(m_pWatcher.data(), SIGNAL(directoryChanged(QString)),
+                this, SLOT(slotWatchedDirectoryChanged(QString)));
+    }
+
+    const QSet<QString> knownDirPaths = dirPaths.toSet();
+    const QSet<QString> watchedDirPaths = m_pWatcher->directories().toSet();
+    QStringList removedDirPaths;
+    foreach (const QString& dirPath, watchedDirPaths) {
+        if (!knownDirPaths.contains(dirPath)) {
+            removedDirPaths.append(dirPath);
+        }
+    }
+    if (!removedDirPaths.isEmpty()) {
+        m_pWatcher->removePaths(removedDirPaths);
+    }
+    QStringList addedDirPaths;
+    foreach (const QString& dirPath, dirPaths) {
+        if (!watchedDirPaths.contains(dirPath)) {
+            addedDirPaths.append(dirPath);
+        }
+    }
+    if (!addedDirPaths.isEmpty()) {
+        m_pWatcher->addPaths(addedDirPaths);
+    }
+
+    const int watchedDirs = m_pWatcher->directories().size();
+    if (watchedDirs < dirPaths.size()) {
+        // e.g. the inotify watch limit of the user has been reached
+        kLogger.warning()
+                << "Only" << watchedDirs << "of" << dirPaths.size()
+                << "library directories are watched for changes";
+    } else {
+        kLogger.debug() << "Watching" << watchedDirs << "directories";
+    }
+}
+
+void LibraryScanner::slotWatchedDirectoryChanged(const QString& dirPath) {
+    {
+        QMutexLocker locker(&m_changedDirsMutex);
+        m_changedDirs.insert(dirPath);
+    }
+    // Restart the timer to wait until the changes have settled
+    m_changedDirsTimer.start();
+}
+
+void LibraryScanner::slotScanPendingDirectories() {
+    // If a scan is in progress the directories are scanned after it has
+    // finished.
+    if (changeScannerState(STARTING)) {
+        slotStartIncrementalScan();
+    }
+}
+
 // is called when all tasks of the first stage are done (threads are finished)
 void LibraryScanner::slotFinishHashedScan() {
     kLogger.debug() << "slotFinishHashedScan";
@@ -341,18 +591,31 @@ void LibraryScanner::slotFinishUnhashedScan() {
            "%d unchanged directories. "
            "%d changed/added directories. "
            "%d tracks verified from changed/added directories. "
-           "%d new tracks.",
+           "%d new tracks. "
+           "%d skipped files. "
+           "%d walked directories. "
+           "%d parsed files.",
            m_scannerGlobal->timerElapsed().formatNanosWithUnit().toLocal8Bit().constData(),
            m_scannerGlobal->verifiedDirectories().size(),
            m_scannerGlobal->numScannedDirectories(),
            m_scannerGlobal->verifiedTracks().size(),
-           m_scannerGlobal->addedTracks().size());
+           m_scannerGlobal->addedTracks().size(),
+           m_scannerGlobal->numSkippedTracks(),
+           m_scannerGlobal->numWalkedDirectories(),
+           m_scannerGlobal->numParsedTracks());
 
+    const bool bCancelled = m_scannerGlobal->shouldCancel();
     m_scannerGlobal.clear();
     changeScannerState(FINISHED);
     // now we may accept new scan commands
 
     emit(scanFinished());
+
+    updateWatchedDirectories();
+    // Scan the directories that have changed in the meantime
+    if (!bCancelled && hasPendingChangedDirectories()) {
+        m_changedDirsTimer.start();
+    }
 }
 
 void LibraryScanner::scan() {
@@ -361,6 +624,16 @@ void LibraryScanner::scan() {
     }
 }
 
+void LibraryScanner::scanModifiedDirectories() {
+    {
+        QMutexLocker locker(&m_changedDirsMutex);
+        m_bScanModifiedDirs = true;
+    }
+    if (changeScannerState(STARTING)) {
+        emit(startIncrementalScan());
+    }
+}
+
 // this is called after pressing the cancel button in the scanner
 // progress dialog
 void LibraryScanner::slotCancel() {
@@ -395,29 +668,42 @@ void LibraryScanner::cancel() {
         scanner->cancel();
     }
 
-    // Wait for the thread pool to empty. This is important because ScannerTasks
+    // Wait for the thread pools to empty. This is important because ScannerTasks
     // have pointers to the LibraryScanner and can cause a segfault if they run
-    // after the LibraryScanner has been destroyed.
+    // after the LibraryScanner has been destroyed. Directory tasks queue
+    // import tasks, so wait for them first.
     m_pool.waitForDone();
+    m_parserPool.waitForDone();
 }
 
 void LibraryScanner::queueTask(ScannerTask* pTask) {
     //kLogger.debug() << "queueTask" << pTask;
     ScopedTimer timer("LibraryScanner::queueTask");
+    startTask(&m_pool, pTask);
+}
+
+void LibraryScanner::queueImportTask(ScannerTask* pTask) {
+    ScopedTimer timer("LibraryScanner::queueImportTask");
+    startTask(&m_parserPool, pTask);
+}
+
+void LibraryScanner::startTask(QThreadPool* pPool, ScannerTask* pTask) {
     if (m_scannerGlobal.isNull() || m_scannerGlobal->shouldCancel()) {
         return;
     }
     m_scannerGlobal->getTaskWatcher().watchTask();
     connect(pTask, SIGNAL(queueTask(ScannerTask*)),
             this, SLOT(queueTask(ScannerTask*)));
-    connect(pTask, SIGNAL(directoryHashedAndScanned(QString, bool, int)),
-            this, SLOT(slotDirectoryHashedAndScanned(QString, bool, int)));
-    connect(pTask, SIGNAL(directoryUnchanged(QString)),
-            this, SLOT(slotDirectoryUnchanged(QString)));
+    connect(pTask, SIGNAL(directoryHashedAndScanned(QString, bool, int, qint64)),
+            this, SLOT(slotDirectoryHashedAndScanned(QString, bool, int, qint64)));
+    connect(pTask, SIGNAL(directoryUnchanged(QString, qint64)),
+            this, SLOT(slotDirectoryUnchanged(QString, qint64)));
     connect(pTask, SIGNAL(trackExists(QString)),
             this, SLOT(slotTrackExists(QString)));
-    connect(pTask, SIGNAL(addNewTrack(QString)),
-            this, SLOT(slotAddNewTrack(QString)));
+    connect(pTask, SIGNAL(trackSkipped(QString)),
+            this, SLOT(slotTrackSkipped(QString)));
+    connect(pTask, SIGNAL(addNewTracks(QList<TrackPointer>)),
+            this, SLOT(slotAddNewTracks(QList<TrackPointer>)));
 
     // Progress signals.
     // Pass directly to the main thread
@@ -426,11 +712,12 @@ void LibraryScanner::queueTask(ScannerTask* pTask) {
     connect(pTask, SIGNAL(progressHashing(QString)),
             this, SIGNAL(progressHashing(QString)));
 
-    m_pool.start(pTask);
+    pPool->start(pTask);
 }
 
 void LibraryScanner::slotDirectoryHashedAndScanned(const QString& directoryPath,
-                                               bool newDirectory, int hash) {
+                                               bool newDirectory, int hash,
+                                               qint64 mtime) {
     ScopedTimer timer("LibraryScanner::slotDirectoryHashedAndScanned");
     //kLogger.debug() << "sloDirectoryHashedAndScanned" << directoryPath
     //          << newDirectory << hash;
@@ -442,20 +729,28 @@ void LibraryScanner::slotDirectoryHashedAndScanned(const QString& directoryPath,
     }
 
     if (newDirectory) {
-        m_libraryHashDao.saveDirectoryHash(directoryPath, hash);
+        m_libraryHashDao.saveDirectoryHash(directoryPath, hash, mtime);
     } else {
-        m_libraryHashDao.updateDirectoryHash(directoryPath, hash, 0);
+        m_libraryHashDao.updateDirectoryHash(directoryPath, hash, 0, mtime);
     }
     emit(progressHashing(directoryPath));
+    reportThroughput();
 }
 
-void LibraryScanner::slotDirectoryUnchanged(const QString& directoryPath) {
+void LibraryScanner::slotDirectoryUnchanged(const QString& directoryPath,
+                                            qint64 mtime) {
     ScopedTimer timer("LibraryScanner::slotDirectoryUnchanged");
     //kLogger.debug() << "slotDirectoryUnchanged" << directoryPath;
     if (m_scannerGlobal) {
         m_scannerGlobal->addVerifiedDirectory(directoryPath);
+        // The modification time also changes when files that are not
+        // imported are added or removed.
+        if (m_scannerGlobal->directoryModificationTimeInDatabase(directoryPath) != mtime) {
+            m_libraryHashDao.updateDirectoryModificationTime(directoryPath, mtime);
+        }
     }
     emit(progressHashing(directoryPath));
+    reportThroughput();
 }
 
 void LibraryScanner::slotTrackExists(const QString& trackPath) {
@@ -466,34 +761,62 @@ void LibraryScanner::slotTrackExists(const QString& trackPath) {
     }
 }
 
-void LibraryScanner::slotAddNewTrack(const QString& trackPath) {
-    //kLogger.debug() << "slotAddNewTrack" << trackPath;
-    ScopedTimer timer("LibraryScanner::addNewTrack");
-    // For statistics tracking and to detect moved tracks
-    TrackPointer pTrack(m_trackDao.addTracksAddFile(trackPath, false));
-    if (pTrack) {
+void LibraryScanner::slotTrackSkipped(const QString& trackPath) {
+    // For statistics tracking. Skipped files are not added, so they
+    // can't be the new location of a moved track either.
+    Q_UNUSED(trackPath);
+    if (m_scannerGlobal) {
+        m_scannerGlobal->trackSkipped();
+    }
+}
+
+void LibraryScanner::slotAddNewTracks(const QList<TrackPointer>& tracks) {
+    //kLogger.debug() << "slotAddNewTracks" << tracks.size();
+    ScopedTimer timer("LibraryScanner::addNewTracks");
+    for (const auto& pTrack: tracks) {
+        // The metadata has already been parsed by the import task. The track
+        // is inserted with the queries prepared by addTracksPrepare().
+        const TrackId trackId(m_trackDao.addTracksAddTrack(pTrack, false));
         // The track's actual location might differ from the
-        // given trackPath
+        // path of the scanned file
         const QString trackLocation(pTrack->getLocation());
-        // Acknowledge successful track addition
-        if (m_scannerGlobal) {
-            m_scannerGlobal->trackAdded(trackLocation);
-        }
-        // Signal the main instance of TrackDAO, that there is
-        // a new track in the database.
-        emit(trackAdded(pTrack));
-        emit(progressLoading(trackLocation));
-    } else {
-        // Acknowledge failed track addition
+        // For statistics tracking and to detect moved tracks
         // TODO(XXX): Is it really intended to acknowledge a failed
         // track addition with a trackAdded() signal??
         if (m_scannerGlobal) {
-            m_scannerGlobal->trackAdded(trackPath);
+            m_scannerGlobal->trackAdded(trackLocation);
         }
-        kLogger.warning()
-                << "Failed to add track to library:"
-                << trackPath;
+        if (trackId.isValid()) {
+            // Signal the main instance of TrackDAO, that there is
+            // a new track in the database.
+            emit(trackAdded(pTrack));
+            emit(progressLoading(trackLocation));
+        } else {
+            kLogger.warning()
+                    << "Failed to add track to library:"
+                    << trackLocation;
+        }
+    }
+    if (m_scannerGlobal) {
+        m_scannerGlobal->releasePendingTracks(tracks.size());
+    }
+    reportThroughput();
+}
+
+void LibraryScanner::reportThroughput() {
+    if (!m_scannerGlobal ||
+            m_throughputTimer.elapsed() < kThroughputReportInterval) {
+        return;
+    }
+    m_throughputTimer.restart();
+    const double seconds = m_scannerGlobal->timerElapsed().toDoubleSeconds();
+    if (seconds <= 0.0) {
+        return;
     }
+    emit(progressThroughput(
+            m_scannerGlobal->numWalkedDirectories() / seconds,
+            m_scannerGlobal->numParsedTracks() / seconds,
+            m_scannerGlobal->addedTracks().size() / seconds));
 }
 
 bool LibraryScanner::changeScannerState(ScannerState newState) {
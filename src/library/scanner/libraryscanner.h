@@ -1,8 +1,12 @@
 #ifndef MIXXX_LIBRARYSCANNER_H
 #define MIXXX_LIBRARYSCANNER_H
 
+#include <QFileSystemWatcher>
+#include <QMutex>
+#include <QSet>
 #include <QThread>
 #include <QThreadPool>
+#include <QTimer>
 #include <QString>
 #include <QStringList>
 #include <QSemaphore>
@@ -26,6 +30,9 @@ class TrackCollection;
 
 class LibraryScanner : public QThread {
     FRIEND_TEST(LibraryScannerTest, ScannerRoundtrip);
+    FRIEND_TEST(LibraryScannerTest, IncrementalScanIsNotRecursive);
+    FRIEND_TEST(LibraryScannerTest, IncrementalScanOfMovedDirectory);
+    FRIEND_TEST(LibraryScannerTest, SkippedTracksAreNotAdded);
     Q_OBJECT
   public:
     LibraryScanner(
@@ -39,6 +46,11 @@ class LibraryScanner : public QThread {
     // in progress.
     void scan();
 
+    // Call from any thread to rescan all directories whose modification
+    // time differs from the one stored by the last scan. This is a lot
+    // cheaper than a full rescan, because only directories are stat'ed.
+    void scanModifiedDirectories();
+
     // Call from any thread to cancel the scan.
     void slotCancel();
 
@@ -48,6 +60,12 @@ class LibraryScanner : public QThread {
     void progressHashing(QString);
     void progressLoading(QString path);
     void progressCoverArt(QString file);
+    // Average throughput of the pipeline stages since the scan started:
+    // walking directories, parsing metadata and adding tracks to the
+    // database.
+    void progressThroughput(double directoriesPerSecond,
+                            double filesParsedPerSecond,
+                            double tracksAddedPerSecond);
     void trackAdded(TrackPointer pTrack);
     void tracksMoved(QSet<TrackId> oldTrackIds, QSet<TrackId> newTrackIds);
     void tracksChanged(QSet<TrackId> changedTrackIds);
@@ -55,24 +73,37 @@ class LibraryScanner : public QThread {
     // Emitted by scan() to invoke slotStartScan in the scanner thread's event
     // loop.
     void startScan();
+    // Emitted by scanModifiedDirectories() to invoke
+    // slotStartIncrementalScan in the scanner thread's event loop.
+    void startIncrementalScan();
 
   protected:
     void run();
 
   public slots:
+    // Directories are walked by a single thread, so duplicate directories
+    // are always discovered in the same order.
     void queueTask(ScannerTask* pTask);
+    // Files are imported on several threads.
+    void queueImportTask(ScannerTask* pTask);
 
   private slots:
     void slotStartScan();
+    void slotStartIncrementalScan();
     void slotFinishHashedScan();
     void slotFinishUnhashedScan();
 
+    // File system watcher signal handlers.
+    void slotWatchedDirectoryChanged(const QString& dirPath);
+    void slotScanPendingDirectories();
+
     // ScannerTask signal handlers.
     void slotDirectoryHashedAndScanned(const QString& directoryPath,
-                                   bool newDirectory, int hash);
-    void slotDirectoryUnchanged(const QString& directoryPath);
+                                   bool newDirectory, int hash, qint64 mtime);
+    void slotDirectoryUnchanged(const QString& directoryPath, qint64 mtime);
     void slotTrackExists(const QString& trackPath);
-    void slotAddNewTrack(const QString& trackPath);
+    void slotTrackSkipped(const QString& trackPath);
+    void slotAddNewTracks(const QList<TrackPointer>& tracks);
 
   private:
     enum ScannerState {
@@ -96,16 +127,32 @@ class LibraryScanner : public QThread {
     // CANCELING -> IDLE
     bool changeScannerState(LibraryScanner::ScannerState newState);
 
+    void initScannerGlobal();
     void cleanUpScan();
 
+    // Takes the pending changed directories and, if requested, adds all
+    // directories whose modification time has changed.
+    QStringList takeChangedDirectories();
+    bool hasPendingChangedDirectories();
+    bool isInLibraryRootDir(const QString& dirPath) const;
+    // Starts or stops watching the directories that are known to the
+    // database.
+    void updateWatchedDirectories();
+
+    void startTask(QThreadPool* pPool, ScannerTask* pTask);
+    void reportThroughput();
+
     mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
+    UserSettingsPointer m_pConfig;
 
     // The library trackcollection. Do not touch this from the library scanner
     // thread.
     TrackCollection* m_pTrackCollection;
 
-    // The pool of threads used for worker tasks.
+    // The pool of threads used for walking directories.
     QThreadPool m_pool;
+    // The pool of threads used for parsing the metadata of new files.
+    QThreadPool m_parserPool;
 
     // The library scanner thread's DAOs.
     LibraryHashDAO m_libraryHashDao;
@@ -117,6 +164,7 @@ class LibraryScanner : public QThread {
 
     // Global scanner state for scan currently in progress.
     ScannerGlobalPointer m_scannerGlobal;
+    PerformanceTimer m_throughputTimer;
 
     // The Semaphore guards the state transitions queued to the
     // Qt even Queue in the way, that you cannot start a
@@ -126,6 +174,19 @@ class LibraryScanner : public QThread {
     volatile ScannerState m_state;
 
     QStringList m_libraryRootDirs;
+
+    // Directories waiting for an incremental scan. Accessed from the main
+    // and the LibraryScanner thread.
+    QMutex m_changedDirsMutex;
+    QSet<QString> m_changedDirs;
+    bool m_bScanModifiedDirs;
+
+    // Only exists in the LibraryScanner thread while watching is enabled.
+    QScopedPointer<QFileSystemWatcher> m_pWatcher;
+    // Collects the change notifications of the watcher, because a single
+    // copy operation causes lots of them.
+    QTimer m_changedDirsTimer;
+
     QScopedPointer<LibraryScannerDlg> m_pProgressDlg;
 };
 
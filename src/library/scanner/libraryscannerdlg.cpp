@@ -47,6 +47,13 @@ LibraryScannerDlg::LibraryScannerDlg(QWidget* parent, Qt::WindowFlags f)
     connect(this, SIGNAL(progress(QString)),
             pCurrent, SLOT(setText(QString)));
     pLayout->addWidget(pCurrent);
+
+    QLabel* pThroughput = new QLabel(this);
+    pThroughput->setAlignment(Qt::AlignTop);
+    pThroughput->setMaximumWidth(600);
+    connect(this, SIGNAL(throughput(QString)),
+            pThroughput, SLOT(setText(QString)));
+    pLayout->addWidget(pThroughput);
     setLayout(pLayout);
 }
 
@@ -79,6 +86,18 @@ void LibraryScannerDlg::slotUpdateCover(QString path) {
     }
 }
 
+void LibraryScannerDlg::slotUpdateThroughput(double directoriesPerSecond,
+                                             double filesParsedPerSecond,
+                                             double tracksAddedPerSecond) {
+    if (isVisible()) {
+        QString status = tr("Folders: %1/s, reading files: %2/s, adding tracks: %3/s")
+                .arg(directoriesPerSecond, 0, 'f', 1)
+                .arg(filesParsedPerSecond, 0, 'f', 1)
+                .arg(tracksAddedPerSecond, 0, 'f', 1);
+        emit(throughput(status));
+    }
+}
+
 void LibraryScannerDlg::slotCancel() {
     qDebug() << "Cancelling library scan...";
     m_bCancelled = true;
@@ -88,6 +107,7 @@ void LibraryScannerDlg::slotCancel() {
 
 void LibraryScannerDlg::slotScanStarted() {
     m_bCancelled = false;
+    emit(throughput(QString()));
     m_timer.start();
 }
 
@@ -34,6 +34,9 @@ class LibraryScannerDlg : public QWidget {
   public slots:
     void slotUpdate(QString path);
     void slotUpdateCover(QString path);
+    void slotUpdateThroughput(double directoriesPerSecond,
+                              double filesParsedPerSecond,
+                              double tracksAddedPerSecond);
     void slotCancel();
     void slotScanFinished();
     void slotScanStarted();
@@ -41,6 +44,7 @@ class LibraryScannerDlg : public QWidget {
   signals:
     void scanCancelled();
     void progress(QString);
+    void throughput(QString);
 
   private:
     PerformanceTimer m_timer;
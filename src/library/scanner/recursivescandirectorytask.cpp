@@ -4,15 +4,18 @@
 
 #include "library/scanner/libraryscanner.h"
 #include "library/scanner/importfilestask.h"
+#include "library/scanner/scannerutil.h"
 #include "util/timer.h"
 
 RecursiveScanDirectoryTask::RecursiveScanDirectoryTask(
         LibraryScanner* pScanner, const ScannerGlobalPointer scannerGlobal,
-        const QDir& dir, SecurityTokenPointer pToken, bool scanUnhashed)
+        const QDir& dir, SecurityTokenPointer pToken, bool scanUnhashed,
+        bool recursive)
         : ScannerTask(pScanner, scannerGlobal),
           m_dir(dir),
           m_pToken(pToken),
-          m_scanUnhashed(scanUnhashed) {
+          m_scanUnhashed(scanUnhashed),
+          m_recursive(recursive) {
 }
 
 void RecursiveScanDirectoryTask::run() {
@@ -30,6 +33,13 @@ void RecursiveScanDirectoryTask::run() {
     // a QDirIterator with a QDir instead of a QString -- but it inherits its
     // Filter from the QDir so we have to set it first. If the QDir has not done
     // any FS operations yet then this should be lightweight.
+    QString dirPath = m_dir.path();
+
+    // Take the modification time before listing the directory. Files that
+    // are added while listing change it again and are picked up by the
+    // next scan.
+    const qint64 mtime = ScannerUtil::getDirectoryModificationTime(dirPath);
+
     m_dir.setFilter(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot);
     QDirIterator it(m_dir);
 
@@ -71,12 +81,12 @@ void RecursiveScanDirectoryTask::run() {
         }
     }
 
+    m_scannerGlobal->directoryWalked();
+
     // Note: A hash of "0" is a real hash if the directory contains no files!
     // Calculate a hash of the directory's file list.
     int newHash = qHash(newHashStr.join(""));
 
-    QString dirPath = m_dir.path();
-
     // Try to retrieve a hash from the last time that directory was scanned.
     int prevHash = m_scannerGlobal->directoryHashInDatabase(dirPath);
     bool prevHashExists = prevHash != -1;
@@ -88,15 +98,17 @@ void RecursiveScanDirectoryTask::run() {
             // Rescan that mofo! If importing fails then the scan was cancelled so
             // we return immediately.
             if (!filesToImport.isEmpty()) {
-                m_pScanner->queueTask(
+                m_pScanner->queueImportTask(
                         new ImportFilesTask(m_pScanner, m_scannerGlobal, dirPath,
-                                            prevHashExists, newHash, filesToImport,
-                                            possibleCovers, m_pToken));
+                                            prevHashExists, newHash, mtime,
+                                            filesToImport, possibleCovers,
+                                            m_pToken));
             } else {
-                emit(directoryHashedAndScanned(dirPath, !prevHashExists, newHash));
+                emit(directoryHashedAndScanned(dirPath, !prevHashExists, newHash,
+                                               mtime));
             }
         } else {
-            emit(directoryUnchanged(dirPath));
+            emit(directoryUnchanged(dirPath, mtime));
         }
     } else {
         m_scannerGlobal->addUnhashedDir(m_dir, m_pToken);
@@ -104,6 +116,12 @@ void RecursiveScanDirectoryTask::run() {
 
     // Process all of the sub-directories.
     foreach (const QDir& nextDir, dirsToScan) {
+        if (!m_recursive &&
+                m_scannerGlobal->directoryHashInDatabase(nextDir.path()) != -1) {
+            // Known sub-directories are rescanned on their own when they
+            // have changed.
+            continue;
+        }
         // Atomically test and mark the directory as scanned to avoid
         // that the same directory is scanned multiple times by different
         // tasks.
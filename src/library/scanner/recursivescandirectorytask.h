@@ -11,6 +11,10 @@
 // performing a hash of the directory's file list, and those hashes are stored
 // in the database. Successful if the scan completed without being
 // cancelled. False if the scan was cancelled part-way through.
+//
+// A non-recursive task only scans the directory itself and those
+// sub-directories that are not known to the database yet. It is used for
+// rescanning directories that have changed since the last scan.
 class RecursiveScanDirectoryTask : public ScannerTask {
     Q_OBJECT
   public:
@@ -19,7 +23,8 @@ class RecursiveScanDirectoryTask : public ScannerTask {
                                const ScannerGlobalPointer scannerGlobal,
                                const QDir& dir,
                                SecurityTokenPointer pToken,
-                               bool scanUnhashed);
+                               bool scanUnhashed,
+                               bool recursive = true);
     virtual ~RecursiveScanDirectoryTask() {}
 
     virtual void run();
@@ -28,6 +33,7 @@ class RecursiveScanDirectoryTask : public ScannerTask {
     QDir m_dir;
     SecurityTokenPointer m_pToken;
     bool m_scanUnhashed;
+    bool m_recursive;
 };
 
 #endif /* RECURSIVESCANDIRECTORYTASK_H */
@@ -1,14 +1,17 @@
 #ifndef SCANNERGLOBAL_H
 #define SCANNERGLOBAL_H
 
+#include <QAtomicInt>
 #include <QSet>
 #include <QHash>
 #include <QRegExp>
 #include <QStringList>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QSemaphore>
 #include <QSharedPointer>
 
+#include "util/compatibility.h"
 #include "util/task.h"
 #include "util/performancetimer.h"
 
@@ -36,20 +39,33 @@ class DirInfo {
 
 class ScannerGlobal {
   public:
+    // The number of parsed tracks that may wait for being added to the
+    // database before the parser threads are blocked. The tracks are full
+    // Track objects, because TrackDAO needs the beats, keys and cover art
+    // of new tracks. This limit bounds their memory independent of the
+    // size of the library.
+    static const int kMaxPendingTracks = 512;
+
     ScannerGlobal(const QSet<QString>& trackLocations,
                   const QHash<QString, int>& directoryHashes,
+                  const QHash<QString, qint64>& directoryModificationTimes,
                   const QRegExp& supportedExtensionsMatcher,
                   const QRegExp& supportedCoverExtensionsMatcher,
                   const QStringList& directoriesBlacklist)
             : m_trackLocations(trackLocations),
               m_directoryHashes(directoryHashes),
+              m_directoryModificationTimes(directoryModificationTimes),
               m_supportedExtensionsMatcher(supportedExtensionsMatcher),
               m_supportedCoverExtensionsMatcher(supportedCoverExtensionsMatcher),
               m_directoriesBlacklist(directoriesBlacklist),
               // Unless marked un-clean, we assume it will finish cleanly.
               m_scanFinishedCleanly(true),
               m_shouldCancel(false),
-              m_numScannedDirectories(0) {
+              m_pendingTracks(kMaxPendingTracks),
+              m_numScannedDirectories(0),
+              m_numSkippedTracks(0),
+              m_numWalkedDirectories(0),
+              m_numParsedTracks(0) {
     }
 
     TaskWatcher& getTaskWatcher() {
@@ -66,6 +82,13 @@ class ScannerGlobal {
         return m_directoryHashes.value(directoryPath, -1);
     }
 
+    // Returns the stored modification time of the directory if it exists or
+    // -1 if it doesn't.
+    inline qint64 directoryModificationTimeInDatabase(
+            const QString& directoryPath) const {
+        return m_directoryModificationTimes.value(directoryPath, -1);
+    }
+
     inline bool directoryBlacklisted(const QString& directoryPath) const {
         return m_directoriesBlacklist.contains(directoryPath);
     }
@@ -172,12 +195,56 @@ class ScannerGlobal {
         m_numScannedDirectories++;
     }
 
+    // New files that are not added, because they are not supported
+    int numSkippedTracks() const {
+        return m_numSkippedTracks;
+    }
+    void trackSkipped() {
+        m_numSkippedTracks++;
+    }
+
+    // Backpressure from the database to the parser threads. A parser thread
+    // takes a slot for each parsed track and the library scanner returns the
+    // slots after adding the tracks to the database.
+    bool tryAcquirePendingTrack() {
+        return m_pendingTracks.tryAcquire();
+    }
+    // Blocks until a slot is free. Returns false if the scan has been
+    // cancelled while waiting.
+    bool acquirePendingTrack() {
+        while (!m_pendingTracks.tryAcquire(1, 100)) {
+            if (shouldCancel()) {
+                return false;
+            }
+        }
+        return true;
+    }
+    void releasePendingTracks(int count) {
+        m_pendingTracks.release(count);
+    }
+
+    // Throughput statistics of the pipeline stages. Updated from the worker
+    // threads.
+    int numWalkedDirectories() const {
+        return load_atomic(m_numWalkedDirectories);
+    }
+    void directoryWalked() {
+        m_numWalkedDirectories.ref();
+    }
+    int numParsedTracks() const {
+        return load_atomic(m_numParsedTracks);
+    }
+    void trackParsed() {
+        m_numParsedTracks.ref();
+    }
+
 
   private:
     TaskWatcher m_watcher;
 
     QSet<QString> m_trackLocations;
     QHash<QString, int> m_directoryHashes;
+    QHash<QString, qint64> m_directoryModificationTimes;
 
     mutable QMutex m_supportedExtensionsMatcherMutex;
     QRegExp m_supportedExtensionsMatcher;
@@ -214,9 +281,14 @@ class ScannerGlobal {
     volatile bool m_scanFinishedCleanly;
     volatile bool m_shouldCancel;
 
+    QSemaphore m_pendingTracks;
+
     // Stats tracking.
     PerformanceTimer m_timer;
     int m_numScannedDirectories;
+    int m_numSkippedTracks;
+    QAtomicInt m_numWalkedDirectories;
+    QAtomicInt m_numParsedTracks;
 };
 
 typedef QSharedPointer<ScannerGlobal> ScannerGlobalPointer;
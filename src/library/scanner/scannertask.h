@@ -1,6 +1,7 @@
 #ifndef SCANNERTASK_H
 #define SCANNERTASK_H
 
+#include <QList>
 #include <QObject>
 #include <QRunnable>
 
@@ -21,11 +22,16 @@ class ScannerTask : public QObject, public QRunnable {
   signals:
     void taskDone(bool success);
     void queueTask(ScannerTask* pTask);
+    // The modification time of the directory is taken before listing its
+    // contents, so changes during the scan are detected by the next one.
     void directoryHashedAndScanned(const QString& directoryPath,
-                                   bool newDirectory, int hash);
-    void directoryUnchanged(const QString& directoryPath);
+                                   bool newDirectory, int hash, qint64 mtime);
+    void directoryUnchanged(const QString& directoryPath, qint64 mtime);
     void trackExists(const QString& filePath);
-    void addNewTrack(const QString& filePath);
+    // A new file that is not added, because it is not supported
+    void trackSkipped(const QString& filePath);
+    // New tracks with their metadata parsed from the file
+    void addNewTracks(const QList<TrackPointer>& tracks);
 
     // Feedback to GUI
     void progressLoading(const QString& fileName);
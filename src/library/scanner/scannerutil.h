@@ -1,8 +1,10 @@
 #ifndef SCANNERUTIL_H
 #define SCANNERUTIL_H
 
+#include <QDateTime>
 #include <QDir>
 #include <QDesktopServices>
+#include <QFileInfo>
 #include <QStringList>
 
 // Library scanner utility methods.
@@ -28,6 +30,18 @@ class ScannerUtil {
         return blacklist;
     }
 
+    // Returns the modification time of the directory in milliseconds since
+    // the epoch or -1 if the directory does not exist. The modification
+    // time of a directory changes whenever files are added, removed or
+    // renamed within it.
+    static qint64 getDirectoryModificationTime(const QString& dirPath) {
+        const QFileInfo dirInfo(dirPath);
+        if (!dirInfo.isDir()) {
+            return -1;
+        }
+        return dirInfo.lastModified().toMSecsSinceEpoch();
+    }
+
   private:
     ScannerUtil() {}
 };
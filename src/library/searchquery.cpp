@@ -5,10 +5,14 @@
 #include "library/queryutil.h"
 #include "track/keyutils.h"
 #include "library/dao/trackschema.h"
+#include "library/dao/searchindexdao.h"
+#include "util/db/dbconnection.h"
 #include "util/db/sqllikewildcards.h"
 
 QVariant getTrackValueForColumn(const TrackPointer& pTrack, const QString& column) {
-    if (column == LIBRARYTABLE_ARTIST) {
+    if (column == LIBRARYTABLE_ID) {
+        return pTrack->getId().toVariant();
+    } else if (column == LIBRARYTABLE_ARTIST) {
         return pTrack->getArtist();
     } else if (column == LIBRARYTABLE_TITLE) {
         return pTrack->getTitle();
@@ -57,6 +61,12 @@ QVariant getTrackValueForColumn(const TrackPointer& pTrack, const QString& colum
     return QVariant();
 }
 
+bool QueryNode::match(const TrackPointer& pTrack) const {
+    return matchValues([&pTrack](const QString& column) {
+        return getTrackValueForColumn(pTrack, column);
+    });
+}
+
 //static
 QString QueryNode::concatSqlClauses(
         const QStringList& sqlClauses, const QString& sqlConcatOp) {
@@ -73,9 +83,9 @@ QString QueryNode::concatSqlClauses(
     }
 }
 
-bool AndNode::match(const TrackPointer& pTrack) const {
+bool AndNode::matchValues(const TrackValueLookup& lookup) const {
     for (const auto& pNode: m_nodes) {
-        if (!pNode->match(pTrack)) {
+        if (!pNode->matchValues(lookup)) {
             return false;
         }
     }
@@ -96,7 +106,7 @@ QString AndNode::toSql() const {
     return concatSqlClauses(queryFragments, "AND");
 }
 
-bool OrNode::match(const TrackPointer& pTrack) const {
+bool OrNode::matchValues(const TrackValueLookup& lookup) const {
     // An empty OR node would always evaluate to false
     // which is inconsistent with the generated SQL query!
     VERIFY_OR_DEBUG_ASSERT(!m_nodes.empty()) {
@@ -106,7 +116,7 @@ bool OrNode::match(const TrackPointer& pTrack) const {
         return true;
     }
     for (const auto& pNode: m_nodes) {
-        if (pNode->match(pTrack)) {
+        if (pNode->matchValues(lookup)) {
             return true;
         }
     }
@@ -125,8 +135,8 @@ QString OrNode::toSql() const {
     return concatSqlClauses(queryFragments, "OR");
 }
 
-bool NotNode::match(const TrackPointer& pTrack) const {
-    return !m_pNode->match(pTrack);
+bool NotNode::matchValues(const TrackValueLookup& lookup) const {
+    return !m_pNode->matchValues(lookup);
 }
 
 QString NotNode::toSql() const {
@@ -141,14 +151,19 @@ QString NotNode::toSql() const {
     }
 }
 
-bool TextFilterNode::match(const TrackPointer& pTrack) const {
+bool TextFilterNode::matchValues(const TrackValueLookup& lookup) const {
     for (const auto& sqlColumn: m_sqlColumns) {
-        QVariant value = getTrackValueForColumn(pTrack, sqlColumn);
-        if (!value.isValid() || !qVariantCanConvert<QString>(value)) {
+        QVariant value = lookup(sqlColumn);
+        if (!value.isValid() || value.isNull() ||
+                !qVariantCanConvert<QString>(value)) {
             continue;
         }
 
-        if (value.toString().contains(m_argument, Qt::CaseInsensitive)) {
+        // Same comparison as the LIKE operator of the database
+        QString pattern = kSqlLikeMatchAll + m_argument + kSqlLikeMatchAll;
+        QString string = value.toString();
+        if (mixxx::DbConnection::likeCompareLatinLow(
+                &pattern, &string, QChar())) {
             return true;
         }
     }
@@ -166,6 +181,88 @@ QString TextFilterNode::toSql() const {
     return concatSqlClauses(searchClauses, "OR");
 }
 
+namespace {
+
+// Splits text into lower case words without diacritics like the unicode61
+// tokenizer of the full-text search index does.
+QStringList foldedWords(const QString& text) {
+    const QString decomposed = text.normalized(QString::NormalizationForm_D);
+    QString folded;
+    folded.reserve(decomposed.size());
+    for (const QChar& ch: decomposed) {
+        if (ch.isLetterOrNumber()) {
+            folded.append(ch.toLower());
+        } else if (ch.category() != QChar::Mark_NonSpacing) {
+            folded.append(' ');
+        }
+    }
+    return folded.split(' ', QString::SkipEmptyParts);
+}
+
+}  // anonymous namespace
+
+FullTextFilterNode::FullTextFilterNode(const QSqlDatabase& database,
+                                       const QStringList& sqlColumns,
+                                       const QString& argument)
+        : m_database(database),
+          m_sqlColumns(sqlColumns),
+          m_words(foldedWords(argument)) {
+    DEBUG_ASSERT(!m_words.isEmpty());
+}
+
+// static
+bool FullTextFilterNode::isSearchable(const QString& argument) {
+    return !foldedWords(argument).isEmpty();
+}
+
+bool FullTextFilterNode::matchValues(const TrackValueLookup& lookup) const {
+    QStringList values;
+    for (const auto& sqlColumn: m_sqlColumns) {
+        QVariant value = lookup(sqlColumn);
+        if (!value.isValid() || value.isNull() ||
+                !qVariantCanConvert<QString>(value)) {
+            continue;
+        }
+        values << value.toString();
+    }
+    // A term with several words like "hip-hop" is a phrase query, so the
+    // words must follow each other in one of the columns.
+    for (const auto& value: values) {
+        const QStringList words = foldedWords(value);
+        for (int i = 0; i + m_words.size() <= words.size(); ++i) {
+            bool matches = true;
+            for (int j = 0; j < m_words.size() - 1; ++j) {
+                if (words[i + j] != m_words[j]) {
+                    matches = false;
+                    break;
+                }
+            }
+            if (matches && words[i + m_words.size() - 1].startsWith(m_words.last())) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+QString FullTextFilterNode::toSql() const {
+    // The phrase query only matches the last word as a prefix.
+    const QString phrase = QString("\"%1*\"").arg(m_words.join(" "));
+    QString matchExpression;
+    if (m_sqlColumns.size() == SearchIndexDAO::indexedColumns().size()) {
+        matchExpression = phrase;
+    } else {
+        QStringList columnPhrases;
+        for (const auto& sqlColumn: m_sqlColumns) {
+            columnPhrases << sqlColumn + ":" + phrase;
+        }
+        matchExpression = columnPhrases.join(" OR ");
+    }
+    FieldEscaper escaper(m_database);
+    return QString("id IN (SELECT docid FROM %1 WHERE %1 MATCH %2)")
+            .arg(SearchIndexDAO::kTableName, escaper.escapeString(matchExpression));
+}
+
 CrateFilterNode::CrateFilterNode(const CrateStorage* pCrateStorage,
                                  const QString& crateNameLike)
     : m_pCrateStorage(pCrateStorage),
@@ -173,23 +270,31 @@ CrateFilterNode::CrateFilterNode(const CrateStorage* pCrateStorage,
       m_matchInitialized(false) {
 }
 
-bool CrateFilterNode::match(const TrackPointer& pTrack) const {
+const CompressedBitmap& CrateFilterNode::matchingTrackIds() const {
     if (!m_matchInitialized) {
-        CrateTrackSelectResult crateTracks(
-             m_pCrateStorage->selectTracksSortedByCrateNameLike(m_crateNameLike));
-
-        while (crateTracks.next()) {
-            m_matchingTrackIds.push_back(crateTracks.trackId());
-        }
-
+        m_matchingTrackIds = m_pCrateStorage->getTrackIdsOfAnyCrate(
+                m_pCrateStorage->collectCrateIdsByNameLike(m_crateNameLike));
         m_matchInitialized = true;
     }
+    return m_matchingTrackIds;
+}
 
-    return std::binary_search(m_matchingTrackIds.begin(), m_matchingTrackIds.end(), pTrack->getId());
+bool CrateFilterNode::matchValues(const TrackValueLookup& lookup) const {
+    const QVariant trackId = lookup(LIBRARYTABLE_ID);
+    if (!trackId.isValid() || trackId.isNull()) {
+        return false;
+    }
+    return matchingTrackIds().contains(TrackId(trackId).toInt());
 }
 
 QString CrateFilterNode::toSql() const {
-    return QString("id IN (%1)").arg(CrateStorage::formatQueryForTrackIdsByCrateNameLike(m_crateNameLike));
+    // The ids are taken from the in-memory index instead of joining
+    // the crate tables in SQL again
+    QStringList trackIds;
+    for (quint32 trackId : matchingTrackIds().toVector()) {
+        trackIds << QString::number(trackId);
+    }
+    return QString("id IN (%1)").arg(trackIds.join(","));
 }
 
 NumericFilterNode::NumericFilterNode(const QStringList& sqlColumns)
@@ -239,10 +344,11 @@ double NumericFilterNode::parse(const QString& arg, bool *ok) {
     return arg.toDouble(ok);
 }
 
-bool NumericFilterNode::match(const TrackPointer& pTrack) const {
+bool NumericFilterNode::matchValues(const TrackValueLookup& lookup) const {
     for (const auto& sqlColumn: m_sqlColumns) {
-        QVariant value = getTrackValueForColumn(pTrack, sqlColumn);
-        if (!value.isValid() || !qVariantCanConvert<double>(value)) {
+        QVariant value = lookup(sqlColumn);
+        if (!value.isValid() || value.isNull() ||
+                !qVariantCanConvert<double>(value)) {
             continue;
         }
 
@@ -336,8 +442,13 @@ KeyFilterNode::KeyFilterNode(mixxx::track::io::key::ChromaticKey key,
     }
 }
 
-bool KeyFilterNode::match(const TrackPointer& pTrack) const {
-    return m_matchKeys.contains(pTrack->getKey());
+bool KeyFilterNode::matchValues(const TrackValueLookup& lookup) const {
+    const QVariant keyId = lookup(LIBRARYTABLE_KEY_ID);
+    if (!keyId.isValid() || keyId.isNull()) {
+        return false;
+    }
+    return m_matchKeys.contains(
+            static_cast<mixxx::track::io::key::ChromaticKey>(keyId.toInt()));
 }
 
 QString KeyFilterNode::toSql() const {
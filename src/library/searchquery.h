@@ -1,6 +1,7 @@
 #ifndef SEARCHQUERY_H
 #define SEARCHQUERY_H
 
+#include <functional>
 #include <vector>
 #include <utility>
 
@@ -18,12 +19,19 @@
 
 QVariant getTrackValueForColumn(const TrackPointer& pTrack, const QString& column);
 
+// Returns the value of an SQL column of the track that is matched, or an
+// invalid QVariant if the column is not available.
+typedef std::function<QVariant(const QString& column)> TrackValueLookup;
+
 class QueryNode {
   public:
     QueryNode(const QueryNode&) = delete; // prevent copying
     virtual ~QueryNode() {}
 
-    virtual bool match(const TrackPointer& pTrack) const = 0;
+    bool match(const TrackPointer& pTrack) const;
+    // Matches the column values of a track without loading it, e.g. the
+    // values that are cached by BaseTrackCache.
+    virtual bool matchValues(const TrackValueLookup& lookup) const = 0;
     virtual QString toSql() const = 0;
 
   protected:
@@ -48,13 +56,13 @@ class GroupNode : public QueryNode {
 
 class OrNode : public GroupNode {
   public:
-    bool match(const TrackPointer& pTrack) const override;
+    bool matchValues(const TrackValueLookup& lookup) const override;
     QString toSql() const override;
 };
 
 class AndNode : public GroupNode {
   public:
-    bool match(const TrackPointer& pTrack) const override;
+    bool matchValues(const TrackValueLookup& lookup) const override;
     QString toSql() const override;
 };
 
@@ -65,7 +73,7 @@ class NotNode : public QueryNode {
         DEBUG_ASSERT(m_pNode);
     }
 
-    bool match(const TrackPointer& pTrack) const override;
+    bool matchValues(const TrackValueLookup& lookup) const override;
     QString toSql() const override;
 
   private:
@@ -82,7 +90,7 @@ class TextFilterNode : public QueryNode {
               m_argument(argument) {
     }
 
-    bool match(const TrackPointer& pTrack) const override;
+    bool matchValues(const TrackValueLookup& lookup) const override;
     QString toSql() const override;
 
   private:
@@ -91,26 +99,51 @@ class TextFilterNode : public QueryNode {
     QString m_argument;
 };
 
+// Matches tracks with a word in one of the given columns that starts with
+// the argument by looking it up in the full-text search index. Unlike
+// TextFilterNode this does not match in the middle of a word.
+class FullTextFilterNode : public QueryNode {
+  public:
+    FullTextFilterNode(const QSqlDatabase& database,
+                       const QStringList& sqlColumns,
+                       const QString& argument);
+
+    bool matchValues(const TrackValueLookup& lookup) const override;
+    QString toSql() const override;
+
+    // Returns true if the argument can be looked up in the index, i.e. if
+    // it contains at least one letter or digit.
+    static bool isSearchable(const QString& argument);
+
+  private:
+    QSqlDatabase m_database;
+    QStringList m_sqlColumns;
+    QStringList m_words;
+};
+
 class CrateFilterNode : public QueryNode {
   public:
     CrateFilterNode(const CrateStorage* pCrateStorage,
                     const QString& crateNameLike);
 
-    bool match(const TrackPointer& pTrack) const override;
+    bool matchValues(const TrackValueLookup& lookup) const override;
     QString toSql() const override;
 
   private:
+    const CompressedBitmap& matchingTrackIds() const;
+
     const CrateStorage* m_pCrateStorage;
     QString m_crateNameLike;
     mutable bool m_matchInitialized;
-    mutable std::vector<TrackId> m_matchingTrackIds;
+    // The tracks of all matching crates from the in-memory index
+    mutable CompressedBitmap m_matchingTrackIds;
 };
 
 class NumericFilterNode : public QueryNode {
   public:
     NumericFilterNode(const QStringList& sqlColumns, const QString& argument);
 
-    bool match(const TrackPointer& pTrack) const override;
+    bool matchValues(const TrackValueLookup& lookup) const override;
     QString toSql() const override;
 
   protected:
@@ -147,7 +180,7 @@ class KeyFilterNode : public QueryNode {
   public:
     KeyFilterNode(mixxx::track::io::key::ChromaticKey key, bool fuzzy);
 
-    bool match(const TrackPointer& pTrack) const override;
+    bool matchValues(const TrackValueLookup& lookup) const override;
     QString toSql() const override;
 
   private:
@@ -163,10 +196,10 @@ class SqlNode : public QueryNode {
             : m_sql(sqlExpression) {
     }
 
-    bool match(const TrackPointer& pTrack) const override {
+    bool matchValues(const TrackValueLookup& lookup) const override {
         // We are usually embedded in an AND node so if we don't match
         // everything then we block everything.
-        Q_UNUSED(pTrack);
+        Q_UNUSED(lookup);
         return true;
     }
 
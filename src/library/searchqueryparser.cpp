@@ -6,7 +6,8 @@ const char* kNegatePrefix = "-";
 const char* kFuzzyPrefix = "~";
 
 SearchQueryParser::SearchQueryParser(TrackCollection* pTrackCollection)
-    : m_pTrackCollection(pTrackCollection) {
+    : m_pTrackCollection(pTrackCollection),
+      m_pSearchIndex(nullptr) {
     m_textFilters << "artist"
                   << "album_artist"
                   << "album"
@@ -177,8 +178,17 @@ void SearchQueryParser::parseTokens(QStringList tokens,
             }
             // Don't trigger on a lone minus sign.
             if (!token.isEmpty()) {
-                pNode = std::make_unique<TextFilterNode>(
-                                m_pTrackCollection->database(), searchColumns, token);
+                if (m_pSearchIndex && m_pSearchIndex->isAvailable() &&
+                        SearchIndexDAO::coversColumns(searchColumns) &&
+                        FullTextFilterNode::isSearchable(token)) {
+                    pNode = std::make_unique<FullTextFilterNode>(
+                            m_pTrackCollection->database(), searchColumns, token);
+                } else {
+                    // Terms without letters or digits and columns that are
+                    // not indexed fall back to a substring match.
+                    pNode = std::make_unique<TextFilterNode>(
+                            m_pTrackCollection->database(), searchColumns, token);
+                }
             }
         }
         if (pNode) {
@@ -190,6 +200,56 @@ void SearchQueryParser::parseTokens(QStringList tokens,
     }
 }
 
+// static
+bool SearchQueryParser::isRefinement(const QString& oldQuery,
+                                     const QString& newQuery,
+                                     QString* pRefinement) {
+    DEBUG_ASSERT(pRefinement);
+    if (oldQuery.trimmed().isEmpty() || newQuery.size() <= oldQuery.size() ||
+            !newQuery.startsWith(oldQuery)) {
+        return false;
+    }
+    // An open quote would swallow the appended text into its argument
+    if (oldQuery.count('"') % 2 != 0) {
+        return false;
+    }
+
+    const QString appended = newQuery.mid(oldQuery.size());
+    const QStringList oldTokens = oldQuery.split(" ", QString::SkipEmptyParts);
+    const QString lastToken = oldTokens.last();
+
+    if (oldQuery.endsWith(' ') || appended.startsWith(' ')) {
+        // New terms are combined with the old ones by AND. A filter without
+        // an argument like "artist:" would take the next term as argument.
+        if (lastToken.endsWith(':')) {
+            return false;
+        }
+        *pRefinement = appended;
+        return true;
+    }
+
+    // The last term is extended. This only narrows the result for plain
+    // terms that match substrings or word prefixes, e.g. not for
+    // "bpm:12" -> "bpm:120" or "-daft" -> "-dafty".
+    if (appended.contains(' ') || appended.contains('"') ||
+            appended.contains(':')) {
+        return false;
+    }
+    if (lastToken.startsWith(kNegatePrefix) ||
+            lastToken.startsWith(kFuzzyPrefix) ||
+            lastToken.contains('"') || lastToken.contains(':')) {
+        return false;
+    }
+    // Appending the first letter or digit switches from a substring to a
+    // full-text match, e.g. "&" -> "&d" also finds "Daft Punk".
+    if (FullTextFilterNode::isSearchable(lastToken) !=
+            FullTextFilterNode::isSearchable(lastToken + appended)) {
+        return false;
+    }
+    *pRefinement = lastToken + appended;
+    return true;
+}
+
 std::unique_ptr<QueryNode> SearchQueryParser::parseQuery(const QString& query,
                                          const QStringList& searchColumns,
                                          const QString& extraFilter) const {
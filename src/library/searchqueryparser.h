@@ -16,11 +16,28 @@ class SearchQueryParser {
 
     virtual ~SearchQueryParser();
 
+    // Plain search terms are looked up in the given full-text search index
+    // if it is available and covers all search columns. They then only
+    // match words that start with the term. Terms without any letter or
+    // digit always match anywhere in the text. The ids of the queried
+    // table must be library track ids.
+    void setSearchIndex(const SearchIndexDAO* pSearchIndex) {
+        m_pSearchIndex = pSearchIndex;
+    }
+
     std::unique_ptr<QueryNode> parseQuery(
             const QString& query,
             const QStringList& searchColumns,
             const QString& extraFilter) const;
 
+    // Returns true if the tracks that match newQuery are a subset of the
+    // tracks that match oldQuery, because newQuery only appends search terms
+    // to oldQuery or extends its last plain search term. In this case the
+    // terms that need to be matched in addition to oldQuery are stored in
+    // pRefinement.
+    static bool isRefinement(const QString& oldQuery,
+                             const QString& newQuery,
+                             QString* pRefinement);
 
   private:
     void parseTokens(QStringList tokens,
@@ -31,6 +48,7 @@ class SearchQueryParser {
                             QStringList* tokens) const;
 
     TrackCollection* m_pTrackCollection;
+    const SearchIndexDAO* m_pSearchIndex;
     QStringList m_textFilters;
     QStringList m_numericFilters;
     QStringList m_specialFilters;
@@ -0,0 +1,233 @@
+#include "library/sqlselectthread.h"
+
+#include <QRegExp>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QtDebug>
+
+#include "library/queryutil.h"
+#include "util/compatibility.h"
+#include "util/db/dbconnectionpooled.h"
+#include "util/db/dbconnectionpooler.h"
+#include "util/db/sqltransaction.h"
+#include "util/logger.h"
+#include "util/performancetimer.h"
+#include "util/trace.h"
+
+namespace {
+
+const mixxx::Logger kLogger("SqlSelectThread");
+
+// Check for cancellation after this many rows
+const int kRowsPerCancelCheck = 256;
+
+}  // anonymous namespace
+
+SqlSelectThread::SqlSelectThread(mixxx::DbConnectionPoolPtr pDbConnectionPool)
+        : m_pDbConnectionPool(std::move(pDbConnectionPool)),
+          m_pRunningClient(nullptr),
+          m_bStop(false),
+          m_nextRequestId(0),
+          m_cancelRunning(0) {
+    qRegisterMetaType<SqlSelectThread::ResultPointer>(
+            "SqlSelectThread::ResultPointer");
+    setObjectName("SqlSelectThread");
+}
+
+SqlSelectThread::~SqlSelectThread() {
+    stop();
+}
+
+void SqlSelectThread::stop() {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_bStop = true;
+        m_requests.clear();
+        m_cancelRunning.fetchAndStoreRelease(1);
+        m_requestAvailable.wakeAll();
+    }
+    wait();
+}
+
+int SqlSelectThread::submit(const void* pClient,
+                            const QSqlDatabase& database,
+                            const QString& queryString,
+                            const QString& filterQueryString) {
+    Request request;
+    request.pClient = pClient;
+    request.queryString = queryString;
+    request.filterQueryString = filterQueryString;
+
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    if (query.exec("SELECT name, sql FROM sqlite_temp_master "
+                   "WHERE type='view' ORDER BY rowid")) {
+        while (query.next()) {
+            request.temporaryViews.append(qMakePair(
+                    query.value(0).toString(), query.value(1).toString()));
+        }
+    } else {
+        LOG_FAILED_QUERY(query);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    request.id = m_nextRequestId++;
+    for (int i = m_requests.size() - 1; i >= 0; --i) {
+        if (m_requests[i].pClient == pClient) {
+            m_requests.removeAt(i);
+        }
+    }
+    if (m_pRunningClient == pClient) {
+        m_cancelRunning.fetchAndStoreRelease(1);
+    }
+    m_requests.append(request);
+    m_requestAvailable.wakeAll();
+    return request.id;
+}
+
+void SqlSelectThread::cancel(const void* pClient) {
+    QMutexLocker locker(&m_mutex);
+    for (int i = m_requests.size() - 1; i >= 0; --i) {
+        if (m_requests[i].pClient == pClient) {
+            m_requests.removeAt(i);
+        }
+    }
+    if (m_pRunningClient == pClient) {
+        m_cancelRunning.fetchAndStoreRelease(1);
+    }
+}
+
+void SqlSelectThread::run() {
+    // Only reads, so writes by the library scanner or the analyzer
+    // never block it
+    const mixxx::DbConnectionPooler dbConnectionPooler(
+            m_pDbConnectionPool,
+            mixxx::DbConnectionPool::AccessMode::ReadOnly);
+    if (!dbConnectionPooler.isPooling()) {
+        kLogger.warning() << "Failed to open a database connection";
+        return;
+    }
+    const QSqlDatabase database = mixxx::DbConnectionPooled(m_pDbConnectionPool);
+
+    while (true) {
+        Request request;
+        {
+            QMutexLocker locker(&m_mutex);
+            m_pRunningClient = nullptr;
+            while (!m_bStop && m_requests.isEmpty()) {
+                m_requestAvailable.wait(&m_mutex);
+            }
+            if (m_bStop) {
+                break;
+            }
+            request = m_requests.takeFirst();
+            m_pRunningClient = request.pClient;
+            m_cancelRunning.fetchAndStoreRelease(0);
+        }
+
+        Trace trace("SqlSelectThread::execute");
+        copyTemporaryViews(database, request);
+        ResultPointer pResult = execute(database, request);
+        if (pResult) {
+            emit(selectFinished(request.id, pResult));
+        }
+    }
+}
+
+void SqlSelectThread::copyTemporaryViews(const QSqlDatabase& database,
+                                         const Request& request) {
+    // SQLite removes the TEMPORARY keyword from the stored definition
+    QRegExp createView("^\\s*CREATE\\s+VIEW\\s", Qt::CaseInsensitive);
+    for (const auto& view: request.temporaryViews) {
+        if (m_temporaryViews.value(view.first) == view.second) {
+            continue;
+        }
+        QSqlQuery query(database);
+        if (m_temporaryViews.contains(view.first)) {
+            // The view has been redefined by the GUI thread
+            if (!query.exec(QString("DROP VIEW IF EXISTS temp.\"%1\"").arg(view.first))) {
+                LOG_FAILED_QUERY(query);
+            }
+        }
+        QString sql = view.second;
+        sql.replace(createView, "CREATE TEMPORARY VIEW ");
+        if (query.exec(sql)) {
+            m_temporaryViews.insert(view.first, view.second);
+        } else {
+            LOG_FAILED_QUERY(query);
+        }
+    }
+}
+
+SqlSelectThread::ResultPointer SqlSelectThread::execute(
+        const QSqlDatabase& database,
+        const Request& request) {
+    PerformanceTimer timer;
+    timer.start();
+
+    // The read transaction makes both queries see the same rows. Nothing
+    // is written, so it is simply rolled back when leaving.
+    SqlTransaction transaction(database);
+
+    QSqlQuery query(database);
+    // This causes a memory savings since QSqlCachedResult (what QtSQLite uses)
+    // won't allocate a giant in-memory table that we won't use at all.
+    query.setForwardOnly(true);
+    ResultPointer pResult(new Result);
+    if (!query.prepare(request.queryString) || !query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return pResult;
+    }
+
+    const int columnCount = query.record().count();
+    int rowCount = 0;
+    while (query.next()) {
+        if (++rowCount % kRowsPerCancelCheck == 0 &&
+                load_atomic(m_cancelRunning)) {
+            return ResultPointer();
+        }
+        QVector<QVariant> row;
+        row.reserve(columnCount);
+        for (int i = 0; i < columnCount; ++i) {
+            row << query.value(i);
+        }
+        pResult->rows.append(row);
+    }
+    if (load_atomic(m_cancelRunning)) {
+        return ResultPointer();
+    }
+    if (!request.filterQueryString.isEmpty()) {
+        if (!executeFilter(database, request, pResult.data())) {
+            if (load_atomic(m_cancelRunning)) {
+                return ResultPointer();
+            }
+            return pResult;
+        }
+    }
+    pResult->ok = true;
+
+    kLogger.debug() << "Query took" << timer.elapsed().debugMillisWithUnit()
+                    << "for" << pResult->rows.size() << "rows";
+    return pResult;
+}
+
+bool SqlSelectThread::executeFilter(const QSqlDatabase& database,
+                                    const Request& request,
+                                    Result* pResult) {
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    if (!query.prepare(request.filterQueryString) || !query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    int rowCount = 0;
+    while (query.next()) {
+        if (++rowCount % kRowsPerCancelCheck == 0 &&
+                load_atomic(m_cancelRunning)) {
+            return false;
+        }
+        pResult->filteredTrackIds.append(TrackId(query.value(0)));
+    }
+    pResult->filtered = true;
+    return true;
+}
@@ -0,0 +1,110 @@
+#ifndef SQLSELECTTHREAD_H
+#define SQLSELECTTHREAD_H
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QList>
+#include <QMetaType>
+#include <QMutex>
+#include <QPair>
+#include <QSharedPointer>
+#include <QSqlDatabase>
+#include <QString>
+#include <QThread>
+#include <QVariant>
+#include <QVector>
+#include <QWaitCondition>
+
+#include "track/trackid.h"
+#include "util/db/dbconnectionpool.h"
+
+// Runs the SELECT queries of track table models on its own database
+// connection, so that loading a large crate or playlist doesn't block the
+// GUI thread. Each client has at most one query in flight: submitting a new
+// query discards a waiting one and cancels a running one of the same
+// client.
+//
+// Most table models select from temporary views that only exist on the
+// connection of the GUI thread. Their definitions are copied to the
+// connection of this thread before a query is executed.
+//
+// Optionally the ids of the tracks that match the search of the table
+// model are selected by a second query, e.g. the filter query of the
+// BaseTrackCache. Both queries read the same snapshot of the database.
+class SqlSelectThread : public QThread {
+    Q_OBJECT
+  public:
+    struct Result {
+        Result()
+                : ok(false),
+                  filtered(false) {
+        }
+        bool ok;
+        QVector<QVector<QVariant>> rows;
+        // Only valid if a filter query has been submitted
+        bool filtered;
+        QVector<TrackId> filteredTrackIds;
+    };
+    typedef QSharedPointer<Result> ResultPointer;
+
+    explicit SqlSelectThread(mixxx::DbConnectionPoolPtr pDbConnectionPool);
+    ~SqlSelectThread() override;
+
+    // Queues the query and the optional filter query, which selects the
+    // track ids in its first column. The temporary views are read from the
+    // given database. Returns the id that is passed to selectFinished().
+    int submit(const void* pClient,
+               const QSqlDatabase& database,
+               const QString& queryString,
+               const QString& filterQueryString = QString());
+    // Discards a waiting query and cancels a running query of the client.
+    void cancel(const void* pClient);
+
+    void stop();
+
+  signals:
+    void selectFinished(int requestId, SqlSelectThread::ResultPointer pResult);
+
+  protected:
+    void run() override;
+
+  private:
+    struct Request {
+        int id;
+        const void* pClient;
+        QString queryString;
+        QString filterQueryString;
+        // Name and SQL of each temporary view in order of creation
+        QList<QPair<QString, QString>> temporaryViews;
+    };
+
+    void copyTemporaryViews(const QSqlDatabase& database,
+                            const Request& request);
+    ResultPointer execute(const QSqlDatabase& database,
+                          const Request& request);
+    // Returns false if the query has failed or has been canceled
+    bool executeFilter(const QSqlDatabase& database,
+                       const Request& request,
+                       Result* pResult);
+
+    const mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
+
+    // You must hold m_mutex to touch the following members
+    QMutex m_mutex;
+    QWaitCondition m_requestAvailable;
+    QList<Request> m_requests;
+    const void* m_pRunningClient;
+    bool m_bStop;
+    int m_nextRequestId;
+
+    // Set to cancel the running query
+    QAtomicInt m_cancelRunning;
+
+    // The temporary views of the connection of this thread. Only touched by
+    // this thread.
+    QHash<QString, QString> m_temporaryViews;
+};
+
+Q_DECLARE_METATYPE(SqlSelectThread::ResultPointer);
+
+#endif // SQLSELECTTHREAD_H
@@ -17,7 +17,8 @@ TrackCollection::TrackCollection(
         const UserSettingsPointer& pConfig)
         : m_analysisDao(pConfig),
           m_trackDao(m_cueDao, m_playlistDao,
-                     m_analysisDao, m_libraryHashDao, pConfig) {
+                     m_analysisDao, m_libraryHashDao, pConfig),
+          m_previewCache(pConfig) {
 }
 
 TrackCollection::~TrackCollection() {
@@ -37,16 +38,38 @@ void TrackCollection::connectDatabase(QSqlDatabase database) {
     m_cueDao.initialize(database);
     m_directoryDao.initialize(database);
     m_analysisDao.initialize(database);
+    m_fingerprintDao.initialize(database);
     m_libraryHashDao.initialize(database);
+    m_searchIndexDao.initialize(database);
     m_crates.connectDatabase(database);
 }
 
 void TrackCollection::disconnectDatabase() {
+    if (m_pSelectThread) {
+        m_pSelectThread->stop();
+        m_pSelectThread.reset();
+    }
     m_database = QSqlDatabase();
     m_trackDao.finish();
+    // Release the cached prepared statements before the
+    // connection is closed
+    m_trackDao.initialize(QSqlDatabase());
+    m_playlistDao.initialize(QSqlDatabase());
+    m_cueDao.initialize(QSqlDatabase());
+    m_analysisDao.initialize(QSqlDatabase());
     m_crates.disconnectDatabase();
 }
 
+void TrackCollection::startSelectThread(
+        mixxx::DbConnectionPoolPtr pDbConnectionPool) {
+    VERIFY_OR_DEBUG_ASSERT(!m_pSelectThread) {
+        return;
+    }
+    m_pSelectThread = std::make_unique<SqlSelectThread>(
+            std::move(pDbConnectionPool));
+    m_pSelectThread->start(QThread::LowPriority);
+}
+
 void TrackCollection::setTrackSource(QSharedPointer<BaseTrackCache> pTrackSource) {
     VERIFY_OR_DEBUG_ASSERT(m_pTrackSource.isNull()) {
         return;
@@ -188,10 +211,13 @@ bool TrackCollection::purgeTracks(
     m_cueDao.deleteCuesForTracks(trackIds);
     m_playlistDao.removeTracksFromPlaylists(trackIds);
     m_analysisDao.deleteAnalyses(trackIds);
+    m_fingerprintDao.deleteFingerprints(trackIds);
+    m_previewCache.deleteIntros(trackIds);
 
     // Post-processing
     // TODO(XXX): Move signals from TrackDAO to TrackCollection
     m_trackDao.afterPurgingTracks(trackIds);
+    m_crates.afterPurgingTracks(trackIds);
 
     // Emit signal(s)
     // TODO(XXX): Emit signals here instead of from DAOs
@@ -266,6 +292,9 @@ bool TrackCollection::deleteCrate(
         return false;
     }
 
+    // Post-processing
+    m_crates.afterDeletingCrate(crateId);
+
     // Emit signals
     emit(crateDeleted(crateId));
 
@@ -287,6 +316,9 @@ bool TrackCollection::addCrateTracks(
         return false;
     }
 
+    // Post-processing
+    m_crates.afterAddingCrateTracks(crateId, trackIds);
+
     // Emit signals
     emit(crateTracksChanged(crateId, trackIds, QList<TrackId>()));
 
@@ -308,6 +340,9 @@ bool TrackCollection::removeCrateTracks(
         return false;
     }
 
+    // Post-processing
+    m_crates.afterRemovingCrateTracks(crateId, trackIds);
+
     // Emit signals
     emit(crateTracksChanged(crateId, QList<TrackId>(), trackIds));
 
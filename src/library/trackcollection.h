@@ -13,7 +13,13 @@
 #include "library/dao/playlistdao.h"
 #include "library/dao/analysisdao.h"
 #include "library/dao/directorydao.h"
+#include "library/dao/fingerprintdao.h"
 #include "library/dao/libraryhashdao.h"
+#include "library/dao/searchindexdao.h"
+#include "library/previewcache.h"
+#include "library/sqlselectthread.h"
+#include "util/db/dbconnectionpool.h"
+#include "util/memory.h"
 
 
 // forward declaration(s)
@@ -56,6 +62,17 @@ class TrackCollection : public QObject,
     AnalysisDao& getAnalysisDAO() {
         return m_analysisDao;
     }
+    const SearchIndexDAO& getSearchIndexDAO() const {
+        return m_searchIndexDao;
+    }
+
+    // Starts a thread with its own database connection from the pool, which
+    // table models use to load their rows without blocking the GUI thread.
+    void startSelectThread(mixxx::DbConnectionPoolPtr pDbConnectionPool);
+    // Returns nullptr if table models should query synchronously.
+    SqlSelectThread* getSelectThread() const {
+        return m_pSelectThread.get();
+    }
 
     QSharedPointer<BaseTrackCache> getTrackSource() const {
         return m_pTrackSource;
@@ -100,10 +117,15 @@ class TrackCollection : public QObject,
     CueDAO m_cueDao;
     DirectoryDAO m_directoryDao;
     AnalysisDao m_analysisDao;
+    FingerprintDao m_fingerprintDao;
     LibraryHashDAO m_libraryHashDao;
+    SearchIndexDAO m_searchIndexDao;
     TrackDAO m_trackDao;
+    PreviewCache m_previewCache;
 
     QSharedPointer<BaseTrackCache> m_pTrackSource;
+
+    std::unique_ptr<SqlSelectThread> m_pSelectThread;
 };
 
 #endif // TRACKCOLLECTION_H
@@ -95,6 +95,13 @@ class TrackModel {
         Q_UNUSED(sourceIndex);
         Q_UNUSED(destIndex);
     }
+    // Moves the tracks in front of destIndex, keeping their order. An
+    // invalid destIndex moves them to the end.
+    virtual void moveTracks(const QModelIndexList& sourceIndices,
+                            const QModelIndex& destIndex) {
+        Q_UNUSED(sourceIndices);
+        Q_UNUSED(destIndex);
+    }
     virtual bool isLocked() {
         return false;
     }
@@ -144,6 +151,13 @@ class TrackModel {
     virtual void select() {
     }
 
+    // Called by the view with the range of rows that are about to be
+    // painted, so the model can load them at once.
+    virtual void prefetchRows(int firstRow, int lastRow) {
+        Q_UNUSED(firstRow);
+        Q_UNUSED(lastRow);
+    }
+
   private:
     QSqlDatabase m_db;
     QString m_settingsNamespace;
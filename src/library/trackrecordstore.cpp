@@ -0,0 +1,245 @@
+#include "library/trackrecordstore.h"
+
+#include "util/assert.h"
+
+TrackRecordStore::TrackRecordStore(int columnCount)
+        : m_columnCount(columnCount) {
+    DEBUG_ASSERT(m_columnCount >= 0);
+}
+
+void TrackRecordStore::clear() {
+    m_trackIds.clear();
+    m_rowByTrackId.clear();
+    m_types.clear();
+    m_values.clear();
+    m_otherValues.clear();
+    m_strings.clear();
+    m_stringRefCounts.clear();
+    m_codeByString.clear();
+    m_freeStringCodes.clear();
+}
+
+void TrackRecordStore::setRecord(TrackId trackId,
+                                 const QVector<QVariant>& record) {
+    DEBUG_ASSERT(trackId.isValid());
+    int row = m_rowByTrackId.value(trackId, -1);
+    if (row < 0) {
+        row = m_trackIds.size();
+        m_trackIds.append(trackId);
+        m_rowByTrackId.insert(trackId, row);
+        m_types.resize(m_types.size() + m_columnCount);
+        m_values.resize(m_values.size() + m_columnCount);
+        for (int column = 0; column < m_columnCount; ++column) {
+            m_types[cellIndex(row, column)] = VALUE_NULL;
+            m_values[cellIndex(row, column)].integer = QVariant::Invalid;
+        }
+    }
+    for (int column = 0; column < m_columnCount; ++column) {
+        const int cell = cellIndex(row, column);
+        // Acquire the new value before releasing the old value, so
+        // that an unmodified string is not removed from the pool.
+        const ValueType oldType = m_types[cell];
+        const Value oldValue = m_values[cell];
+        setCell(cell, record.value(column));
+        if (oldType == VALUE_STRING) {
+            releaseString(oldValue.stringCode);
+        }
+    }
+}
+
+void TrackRecordStore::removeRecord(TrackId trackId) {
+    const int row = m_rowByTrackId.value(trackId, -1);
+    if (row < 0) {
+        return;
+    }
+    for (int column = 0; column < m_columnCount; ++column) {
+        releaseCell(cellIndex(row, column));
+    }
+    // Move the last row into the gap
+    const int lastRow = m_trackIds.size() - 1;
+    if (row != lastRow) {
+        for (int column = 0; column < m_columnCount; ++column) {
+            const int cell = cellIndex(row, column);
+            const int lastCell = cellIndex(lastRow, column);
+            m_types[cell] = m_types[lastCell];
+            m_values[cell] = m_values[lastCell];
+            if (m_types[cell] == VALUE_OTHER) {
+                m_otherValues.insert(cell, m_otherValues.take(lastCell));
+            }
+        }
+        m_trackIds[row] = m_trackIds[lastRow];
+        m_rowByTrackId[m_trackIds[row]] = row;
+    }
+    m_trackIds.resize(lastRow);
+    m_rowByTrackId.remove(trackId);
+    m_types.resize(lastRow * m_columnCount);
+    m_values.resize(lastRow * m_columnCount);
+}
+
+QVariant TrackRecordStore::value(TrackId trackId, int column,
+                                 const QVariant& defaultValue) const {
+    if (column < 0 || column >= m_columnCount) {
+        return defaultValue;
+    }
+    const int row = m_rowByTrackId.value(trackId, -1);
+    if (row < 0) {
+        return defaultValue;
+    }
+    return cellValue(cellIndex(row, column));
+}
+
+QVector<QVariant> TrackRecordStore::record(TrackId trackId) const {
+    QVector<QVariant> result;
+    const int row = m_rowByTrackId.value(trackId, -1);
+    if (row < 0) {
+        return result;
+    }
+    result.reserve(m_columnCount);
+    for (int column = 0; column < m_columnCount; ++column) {
+        result.append(cellValue(cellIndex(row, column)));
+    }
+    return result;
+}
+
+qint64 TrackRecordStore::memoryUsage() const {
+    // The size of a hash node without its key and value: the next pointer
+    // and the hash value, padded to pointer alignment
+    const qint64 kHashNodeSize = 2 * sizeof(void*);
+    // The header of the shared data of a string
+    const qint64 kStringHeaderSize = 3 * sizeof(int) + sizeof(void*);
+    qint64 result = 0;
+    result += m_trackIds.capacity() * sizeof(TrackId);
+    result += m_rowByTrackId.size() * (kHashNodeSize + sizeof(TrackId) + sizeof(int));
+    result += m_types.capacity() * sizeof(ValueType);
+    result += m_values.capacity() * sizeof(Value);
+    result += m_otherValues.size() * (kHashNodeSize + sizeof(int) + sizeof(QVariant));
+    result += m_strings.capacity() * sizeof(QString);
+    result += m_stringRefCounts.capacity() * sizeof(int);
+    result += m_freeStringCodes.capacity() * sizeof(int);
+    // The keys of m_codeByString share their data with m_strings
+    result += m_codeByString.size() * (kHashNodeSize + sizeof(QString) + sizeof(int));
+    for (const auto& string: m_strings) {
+        if (!string.isNull()) {
+            result += kStringHeaderSize + (string.capacity() + 1) * sizeof(QChar);
+        }
+    }
+    return result;
+}
+
+void TrackRecordStore::setCell(int cell, const QVariant& value) {
+    if (m_types[cell] == VALUE_OTHER) {
+        m_otherValues.remove(cell);
+    }
+    Value& target = m_values[cell];
+    if (value.isNull() && value.type() != QVariant::UserType) {
+        m_types[cell] = VALUE_NULL;
+        target.integer = value.type();
+        return;
+    }
+    switch (value.type()) {
+    case QVariant::Bool:
+        m_types[cell] = VALUE_BOOL;
+        target.integer = value.toBool();
+        break;
+    case QVariant::Int:
+        m_types[cell] = VALUE_INT;
+        target.integer = value.toInt();
+        break;
+    case QVariant::UInt:
+        m_types[cell] = VALUE_UINT;
+        target.unsignedInteger = value.toUInt();
+        break;
+    case QVariant::LongLong:
+        m_types[cell] = VALUE_LONGLONG;
+        target.integer = value.toLongLong();
+        break;
+    case QVariant::ULongLong:
+        m_types[cell] = VALUE_ULONGLONG;
+        target.unsignedInteger = value.toULongLong();
+        break;
+    case QVariant::Double:
+        m_types[cell] = VALUE_DOUBLE;
+        target.number = value.toDouble();
+        break;
+    case QVariant::String:
+        m_types[cell] = VALUE_STRING;
+        target.stringCode = internString(value.toString());
+        break;
+    default:
+        m_types[cell] = VALUE_OTHER;
+        target.integer = 0;
+        m_otherValues.insert(cell, value);
+    }
+}
+
+void TrackRecordStore::releaseCell(int cell) {
+    switch (m_types[cell]) {
+    case VALUE_STRING:
+        releaseString(m_values[cell].stringCode);
+        break;
+    case VALUE_OTHER:
+        m_otherValues.remove(cell);
+        break;
+    default:
+        break;
+    }
+    m_types[cell] = VALUE_NULL;
+    m_values[cell].integer = QVariant::Invalid;
+}
+
+QVariant TrackRecordStore::cellValue(int cell) const {
+    const Value& value = m_values[cell];
+    switch (m_types[cell]) {
+    case VALUE_NULL:
+        return QVariant(static_cast<QVariant::Type>(value.integer));
+    case VALUE_BOOL:
+        return QVariant(value.integer != 0);
+    case VALUE_INT:
+        return QVariant(static_cast<int>(value.integer));
+    case VALUE_UINT:
+        return QVariant(static_cast<uint>(value.unsignedInteger));
+    case VALUE_LONGLONG:
+        return QVariant(value.integer);
+    case VALUE_ULONGLONG:
+        return QVariant(value.unsignedInteger);
+    case VALUE_DOUBLE:
+        return QVariant(value.number);
+    case VALUE_STRING:
+        return QVariant(m_strings[value.stringCode]);
+    case VALUE_OTHER:
+        return m_otherValues.value(cell);
+    }
+    DEBUG_ASSERT(!"unhandled switch/case");
+    return QVariant();
+}
+
+int TrackRecordStore::internString(const QString& string) {
+    int code = m_codeByString.value(string, -1);
+    if (code >= 0) {
+        ++m_stringRefCounts[code];
+        return code;
+    }
+    if (m_freeStringCodes.isEmpty()) {
+        code = m_strings.size();
+        m_strings.append(string);
+        m_stringRefCounts.append(1);
+    } else {
+        code = m_freeStringCodes.takeLast();
+        m_strings[code] = string;
+        m_stringRefCounts[code] = 1;
+    }
+    // Don't keep the caller's buffer alive if it has extra capacity
+    m_strings[code].squeeze();
+    m_codeByString.insert(m_strings[code], code);
+    return code;
+}
+
+void TrackRecordStore::releaseString(int code) {
+    DEBUG_ASSERT(m_stringRefCounts[code] > 0);
+    if (--m_stringRefCounts[code] > 0) {
+        return;
+    }
+    m_codeByString.remove(m_strings[code]);
+    m_strings[code] = QString();
+    m_freeStringCodes.append(code);
+}
@@ -0,0 +1,112 @@
+#ifndef TRACKRECORDSTORE_H
+#define TRACKRECORDSTORE_H
+
+#include <QHash>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+#include "track/trackid.h"
+
+// A compact copy of the rows of a track table, e.g. all rows of the library
+// for searching and sorting without SQLite. Instead of a QVector<QVariant>
+// per track, the values of all tracks are stored in two flat arrays of
+// 1 byte for the type and 8 bytes for the value of each cell. Strings are
+// interned and reference counted, so the artist, album, genre, etc. of all
+// tracks share a single copy of each distinct string.
+//
+// The values are returned as QVariants of the same type and nullness as
+// they were stored, so that the store can replace a hash of QVariant
+// records without changing any results.
+class TrackRecordStore {
+  public:
+    explicit TrackRecordStore(int columnCount = 0);
+
+    void clear();
+
+    int columnCount() const {
+        return m_columnCount;
+    }
+    int rowCount() const {
+        return m_trackIds.size();
+    }
+    bool contains(TrackId trackId) const {
+        return m_rowByTrackId.contains(trackId);
+    }
+    // The ids of all stored tracks in no particular order
+    const QVector<TrackId>& trackIds() const {
+        return m_trackIds;
+    }
+
+    // Inserts or replaces the record of a track. Missing values are
+    // stored as invalid QVariants and extra values are ignored.
+    void setRecord(TrackId trackId, const QVector<QVariant>& record);
+    void removeRecord(TrackId trackId);
+
+    // Returns defaultValue if the track is not stored or if the column
+    // is out of range.
+    QVariant value(TrackId trackId, int column,
+                   const QVariant& defaultValue = QVariant()) const;
+    // Returns an empty record if the track is not stored.
+    QVector<QVariant> record(TrackId trackId) const;
+
+    // The number of distinct strings that are referenced by all records
+    int stringCount() const {
+        return m_strings.size() - m_freeStringCodes.size();
+    }
+    // An estimate of the heap memory in bytes that is allocated for the
+    // records, including the interned strings.
+    qint64 memoryUsage() const;
+
+  private:
+    enum ValueType : quint8 {
+        // The QVariant type of a null value is stored as an integer
+        VALUE_NULL,
+        VALUE_BOOL,
+        VALUE_INT,
+        VALUE_UINT,
+        VALUE_LONGLONG,
+        VALUE_ULONGLONG,
+        VALUE_DOUBLE,
+        VALUE_STRING,
+        // Any other type is stored unencoded in m_otherValues
+        VALUE_OTHER,
+    };
+
+    union Value {
+        qlonglong integer;
+        qulonglong unsignedInteger;
+        double number;
+        int stringCode;
+    };
+
+    int cellIndex(int row, int column) const {
+        return row * m_columnCount + column;
+    }
+    void setCell(int cell, const QVariant& value);
+    void releaseCell(int cell);
+    QVariant cellValue(int cell) const;
+
+    int internString(const QString& string);
+    void releaseString(int code);
+
+    int m_columnCount;
+
+    QVector<TrackId> m_trackIds;
+    QHash<TrackId, int> m_rowByTrackId;
+
+    // Parallel arrays of rowCount() * columnCount() cells in row order
+    QVector<ValueType> m_types;
+    QVector<Value> m_values;
+    // The values of VALUE_OTHER cells by cell index
+    QHash<int, QVariant> m_otherValues;
+
+    // The interned strings and the number of cells that reference them.
+    // Unreferenced codes are reused.
+    QVector<QString> m_strings;
+    QVector<int> m_stringRefCounts;
+    QHash<QString, int> m_codeByString;
+    QVector<int> m_freeStringCodes;
+};
+
+#endif // TRACKRECORDSTORE_H
@@ -0,0 +1,91 @@
+#include "library/tracktagwriter.h"
+
+#include "sources/soundsourceproxy.h"
+#include "track/track.h"
+#include "util/logger.h"
+#include "util/trace.h"
+
+namespace {
+
+const mixxx::Logger kLogger("TrackTagWriter");
+
+}  // anonymous namespace
+
+TrackTagWriter::TrackTagWriter()
+        : m_bStop(false) {
+    setObjectName("TrackTagWriter");
+}
+
+TrackTagWriter::~TrackTagWriter() {
+    stop();
+}
+
+bool TrackTagWriter::enqueue(const Track& track) {
+    mixxx::TrackMetadata trackMetadata;
+    bool parsedFromFile = false;
+    track.getTrackMetadata(&trackMetadata, &parsedFromFile);
+    if (!parsedFromFile) {
+        kLogger.debug() << "Skip writing of track metadata into file"
+                << track.getLocation();
+        return true;
+    }
+    const QString location = track.getCanonicalLocation();
+    if (location.isEmpty()) {
+        kLogger.debug() << "Failed to write track metadata into missing file"
+                << track.getLocation();
+        return true;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_pendingMetadata.find(location);
+    if (it != m_pendingMetadata.end()) {
+        // Coalesce with the pending write
+        it.value() = trackMetadata;
+        return true;
+    }
+    if (m_pendingLocations.size() >= kMaxBacklog) {
+        kLogger.warning() << "Backlog full, not writing track metadata of"
+                << location;
+        return false;
+    }
+    m_pendingLocations.append(location);
+    m_pendingMetadata.insert(location, trackMetadata);
+    m_writeAvailable.wakeAll();
+    return true;
+}
+
+int TrackTagWriter::backlog() {
+    QMutexLocker locker(&m_mutex);
+    return m_pendingLocations.size();
+}
+
+void TrackTagWriter::stop() {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_bStop = true;
+        m_writeAvailable.wakeAll();
+    }
+    wait();
+}
+
+void TrackTagWriter::run() {
+    while (true) {
+        QString location;
+        mixxx::TrackMetadata trackMetadata;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (!m_bStop && m_pendingLocations.isEmpty()) {
+                m_writeAvailable.wait(&m_mutex);
+            }
+            // Drain the backlog before stopping
+            if (m_pendingLocations.isEmpty()) {
+                break;
+            }
+            location = m_pendingLocations.takeFirst();
+            trackMetadata = m_pendingMetadata.take(location);
+        }
+
+        Trace trace("TrackTagWriter::write");
+        SoundSourceProxy::saveTrackMetadata(location, trackMetadata);
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef TRACKTAGWRITER_H
+#define TRACKTAGWRITER_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "track/trackmetadata.h"
+
+class Track;
+
+// Writes the metadata of saved tracks into the tags of their files on a
+// low-priority thread, so that saving tracks doesn't block the GUI thread
+// on file I/O. A snapshot of the metadata is taken when a track is queued.
+// Pending writes into the same file are coalesced and only the latest
+// metadata is written.
+//
+// The backlog is bounded. When it is full, enqueue() fails and the caller
+// has to write the tags itself.
+class TrackTagWriter : public QThread {
+    Q_OBJECT
+  public:
+    static const int kMaxBacklog = 100;
+
+    TrackTagWriter();
+    // Writes the pending tags before returning
+    ~TrackTagWriter() override;
+
+    // Returns false if the backlog is full. Tracks that have never been
+    // parsed from their files are skipped.
+    bool enqueue(const Track& track);
+
+    // The number of files with pending writes
+    int backlog();
+
+    // Writes the pending tags and stops the thread.
+    void stop();
+
+  protected:
+    void run() override;
+
+  private:
+    // You must hold m_mutex to touch the following members
+    QMutex m_mutex;
+    QWaitCondition m_writeAvailable;
+    // The canonical locations of the files in order of arrival
+    QList<QString> m_pendingLocations;
+    QHash<QString, mixxx::TrackMetadata> m_pendingMetadata;
+    bool m_bStop;
+};
+
+#endif // TRACKTAGWRITER_H
@@ -10,6 +10,7 @@
 
 #include "library/traktor/traktorfeature.h"
 
+#include "library/dao/settingsdao.h"
 #include "library/librarytablemodel.h"
 #include "library/missingtablemodel.h"
 #include "library/queryutil.h"
@@ -17,6 +18,17 @@
 #include "library/treeitem.h"
 #include "util/sandbox.h"
 
+namespace {
+
+// Identifies the collection file of the last complete import
+const QString kCollectionVersionKey = "mixxx.traktorfeature.collectionversion";
+
+// Separates the names of the folders and the playlist in the unique path
+// of a playlist
+const QString kPlaylistPathDelimiter = "-->";
+
+}  // anonymous namespace
+
 TraktorTrackModel::TraktorTrackModel(QObject* parent,
                                      TrackCollection* pTrackCollection,
                                      QSharedPointer<BaseTrackCache> trackSource)
@@ -99,6 +111,12 @@ TraktorFeature::TraktorFeature(QObject* parent, TrackCollection* pTrackCollectio
     }
     connect(&m_future_watcher, SIGNAL(finished()),
             this, SLOT(onTrackCollectionLoaded()));
+    connect(this, SIGNAL(tracksImported()),
+            this, SLOT(slotTracksImported()),
+            Qt::QueuedConnection);
+    connect(this, SIGNAL(playlistsImported(QStringList)),
+            this, SLOT(slotPlaylistsImported(QStringList)),
+            Qt::QueuedConnection);
 }
 
 TraktorFeature::~TraktorFeature() {
@@ -139,15 +157,9 @@ void TraktorFeature::activate() {
 
     if (!m_isActivated) {
         m_isActivated =  true;
-        // Ususally the maximum number of threads
-        // is > 2 depending on the CPU cores
-        // Unfortunately, within VirtualBox
-        // the maximum number of allowed threads
-        // is 1 at all times We'll need to increase
-        // the number to > 1, otherwise importing the music collection
-        // takes place when the GUI threads terminates, i.e., on
-        // Mixxx shutdown.
-        QThreadPool::globalInstance()->setMaxThreadCount(4); //Tobias decided to use 4
+        // Playlists are added to the new root item while they are imported
+        m_childModel.setRootItem(std::make_unique<TreeItem>(this));
+        reserveImportThread();
         // Let a worker thread do the XML parsing
         m_future = QtConcurrent::run(this, &TraktorFeature::importLibrary,
                                      getTraktorMusicDatabase());
@@ -182,8 +194,20 @@ TreeItem* TraktorFeature::importLibrary(QString file) {
     thisThread->setPriority(QThread::LowPriority);
     //Invisible root item of Traktor's child model
     TreeItem* root = NULL;
+
+    // The tables still hold the result of the last complete import if the
+    // collection has not been touched since then.
+    const QString sourceVersion = sourceFilesVersion(QStringList() << file);
+    SettingsDAO settings(m_database);
+    if (settings.getValue(kCollectionVersionKey) == sourceVersion) {
+        qDebug() << "Traktor music collection is unchanged since the last import";
+        return loadPlaylists();
+    }
+
     //Delete all table entries of Traktor feature
     ScopedTransaction transaction(m_database);
+    // The tables are incomplete until the import has finished
+    settings.setValue(kCollectionVersionKey, QString());
     clearTable("traktor_playlist_tracks");
     clearTable("traktor_library");
     clearTable("traktor_playlists");
@@ -220,6 +244,10 @@ TreeItem* TraktorFeature::importLibrary(QString file) {
                 //parse track
                 parseTrack(xml, query);
                 ++nAudioFiles; //increment number of files in the music collection
+                if (nAudioFiles % kTracksPerImportTransaction == 0) {
+                    transaction.commit();
+                    transaction.transaction();
+                }
             }
             if (xml.name() == "PLAYLISTS") {
                 inPlaylistsTag = true;
@@ -230,7 +258,7 @@ TreeItem* TraktorFeature::importLibrary(QString file) {
 
                 if (nodetype == "FOLDER" && name == "$ROOT") {
                     //process all playlists
-                    root = parsePlaylists(xml);
+                    root = parsePlaylists(xml, &transaction);
                     isRootFolderParsed = true;
                 }
             }
@@ -238,6 +266,10 @@ TreeItem* TraktorFeature::importLibrary(QString file) {
         if (xml.isEndElement()) {
             if (xml.name() == "COLLECTION") {
                 inCollectionTag = false;
+                // Commit the tracks before the playlists that refer to them
+                transaction.commit();
+                transaction.transaction();
+                emit(tracksImported());
             }
             if (xml.name() == "PLAYLISTS" && inPlaylistsTag) {
                 inPlaylistsTag = false;
@@ -256,9 +288,47 @@ TreeItem* TraktorFeature::importLibrary(QString file) {
     //initialize TraktorTableModel
     transaction.commit();
 
+    if (root && !m_cancelImport) {
+        settings.setValue(kCollectionVersionKey, sourceVersion);
+    }
     return root;
 }
 
+// Builds the child model from the playlists of the last import. Folders
+// without any playlists are not restored.
+TreeItem* TraktorFeature::loadPlaylists() {
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT name FROM traktor_playlists ORDER BY id")) {
+        LOG_FAILED_QUERY(query);
+        return NULL;
+    }
+    TreeItem* rootItem = new TreeItem(this);
+    while (query.next()) {
+        const QString playlistPath = query.value(0).toString();
+        const QStringList names = playlistPath.split(
+                kPlaylistPathDelimiter, QString::SkipEmptyParts);
+        TreeItem* parent = rootItem;
+        QString path;
+        for (const auto& name: names) {
+            path += kPlaylistPathDelimiter;
+            path += name;
+            TreeItem* item = NULL;
+            for (TreeItem* child: parent->children()) {
+                if (child->getData().toString() == path) {
+                    item = child;
+                    break;
+                }
+            }
+            if (!item) {
+                item = parent->appendChild(name, path);
+            }
+            parent = item;
+        }
+    }
+    return rootItem;
+}
+
 void TraktorFeature::parseTrack(QXmlStreamReader &xml, QSqlQuery &query) {
     QString title;
     QString artist;
@@ -373,14 +443,17 @@ void TraktorFeature::parseTrack(QXmlStreamReader &xml, QSqlQuery &query) {
 // A folder can contain folders and playlists. A playlist contains entries but no folders.
 // In other words, Traktor uses a tree structure to organize music.
 // Inner nodes represent folders while leaves are playlists.
-TreeItem* TraktorFeature::parsePlaylists(QXmlStreamReader &xml) {
+TreeItem* TraktorFeature::parsePlaylists(QXmlStreamReader &xml,
+                                         ScopedTransaction* pTransaction) {
 
     qDebug() << "Process RootFolder";
     //Each playlist is unique and can be identified by a path in the tree structure.
     QString current_path = "";
     QMap<QString,QString> map;
 
-    QString delimiter = "-->";
+    const QString& delimiter = kPlaylistPathDelimiter;
+    // The playlists that have not been committed yet
+    QStringList newPlaylists;
 
     TreeItem *rootItem = new TreeItem(this);
     TreeItem * parent = rootItem;
@@ -422,6 +495,13 @@ TreeItem* TraktorFeature::parsePlaylists(QXmlStreamReader &xml) {
                     parsePlaylistEntries(xml, current_path,
                                          query_insert_to_playlists,
                                          query_insert_to_playlist_tracks);
+                    newPlaylists << current_path;
+                    if (newPlaylists.size() >= kPlaylistsPerImportTransaction) {
+                        pTransaction->commit();
+                        pTransaction->transaction();
+                        emit(playlistsImported(newPlaylists));
+                        newPlaylists.clear();
+                    }
                 }
             }
         }
@@ -597,6 +677,38 @@ QString TraktorFeature::getTraktorMusicDatabase() {
     return musicFolder;
 }
 
+void TraktorFeature::slotTracksImported() {
+    // Show the imported tracks while the playlists are being imported
+    m_trackSource->buildIndex();
+    emit(showTrackModel(m_pTraktorTableModel));
+}
+
+void TraktorFeature::slotPlaylistsImported(QStringList playlistPaths) {
+    for (const auto& playlistPath: playlistPaths) {
+        const QStringList names = playlistPath.split(
+                kPlaylistPathDelimiter, QString::SkipEmptyParts);
+        // Add the folders of the playlist that are not shown yet
+        QModelIndex parentIndex;
+        QString path;
+        for (const auto& name: names) {
+            path += kPlaylistPathDelimiter;
+            path += name;
+            TreeItem* parent = m_childModel.getItem(parentIndex);
+            int row = 0;
+            while (row < parent->childRows() &&
+                    parent->child(row)->getData().toString() != path) {
+                ++row;
+            }
+            if (row == parent->childRows()) {
+                QList<TreeItem*> items;
+                items << new TreeItem(this, name, path);
+                m_childModel.insertTreeItemRows(items, row, parentIndex);
+            }
+            parentIndex = m_childModel.index(row, 0, parentIndex);
+        }
+    }
+}
+
 void TraktorFeature::onTrackCollectionLoaded() {
     std::unique_ptr<TreeItem> root(m_future.result());
     if (root) {
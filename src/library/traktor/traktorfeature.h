@@ -18,6 +18,7 @@
 
 class TrackCollection;
 class BaseExternalPlaylistModel;
+class ScopedTransaction;
 
 class TraktorTrackModel : public BaseExternalTrackModel {
   public:
@@ -53,13 +54,26 @@ class TraktorFeature : public BaseExternalLibraryFeature {
     void refreshLibraryModels();
     void onTrackCollectionLoaded();
 
+  signals:
+    // Emitted by the import thread after the tracks have been committed
+    void tracksImported();
+    // Emitted by the import thread after the playlists with the given
+    // paths have been committed
+    void playlistsImported(QStringList playlistPaths);
+
+  private slots:
+    void slotTracksImported();
+    void slotPlaylistsImported(QStringList playlistPaths);
+
   private:
     virtual BaseSqlTableModel* getPlaylistModelForPlaylist(QString playlist);
     TreeItem* importLibrary(QString file);
+    TreeItem* loadPlaylists();
     // parses a track in the music collection
     void parseTrack(QXmlStreamReader &xml, QSqlQuery &query);
     // Iterates over all playliost and folders and constructs the childmodel
-    TreeItem* parsePlaylists(QXmlStreamReader &xml);
+    TreeItem* parsePlaylists(QXmlStreamReader &xml,
+                             ScopedTransaction* pTransaction);
     // processes a particular playlist
     void parsePlaylistEntries(QXmlStreamReader &xml, QString playlist_path,
     QSqlQuery query_insert_into_playlist, QSqlQuery query_insert_into_playlisttracks);
@@ -264,7 +264,9 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
     delete pModplugPrefs; // not needed anymore
 #endif
 
-    CoverArtCache::create();
+    CoverArtCache* pCoverArtCache = CoverArtCache::create();
+    pCoverArtCache->openThumbnailStore(
+            QDir(pConfig->getSettingsPath()).filePath("coverart"));
 
     m_pDbConnectionPool = MixxxDb(pConfig).connectionPool();
     if (!m_pDbConnectionPool) {
@@ -429,6 +431,11 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
     // loaded a skin, see Bug #1047435
     if (rescan || hasChanged_MusicDir || m_pSettingsManager->shouldRescanLibrary()) {
         m_pLibrary->scan();
+    } else if (pConfig->getValue<bool>(
+            ConfigKey("[Library]", "WatchDirectories"), false)) {
+        // Pick up the changes that have been made while Mixxx was not
+        // running.
+        m_pLibrary->scanModifiedDirectories();
     }
 
     // Try open player device If that fails, the preference panel is opened.
@@ -617,7 +624,7 @@ void MixxxMainWindow::finalize() {
                 continue;
             }
             ConfigKey key = pCDP->getKey();
-            qDebug() << key.group << key.item << pCDP->getCreatorCO();
+            qDebug() << key.group() << key.item() << pCDP->getCreatorCO();
             leakedConfigKeys.append(key);
         }
 
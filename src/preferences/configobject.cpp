@@ -6,6 +6,8 @@
 #include <QDir>
 #include <QtDebug>
 
+#include <algorithm>
+
 #include "widget/wwidget.h"
 #include "util/cmdlineargs.h"
 #include "util/xml.h"
@@ -77,19 +79,126 @@ QString computeSettingsPath(const QString& configFilename) {
     return configFileInfo.absoluteDir().absolutePath();
 }
 
+// Process-wide table of interned ConfigKey group and item strings. Strings are
+// stored in fixed-size chunks that are never moved or freed, so a symbol id
+// that has been handed out can be resolved without taking the lock.
+class ConfigKeySymbolTable {
+  public:
+    static ConfigKeySymbolTable& instance() {
+        static ConfigKeySymbolTable s_instance;
+        return s_instance;
+    }
+
+    quint32 intern(const QString& string) {
+        if (string.isNull()) {
+            return kNullSymbol;
+        }
+        {
+            QReadLocker locker(&m_lock);
+            auto it = m_symbolIds.constFind(string);
+            if (it != m_symbolIds.constEnd()) {
+                return it.value();
+            }
+        }
+        QWriteLocker locker(&m_lock);
+        // Another thread may have interned the string in the meantime.
+        auto it = m_symbolIds.constFind(string);
+        if (it != m_symbolIds.constEnd()) {
+            return it.value();
+        }
+        return insert(string);
+    }
+
+    const QString& lookup(quint32 id) const {
+        return m_chunks[id / kChunkSize][id % kChunkSize];
+    }
+
+    int size() const {
+        QReadLocker locker(&m_lock);
+        return static_cast<int>(m_size);
+    }
+
+  private:
+    static const quint32 kNullSymbol = 0;
+    static const quint32 kEmptySymbol = 1;
+    static const quint32 kChunkSize = 1024;
+    // Allows up to 4M distinct strings, far more than any configuration.
+    static const quint32 kMaxChunks = 4096;
+
+    ConfigKeySymbolTable()
+            : m_size(0) {
+        std::fill(m_chunks, m_chunks + kMaxChunks, nullptr);
+        m_chunks[0] = new QString[kChunkSize];
+        // QString() and QString("") compare equal, so only the empty string
+        // is looked up through the hash. Null strings are mapped to
+        // kNullSymbol directly in intern().
+        m_chunks[0][kNullSymbol] = QString();
+        m_chunks[0][kEmptySymbol] = QString("");
+        m_symbolIds.insert(m_chunks[0][kEmptySymbol], kEmptySymbol);
+        m_size = kEmptySymbol + 1;
+    }
+
+    // Must be called with the write lock held.
+    quint32 insert(const QString& string) {
+        const quint32 id = m_size;
+        const quint32 chunk = id / kChunkSize;
+        if (chunk >= kMaxChunks) {
+            reportFatalErrorAndQuit("ConfigKey symbol table is full");
+        }
+        if (m_chunks[chunk] == nullptr) {
+            m_chunks[chunk] = new QString[kChunkSize];
+        }
+        // The copy in the chunk and the hash key share the string data.
+        m_chunks[chunk][id % kChunkSize] = string;
+        m_symbolIds.insert(string, id);
+        ++m_size;
+        return id;
+    }
+
+    mutable QReadWriteLock m_lock;
+    QHash<QString, quint32> m_symbolIds;
+    QString* m_chunks[kMaxChunks];
+    quint32 m_size;
+};
+
 }  // namespace
 
-ConfigKey::ConfigKey() {
+// static
+ConfigKey::SymbolId ConfigKey::internSymbol(const QString& string) {
+    return ConfigKeySymbolTable::instance().intern(string);
+}
+
+// static
+const QString& ConfigKey::symbolString(SymbolId id) {
+    return ConfigKeySymbolTable::instance().lookup(id);
+}
+
+// static
+int ConfigKey::symbolCount() {
+    return ConfigKeySymbolTable::instance().size();
+}
+
+ConfigKey::ConfigKey()
+    : m_groupId(kNullSymbol),
+      m_itemId(kNullSymbol) {
 }
 
 ConfigKey::ConfigKey(const ConfigKey& key)
-    : group(key.group),
-      item(key.item) {
+    : m_groupId(key.m_groupId),
+      m_itemId(key.m_itemId) {
 }
 
 ConfigKey::ConfigKey(const QString& g, const QString& i)
-    : group(g),
-      item(i) {
+    : m_groupId(internSymbol(g)),
+      m_itemId(internSymbol(i)) {
+}
+
+void ConfigKey::setGroup(const QString& group) {
+    m_groupId = internSymbol(group);
+}
+
+void ConfigKey::setItem(const QString& item) {
+    m_itemId = internSymbol(item);
 }
 
 // static
@@ -244,12 +353,12 @@ template <class ValueType> void ConfigObject<ValueType>::save() {
 
         typename QMap<ConfigKey, ValueType>::const_iterator i;
         for (i = m_values.begin(); i != m_values.end(); ++i) {
-            //qDebug() << "group:" << it.key().group << "item" << it.key().item << "val" << it.value()->value;
-            if (i.key().group != grp) {
-                grp = i.key().group;
+            //qDebug() << "group:" << it.key().group() << "item" << it.key().item() << "val" << it.value()->value;
+            if (i.key().group() != grp) {
+                grp = i.key().group();
                 stream << "\n" << grp << "\n";
             }
-            stream << i.key().item << " " << i.value().value << "\n";
+            stream << i.key().item() << " " << i.value().value << "\n";
         }
         file.close();
         if (file.error()!=QFile::NoError) { //could be better... should actually say what the error was..
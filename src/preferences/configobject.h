@@ -13,6 +13,11 @@
 
 // Class for the key for a specific configuration element. A key consists of a
 // group and an item.
+//
+// Group and item strings are interned into a process-wide symbol table, so a
+// ConfigKey is just a pair of 32-bit symbol ids. Hashing and equality only
+// compare the ids, which keeps lookups in the control registry cheap and lets
+// the tens of thousands of keys created at startup share their strings.
 class ConfigKey {
   public:
     ConfigKey(); // is required for qMetaTypeConstructHelper()
@@ -20,43 +25,91 @@ class ConfigKey {
     ConfigKey(const QString& g, const QString& i);
     static ConfigKey parseCommaSeparated(const QString& key);
 
+    ConfigKey& operator=(const ConfigKey& key) {
+        m_groupId = key.m_groupId;
+        m_itemId = key.m_itemId;
+        return *this;
+    }
+
+    const QString& group() const {
+        return symbolString(m_groupId);
+    }
+    void setGroup(const QString& group);
+
+    const QString& item() const {
+        return symbolString(m_itemId);
+    }
+    void setItem(const QString& item);
+
     inline bool isEmpty() const {
-        return group.isEmpty() && item.isEmpty();
+        return m_groupId <= kEmptySymbol && m_itemId <= kEmptySymbol;
     }
 
     inline bool isNull() const {
-        return group.isNull() && item.isNull();
+        return m_groupId == kNullSymbol && m_itemId == kNullSymbol;
     }
 
-    // comparison function for ConfigKeys. Used by a QHash in ControlObject
+    // comparison function for ConfigKeys. Used by a QHash in ControlObject.
+    // Like QString, null and empty strings compare equal.
     friend inline bool operator==(const ConfigKey& lhs, const ConfigKey& rhs) {
-        return lhs.group == rhs.group && lhs.item == rhs.item;
+        return equivalentSymbol(lhs.m_groupId) == equivalentSymbol(rhs.m_groupId) &&
+                equivalentSymbol(lhs.m_itemId) == equivalentSymbol(rhs.m_itemId);
+    }
+
+    friend inline bool operator!=(const ConfigKey& lhs, const ConfigKey& rhs) {
+        return !(lhs == rhs);
     }
 
-    // comparison function for ConfigKeys. Used by a QMap in ControlObject
+    // comparison function for ConfigKeys. Used by a QMap in ControlObject.
+    // Compares the strings (not the symbol ids) so that iterating a
+    // QMap<ConfigKey, ...> still yields keys in lexical order.
     friend inline bool operator<(const ConfigKey& lhs, const ConfigKey& rhs) {
-        int groupResult = lhs.group.compare(rhs.group);
-        if (groupResult == 0) {
-            return lhs.item < rhs.item;
+        if (equivalentSymbol(lhs.m_groupId) != equivalentSymbol(rhs.m_groupId)) {
+            return lhs.group() < rhs.group();
         }
-        return (groupResult < 0);
+        if (equivalentSymbol(lhs.m_itemId) != equivalentSymbol(rhs.m_itemId)) {
+            return lhs.item() < rhs.item();
+        }
+        return false;
+    }
+
+    friend inline uint qHash(const ConfigKey& key) {
+        return qHash((static_cast<quint64>(equivalentSymbol(key.m_groupId)) << 32) |
+                equivalentSymbol(key.m_itemId));
+    }
+
+    // The number of distinct group and item strings interned so far,
+    // including the reserved null and empty strings.
+    static int symbolCount();
+
+  private:
+    typedef quint32 SymbolId;
+
+    // Reserved symbols for QString() and QString("").
+    static const SymbolId kNullSymbol = 0;
+    static const SymbolId kEmptySymbol = 1;
+
+    static SymbolId internSymbol(const QString& string);
+    static const QString& symbolString(SymbolId id);
+
+    // Maps the null string onto the empty string for comparisons
+    // and hashing. Only isNull() distinguishes them.
+    static SymbolId equivalentSymbol(SymbolId id) {
+        return (id == kNullSymbol) ? kEmptySymbol : id;
     }
-    QString group, item;
+
+    SymbolId m_groupId;
+    SymbolId m_itemId;
 };
 Q_DECLARE_METATYPE(ConfigKey);
 
 
 // stream operator function for trivial qDebug()ing of ConfigKeys
 inline QDebug operator<<(QDebug stream, const ConfigKey& c1) {
-    stream << c1.group << "," << c1.item;
+    stream << c1.group() << "," << c1.item();
     return stream;
 }
 
-// QHash hash function for ConfigKey objects.
-inline uint qHash(const ConfigKey& key) {
-    return qHash(key.group) ^ qHash(key.item);
-}
-
 inline uint qHash(const QKeySequence& key) {
     return qHash(key.toString());
 }
@@ -46,6 +46,9 @@ DlgPrefAutoDJ::DlgPrefAutoDJ(QWidget* pParent,
     autoDJRandomQueueMinimumSpinBox->setValue(
             m_pConfig->getValue(
                     ConfigKey("[Auto DJ]", "RandomQueueMinimumAllowed"), 5));
+    autoDJRandomQueueMatchingCheckBox->setChecked(
+            m_pConfig->getValue(
+                    ConfigKey("[Auto DJ]", "RandomQueueMatching"), false));
     slotEnableAutoDJRandomQueueComboBox(
             m_pConfig->getValueString(ConfigKey("[Auto DJ]", "Requeue")).toInt());
     slotEnableAutoDJRandomQueue(
@@ -59,6 +62,8 @@ DlgPrefAutoDJ::DlgPrefAutoDJ(QWidget* pParent,
             SLOT(slotEnableAutoDJRandomQueue(int)));
     connect(autoDJRandomQueueMinimumSpinBox, SIGNAL(valueChanged(int)), this,
             SLOT(slotSetAutoDJRandomQueueMin(int)));
+    connect(autoDJRandomQueueMatchingCheckBox, SIGNAL(stateChanged(int)), this,
+            SLOT(slotSetAutoDJRandomQueueMatching(int)));
 }
 
 DlgPrefAutoDJ::~DlgPrefAutoDJ() {
@@ -88,6 +93,9 @@ void DlgPrefAutoDJ::slotApply() {
     m_pConfig->setValue(ConfigKey("[Auto DJ]", "EnableRandomQueue"),
             m_pConfig->getValue(
                     ConfigKey("[Auto DJ]", "EnableRandomQueueBuff"), 0));
+    m_pConfig->setValue(ConfigKey("[Auto DJ]", "RandomQueueMatching"),
+            m_pConfig->getValue(
+                    ConfigKey("[Auto DJ]", "RandomQueueMatchingBuff"), 0));
 }
 
 void DlgPrefAutoDJ::slotCancel() {
@@ -117,6 +125,12 @@ void DlgPrefAutoDJ::slotCancel() {
     autoDJRandomQueueMinimumSpinBox->setValue(
             m_pConfig->getValue(
                     ConfigKey("[Auto DJ]", "RandomQueueMinimumAllowed"), 5));
+    autoDJRandomQueueMatchingCheckBox->setChecked(
+            m_pConfig->getValue(
+                    ConfigKey("[Auto DJ]", "RandomQueueMatching"), false));
+    m_pConfig->setValue(ConfigKey("[Auto DJ]", "RandomQueueMatchingBuff"),
+            m_pConfig->getValue(
+                    ConfigKey("[Auto DJ]", "RandomQueueMatching"), 0));
     ComboBoxAutoDjRandomQueue->setCurrentIndex(
             m_pConfig->getValue(
                     ConfigKey("[Auto DJ]", "EnableRandomQueue"), 0));
@@ -143,9 +157,12 @@ void DlgPrefAutoDJ::slotResetToDefaults() {
     autoDjIgnoreTimeEdit->setEnabled(false);
 
     autoDJRandomQueueMinimumSpinBox->setValue(5);
+    autoDJRandomQueueMatchingCheckBox->setChecked(false);
+    m_pConfig->set(ConfigKey("[Auto DJ]", "RandomQueueMatchingBuff"),QString("0"));
     ComboBoxAutoDjRandomQueue->setCurrentIndex(0);
     m_pConfig->set(ConfigKey("[Auto DJ]", "EnableRandomQueueBuff"),QString("0"));
     autoDJRandomQueueMinimumSpinBox->setEnabled(false);
+    autoDJRandomQueueMatchingCheckBox->setEnabled(false);
     ComboBoxAutoDjRandomQueue->setEnabled(true);
 }
 
@@ -179,6 +196,11 @@ void DlgPrefAutoDJ::slotSetAutoDJRandomQueueMin(int a_iValue) {
     m_pConfig->set(ConfigKey("[Auto DJ]", "RandomQueueMinimumAllowedBuff"), str);
 }
 
+void DlgPrefAutoDJ::slotSetAutoDJRandomQueueMatching(int a_iState) {
+    QString strChecked = (a_iState == Qt::Checked) ? "1" : "0";
+    m_pConfig->set(ConfigKey("[Auto DJ]", "RandomQueueMatchingBuff"), strChecked);
+}
+
 void DlgPrefAutoDJ::slotEnableAutoDJRandomQueueComboBox(int a_iValue) {
     if (a_iValue == 1) {
         // Requeue is enabled
@@ -187,11 +209,13 @@ void DlgPrefAutoDJ::slotEnableAutoDJRandomQueueComboBox(int a_iValue) {
         ComboBoxAutoDjRandomQueue->setCurrentIndex(0);
         ComboBoxAutoDjRandomQueue->setEnabled(false);
         autoDJRandomQueueMinimumSpinBox->setEnabled(false);
+        autoDJRandomQueueMatchingCheckBox->setEnabled(false);
     } else {
         ComboBoxAutoDjRandomQueue->setEnabled(true);
-        autoDJRandomQueueMinimumSpinBox->setEnabled(
-                m_pConfig->getValue(
-                        ConfigKey("[Auto DJ]", "EnableRandomQueueBuff"), false));
+        bool bRandomQueue = m_pConfig->getValue(
+                ConfigKey("[Auto DJ]", "EnableRandomQueueBuff"), false);
+        autoDJRandomQueueMinimumSpinBox->setEnabled(bRandomQueue);
+        autoDJRandomQueueMatchingCheckBox->setEnabled(bRandomQueue);
     }
 }
 
@@ -199,10 +223,12 @@ void DlgPrefAutoDJ::slotEnableAutoDJRandomQueue(int a_iValue) {
     // Disable enable the option to select minimum tracks
     if (a_iValue == 0) {
         autoDJRandomQueueMinimumSpinBox->setEnabled(false);
+        autoDJRandomQueueMatchingCheckBox->setEnabled(false);
         m_pConfig->set(ConfigKey("[Auto DJ]", "EnableRandomQueueBuff"),
                 ConfigValue(0));
     } else {
         autoDJRandomQueueMinimumSpinBox->setEnabled(true);
+        autoDJRandomQueueMatchingCheckBox->setEnabled(true);
         m_pConfig->set(ConfigKey("[Auto DJ]", "EnableRandomQueueBuff"),
                 ConfigValue(1));
     }
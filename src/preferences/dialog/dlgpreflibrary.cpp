@@ -148,6 +148,7 @@ void DlgPrefLibrary::slotExtraPlugins() {
 
 void DlgPrefLibrary::slotResetToDefaults() {
     checkBox_library_scan->setChecked(false);
+    checkBox_watch_directories->setChecked(false);
     checkbox_ID3_sync->setChecked(false);
     checkBox_use_relative_path->setChecked(false);
     checkBox_show_rhythmbox->setChecked(true);
@@ -165,6 +166,8 @@ void DlgPrefLibrary::slotUpdate() {
     initializeDirList();
     checkBox_library_scan->setChecked(m_pconfig->getValue(
             ConfigKey("[Library]","RescanOnStartup"), false));
+    checkBox_watch_directories->setChecked(m_pconfig->getValue(
+            ConfigKey("[Library]","WatchDirectories"), false));
     checkbox_ID3_sync->setChecked(m_pconfig->getValue(
             ConfigKey("[Library]","WriteAudioTags"), false));
     checkBox_use_relative_path->setChecked(m_pconfig->getValue(
@@ -298,6 +301,8 @@ void DlgPrefLibrary::slotRelocateDir() {
 void DlgPrefLibrary::slotApply() {
     m_pconfig->set(ConfigKey("[Library]","RescanOnStartup"),
                 ConfigValue((int)checkBox_library_scan->isChecked()));
+    m_pconfig->set(ConfigKey("[Library]","WatchDirectories"),
+                ConfigValue((int)checkBox_watch_directories->isChecked()));
     m_pconfig->set(ConfigKey("[Library]","WriteAudioTags"),
                 ConfigValue((int)checkbox_ID3_sync->isChecked()));
     m_pconfig->set(ConfigKey("[Library]","UseRelativePathOnExport"),
@@ -4,6 +4,7 @@
 #include "skin/legacyskinparser.h"
 
 #include <QDir>
+#include <QFuture>
 #include <QGridLayout>
 #include <QLabel>
 #include <QMutexLocker>
@@ -27,6 +28,7 @@
 #include "skin/colorschemeparser.h"
 #include "skin/skincontext.h"
 #include "skin/launchimage.h"
+#include "skin/skintemplatecache.h"
 
 #include "effects/effectsmanager.h"
 
@@ -72,6 +74,7 @@
 #include "widget/wlibrarysidebar.h"
 #include "widget/wskincolor.h"
 #include "widget/wpixmapstore.h"
+#include "widget/svgrastercache.h"
 #include "widget/wwidgetstack.h"
 #include "widget/wsizeawarestack.h"
 #include "widget/wwidgetgroup.h"
@@ -110,7 +113,7 @@ ControlObject* controlFromConfigKey(const ConfigKey& key, bool bPersist,
     // TODO(rryan): Make this configurable by the skin.
     if (CmdlineArgs::Instance().getDeveloper()) {
         qWarning() << "Requested control does not exist:"
-                   << QString("%1,%2").arg(key.group, key.item)
+                   << QString("%1,%2").arg(key.group(), key.item())
                    << "Creating it.";
     }
     // Since the usual behavior here is to create a skin-defined push
@@ -307,6 +310,18 @@ QWidget* LegacySkinParser::parseSkin(const QString& skinPath, QWidget* pParent)
     m_pContext = std::make_unique<SkinContext>(m_pConfig, skinPath + "/skin.xml");
     m_pContext->setSkinBasePath(skinPath + "/");
 
+    // Parse all template files on worker threads while we process the
+    // manifest. Only template instantiation and widget creation are left for
+    // the GUI thread.
+    QFuture<void> templatesParsed = SkinTemplateCache::preload(skinPath);
+    // Rasterize the skin's SVGs in the background as well. Paintable picks up
+    // the images from SvgRasterCache, rasterizing only missing ones itself.
+    // The cache keeps track of the prefetch and cancels it when another skin
+    // is loaded or the skin is unloaded.
+    SvgRasterCache::setCacheDirectory(
+            m_pConfig->getSettingsPath() + "/cache/skin_images");
+    SvgRasterCache::prefetch(skinPath, m_pContext->getScaleFactor());
+
     if (m_pParent) {
         qDebug() << "ERROR: Somehow a parent already exists -- you are probably re-using a LegacySkinParser which is not advisable!";
     }
@@ -381,6 +396,10 @@ QWidget* LegacySkinParser::parseSkin(const QString& skinPath, QWidget* pParent)
     // created parent so MixxxMainWindow can use it for nefarious purposes (
     // fullscreen mostly) --bkgood
     m_pParent = pParent;
+    {
+        ScopedTimer timer("SkinLoader::parseSkin waiting for templates");
+        templatesParsed.waitForFinished();
+    }
     QList<QWidget*> widgets = parseNode(skinDocument);
 
     if (widgets.empty()) {
@@ -1496,27 +1515,15 @@ QDomElement LegacySkinParser::loadTemplate(const QString& path) {
         return it.value();
     }
 
-    QFile templateFile(absolutePath);
-
-    if (!templateFile.open(QIODevice::ReadOnly)) {
-        qWarning() << "Could not open template file:" << absolutePath;
-    }
-
-    QDomDocument tmpl("template");
-    QString errorMessage;
-    int errorLine;
-    int errorColumn;
-
-    if (!tmpl.setContent(&templateFile, &errorMessage,
-                         &errorLine, &errorColumn)) {
-        qWarning() << "LegacySkinParser::loadTemplate - setContent failed see"
-                   << absolutePath << "line:" << errorLine << "column:" << errorColumn;
-        qWarning() << "LegacySkinParser::loadTemplate - message:" << errorMessage;
+    // Usually already parsed by the preload started in parseSkin().
+    QDomElement templateElement =
+            SkinTemplateCache::documentElement(absolutePath);
+    if (templateElement.isNull()) {
         return QDomElement();
     }
 
-    m_templateCache[absolutePath] = tmpl.documentElement();
-    return tmpl.documentElement();
+    m_templateCache[absolutePath] = templateElement;
+    return templateElement;
 }
 
 QList<QWidget*> LegacySkinParser::parseTemplate(const QDomElement& node) {
@@ -2089,12 +2096,12 @@ void LegacySkinParser::setupConnections(const QDomNode& node, WBaseWidget* pWidg
                     QString shortcut;
 
                     subkey = configKey;
-                    subkey.item += "_activate";
+                    subkey.setItem(subkey.item() + "_activate");
                     shortcut = m_pKeyboard->getKeyboardConfig()->getValueString(subkey);
                     addShortcutToToolTip(pWidget, shortcut, tr("activate"));
 
                     subkey = configKey;
-                    subkey.item += "_toggle";
+                    subkey.setItem(subkey.item() + "_toggle");
                     shortcut = m_pKeyboard->getKeyboardConfig()->getValueString(subkey);
                     addShortcutToToolTip(pWidget, shortcut, tr("toggle"));
                 } else if ((pSlider = qobject_cast<const WSliderComposed*>(pWidget->toQWidget()))) {
@@ -2104,42 +2111,42 @@ void LegacySkinParser::setupConnections(const QDomNode& node, WBaseWidget* pWidg
 
                     if (pSlider->isHorizontal()) {
                         subkey = configKey;
-                        subkey.item += "_up";
+                        subkey.setItem(subkey.item() + "_up");
                         shortcut = m_pKeyboard->getKeyboardConfig()->getValueString(subkey);
                         addShortcutToToolTip(pWidget, shortcut, tr("right"));
 
                         subkey = configKey;
-                        subkey.item += "_down";
+                        subkey.setItem(subkey.item() + "_down");
                         shortcut = m_pKeyboard->getKeyboardConfig()->getValueString(subkey);
                         addShortcutToToolTip(pWidget, shortcut, tr("left"));
 
                         subkey = configKey;
-                        subkey.item += "_up_small";
+                        subkey.setItem(subkey.item() + "_up_small");
                         shortcut = m_pKeyboard->getKeyboardConfig()->getValueString(subkey);
                         addShortcutToToolTip(pWidget, shortcut, tr("right small"));
 
                         subkey = configKey;
-                        subkey.item += "_down_small";
+                        subkey.setItem(subkey.item() + "_down_small");
                         shortcut = m_pKeyboard->getKeyboardConfig()->getValueString(subkey);
                         addShortcutToToolTip(pWidget, shortcut, tr("left small"));
                     } else {
                         subkey = configKey;
-                        subkey.item += "_up";
+                        subkey.setItem(subkey.item() + "_up");
                         shortcut = m_pKeyboard->getKeyboardConfig()->getValueString(subkey);
                         addShortcutToToolTip(pWidget, shortcut, tr("up"));
 
                         subkey = configKey;
-                        subkey.item += "_down";
+                        subkey.setItem(subkey.item() + "_down");
                         shortcut = m_pKeyboard->getKeyboardConfig()->getValueString(subkey);
                         addShortcutToToolTip(pWidget, shortcut, tr("down"));
 
                         subkey = configKey;
-                        subkey.item += "_up_small";
+                        subkey.setItem(subkey.item() + "_up_small");
                         shortcut = m_pKeyboard->getKeyboardConfig()->getValueString(subkey);
                         addShortcutToToolTip(pWidget, shortcut, tr("up small"));
 
                         subkey = configKey;
-                        subkey.item += "_down_small";
+                        subkey.setItem(subkey.item() + "_down_small");
                         shortcut = m_pKeyboard->getKeyboardConfig()->getValueString(subkey);
                         addShortcutToToolTip(pWidget, shortcut, tr("down small"));
                     }
@@ -19,12 +19,14 @@
 #include "skin/launchimage.h"
 #include "util/timer.h"
 #include "recording/recordingmanager.h"
+#include "widget/svgrastercache.h"
 
 SkinLoader::SkinLoader(UserSettingsPointer pConfig) :
         m_pConfig(pConfig) {
 }
 
 SkinLoader::~SkinLoader() {
+    SvgRasterCache::cancelPrefetch();
     LegacySkinParser::freeChannelStrings();
 }
 
@@ -0,0 +1,87 @@
+#include "skin/skintemplatecache.h"
+
+#include <QCryptographicHash>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include <QtConcurrentMap>
+#include <QtDebug>
+
+namespace {
+
+bool preloadFile(const QString& path) {
+    return !SkinTemplateCache::documentElement(path).isNull();
+}
+
+}  // anonymous namespace
+
+// static
+QMutex SkinTemplateCache::s_mutex;
+// static
+QHash<QString, SkinTemplateCache::Entry> SkinTemplateCache::s_entries;
+
+// static
+QFuture<void> SkinTemplateCache::preload(const QString& skinPath) {
+    QStringList paths;
+    QDirIterator it(skinPath, QStringList() << "*.xml", QDir::Files,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        paths.append(it.next());
+    }
+    // Unlike map(), which modifies the passed sequence in place, mapped()
+    // keeps its own copy of the sequence until all files have been parsed,
+    // so the local list may go out of scope before the work is done. The
+    // results are not needed by the caller.
+    return QtConcurrent::mapped(paths, preloadFile);
+}
+
+// static
+QDomElement SkinTemplateCache::documentElement(const QString& path) {
+    const QString absolutePath = QFileInfo(path).absoluteFilePath();
+
+    QFile file(absolutePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open template file:" << absolutePath;
+        return QDomElement();
+    }
+    const QByteArray content = file.readAll();
+    file.close();
+    const QByteArray contentHash =
+            QCryptographicHash::hash(content, QCryptographicHash::Sha1);
+
+    {
+        QMutexLocker locker(&s_mutex);
+        auto it = s_entries.constFind(absolutePath);
+        if (it != s_entries.constEnd() &&
+                it.value().contentHash == contentHash) {
+            return it.value().document.documentElement();
+        }
+    }
+
+    // Parse without holding the lock so that other files can be parsed
+    // concurrently.
+    Entry entry;
+    entry.contentHash = contentHash;
+    entry.document = QDomDocument("template");
+    QString errorMessage;
+    int errorLine;
+    int errorColumn;
+    if (!entry.document.setContent(content, &errorMessage,
+                                   &errorLine, &errorColumn)) {
+        qWarning() << "SkinTemplateCache - setContent failed see"
+                   << absolutePath << "line:" << errorLine << "column:" << errorColumn;
+        qWarning() << "SkinTemplateCache - message:" << errorMessage;
+        return QDomElement();
+    }
+
+    QMutexLocker locker(&s_mutex);
+    s_entries.insert(absolutePath, entry);
+    return entry.document.documentElement();
+}
+
+// static
+void SkinTemplateCache::clear() {
+    QMutexLocker locker(&s_mutex);
+    s_entries.clear();
+}
@@ -0,0 +1,51 @@
+#ifndef SKIN_SKINTEMPLATECACHE_H
+#define SKIN_SKINTEMPLATECACHE_H
+
+#include <QByteArray>
+#include <QDomDocument>
+#include <QDomElement>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+// A process-wide cache of parsed skin XML files (skin.xml and templates).
+//
+// Loading a skin used to parse every template file on the GUI thread while
+// the widgets were being created. LegacySkinParser now calls preload() when
+// it starts loading a skin, which parses all XML files of the skin on the
+// global thread pool while the GUI thread applies the manifest. Template
+// instantiation and widget construction then only work on the in-memory
+// documents.
+//
+// Entries are keyed by the absolute file path and validated against a hash
+// of the file contents, so switching back to a skin reuses the parsed
+// documents while edits to skin files are still picked up on reload.
+//
+// The cached documents are shared and must be treated as read-only.
+class SkinTemplateCache {
+  public:
+    // Starts parsing all XML files in skinPath (recursively) on the global
+    // thread pool. Wait on the returned future before calling
+    // documentElement() for any of these files from the GUI thread.
+    static QFuture<void> preload(const QString& skinPath);
+
+    // Returns the document element of the XML file at path, parsing the file
+    // on the calling thread if it is not cached or has changed. Returns a
+    // null element if the file could not be read or parsed.
+    static QDomElement documentElement(const QString& path);
+
+    // Drops all cached documents.
+    static void clear();
+
+  private:
+    struct Entry {
+        QByteArray contentHash;
+        QDomDocument document;
+    };
+
+    static QMutex s_mutex;
+    static QHash<QString, Entry> s_entries;
+};
+
+#endif /* SKIN_SKINTEMPLATECACHE_H */
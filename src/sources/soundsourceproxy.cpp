@@ -329,6 +329,24 @@ SoundSourceProxy::SaveTrackMetadataResult SoundSourceProxy::saveTrackMetadata(
     return SaveTrackMetadataResult::FAILED;
 }
 
+//static
+SoundSourceProxy::SaveTrackMetadataResult SoundSourceProxy::saveTrackMetadata(
+        const QString& canonicalLocation,
+        const mixxx::TrackMetadata& trackMetadata) {
+    if (!canonicalLocation.isEmpty()) {
+        SoundSourceProxy proxy(QUrl::fromLocalFile(canonicalLocation));
+        if (proxy.m_pSoundSource &&
+                (proxy.m_pSoundSource->writeTrackMetadata(trackMetadata) == OK)) {
+            kLogger.debug() << "Track metadata has been written into file"
+                    << canonicalLocation;
+            return SaveTrackMetadataResult::SUCCEEDED;
+        }
+    }
+    kLogger.debug() << "Failed to write track metadata into file"
+            << canonicalLocation;
+    return SaveTrackMetadataResult::FAILED;
+}
+
 SoundSourceProxy::SoundSourceProxy(
         TrackPointer pTrack)
     : m_pTrack(std::move(pTrack)),
@@ -345,6 +363,13 @@ SoundSourceProxy::SoundSourceProxy(const Track* pTrack)
     initSoundSource();
 }
 
+SoundSourceProxy::SoundSourceProxy(const QUrl& url)
+    : m_url(url),
+      m_soundSourceProviderRegistrations(findSoundSourceProviderRegistrations(m_url)),
+      m_soundSourceProviderRegistrationIndex(0) {
+    initSoundSource();
+}
+
 mixxx::SoundSourceProviderPointer SoundSourceProxy::getSoundSourceProvider() const {
     DEBUG_ASSERT(0 <= m_soundSourceProviderRegistrationIndex);
     if (m_soundSourceProviderRegistrations.size() > m_soundSourceProviderRegistrationIndex) {
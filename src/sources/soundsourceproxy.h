@@ -87,6 +87,11 @@ class SoundSourceProxy {
     static SaveTrackMetadataResult saveTrackMetadata(
             const Track* pTrack,
             bool evenIfNeverParsedFromFileBefore = false);
+    // Writes the metadata into the file at the given location, e.g. a
+    // snapshot of a track's metadata from another thread.
+    static SaveTrackMetadataResult saveTrackMetadata(
+            const QString& canonicalLocation,
+            const mixxx::TrackMetadata& trackMetadata);
 
     // Opening the audio data through the proxy will
     // update the some metadata of the track object.
@@ -105,6 +110,8 @@ class SoundSourceProxy {
     // for writing metadata immediately before the TIO is destroyed.
     explicit SoundSourceProxy(
             const Track* pTrack);
+    explicit SoundSourceProxy(
+            const QUrl& url);
 
     const TrackPointer m_pTrack;
 
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include "library/autodj/autodjcratesindex.h"
+
+namespace {
+
+class AutoDJCratesIndexTest : public testing::Test {
+  protected:
+    std::vector<int> activeTracks() const {
+        std::vector<int> trackIds;
+        for (int i = 0; i < m_index.activeTrackCount(); ++i) {
+            trackIds.push_back(m_index.activeTrack(i).toInt());
+        }
+        return trackIds;
+    }
+
+    AutoDJCratesIndex m_index;
+};
+
+TEST_F(AutoDJCratesIndexTest, OrderOfPreference) {
+    m_index.addTrack(TrackId(1), 2);
+    m_index.addTrack(TrackId(2), 0);
+    m_index.addTrack(TrackId(3), 1);
+    m_index.addTrack(TrackId(4), 1);
+    m_index.setLastPlayed(TrackId(3), "2018-02-01 10:00:00");
+    m_index.setLastPlayed(TrackId(4), "2018-01-01 10:00:00");
+    EXPECT_EQ(std::vector<int>({2, 4, 3, 1}), activeTracks());
+    EXPECT_EQ(1, m_index.unplayedActiveTrackCount());
+
+    // Playing a track moves it to the next bucket
+    m_index.setTimesPlayed(TrackId(2), 1);
+    EXPECT_EQ(std::vector<int>({2, 4, 3, 1}), activeTracks());
+    m_index.setLastPlayed(TrackId(2), "2018-03-01 10:00:00");
+    EXPECT_EQ(std::vector<int>({4, 3, 2, 1}), activeTracks());
+    EXPECT_EQ(0, m_index.unplayedActiveTrackCount());
+
+    // Only the last-played date/time counts when ignoring the play count
+    m_index.setLastPlayed(TrackId(1), "2017-01-01 10:00:00");
+    m_index.setUseIgnoreTime(true);
+    EXPECT_EQ(std::vector<int>({1, 4, 3, 2}), activeTracks());
+    EXPECT_EQ(2, m_index.activeTrackCountPlayedBefore("2018-01-15 00:00:00"));
+}
+
+TEST_F(AutoDJCratesIndexTest, AutoDjReferences) {
+    m_index.addTrack(TrackId(1), 0);
+    m_index.addTrack(TrackId(2), 0);
+    m_index.addAutoDjReference(TrackId(1));
+    m_index.addAutoDjReference(TrackId(1));
+    // Not in the index
+    m_index.addAutoDjReference(TrackId(3));
+    EXPECT_EQ(std::vector<int>({2}), activeTracks());
+    EXPECT_EQ(1, m_index.queuedTrackCount());
+    EXPECT_EQ(2, m_index.autoDjReferences(TrackId(1)));
+    EXPECT_FALSE(m_index.isActive(TrackId(1)));
+    EXPECT_TRUE(m_index.isActive(TrackId(2)));
+    EXPECT_FALSE(m_index.isActive(TrackId(3)));
+
+    m_index.removeAutoDjReference(TrackId(1));
+    EXPECT_EQ(std::vector<int>({2}), activeTracks());
+    m_index.removeAutoDjReference(TrackId(1));
+    EXPECT_EQ(std::vector<int>({1, 2}), activeTracks());
+    EXPECT_EQ(0, m_index.queuedTrackCount());
+}
+
+TEST_F(AutoDJCratesIndexTest, CrateReferences) {
+    m_index.addTrack(TrackId(1), 0);
+    m_index.addTrack(TrackId(1), 0);
+    m_index.addTrack(TrackId(2), 0);
+    m_index.addAutoDjReference(TrackId(2));
+
+    m_index.removeCrateReference(TrackId(1));
+    EXPECT_TRUE(m_index.contains(TrackId(1)));
+    m_index.removeCrateReference(TrackId(1));
+    EXPECT_FALSE(m_index.contains(TrackId(1)));
+    EXPECT_EQ(0, m_index.activeTrackCount());
+
+    m_index.removeCrateReference(TrackId(2));
+    EXPECT_FALSE(m_index.contains(TrackId(2)));
+    EXPECT_EQ(0, m_index.queuedTrackCount());
+}
+
+}  // anonymous namespace
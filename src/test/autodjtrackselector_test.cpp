@@ -0,0 +1,142 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QSet>
+
+#include "library/autodj/autodjtrackselector.h"
+
+using namespace mixxx::track::io::key;
+
+namespace {
+
+class AutoDJTrackSelectorTest : public testing::Test {
+  protected:
+    AutoDJTrackSelectorTest()
+            : m_reference(128.0, C_MAJOR, 1.0) {
+    }
+
+    const AutoDJTrackSelector::Features m_reference;
+    AutoDJTrackSelector m_selector;
+};
+
+TEST_F(AutoDJTrackSelectorTest, Distance) {
+    EXPECT_DOUBLE_EQ(0.0, AutoDJTrackSelector::distance(m_reference,
+            AutoDJTrackSelector::Features(128.0, C_MAJOR, 1.0)));
+    // Half and double time
+    EXPECT_DOUBLE_EQ(0.0, AutoDJTrackSelector::distance(m_reference,
+            AutoDJTrackSelector::Features(64.0, C_MAJOR, 1.0)));
+    EXPECT_DOUBLE_EQ(0.0, AutoDJTrackSelector::distance(m_reference,
+            AutoDJTrackSelector::Features(256.0, C_MAJOR, 1.0)));
+
+    // A compatible key is closer than an unknown key
+    const double relativeMinor = AutoDJTrackSelector::distance(m_reference,
+            AutoDJTrackSelector::Features(128.0, A_MINOR, 1.0));
+    const double unknownKey = AutoDJTrackSelector::distance(m_reference,
+            AutoDJTrackSelector::Features(128.0, INVALID, 1.0));
+    const double tritone = AutoDJTrackSelector::distance(m_reference,
+            AutoDJTrackSelector::Features(128.0, F_SHARP_MAJOR, 1.0));
+    EXPECT_DOUBLE_EQ(1.0, relativeMinor);
+    EXPECT_LT(relativeMinor, unknownKey);
+    EXPECT_LT(unknownKey, tritone);
+
+    // Close tempo and loudness
+    const double close = AutoDJTrackSelector::distance(m_reference,
+            AutoDJTrackSelector::Features(130.0, C_MAJOR, 0.9));
+    const double far = AutoDJTrackSelector::distance(m_reference,
+            AutoDJTrackSelector::Features(100.0, C_MAJOR, 0.5));
+    const double unknown = AutoDJTrackSelector::distance(m_reference,
+            AutoDJTrackSelector::Features());
+    EXPECT_LT(0.0, close);
+    EXPECT_LT(close, far);
+    EXPECT_LT(close, unknown);
+}
+
+TEST_F(AutoDJTrackSelectorTest, SelectTrack) {
+    // The best matching tracks
+    QSet<TrackId> bestTrackIds;
+    for (int i = 1; i <= AutoDJTrackSelector::kMaxCandidates; ++i) {
+        m_selector.setTrack(TrackId(i),
+                AutoDJTrackSelector::Features(127.0 + i * 0.1, G_MAJOR, 1.0));
+        bestTrackIds.insert(TrackId(i));
+    }
+    // Worse matches, including a perfect match that is not a candidate
+    for (int i = 101; i <= 120; ++i) {
+        m_selector.setTrack(TrackId(i),
+                AutoDJTrackSelector::Features(90.0, E_FLAT_MAJOR, 0.5));
+    }
+    m_selector.setTrack(TrackId(200), m_reference);
+    EXPECT_EQ(AutoDJTrackSelector::kMaxCandidates + 21, m_selector.trackCount());
+
+    const auto isCandidate = [](TrackId trackId) {
+        return trackId != TrackId(200);
+    };
+    QSet<TrackId> selectedTrackIds;
+    for (int i = 0; i < 50; ++i) {
+        const TrackId trackId = m_selector.selectTrack(m_reference, isCandidate);
+        EXPECT_TRUE(bestTrackIds.contains(trackId));
+        selectedTrackIds.insert(trackId);
+    }
+    // The candidates are chosen from at random
+    EXPECT_LT(1, selectedTrackIds.size());
+
+    // Once the best matches are gone, the remaining tracks are selected
+    for (const auto& trackId : bestTrackIds) {
+        m_selector.removeTrack(trackId);
+    }
+    EXPECT_EQ(21, m_selector.trackCount());
+    const TrackId trackId = m_selector.selectTrack(m_reference, isCandidate);
+    EXPECT_LE(101, trackId.toInt());
+    EXPECT_GE(120, trackId.toInt());
+
+    EXPECT_FALSE(m_selector.selectTrack(m_reference,
+            [](TrackId) { return false; }).isValid());
+}
+
+TEST_F(AutoDJTrackSelectorTest, SetAndRemoveTrack) {
+    m_selector.setTrack(TrackId(1), AutoDJTrackSelector::Features(120.0, C_MAJOR, 1.0));
+    m_selector.setTrack(TrackId(2), AutoDJTrackSelector::Features(125.0, D_MINOR, 0.8));
+    m_selector.setTrack(TrackId(3), AutoDJTrackSelector::Features(130.0, E_MINOR, 0.6));
+
+    // Update in place
+    m_selector.setTrack(TrackId(1), AutoDJTrackSelector::Features(121.0, A_MINOR, 0.9));
+    EXPECT_EQ(3, m_selector.trackCount());
+
+    // The last row fills the gap
+    m_selector.removeTrack(TrackId(1));
+    EXPECT_EQ(2, m_selector.trackCount());
+    EXPECT_FALSE(m_selector.contains(TrackId(1)));
+    const AutoDJTrackSelector::Features features =
+            m_selector.getFeatures(TrackId(3));
+    EXPECT_DOUBLE_EQ(130.0, features.bpm);
+    EXPECT_EQ(E_MINOR, features.key);
+    EXPECT_DOUBLE_EQ(0.6, features.replayGainRatio);
+
+    m_selector.removeTrack(TrackId(1));
+    EXPECT_EQ(2, m_selector.trackCount());
+    m_selector.clear();
+    EXPECT_EQ(0, m_selector.trackCount());
+}
+
+// Selects a track from a library of the given size with varied features.
+// Run with --benchmark.
+static void BM_SelectTrack(benchmark::State& state) {
+    const int numTracks = state.range_x();
+    AutoDJTrackSelector selector;
+    for (int i = 0; i < numTracks; ++i) {
+        selector.setTrack(TrackId(i + 1), AutoDJTrackSelector::Features(
+                60.0 + (i * 7919) % 12000 / 100.0,
+                static_cast<ChromaticKey>(1 + (i * 104729) % 24),
+                0.25 + (i * 31) % 100 / 100.0));
+    }
+    const AutoDJTrackSelector::Features reference(128.0, C_MAJOR, 1.0);
+    const auto isCandidate = [](TrackId) {
+        return true;
+    };
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(selector.selectTrack(reference, isCandidate));
+    }
+    state.SetItemsProcessed(state.iterations() * numTracks);
+}
+BENCHMARK(BM_SelectTrack)->Arg(100000);
+
+}  // anonymous namespace
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <QFile>
+#include <QStringList>
+
+#include "test/mixxxtest.h"
+
+#include "library/baseexternallibraryfeature.h"
+
+namespace {
+
+// Only exposes the protected static functions, never instantiated
+class TestExternalLibraryFeature : public BaseExternalLibraryFeature {
+  public:
+    using BaseExternalLibraryFeature::sourceFilesVersion;
+};
+
+class BaseExternalLibraryFeatureTest : public MixxxTest {
+  protected:
+    QString filePath(const QString& fileName) const {
+        return getTestDataDir().filePath(fileName);
+    }
+
+    void writeFile(const QString& fileName, const QByteArray& content) {
+        QFile file(filePath(fileName));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(content);
+        file.close();
+    }
+};
+
+TEST_F(BaseExternalLibraryFeatureTest, SourceFilesVersion) {
+    writeFile("library.xml", "<library/>");
+    writeFile("playlists.xml", "<playlists/>");
+    const QStringList filePaths = QStringList()
+            << filePath("library.xml") << filePath("playlists.xml");
+
+    const QString version =
+            TestExternalLibraryFeature::sourceFilesVersion(filePaths);
+    EXPECT_FALSE(version.isEmpty());
+    // Unchanged files
+    EXPECT_EQ(version,
+            TestExternalLibraryFeature::sourceFilesVersion(filePaths));
+
+    // Modified file
+    writeFile("playlists.xml", "<playlists><playlist/></playlists>");
+    const QString modifiedVersion =
+            TestExternalLibraryFeature::sourceFilesVersion(filePaths);
+    EXPECT_NE(version, modifiedVersion);
+
+    // Removed file
+    ASSERT_TRUE(QFile::remove(filePath("library.xml")));
+    const QString removedVersion =
+            TestExternalLibraryFeature::sourceFilesVersion(filePaths);
+    EXPECT_NE(modifiedVersion, removedVersion);
+
+    // Recreated file
+    writeFile("library.xml", "<library/>");
+    EXPECT_NE(removedVersion,
+            TestExternalLibraryFeature::sourceFilesVersion(filePaths));
+}
+
+TEST_F(BaseExternalLibraryFeatureTest, SourceFilesVersionOfMissingFiles) {
+    const QString missingFile = filePath("missing.xml");
+    EXPECT_EQ(TestExternalLibraryFeature::sourceFilesVersion(
+                    QStringList() << missingFile),
+            TestExternalLibraryFeature::sourceFilesVersion(
+                    QStringList() << missingFile));
+    // The order of the files matters
+    writeFile("library.xml", "<library/>");
+    EXPECT_NE(TestExternalLibraryFeature::sourceFilesVersion(
+                    QStringList() << missingFile << filePath("library.xml")),
+            TestExternalLibraryFeature::sourceFilesVersion(
+                    QStringList() << filePath("library.xml") << missingFile));
+}
+
+}  // anonymous namespace
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include <QScopedPointer>
+#include <QSqlQuery>
+
+#include <algorithm>
+
+#include "test/librarytest.h"
+
+#include "library/basesqltablemodel.h"
+#include "library/librarytablemodel.h"
+#include "library/dao/trackschema.h"
+#include "library/queryutil.h"
+#include "util/db/sqltransaction.h"
+
+namespace {
+
+const int kTrackCount = 300;
+// The number of rows that prefetchRows() adds around the visible rows
+const int kPrefetchMarginRows = 64;
+
+}  // anonymous namespace
+
+class BaseSqlTableModelTest : public LibraryTest {
+  protected:
+    BaseSqlTableModelTest() {
+        collection()->setTrackSource(QSharedPointer<BaseTrackCache>(
+                new BaseTrackCache(collection(), "library", LIBRARYTABLE_ID,
+                                   QStringList() << LIBRARYTABLE_ID
+                                                 << LIBRARYTABLE_ARTIST
+                                                 << LIBRARYTABLE_TITLE,
+                                   false)));
+        addTracks();
+        m_pModel.reset(new LibraryTableModel(
+                nullptr, collection(), "mixxx.db.model.library"));
+        m_pModel->select();
+        m_titleColumn = m_pModel->fieldIndex(LIBRARYTABLE_TITLE);
+    }
+
+    void addTracks() {
+        SqlTransaction transaction(dbConnection());
+        QSqlQuery locationQuery(dbConnection());
+        locationQuery.prepare(
+                "INSERT INTO track_locations "
+                "(location,directory,filename,filesize,fs_deleted,needs_verification) "
+                "VALUES (:location,'/music',:filename,0,0,0)");
+        QSqlQuery libraryQuery(dbConnection());
+        libraryQuery.prepare(
+                "INSERT INTO library (artist,title,location,mixxx_deleted) "
+                "VALUES (:artist,:title,:location,0)");
+        for (int i = 0; i < kTrackCount; ++i) {
+            const QString number = QString::number(i).rightJustified(3, '0');
+            locationQuery.bindValue(":location", "/music/" + number + ".mp3");
+            locationQuery.bindValue(":filename", number + ".mp3");
+            if (!locationQuery.exec()) {
+                LOG_FAILED_QUERY(locationQuery);
+            }
+            const QString title = "Title " + number;
+            libraryQuery.bindValue(":artist", "Artist " + number);
+            libraryQuery.bindValue(":title", title);
+            libraryQuery.bindValue(":location", locationQuery.lastInsertId());
+            if (!libraryQuery.exec()) {
+                LOG_FAILED_QUERY(libraryQuery);
+            }
+            m_titles.insert(TrackId(libraryQuery.lastInsertId()), title);
+        }
+        transaction.commit();
+    }
+
+    QVariant displayedTitle(int row) const {
+        return m_pModel->data(m_pModel->index(row, m_titleColumn));
+    }
+
+    QString expectedTitle(int row) const {
+        return m_titles.value(m_pModel->getTrackId(m_pModel->index(row, 0)));
+    }
+
+    QList<int> prefetchedRows() const {
+        QList<int> rows = m_pModel->m_displayValues.keys();
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+
+    static QList<int> rowRange(int firstRow, int lastRow) {
+        QList<int> rows;
+        for (int row = firstRow; row <= lastRow; ++row) {
+            rows.append(row);
+        }
+        return rows;
+    }
+
+    QScopedPointer<BaseSqlTableModel> m_pModel;
+    QHash<TrackId, QString> m_titles;
+    int m_titleColumn;
+};
+
+TEST_F(BaseSqlTableModelTest, PrefetchedRowsAreCached) {
+    ASSERT_EQ(kTrackCount, m_pModel->rowCount());
+    ASSERT_LE(0, m_titleColumn);
+    EXPECT_TRUE(prefetchedRows().isEmpty());
+
+    m_pModel->prefetchRows(100, 110);
+    EXPECT_EQ(rowRange(100 - kPrefetchMarginRows, 110 + kPrefetchMarginRows),
+              prefetchedRows());
+    EXPECT_EQ(expectedTitle(100), displayedTitle(100).toString());
+
+    // A hit is answered from the prefetched values
+    m_pModel->m_displayValues[100][m_titleColumn] = "Prefetched";
+    EXPECT_EQ(QString("Prefetched"), displayedTitle(100).toString());
+
+    // Rows outside of the window are formatted on the fly
+    const int outsideRow = 110 + kPrefetchMarginRows + 1;
+    EXPECT_EQ(expectedTitle(outsideRow), displayedTitle(outsideRow).toString());
+    EXPECT_FALSE(m_pModel->m_displayValues.contains(outsideRow));
+
+    // Moving the window a little keeps the rows that are still inside
+    m_pModel->prefetchRows(105, 115);
+    EXPECT_EQ(rowRange(105 - kPrefetchMarginRows, 115 + kPrefetchMarginRows),
+              prefetchedRows());
+    EXPECT_EQ(QString("Prefetched"), displayedTitle(100).toString());
+}
+
+TEST_F(BaseSqlTableModelTest, DataChangedInvalidatesPrefetchedRows) {
+    m_pModel->prefetchRows(100, 110);
+    for (int row = 98; row <= 102; ++row) {
+        m_pModel->m_displayValues[row][m_titleColumn] = "Prefetched";
+    }
+
+    emit(m_pModel->dataChanged(
+            m_pModel->index(99, 0),
+            m_pModel->index(101, m_pModel->columnCount() - 1)));
+    for (int row = 99; row <= 101; ++row) {
+        EXPECT_FALSE(m_pModel->m_displayValues.contains(row));
+        EXPECT_EQ(expectedTitle(row), displayedTitle(row).toString());
+    }
+    // The neighbours are not affected
+    EXPECT_EQ(QString("Prefetched"), displayedTitle(98).toString());
+    EXPECT_EQ(QString("Prefetched"), displayedTitle(102).toString());
+
+    // The next prefetch fills the gap again
+    m_pModel->prefetchRows(100, 110);
+    EXPECT_EQ(rowRange(100 - kPrefetchMarginRows, 110 + kPrefetchMarginRows),
+              prefetchedRows());
+    EXPECT_EQ(expectedTitle(100), displayedTitle(100).toString());
+}
+
+TEST_F(BaseSqlTableModelTest, ScrollPastPrefetchWindow) {
+    m_pModel->prefetchRows(0, 20);
+    EXPECT_EQ(rowRange(0, 20 + kPrefetchMarginRows), prefetchedRows());
+    m_pModel->m_displayValues[0][m_titleColumn] = "Prefetched";
+
+    // Scroll to the end of the table, beyond the previous window
+    m_pModel->prefetchRows(250, 270);
+    EXPECT_EQ(rowRange(250 - kPrefetchMarginRows, kTrackCount - 1),
+              prefetchedRows());
+    for (int row = 250; row <= 270; ++row) {
+        EXPECT_EQ(expectedTitle(row),
+                  m_pModel->m_displayValues.value(row).value(m_titleColumn).toString());
+    }
+
+    // The rows that have left the window are formatted again
+    EXPECT_FALSE(m_pModel->m_displayValues.contains(0));
+    EXPECT_EQ(expectedTitle(0), displayedTitle(0).toString());
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <QDir>
+
+#include "test/librarytest.h"
+
+#include "library/basetrackcache.h"
+#include "library/crate/crate.h"
+#include "library/dao/trackschema.h"
+
+namespace {
+
+class BaseTrackCacheTest : public LibraryTest {
+  protected:
+    BaseTrackCacheTest()
+            : m_trackCache(collection(), "library", LIBRARYTABLE_ID,
+                           QStringList() << LIBRARYTABLE_ID
+                                         << LIBRARYTABLE_ARTIST
+                                         << LIBRARYTABLE_TITLE,
+                           false) {
+    }
+
+    TrackId addTrackToCollection(const QString& fileName) {
+        const QString trackLocation = QDir::currentPath() +
+                "/src/test/id3-test-data/" + fileName;
+        TrackPointer pTrack(collection()->getTrackDAO().addSingleTrack(
+                trackLocation, false));
+        return pTrack ? pTrack->getId() : TrackId();
+    }
+
+    QHash<TrackId, int> search(const QSet<TrackId>& trackIds,
+                               const QString& searchQuery) {
+        QHash<TrackId, int> trackToIndex;
+        m_trackCache.filterAndSort(trackIds, searchQuery, QString(),
+                QString(), QList<SortColumn>(), 0, &trackToIndex);
+        return trackToIndex;
+    }
+
+    BaseTrackCache m_trackCache;
+};
+
+TEST_F(BaseTrackCacheTest, SearchCrateAfterMembershipChanged) {
+    const TrackId firstTrackId = addTrackToCollection("cover-test-jpg.mp3");
+    const TrackId secondTrackId = addTrackToCollection("cover-test-png.mp3");
+    ASSERT_TRUE(firstTrackId.isValid());
+    ASSERT_TRUE(secondTrackId.isValid());
+    QSet<TrackId> trackIds;
+    trackIds << firstTrackId << secondTrackId;
+
+    Crate crate;
+    crate.setName("House");
+    CrateId crateId;
+    ASSERT_TRUE(collection()->insertCrate(crate, &crateId));
+    ASSERT_TRUE(collection()->addCrateTracks(
+            crateId, QList<TrackId>() << firstTrackId));
+
+    QHash<TrackId, int> result = search(trackIds, "crate:House");
+    EXPECT_EQ(1, result.size());
+    EXPECT_TRUE(result.contains(firstTrackId));
+
+    // The same search again must not return the result from before
+    ASSERT_TRUE(collection()->addCrateTracks(
+            crateId, QList<TrackId>() << secondTrackId));
+    result = search(trackIds, "crate:House");
+    EXPECT_EQ(2, result.size());
+    EXPECT_TRUE(result.contains(secondTrackId));
+
+    ASSERT_TRUE(collection()->removeCrateTracks(
+            crateId, QList<TrackId>() << firstTrackId));
+    result = search(trackIds, "crate:House");
+    EXPECT_EQ(1, result.size());
+    EXPECT_TRUE(result.contains(secondTrackId));
+}
+
+}  // anonymous namespace
@@ -0,0 +1,275 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <vector>
+
+#include "engine/cachingreader.h"
+#include "test/cachingreader_test.h"
+#include "library/previewcache.h"
+#include "test/mixxxtest.h"
+#include "util/memory.h"
+#include "util/sample.h"
+
+namespace {
+
+class CachingReaderTest : public MixxxTest {
+};
+
+TEST_F(CachingReaderTest, ReadBeforeFirstTrack) {
+    // No chunk memory is allocated before the first track is loaded, so
+    // reading and hinting must not touch any chunks.
+    CachingReader reader("[Sampler1]", config());
+
+    HintVector hints;
+    Hint hint;
+    hint.frame = 0;
+    hint.frameCount = Hint::kFrameCountForward;
+    hint.priority = 1;
+    hints.append(hint);
+    reader.hintAndMaybeWake(hints);
+
+    CSAMPLE buffer[64];
+    SampleUtil::fill(buffer, 1.0f, 64);
+    EXPECT_EQ(0, reader.read(0, 64, false, buffer));
+
+    // Ejecting without a loaded track is a no-op.
+    reader.newTrack(TrackPointer());
+}
+
+const SINT kSampleRate = 44100;
+const SINT kFrameCount = 10 * kSampleRate;
+
+TrackPointer newTrackWithIntro(const UserSettingsPointer& pConfig,
+        SINT startFrame, SINT introFrameCount, SAMPLE sample,
+        TrackId trackId = TrackId(1)) {
+    const QString trackLocation(QDir::currentPath() +
+            "/src/test/id3-test-data/cover-test-jpg.mp3");
+    TrackPointer pTrack(Track::newDummy(QFileInfo(trackLocation), trackId));
+    pTrack->setSampleRate(kSampleRate);
+    pTrack->setDuration(double(kFrameCount) / kSampleRate);
+
+    PreviewCache::Intro intro;
+    intro.sampleRate = kSampleRate;
+    intro.frameCount = kFrameCount;
+    intro.startFrame = startFrame;
+    intro.samples.assign(CachingReaderChunk::frames2samples(introFrameCount), sample);
+    PreviewCache previewCache(pConfig);
+    EXPECT_TRUE(previewCache.saveIntro(pTrack->getId(), intro));
+    return pTrack;
+}
+
+TEST_F(CachingReaderTest, PreviewCache) {
+    const SINT startFrame = CachingReaderChunk::kFrames;
+    TrackPointer pTrack = newTrackWithIntro(config(), startFrame, 100, 1000);
+    const TrackId trackId = pTrack->getId();
+
+    PreviewCache previewCache(config());
+    EXPECT_TRUE(previewCache.hasIntro(trackId, startFrame));
+    EXPECT_FALSE(previewCache.hasIntro(trackId, 0));
+    EXPECT_FALSE(previewCache.hasIntro(TrackId(2), startFrame));
+
+    PreviewCache::Intro intro;
+    ASSERT_TRUE(previewCache.loadIntro(*pTrack, &intro));
+    EXPECT_EQ(kSampleRate, intro.sampleRate);
+    EXPECT_EQ(kFrameCount, intro.frameCount);
+    EXPECT_EQ(startFrame, intro.startFrame);
+    EXPECT_EQ(100, intro.getIntroFrameCount());
+    EXPECT_EQ(std::vector<SAMPLE>(200, 1000), intro.samples);
+
+    // The file has been modified after the analysis
+    pTrack->setDuration(20.0);
+    EXPECT_FALSE(previewCache.loadIntro(*pTrack, &intro));
+
+    previewCache.deleteIntros(QList<TrackId>() << trackId);
+    EXPECT_FALSE(previewCache.hasIntro(trackId, startFrame));
+}
+
+TEST_F(CachingReaderTest, PreviewCacheSharesSizeLimit) {
+    // Each intro takes a little more than 512 KiB
+    config()->set(ConfigKey("[Library]", "PreviewCacheSizeMB"), QString("2"));
+    PreviewCache::Intro intro;
+    intro.sampleRate = kSampleRate;
+    intro.frameCount = kFrameCount;
+    intro.samples.assign(
+            CachingReaderChunk::frames2samples(PreviewCache::kIntroFrameCount), 0);
+    QList<TrackId> trackIds;
+    for (int i = 1; i <= 6; ++i) {
+        trackIds << TrackId(100 + i);
+    }
+    auto storedTrackIds = [&trackIds](const PreviewCache& previewCache) {
+        QList<TrackId> storedTrackIds;
+        for (const auto& trackId: trackIds) {
+            if (previewCache.hasIntro(trackId, 0)) {
+                storedTrackIds << trackId;
+            }
+        }
+        return storedTrackIds;
+    };
+
+    // Like the analyzer and the track collection
+    PreviewCache analyzerCache(config());
+    PreviewCache collectionCache(config());
+    EXPECT_TRUE(analyzerCache.saveIntro(trackIds[0], intro));
+    EXPECT_TRUE(analyzerCache.saveIntro(trackIds[1], intro));
+    {
+        // Another analyzer that exists only temporarily
+        PreviewCache otherAnalyzerCache(config());
+        EXPECT_TRUE(otherAnalyzerCache.saveIntro(trackIds[2], intro));
+    }
+    EXPECT_EQ(3, storedTrackIds(collectionCache).size());
+    // The fourth intro exceeds the limit of all instances together
+    EXPECT_TRUE(analyzerCache.saveIntro(trackIds[3], intro));
+    QList<TrackId> remainingTrackIds = storedTrackIds(collectionCache);
+    EXPECT_EQ(3, remainingTrackIds.size());
+
+    // Deleting intros in one instance leaves room for the others
+    collectionCache.deleteIntros(remainingTrackIds.mid(0, 2));
+    EXPECT_TRUE(analyzerCache.saveIntro(trackIds[4], intro));
+    EXPECT_TRUE(analyzerCache.saveIntro(trackIds[5], intro));
+    EXPECT_EQ(QList<TrackId>() << remainingTrackIds[2]
+                               << trackIds[4] << trackIds[5],
+              storedTrackIds(collectionCache));
+
+    collectionCache.deleteIntros(trackIds);
+}
+
+TEST_F(CachingReaderTest, PlayIntroOfPreviewDeck) {
+    // 0.5 after the conversion. The decoded file has a different content.
+    const SAMPLE kIntroSample = 16384;
+    const SINT introFrameCount = 2 * CachingReaderChunk::kFrames;
+    TrackPointer pTrack = newTrackWithIntro(
+            config(), 0, introFrameCount, kIntroSample);
+
+    CachingReader reader("[PreviewDeck1]", config());
+    TrackLoadWaiter waiter(&reader);
+    reader.newTrack(pTrack);
+    ASSERT_TRUE(waiter.wait());
+    reader.process();
+
+    // The intro can be read as soon as the track has been loaded, before
+    // any chunks have been read from the audio source
+    const SINT numSamples = CachingReaderChunk::frames2samples(
+            CachingReaderChunk::kFrames);
+    std::vector<CSAMPLE> buffer(numSamples);
+    const SINT startSample = CachingReaderChunk::frames2samples(
+            CachingReaderChunk::kFrames / 2);
+    ASSERT_EQ(numSamples,
+            reader.read(startSample, numSamples, false, buffer.data()));
+    for (const auto sample: buffer) {
+        ASSERT_EQ(0.5f, sample);
+    }
+
+    // Beyond the intro nothing has been read yet
+    EXPECT_EQ(numSamples, reader.read(
+            CachingReaderChunk::frames2samples(introFrameCount),
+            numSamples, false, buffer.data()));
+    for (const auto sample: buffer) {
+        ASSERT_EQ(0.0f, sample);
+    }
+
+    PreviewCache(config()).deleteIntros(QList<TrackId>() << pTrack->getId());
+}
+
+TEST_F(CachingReaderTest, NoIntrosForSamplers) {
+    TrackPointer pTrack = newTrackWithIntro(
+            config(), 0, 2 * CachingReaderChunk::kFrames, 16384);
+
+    CachingReader reader("[Sampler1]", config());
+    TrackLoadWaiter waiter(&reader);
+    reader.newTrack(pTrack);
+    ASSERT_TRUE(waiter.wait());
+    reader.process();
+
+    const SINT numSamples = 64;
+    std::vector<CSAMPLE> buffer(numSamples);
+    ASSERT_EQ(numSamples, reader.read(0, numSamples, false, buffer.data()));
+    // The chunk has not been hinted and is not available
+    for (const auto sample: buffer) {
+        ASSERT_EQ(0.0f, sample);
+    }
+
+    PreviewCache(config()).deleteIntros(QList<TrackId>() << pTrack->getId());
+}
+
+TEST_F(CachingReaderTest, HandOverIntroChunks) {
+    const SINT introFrameCount = 2 * CachingReaderChunk::kFrames;
+    TrackPointer pTrack1 = newTrackWithIntro(
+            config(), 0, introFrameCount, 16384, TrackId(1));
+    TrackPointer pTrack2 = newTrackWithIntro(
+            config(), 0, introFrameCount, 8192, TrackId(2));
+    TrackPointer pTrack3 = newTrackWithIntro(
+            config(), 0, introFrameCount, 4096, TrackId(3));
+
+    CachingReader reader("[PreviewDeck1]", config());
+    TrackLoadWaiter waiter(&reader);
+    const SINT numSamples = 64;
+    std::vector<CSAMPLE> buffer(numSamples);
+
+    reader.newTrack(pTrack1);
+    ASSERT_TRUE(waiter.wait());
+    reader.process();
+    ASSERT_EQ(numSamples, reader.read(0, numSamples, false, buffer.data()));
+    EXPECT_EQ(0.5f, buffer.front());
+
+    // The cache still reads from the intro of the first track until it
+    // receives the status of the second track. Meanwhile the third track
+    // is loaded without its intro instead of overwriting it.
+    reader.newTrack(pTrack2);
+    ASSERT_TRUE(waiter.wait());
+    reader.newTrack(pTrack3);
+    ASSERT_TRUE(waiter.wait());
+    reader.process();
+    ASSERT_EQ(numSamples, reader.read(0, numSamples, false, buffer.data()));
+    for (const auto sample: buffer) {
+        ASSERT_EQ(0.0f, sample);
+    }
+
+    // All intro chunks have been released again
+    reader.newTrack(pTrack2);
+    ASSERT_TRUE(waiter.wait());
+    reader.process();
+    ASSERT_EQ(numSamples, reader.read(0, numSamples, false, buffer.data()));
+    EXPECT_EQ(0.25f, buffer.front());
+
+    PreviewCache(config()).deleteIntros(QList<TrackId>()
+            << pTrack1->getId() << pTrack2->getId() << pTrack3->getId());
+}
+
+// Resident set size of this process in KiB, or -1 if not available.
+long residentSetSizeKiB() {
+#ifdef __LINUX__
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) {
+            return fields[1].toLong() * 4;
+        }
+    }
+#endif
+    return -1;
+}
+
+// Constructs the caching readers of 4 decks, 64 samplers and 1 preview deck
+// like PlayerManager does at startup. Run with --benchmark.
+static void BM_ConstructCachingReaders(benchmark::State& state) {
+    const int numReaders = state.range_x();
+    long rssDeltaKiB = 0;
+    while (state.KeepRunning()) {
+        const long rssBefore = residentSetSizeKiB();
+        std::vector<std::unique_ptr<CachingReader>> readers;
+        for (int i = 0; i < numReaders; ++i) {
+            readers.push_back(std::make_unique<CachingReader>(
+                    QString("[Sampler%1]").arg(i + 1), UserSettingsPointer()));
+        }
+        rssDeltaKiB = residentSetSizeKiB() - rssBefore;
+    }
+    state.SetLabel(QString("RSS +%1 KiB").arg(rssDeltaKiB).toStdString());
+}
+BENCHMARK(BM_ConstructCachingReaders)->Arg(4 + 64 + 1);
+
+}  // namespace
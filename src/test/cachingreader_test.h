@@ -0,0 +1,38 @@
+#ifndef CACHINGREADER_TEST_H
+#define CACHINGREADER_TEST_H
+
+#include <QObject>
+#include <QSemaphore>
+
+#include "engine/cachingreader.h"
+
+// Blocks until the worker of a CachingReader has finished loading a track.
+// The signals are delivered on the worker thread after the status of the
+// track has been passed to the reader.
+class TrackLoadWaiter : public QObject {
+    Q_OBJECT
+  public:
+    explicit TrackLoadWaiter(CachingReader* pReader) {
+        connect(pReader, SIGNAL(trackLoaded(TrackPointer, int, int)),
+                this, SLOT(slotTrackLoaded()),
+                Qt::DirectConnection);
+        connect(pReader, SIGNAL(trackLoadFailed(TrackPointer, QString)),
+                this, SLOT(slotTrackLoaded()),
+                Qt::DirectConnection);
+    }
+
+    // Returns false if no track has been loaded within a generous timeout
+    bool wait() {
+        return m_loaded.tryAcquire(1, 10000);
+    }
+
+  public slots:
+    void slotTrackLoaded() {
+        m_loaded.release();
+    }
+
+  private:
+    QSemaphore m_loaded;
+};
+
+#endif // CACHINGREADER_TEST_H
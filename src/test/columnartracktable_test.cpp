@@ -0,0 +1,155 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+
+#include "library/columnartracktable.h"
+
+namespace {
+
+const int kNumberColumn = 0;
+const int kTextColumn = 1;
+const int kIntegerColumn = 2;
+
+class ColumnarTrackTableTest : public testing::Test {
+  protected:
+    ColumnarTrackTableTest()
+            : m_table(3) {
+        m_table.setCollation(kTextColumn, ColumnarTrackTable::Collation::NoCase);
+        m_table.setCollation(kIntegerColumn, ColumnarTrackTable::Collation::Integer);
+    }
+
+    void addRow(int id, QVariant number, QVariant text, QVariant integer) {
+        QVector<QVariant> record;
+        record << number << text << integer;
+        m_records[TrackId(id)] = record;
+        m_table.updateRow(TrackId(id), record);
+    }
+
+    void materializeAll() {
+        for (int column = 0; column < 3; ++column) {
+            m_table.materialize(column, m_records);
+        }
+    }
+
+    QList<int> sortedIds(const QList<ColumnarTrackTable::SortKey>& sortKeys) {
+        QVector<TrackId> trackIds;
+        for (auto it = m_records.constBegin(); it != m_records.constEnd(); ++it) {
+            trackIds.append(it.key());
+        }
+        QList<int> result;
+        for (const auto& trackId: m_table.sorted(trackIds, sortKeys)) {
+            result.append(trackId.toVariant().toInt());
+        }
+        return result;
+    }
+
+    ColumnarTrackTable m_table;
+    ColumnarTrackTable::Records m_records;
+};
+
+TEST_F(ColumnarTrackTableTest, SortNumbers) {
+    addRow(1, 128.0, "a", "1");
+    addRow(2, QVariant(), "b", "2");
+    addRow(3, 90.5, "c", "3");
+    addRow(4, 128.0, "d", "4");
+    materializeAll();
+
+    QList<ColumnarTrackTable::SortKey> sortKeys;
+    sortKeys << ColumnarTrackTable::SortKey(kNumberColumn, Qt::AscendingOrder);
+    // NULL first, ties ordered by id
+    EXPECT_EQ(QList<int>() << 2 << 3 << 1 << 4, sortedIds(sortKeys));
+
+    sortKeys.clear();
+    sortKeys << ColumnarTrackTable::SortKey(kNumberColumn, Qt::DescendingOrder)
+             << ColumnarTrackTable::SortKey(kTextColumn, Qt::DescendingOrder);
+    EXPECT_EQ(QList<int>() << 4 << 1 << 3 << 2, sortedIds(sortKeys));
+}
+
+TEST_F(ColumnarTrackTableTest, SortTextCaseInsensitive) {
+    addRow(1, 1, "beta", "");
+    addRow(2, 2, "Alpha", "");
+    addRow(3, 3, "alpha", "");
+    addRow(4, 4, "Gamma", "");
+    materializeAll();
+
+    QList<ColumnarTrackTable::SortKey> sortKeys;
+    sortKeys << ColumnarTrackTable::SortKey(kTextColumn, Qt::AscendingOrder);
+    EXPECT_EQ(QList<int>() << 2 << 3 << 1 << 4, sortedIds(sortKeys));
+}
+
+TEST_F(ColumnarTrackTableTest, SortIntegerCast) {
+    addRow(1, 1, "", "10/12");
+    addRow(2, 2, "", "2");
+    addRow(3, 3, "", "no number");
+    addRow(4, 4, "", QVariant());
+    materializeAll();
+
+    QList<ColumnarTrackTable::SortKey> sortKeys;
+    sortKeys << ColumnarTrackTable::SortKey(kIntegerColumn, Qt::AscendingOrder);
+    EXPECT_EQ(QList<int>() << 4 << 3 << 2 << 1, sortedIds(sortKeys));
+}
+
+TEST_F(ColumnarTrackTableTest, ValueOrder) {
+    addRow(1, 2, "", "");
+    addRow(2, 0, "", "");
+    addRow(3, 1, "", "");
+    addRow(4, 7, "", "");
+    materializeAll();
+
+    ColumnarTrackTable::SortKey sortKey(kNumberColumn, Qt::AscendingOrder);
+    sortKey.valueOrder << 5 << 3 << 4;
+    // 7 is out of range and sorts like NULL
+    EXPECT_EQ(QList<int>() << 4 << 3 << 1 << 2,
+              sortedIds(QList<ColumnarTrackTable::SortKey>() << sortKey));
+}
+
+TEST_F(ColumnarTrackTableTest, UpdateAndRemoveRows) {
+    addRow(1, 3, "", "");
+    addRow(2, 2, "", "");
+    addRow(3, 1, "", "");
+    materializeAll();
+
+    // Rows that are added or changed after materializing
+    addRow(4, 0, "", "");
+    addRow(1, -1, "", "");
+    m_table.removeRow(TrackId(2));
+    m_records.remove(TrackId(2));
+    EXPECT_EQ(3, m_table.rowCount());
+    EXPECT_FALSE(m_table.containsRow(TrackId(2)));
+
+    QList<ColumnarTrackTable::SortKey> sortKeys;
+    sortKeys << ColumnarTrackTable::SortKey(kNumberColumn, Qt::AscendingOrder);
+    EXPECT_EQ(QList<int>() << 1 << 4 << 3, sortedIds(sortKeys));
+}
+
+// Re-sorts a library of the given size by BPM and by artist. Run with
+// --benchmark.
+static void BM_SortLibrary(benchmark::State& state) {
+    const int numTracks = state.range_x();
+    ColumnarTrackTable table(2);
+    table.setCollation(1, ColumnarTrackTable::Collation::NoCase);
+    ColumnarTrackTable::Records records;
+    QVector<TrackId> trackIds;
+    for (int i = 0; i < numTracks; ++i) {
+        QVector<QVariant> record;
+        record << QVariant(60.0 + (i * 7919) % 12000 / 100.0)
+               << QVariant(QString("Artist %1").arg((i * 104729) % (numTracks / 5 + 1)));
+        records[TrackId(i + 1)] = record;
+        table.updateRow(TrackId(i + 1), record);
+        trackIds.append(TrackId(i + 1));
+    }
+    table.materialize(0, records);
+    table.materialize(1, records);
+
+    const int column = state.range_y();
+    QList<ColumnarTrackTable::SortKey> sortKeys;
+    sortKeys << ColumnarTrackTable::SortKey(column, Qt::AscendingOrder);
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(table.sorted(trackIds, sortKeys));
+    }
+    state.SetItemsProcessed(state.iterations() * numTracks);
+}
+BENCHMARK(BM_SortLibrary)->ArgPair(150000, 0)->ArgPair(150000, 1);
+
+}  // namespace
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include "util/compressedbitmap.h"
+
+namespace {
+
+CompressedBitmap makeBitmap(const QVector<quint32>& values) {
+    CompressedBitmap bitmap;
+    for (const auto value: values) {
+        bitmap.add(value);
+    }
+    return bitmap;
+}
+
+TEST(CompressedBitmapTest, AddAndRemove) {
+    CompressedBitmap bitmap;
+    EXPECT_TRUE(bitmap.isEmpty());
+    EXPECT_TRUE(bitmap.add(7));
+    EXPECT_TRUE(bitmap.add(1));
+    // Values in a different chunk
+    EXPECT_TRUE(bitmap.add(70000));
+    EXPECT_TRUE(bitmap.add(0xFFFFFFFF));
+    EXPECT_FALSE(bitmap.add(7));
+    EXPECT_EQ(4, bitmap.cardinality());
+
+    EXPECT_TRUE(bitmap.contains(1));
+    EXPECT_TRUE(bitmap.contains(70000));
+    EXPECT_FALSE(bitmap.contains(2));
+    EXPECT_FALSE(bitmap.contains(65536 + 7));
+    EXPECT_EQ(QVector<quint32>() << 1 << 7 << 70000 << 0xFFFFFFFF,
+              bitmap.toVector());
+
+    EXPECT_TRUE(bitmap.remove(70000));
+    EXPECT_FALSE(bitmap.remove(70000));
+    EXPECT_FALSE(bitmap.remove(3));
+    EXPECT_EQ(QVector<quint32>() << 1 << 7 << 0xFFFFFFFF, bitmap.toVector());
+
+    bitmap.clear();
+    EXPECT_TRUE(bitmap.isEmpty());
+    EXPECT_EQ(0, bitmap.cardinality());
+}
+
+TEST(CompressedBitmapTest, DenseChunk) {
+    // Every other value of the first chunk, more than fit into an array
+    QVector<quint32> values;
+    for (quint32 value = 0; value < 65536; value += 2) {
+        values.append(value);
+    }
+    CompressedBitmap bitmap = makeBitmap(values);
+    EXPECT_EQ(32768, bitmap.cardinality());
+    EXPECT_TRUE(bitmap.contains(65534));
+    EXPECT_FALSE(bitmap.contains(65535));
+    EXPECT_EQ(values, bitmap.toVector());
+
+    // Removing values until the chunk fits into an array again
+    while (values.size() > 10) {
+        EXPECT_TRUE(bitmap.remove(values.last()));
+        values.removeLast();
+    }
+    EXPECT_EQ(values, bitmap.toVector());
+    EXPECT_EQ(makeBitmap(values), bitmap);
+}
+
+TEST(CompressedBitmapTest, UnionAndIntersection) {
+    QVector<quint32> multiplesOf2;
+    QVector<quint32> multiplesOf3;
+    QVector<quint32> multiplesOf6;
+    QVector<quint32> multiplesOf2Or3;
+    for (quint32 value = 0; value < 200000; ++value) {
+        if (value % 2 == 0) {
+            multiplesOf2.append(value);
+        }
+        if (value % 3 == 0) {
+            multiplesOf3.append(value);
+        }
+        if (value % 6 == 0) {
+            multiplesOf6.append(value);
+        }
+        if (value % 2 == 0 || value % 3 == 0) {
+            multiplesOf2Or3.append(value);
+        }
+    }
+    // A sparse bitmap with array chunks only
+    const CompressedBitmap sparse = makeBitmap(
+            QVector<quint32>() << 3 << 4 << 5 << 65536 << 131073 << 500000);
+
+    const CompressedBitmap bitmap2 = makeBitmap(multiplesOf2);
+    const CompressedBitmap bitmap3 = makeBitmap(multiplesOf3);
+    EXPECT_EQ(multiplesOf2Or3, (bitmap2 | bitmap3).toVector());
+    EXPECT_EQ(multiplesOf6, (bitmap2 & bitmap3).toVector());
+    EXPECT_EQ(bitmap3 & bitmap2, bitmap2 & bitmap3);
+
+    EXPECT_EQ(QVector<quint32>() << 4 << 65536,
+              (sparse & bitmap2).toVector());
+    EXPECT_EQ(QVector<quint32>() << 3 << 131073,
+              (bitmap3 & sparse).toVector());
+    // 3, 5, 131073 and 500000 are not contained in bitmap2
+    EXPECT_EQ(multiplesOf2.size() + 4, (bitmap2 | sparse).cardinality());
+    EXPECT_TRUE((bitmap2 | sparse).contains(500000));
+
+    CompressedBitmap empty;
+    EXPECT_EQ(sparse, empty | sparse);
+    EXPECT_TRUE((empty & sparse).isEmpty());
+}
+
+}  // anonymous namespace
@@ -139,4 +139,60 @@ TEST_F(ConfigObjectTest, Save) {
     }
 }
 
+TEST_F(ConfigObjectTest, ConfigKey_Interned) {
+    QString group("[Interned]");
+    QString item = QString("con") + QString("trol");
+    auto ck = ConfigKey(group, item);
+    auto ck2 = ConfigKey("[Interned]", "control");
+    EXPECT_EQ(ck, ck2);
+    EXPECT_EQ(qHash(ck), qHash(ck2));
+    EXPECT_QSTRING_EQ("[Interned]", ck2.group());
+    EXPECT_QSTRING_EQ("control", ck2.item());
+
+    // Interning the same strings again does not grow the symbol table.
+    const int symbolCount = ConfigKey::symbolCount();
+    ConfigKey("[Interned]", "control");
+    EXPECT_EQ(symbolCount, ConfigKey::symbolCount());
+
+    ck2.setItem("control_up");
+    EXPECT_NE(ck, ck2);
+    EXPECT_QSTRING_EQ("control_up", ck2.item());
+}
+
+TEST_F(ConfigObjectTest, ConfigKey_NullVsEmpty) {
+    EXPECT_TRUE(ConfigKey().isNull());
+    EXPECT_TRUE(ConfigKey().isEmpty());
+    EXPECT_TRUE(ConfigKey().group().isNull());
+
+    auto ck = ConfigKey("", "");
+    EXPECT_FALSE(ck.isNull());
+    EXPECT_TRUE(ck.isEmpty());
+    EXPECT_FALSE(ck.item().isNull());
+    // Null and empty strings are equivalent, both for hashing
+    // and for ordering
+    EXPECT_EQ(ConfigKey(), ck);
+    EXPECT_EQ(qHash(ConfigKey()), qHash(ck));
+    EXPECT_FALSE(ConfigKey() < ck);
+    EXPECT_FALSE(ck < ConfigKey());
+    EXPECT_EQ(ConfigKey("[Group]", QString()), ConfigKey("[Group]", ""));
+
+    QHash<ConfigKey, int> hash;
+    hash.insert(ConfigKey(), 1);
+    EXPECT_EQ(1, hash.value(ck));
+    QMap<ConfigKey, int> map;
+    map.insert(ConfigKey(), 1);
+    EXPECT_EQ(1, map.value(ck));
+}
+
+TEST_F(ConfigObjectTest, ConfigKey_LexicalOrder) {
+    // Create the keys in reverse order so symbol ids don't match the order.
+    auto ck3 = ConfigKey("[OrderB]", "b");
+    auto ck2 = ConfigKey("[OrderB]", "a");
+    auto ck1 = ConfigKey("[OrderA]", "z");
+    EXPECT_TRUE(ck1 < ck2);
+    EXPECT_TRUE(ck2 < ck3);
+    EXPECT_FALSE(ck3 < ck1);
+    EXPECT_FALSE(ck1 < ck1);
+}
+
 }  // namespace
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "library/coverartthumbnailstore.h"
+#include "test/mixxxtest.h"
+
+namespace {
+
+class CoverArtThumbnailStoreTest : public MixxxTest {
+  protected:
+    static CoverInfo makeCoverInfo(quint16 hash, const QString& trackLocation) {
+        CoverInfo info;
+        info.type = CoverInfo::METADATA;
+        info.source = CoverInfo::GUESSED;
+        info.hash = hash;
+        info.trackLocation = trackLocation;
+        return info;
+    }
+
+    static QImage makeImage(int width, QRgb color) {
+        QImage image(width, width, QImage::Format_RGB32);
+        image.fill(color);
+        return image;
+    }
+
+    QTemporaryDir m_dir;
+};
+
+TEST_F(CoverArtThumbnailStoreTest, StoreAndReopen) {
+    ASSERT_TRUE(m_dir.isValid());
+    const CoverInfo info = makeCoverInfo(1234, "/music/a.mp3");
+    {
+        CoverArtThumbnailStore store(m_dir.path());
+        ASSERT_TRUE(store.isOpen());
+        EXPECT_TRUE(store.load(info, 32).isNull());
+        store.store(info, 32, makeImage(32, qRgb(255, 0, 0)));
+        EXPECT_EQ(1, store.thumbnailCount());
+    }
+
+    CoverArtThumbnailStore store(m_dir.path());
+    ASSERT_TRUE(store.isOpen());
+    EXPECT_EQ(1, store.thumbnailCount());
+    QImage image = store.load(info, 32);
+    ASSERT_FALSE(image.isNull());
+    EXPECT_EQ(32, image.width());
+    // JPEG is lossy, but a uniform color survives almost unchanged
+    EXPECT_GT(qRed(image.pixel(16, 16)), 240);
+    EXPECT_LT(qGreen(image.pixel(16, 16)), 16);
+
+    // A different width or track doesn't match
+    EXPECT_TRUE(store.load(info, 64).isNull());
+    EXPECT_TRUE(store.load(makeCoverInfo(1234, "/music/b.mp3"), 32).isNull());
+}
+
+TEST_F(CoverArtThumbnailStoreTest, DiscardIncompleteRecord) {
+    ASSERT_TRUE(m_dir.isValid());
+    const CoverInfo info1 = makeCoverInfo(1, "/music/a.mp3");
+    const CoverInfo info2 = makeCoverInfo(2, "/music/b.mp3");
+    {
+        CoverArtThumbnailStore store(m_dir.path());
+        store.store(info1, 32, makeImage(32, qRgb(0, 0, 255)));
+        store.store(info2, 32, makeImage(32, qRgb(0, 255, 0)));
+    }
+
+    // Simulate a crash while the second thumbnail was written
+    QFile dataFile(m_dir.path() + "/thumbnails.dat");
+    ASSERT_TRUE(dataFile.resize(dataFile.size() - 1));
+
+    CoverArtThumbnailStore store(m_dir.path());
+    EXPECT_EQ(1, store.thumbnailCount());
+    EXPECT_FALSE(store.load(info1, 32).isNull());
+    EXPECT_TRUE(store.load(info2, 32).isNull());
+}
+
+TEST_F(CoverArtThumbnailStoreTest, ClearWhenFull) {
+    ASSERT_TRUE(m_dir.isValid());
+    const QImage image = makeImage(64, qRgb(128, 128, 128));
+    const CoverInfo info1 = makeCoverInfo(1, "/music/a.mp3");
+    const CoverInfo info2 = makeCoverInfo(2, "/music/b.mp3");
+    {
+        CoverArtThumbnailStore store(m_dir.path());
+        store.store(info1, 64, image);
+    }
+    const qint64 thumbnailSize = QFile(m_dir.path() + "/thumbnails.dat").size();
+    ASSERT_LT(0, thumbnailSize);
+
+    // Leave room for only one thumbnail
+    CoverArtThumbnailStore store(m_dir.path(), thumbnailSize * 3 / 2);
+    ASSERT_EQ(1, store.thumbnailCount());
+    store.store(info2, 64, image);
+    EXPECT_EQ(1, store.thumbnailCount());
+    EXPECT_TRUE(store.load(info1, 64).isNull());
+    EXPECT_FALSE(store.load(info2, 64).isNull());
+}
+
+}  // anonymous namespace
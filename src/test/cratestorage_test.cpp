@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <QDir>
+
+#include "test/librarytest.h"
+
+#include "library/crate/crate.h"
+
+namespace {
+
+class CrateStorageTest : public LibraryTest {
+  protected:
+    CrateId insertCrate(const QString& name) {
+        Crate crate;
+        crate.setName(name);
+        CrateId crateId;
+        EXPECT_TRUE(collection()->insertCrate(crate, &crateId));
+        return crateId;
+    }
+
+    static QVector<quint32> toVector(const QList<TrackId>& trackIds) {
+        QVector<quint32> result;
+        for (const auto& trackId: trackIds) {
+            result.append(trackId.toInt());
+        }
+        return result;
+    }
+
+    const CrateStorage& crates() {
+        return collection()->crates();
+    }
+
+    CompressedBitmap crateTrackIds(CrateId crateId) {
+        return crates().getTrackIdsOfAnyCrate(QList<CrateId>() << crateId);
+    }
+};
+
+TEST_F(CrateStorageTest, CrateTrackIndex) {
+    const CrateId houseCrateId = insertCrate("House");
+    const CrateId techHouseCrateId = insertCrate("Tech House");
+    const CrateId emptyCrateId = insertCrate("Empty");
+
+    // The tracks don't need to exist in the library for the index
+    const QList<TrackId> houseTrackIds =
+            QList<TrackId>() << TrackId(1) << TrackId(2) << TrackId(3);
+    const QList<TrackId> techHouseTrackIds =
+            QList<TrackId>() << TrackId(3) << TrackId(4);
+    ASSERT_TRUE(collection()->addCrateTracks(houseCrateId, houseTrackIds));
+    ASSERT_TRUE(collection()->addCrateTracks(techHouseCrateId, techHouseTrackIds));
+
+    EXPECT_EQ(3u, crates().countCrateTracks(houseCrateId));
+    EXPECT_EQ(0u, crates().countCrateTracks(emptyCrateId));
+    EXPECT_EQ(toVector(houseTrackIds),
+              crateTrackIds(houseCrateId).toVector());
+
+    const QList<CrateId> crateIds =
+            QList<CrateId>() << houseCrateId << techHouseCrateId;
+    EXPECT_EQ(QVector<quint32>() << 1 << 2 << 3 << 4,
+              crates().getTrackIdsOfAnyCrate(crateIds).toVector());
+    EXPECT_EQ(toVector(houseTrackIds), crates().getTrackIdsOfAnyCrate(
+            QList<CrateId>() << houseCrateId << emptyCrateId).toVector());
+    EXPECT_TRUE(crates().getTrackIdsOfAnyCrate(QList<CrateId>()).isEmpty());
+
+    QList<CrateId> matchingCrateIds = crates().collectCrateIdsByNameLike("house");
+    std::sort(matchingCrateIds.begin(), matchingCrateIds.end());
+    EXPECT_EQ(crateIds, matchingCrateIds);
+
+    EXPECT_EQ(QSet<CrateId>() << houseCrateId << techHouseCrateId,
+              crates().collectCrateIdsOfTracks(QList<TrackId>() << TrackId(3)));
+    EXPECT_EQ(QSet<CrateId>() << techHouseCrateId,
+              crates().collectCrateIdsOfTracks(
+                      QList<TrackId>() << TrackId(4) << TrackId(5)));
+
+    // Modifications
+    ASSERT_TRUE(collection()->removeCrateTracks(
+            houseCrateId, QList<TrackId>() << TrackId(1)));
+    ASSERT_TRUE(collection()->purgeTracks(QList<TrackId>() << TrackId(3)));
+    EXPECT_EQ(QVector<quint32>() << 2,
+              crateTrackIds(houseCrateId).toVector());
+    EXPECT_EQ(QVector<quint32>() << 4,
+              crateTrackIds(techHouseCrateId).toVector());
+
+    ASSERT_TRUE(collection()->deleteCrate(techHouseCrateId));
+    EXPECT_TRUE(crateTrackIds(techHouseCrateId).isEmpty());
+    EXPECT_TRUE(crates().collectCrateIdsOfTracks(
+            QList<TrackId>() << TrackId(4)).isEmpty());
+
+    // The index is reloaded from the database
+    const CompressedBitmap houseTrackIdsBefore =
+            crateTrackIds(houseCrateId);
+    collection()->disconnectDatabase();
+    collection()->connectDatabase(dbConnection());
+    EXPECT_EQ(houseTrackIdsBefore, crateTrackIds(houseCrateId));
+    EXPECT_EQ(1u, crates().countCrateTracks(houseCrateId));
+}
+
+TEST_F(CrateStorageTest, ReadCrateSummaryById) {
+    const QString trackLocation(QDir::currentPath() %
+            "/src/test/id3-test-data/cover-test-jpg.mp3");
+    TrackPointer pTrack(collection()->getTrackDAO().addSingleTrack(trackLocation, false));
+    ASSERT_TRUE(pTrack);
+
+    const CrateId crateId = insertCrate("Crate");
+    const CrateId otherCrateId = insertCrate("Other");
+    ASSERT_TRUE(collection()->addCrateTracks(
+            crateId, QList<TrackId>() << pTrack->getId()));
+
+    CrateSummary crateSummary;
+    ASSERT_TRUE(crates().readCrateSummaryById(crateId, &crateSummary));
+    EXPECT_EQ(crateId, crateSummary.getId());
+    EXPECT_EQ("Crate", crateSummary.getName());
+    EXPECT_EQ(1u, crateSummary.getTrackCount());
+
+    ASSERT_TRUE(crates().readCrateSummaryById(otherCrateId, &crateSummary));
+    EXPECT_EQ(otherCrateId, crateSummary.getId());
+    EXPECT_EQ(0u, crateSummary.getTrackCount());
+    EXPECT_EQ(0.0, crateSummary.getTrackDuration());
+}
+
+}  // anonymous namespace
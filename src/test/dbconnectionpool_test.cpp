@@ -1,5 +1,10 @@
 #include <gtest/gtest.h>
 
+#include <QSqlQuery>
+
+#include <atomic>
+#include <thread>
+
 #include "test/mixxxtest.h"
 
 #include "database/mixxxdb.h"
@@ -35,3 +40,75 @@ TEST_F(DbConnectionPoolTest, MoveSemantics) {
     EXPECT_TRUE(p1.isPooling());
     EXPECT_FALSE(p2.isPooling());
 }
+
+TEST_F(DbConnectionPoolTest, WriteAheadLogging) {
+    const mixxx::DbConnectionPooler dbConnectionPooler(m_mixxxDb.connectionPool());
+    ASSERT_TRUE(dbConnectionPooler.isPooling());
+    EXPECT_EQ(1, m_mixxxDb.connectionPool()->statistics().openConnections);
+
+    QSqlQuery query(mixxx::DbConnectionPooled(m_mixxxDb.connectionPool()));
+    ASSERT_TRUE(query.exec("PRAGMA journal_mode"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(QString("wal"), query.value(0).toString().toLower());
+}
+
+TEST_F(DbConnectionPoolTest, ReadOnly) {
+    const mixxx::DbConnectionPooler dbConnectionPooler(m_mixxxDb.connectionPool());
+    QSqlQuery query(mixxx::DbConnectionPooled(m_mixxxDb.connectionPool()));
+    ASSERT_TRUE(query.exec("CREATE TABLE IF NOT EXISTS test_values (value INTEGER)"));
+    ASSERT_TRUE(query.exec("INSERT INTO test_values VALUES (1)"));
+
+    // Only a single connection per thread
+    bool readSucceeded = false;
+    bool writeFailed = false;
+    int openConnections = 0;
+    std::thread reader([&] {
+        const mixxx::DbConnectionPooler readOnlyPooler(
+                m_mixxxDb.connectionPool(),
+                mixxx::DbConnectionPool::AccessMode::ReadOnly);
+        openConnections = m_mixxxDb.connectionPool()->statistics().openConnections;
+        QSqlQuery readQuery(mixxx::DbConnectionPooled(m_mixxxDb.connectionPool()));
+        readSucceeded = readQuery.exec("SELECT value FROM test_values") &&
+                readQuery.next();
+        writeFailed = !readQuery.exec("INSERT INTO test_values VALUES (2)");
+    });
+    reader.join();
+    EXPECT_EQ(2, openConnections);
+    EXPECT_TRUE(readSucceeded);
+    EXPECT_TRUE(writeFailed);
+    EXPECT_EQ(1, m_mixxxDb.connectionPool()->statistics().openConnections);
+}
+
+// Only counted by the busy handler installed through the SQLite3 API
+#ifdef __SQLITE3__
+TEST_F(DbConnectionPoolTest, BusyRetries) {
+    const mixxx::DbConnectionPooler dbConnectionPooler(m_mixxxDb.connectionPool());
+    QSqlQuery query(mixxx::DbConnectionPooled(m_mixxxDb.connectionPool()));
+    ASSERT_TRUE(query.exec("CREATE TABLE IF NOT EXISTS test_values (value INTEGER)"));
+
+    // Hold the write lock while another connection tries to write
+    ASSERT_TRUE(query.exec("BEGIN IMMEDIATE"));
+    ASSERT_TRUE(query.exec("INSERT INTO test_values VALUES (1)"));
+    std::atomic<bool> writing(false);
+    bool writeSucceeded = false;
+    std::thread writer([&] {
+        const mixxx::DbConnectionPooler writerPooler(m_mixxxDb.connectionPool());
+        QSqlQuery writeQuery(mixxx::DbConnectionPooled(m_mixxxDb.connectionPool()));
+        writing = true;
+        writeSucceeded = writeQuery.exec("INSERT INTO test_values VALUES (2)");
+    });
+    while (!writing) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_TRUE(query.exec("COMMIT"));
+    writer.join();
+
+    EXPECT_TRUE(writeSucceeded);
+    const mixxx::DbConnectionPool::Statistics stats =
+            m_mixxxDb.connectionPool()->statistics();
+    EXPECT_LT(0, stats.busyRetries);
+    EXPECT_LT(0, stats.busyWaitMillis);
+    EXPECT_EQ(0, stats.busyTimeouts);
+}
+#endif // __SQLITE3__
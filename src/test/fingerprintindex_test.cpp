@@ -0,0 +1,216 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include <QtDebug>
+#include <QDir>
+
+#include "library/dao/fingerprintdao.h"
+#include "library/duplicates/duplicatefinder.h"
+#include "library/duplicates/fingerprintindex.h"
+#include "test/librarytest.h"
+
+namespace {
+
+// About two minutes
+const int kFingerprintSize = 969;
+
+class FingerprintIndexTest : public testing::Test {
+  protected:
+    FingerprintIndexTest()
+            : m_random(42) {
+    }
+
+    QVector<quint32> randomFingerprint() {
+        QVector<quint32> fingerprint(kFingerprintSize);
+        for (auto& item: fingerprint) {
+            item = m_random();
+        }
+        return fingerprint;
+    }
+
+    // Like a re-encoded track: Each bit is flipped with the given
+    // probability and the audio starts a few items later.
+    QVector<quint32> reencode(const QVector<quint32>& fingerprint,
+                              double bitErrorRate, int delay) {
+        std::bernoulli_distribution bitError(bitErrorRate);
+        QVector<quint32> result;
+        for (int i = 0; i < delay; ++i) {
+            result.append(m_random());
+        }
+        for (const auto item: fingerprint) {
+            quint32 reencodedItem = item;
+            for (int bit = 0; bit < 32; ++bit) {
+                if (bitError(m_random)) {
+                    reencodedItem ^= 1U << bit;
+                }
+            }
+            result.append(reencodedItem);
+        }
+        return result;
+    }
+
+    std::mt19937 m_random;
+};
+
+TEST_F(FingerprintIndexTest, Signature) {
+    const QVector<quint32> fingerprint = randomFingerprint();
+    const QVector<quint32> signature = FingerprintIndex::signature(fingerprint);
+    ASSERT_EQ(FingerprintIndex::kSignatureSize, signature.size());
+    EXPECT_EQ(signature, FingerprintIndex::signature(fingerprint));
+    EXPECT_TRUE(FingerprintIndex::signature(QVector<quint32>()).isEmpty());
+
+    const QVector<quint32> reencodedSignature =
+            FingerprintIndex::signature(reencode(fingerprint, 0.02, 3));
+    const QVector<quint32> otherSignature =
+            FingerprintIndex::signature(randomFingerprint());
+    int reencodedMatches = 0;
+    int otherMatches = 0;
+    for (int i = 0; i < FingerprintIndex::kSignatureSize; ++i) {
+        if (signature[i] == reencodedSignature[i]) {
+            ++reencodedMatches;
+        }
+        if (signature[i] == otherSignature[i]) {
+            ++otherMatches;
+        }
+    }
+    EXPECT_LE(4, reencodedMatches);
+    EXPECT_EQ(0, otherMatches);
+}
+
+TEST_F(FingerprintIndexTest, Similarity) {
+    const QVector<quint32> fingerprint = randomFingerprint();
+    const QVector<quint32> excerpt = FingerprintIndex::excerpt(fingerprint);
+    EXPECT_GT(fingerprint.size(), excerpt.size());
+    EXPECT_EQ(1.0, FingerprintIndex::similarity(excerpt, excerpt));
+
+    const QVector<quint32> reencodedExcerpt =
+            FingerprintIndex::excerpt(reencode(fingerprint, 0.05, 10));
+    EXPECT_LE(FingerprintIndex::kMinSimilarity,
+              FingerprintIndex::similarity(excerpt, reencodedExcerpt));
+    EXPECT_LE(FingerprintIndex::kMinSimilarity,
+              FingerprintIndex::similarity(reencodedExcerpt, excerpt));
+
+    const QVector<quint32> otherExcerpt =
+            FingerprintIndex::excerpt(randomFingerprint());
+    EXPECT_GT(0.6, FingerprintIndex::similarity(excerpt, otherExcerpt));
+    EXPECT_EQ(0.0, FingerprintIndex::similarity(excerpt, QVector<quint32>()));
+}
+
+TEST_F(FingerprintIndexTest, FindCandidates) {
+    FingerprintIndex index;
+    const QVector<quint32> fingerprint = randomFingerprint();
+    for (int i = 1; i <= 1000; ++i) {
+        index.insert(TrackId(i), FingerprintIndex::signature(randomFingerprint()));
+    }
+    index.insert(TrackId(1001), FingerprintIndex::signature(fingerprint));
+    index.insert(TrackId(1002), FingerprintIndex::signature(
+            reencode(fingerprint, 0.02, 5)));
+    // Ignored
+    index.insert(TrackId(1003), QVector<quint32>());
+    index.insert(TrackId(), FingerprintIndex::signature(fingerprint));
+    EXPECT_EQ(1002, index.size());
+
+    const QList<QPair<TrackId, TrackId>> candidates = index.findCandidates();
+    EXPECT_TRUE(candidates.contains(qMakePair(TrackId(1001), TrackId(1002))));
+    EXPECT_GT(10, candidates.size());
+}
+
+TEST_F(FingerprintIndexTest, GroupDuplicates) {
+    const QVector<quint32> fingerprint = randomFingerprint();
+    QHash<TrackId, QVector<quint32>> excerpts;
+    excerpts[TrackId(1)] = FingerprintIndex::excerpt(fingerprint);
+    excerpts[TrackId(2)] = FingerprintIndex::excerpt(reencode(fingerprint, 0.02, 2));
+    excerpts[TrackId(3)] = FingerprintIndex::excerpt(reencode(fingerprint, 0.02, 4));
+    // An edit with a different duration
+    excerpts[TrackId(4)] = FingerprintIndex::excerpt(fingerprint);
+    excerpts[TrackId(5)] = FingerprintIndex::excerpt(randomFingerprint());
+    excerpts[TrackId(6)] = FingerprintIndex::excerpt(randomFingerprint());
+    excerpts[TrackId(7)] = excerpts[TrackId(6)];
+    QHash<TrackId, double> durations;
+    durations[TrackId(1)] = 300.0;
+    durations[TrackId(2)] = 301.0;
+    durations[TrackId(3)] = 299.5;
+    durations[TrackId(4)] = 420.0;
+
+    QList<QPair<TrackId, TrackId>> candidates;
+    candidates << qMakePair(TrackId(2), TrackId(3))
+               << qMakePair(TrackId(1), TrackId(3))
+               << qMakePair(TrackId(1), TrackId(4))
+               << qMakePair(TrackId(1), TrackId(5))
+               << qMakePair(TrackId(6), TrackId(7))
+               << qMakePair(TrackId(6), TrackId(8));
+
+    QList<QList<TrackId>> expectedGroups;
+    expectedGroups << (QList<TrackId>() << TrackId(1) << TrackId(2) << TrackId(3))
+                   << (QList<TrackId>() << TrackId(6) << TrackId(7));
+    EXPECT_EQ(expectedGroups,
+              DuplicateFinder::groupDuplicates(candidates, excerpts, durations));
+}
+
+class FingerprintDaoTest : public LibraryTest {
+};
+
+TEST_F(FingerprintDaoTest, SaveAndLoad) {
+    const QString trackLocation(QDir::currentPath() %
+            "/src/test/id3-test-data/cover-test-jpg.mp3");
+    TrackPointer pTrack(collection()->getTrackDAO().addSingleTrack(trackLocation, false));
+    ASSERT_TRUE(pTrack);
+    const TrackId trackId = pTrack->getId();
+
+    FingerprintDao dao;
+    dao.initialize(dbConnection());
+    EXPECT_FALSE(dao.hasFingerprint(trackId, FingerprintIndex::kVersion));
+
+    const QVector<quint32> signature = QVector<quint32>() << 1 << 0xFFFFFFFF;
+    const QVector<quint32> excerpt = QVector<quint32>() << 7 << 0x12345678 << 0;
+    ASSERT_TRUE(dao.saveFingerprint(trackId, FingerprintIndex::kVersion,
+                                    signature, excerpt));
+    EXPECT_TRUE(dao.hasFingerprint(trackId, FingerprintIndex::kVersion));
+    EXPECT_FALSE(dao.hasFingerprint(trackId, FingerprintIndex::kVersion + 1));
+
+    const QList<FingerprintDao::TrackSignature> signatures =
+            dao.loadSignatures(FingerprintIndex::kVersion);
+    ASSERT_EQ(1, signatures.size());
+    EXPECT_EQ(trackId, signatures.first().trackId);
+    EXPECT_EQ(signature, signatures.first().signature);
+    EXPECT_TRUE(dao.loadSignatures(FingerprintIndex::kVersion + 1).isEmpty());
+
+    const QHash<TrackId, QVector<quint32>> excerpts =
+            dao.loadExcerpts(QList<TrackId>() << trackId << TrackId(trackId.toInt() + 1));
+    ASSERT_EQ(1, excerpts.size());
+    EXPECT_EQ(excerpt, excerpts.value(trackId));
+
+    // Hidden tracks are excluded
+    ASSERT_TRUE(collection()->hideTracks(QList<TrackId>() << trackId));
+    EXPECT_TRUE(dao.loadSignatures(FingerprintIndex::kVersion).isEmpty());
+
+    ASSERT_TRUE(collection()->purgeTracks(QList<TrackId>() << trackId));
+    EXPECT_FALSE(dao.hasFingerprint(trackId, FingerprintIndex::kVersion));
+}
+
+// Finds the candidates among the signatures of a large library. Run with
+// --benchmark.
+static void BM_FindCandidates(benchmark::State& state) {
+    const int numTracks = state.range_x();
+    std::mt19937 random(42);
+    FingerprintIndex index;
+    index.reserve(numTracks);
+    QVector<quint32> signature(FingerprintIndex::kSignatureSize);
+    for (int i = 1; i <= numTracks; ++i) {
+        for (auto& value: signature) {
+            value = random();
+        }
+        index.insert(TrackId(i), signature);
+    }
+    int numCandidates = 0;
+    while (state.KeepRunning()) {
+        numCandidates = index.findCandidates().size();
+    }
+    state.SetItemsProcessed(state.iterations() * numTracks);
+    state.SetLabel(QString("%1 candidates").arg(numCandidates).toStdString());
+}
+BENCHMARK(BM_FindCandidates)->Arg(200000);
+
+}  // namespace
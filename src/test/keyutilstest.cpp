@@ -232,4 +232,19 @@ TEST_F(KeyUtilsTest, GetCompatibleKeys) {
         mixxx::track::io::key::D_MINOR));
 }
 
+TEST_F(KeyUtilsTest, CircleOfFifthsDistance) {
+    using namespace mixxx::track::io::key;
+    EXPECT_EQ(0, KeyUtils::circleOfFifthsDistance(C_MAJOR, C_MAJOR));
+    // Relative minor
+    EXPECT_EQ(1, KeyUtils::circleOfFifthsDistance(C_MAJOR, A_MINOR));
+    // Dominant and sub-dominant, wrapping around between 1 and 12
+    EXPECT_EQ(1, KeyUtils::circleOfFifthsDistance(C_MAJOR, G_MAJOR));
+    EXPECT_EQ(1, KeyUtils::circleOfFifthsDistance(C_MAJOR, F_MAJOR));
+    EXPECT_EQ(2, KeyUtils::circleOfFifthsDistance(F_MAJOR, G_MAJOR));
+    EXPECT_EQ(3, KeyUtils::circleOfFifthsDistance(F_MAJOR, E_MINOR));
+    // Tritone
+    EXPECT_EQ(6, KeyUtils::circleOfFifthsDistance(C_MAJOR, F_SHARP_MAJOR));
+    EXPECT_EQ(-1, KeyUtils::circleOfFifthsDistance(C_MAJOR, INVALID));
+}
+
 }  // namespace
@@ -1,9 +1,23 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSignalSpy>
+#include <QSqlQuery>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 #include "test/librarytest.h"
 
+#include "library/dao/libraryhashdao.h"
+#include "library/dao/searchindexdao.h"
+#include "library/scanner/importfilestask.h"
 #include "library/scanner/libraryscanner.h"
+#include "util/performancetimer.h"
 
 class LibraryScannerTest : public LibraryTest {
   protected:
@@ -52,3 +66,374 @@ TEST_F(LibraryScannerTest, ScannerRoundtrip) {
     m_libraryScanner.changeScannerState(LibraryScanner::IDLE);
     EXPECT_EQ(m_libraryScanner.m_state, LibraryScanner::IDLE);
 }
+
+TEST_F(LibraryScannerTest, DirectoryModificationTimes) {
+    LibraryHashDAO libraryHashDao;
+    libraryHashDao.initialize(dbConnection());
+    libraryHashDao.saveDirectoryHash("/music/a", 1, 1000);
+    libraryHashDao.saveDirectoryHash("/music/b", 2, 2000);
+
+    QHash<QString, qint64> mtimes = libraryHashDao.getDirectoryModificationTimes();
+    EXPECT_EQ(2, mtimes.size());
+    EXPECT_EQ(1000, mtimes.value("/music/a"));
+    EXPECT_EQ(2000, mtimes.value("/music/b"));
+
+    libraryHashDao.updateDirectoryModificationTime("/music/a", 1500);
+    libraryHashDao.updateDirectoryHash("/music/b", 3, 0, 2500);
+    mtimes = libraryHashDao.getDirectoryModificationTimes();
+    EXPECT_EQ(1500, mtimes.value("/music/a"));
+    EXPECT_EQ(2500, mtimes.value("/music/b"));
+    EXPECT_EQ(1, libraryHashDao.getDirectoryHash("/music/a"));
+    EXPECT_EQ(3, libraryHashDao.getDirectoryHash("/music/b"));
+
+    // Deleted directories are not rescanned
+    libraryHashDao.updateDirectoryStatuses(
+            QStringList() << "/music/b", true, false);
+    mtimes = libraryHashDao.getDirectoryModificationTimes();
+    EXPECT_EQ(1, mtimes.size());
+    EXPECT_TRUE(mtimes.contains("/music/a"));
+}
+
+TEST_F(LibraryScannerTest, IncrementalScanIsNotRecursive) {
+    const QDir testDir(QDir::current().absoluteFilePath("src/test/id3-test-data"));
+    const QString testFile = testDir.absoluteFilePath("TOAL_TPE2.mp3");
+    const QString rootPath = getTestDataDir().absoluteFilePath("library");
+    const QString knownPath = rootPath + "/known";
+    const QString oldPath = knownPath + "/old";
+    const QString newPath = knownPath + "/new";
+    ASSERT_TRUE(QDir().mkpath(oldPath));
+    ASSERT_TRUE(QFile::copy(testFile, knownPath + "/a.mp3"));
+    ASSERT_TRUE(QFile::copy(testFile, oldPath + "/b.mp3"));
+    ASSERT_EQ(ALL_FINE, collection()->getDirectoryDAO().addDirectory(rootPath));
+
+    auto waitForScan = [this]() {
+        QElapsedTimer timer;
+        timer.start();
+        while (m_libraryScanner.m_state != LibraryScanner::IDLE &&
+                timer.elapsed() < 30000) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return m_libraryScanner.m_state == LibraryScanner::IDLE;
+    };
+
+    m_libraryScanner.scan();
+    ASSERT_TRUE(waitForScan());
+    TrackDAO& trackDao = collection()->getTrackDAO();
+    EXPECT_TRUE(trackDao.getTrackId(knownPath + "/a.mp3").isValid());
+    EXPECT_TRUE(trackDao.getTrackId(oldPath + "/b.mp3").isValid());
+
+    // A stale hash is only corrected if the directory is rescanned
+    const int kStaleHash = 12345;
+    QSqlQuery query(dbConnection());
+    query.prepare("UPDATE LibraryHashes SET hash=:hash "
+                  "WHERE directory_path=:directory_path");
+    query.bindValue(":hash", kStaleHash);
+    query.bindValue(":directory_path", oldPath);
+    ASSERT_TRUE(query.exec());
+    ASSERT_EQ(1, query.numRowsAffected());
+
+    // Some file systems only store the modification time in seconds
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    ASSERT_TRUE(QFile::copy(testFile, knownPath + "/c.mp3"));
+    ASSERT_TRUE(QDir().mkpath(newPath));
+    ASSERT_TRUE(QFile::copy(testFile, newPath + "/d.mp3"));
+
+    m_libraryScanner.scanModifiedDirectories();
+    ASSERT_TRUE(waitForScan());
+
+    // The modified directory and the new sub-directory have been scanned
+    EXPECT_TRUE(trackDao.getTrackId(knownPath + "/c.mp3").isValid());
+    EXPECT_TRUE(trackDao.getTrackId(newPath + "/d.mp3").isValid());
+    LibraryHashDAO libraryHashDao;
+    libraryHashDao.initialize(dbConnection());
+    EXPECT_NE(-1, libraryHashDao.getDirectoryHash(newPath));
+    // The unmodified sub-directory that is already known has been skipped
+    EXPECT_EQ(kStaleHash, libraryHashDao.getDirectoryHash(oldPath));
+}
+
+TEST_F(LibraryScannerTest, IncrementalScanOfMovedDirectory) {
+    const QDir testDir(QDir::current().absoluteFilePath("src/test/id3-test-data"));
+    const QString testFile = testDir.absoluteFilePath("TOAL_TPE2.mp3");
+    const QString rootPath = getTestDataDir().absoluteFilePath("library");
+    const QString oldPath = rootPath + "/artist";
+    const QString newPath = rootPath + "/moved";
+    ASSERT_TRUE(QDir().mkpath(oldPath + "/album"));
+    ASSERT_TRUE(QFile::copy(testFile, oldPath + "/a.mp3"));
+    ASSERT_TRUE(QFile::copy(testFile, oldPath + "/album/b.mp3"));
+    ASSERT_EQ(ALL_FINE, collection()->getDirectoryDAO().addDirectory(rootPath));
+
+    auto waitForScan = [this]() {
+        QElapsedTimer timer;
+        timer.start();
+        while (m_libraryScanner.m_state != LibraryScanner::IDLE &&
+                timer.elapsed() < 30000) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return m_libraryScanner.m_state == LibraryScanner::IDLE;
+    };
+
+    m_libraryScanner.scan();
+    ASSERT_TRUE(waitForScan());
+    TrackDAO& trackDao = collection()->getTrackDAO();
+    const TrackId trackIdA = trackDao.getTrackId(oldPath + "/a.mp3");
+    const TrackId trackIdB = trackDao.getTrackId(oldPath + "/album/b.mp3");
+    ASSERT_TRUE(trackIdA.isValid());
+    ASSERT_TRUE(trackIdB.isValid());
+
+    ASSERT_TRUE(QDir().rename(oldPath, newPath));
+    // Like the file system watcher only the moved directory and its parent
+    // are reported as changed
+    {
+        QMutexLocker locker(&m_libraryScanner.m_changedDirsMutex);
+        m_libraryScanner.m_changedDirs.insert(oldPath);
+        m_libraryScanner.m_changedDirs.insert(rootPath);
+    }
+    ASSERT_TRUE(m_libraryScanner.changeScannerState(LibraryScanner::STARTING));
+    emit(m_libraryScanner.startIncrementalScan());
+    ASSERT_TRUE(waitForScan());
+
+    // The tracks have been moved instead of being added again
+    EXPECT_EQ(trackIdA, trackDao.getTrackId(newPath + "/a.mp3"));
+    EXPECT_EQ(trackIdB, trackDao.getTrackId(newPath + "/album/b.mp3"));
+    QSqlQuery query(dbConnection());
+    ASSERT_TRUE(query.exec("SELECT COUNT(*) FROM library WHERE mixxx_deleted=0"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(2, query.value(0).toInt());
+
+    // The subdirectory of the moved directory is no longer known
+    LibraryHashDAO libraryHashDao;
+    libraryHashDao.initialize(dbConnection());
+    EXPECT_TRUE(libraryHashDao.getSubdirectories(oldPath).isEmpty());
+    EXPECT_EQ(QStringList() << newPath + "/album",
+            libraryHashDao.getSubdirectories(newPath));
+}
+
+namespace {
+
+ScannerGlobalPointer newScannerGlobal() {
+    return ScannerGlobalPointer(new ScannerGlobal(
+            QSet<QString>(), QHash<QString, int>(), QHash<QString, qint64>(),
+            QRegExp(), QRegExp(), QStringList()));
+}
+
+}  // anonymous namespace
+
+TEST_F(LibraryScannerTest, PendingTracksBackpressure) {
+    ScannerGlobalPointer scannerGlobal = newScannerGlobal();
+    for (int i = 0; i < ScannerGlobal::kMaxPendingTracks; ++i) {
+        ASSERT_TRUE(scannerGlobal->tryAcquirePendingTrack());
+    }
+    EXPECT_FALSE(scannerGlobal->tryAcquirePendingTrack());
+
+    // A parser blocks until the database has caught up
+    std::atomic<bool> acquired(false);
+    std::thread parser([&scannerGlobal, &acquired]() {
+        acquired = scannerGlobal->acquirePendingTrack();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_FALSE(acquired);
+    scannerGlobal->releasePendingTracks(1);
+    parser.join();
+    EXPECT_TRUE(acquired);
+
+    // Cancelling the scan unblocks the waiting parsers
+    std::thread cancelledParser([&scannerGlobal, &acquired]() {
+        acquired = scannerGlobal->acquirePendingTrack();
+    });
+    scannerGlobal->cancel();
+    cancelledParser.join();
+    EXPECT_FALSE(acquired);
+}
+
+TEST_F(LibraryScannerTest, ImportFilesTaskHandsOverTracks) {
+    const QDir testDir(QDir::current().absoluteFilePath("src/test/id3-test-data"));
+    const QString testFile = testDir.absoluteFilePath("TOAL_TPE2.mp3");
+    const QDir dir(getTestDataDir());
+    QLinkedList<QFileInfo> filesToImport;
+    for (int i = 0; i < 3; ++i) {
+        const QString filePath = dir.absoluteFilePath(QString("track%1.mp3").arg(i));
+        ASSERT_TRUE(QFile::copy(testFile, filePath));
+        filesToImport.append(QFileInfo(filePath));
+    }
+    const QString unsupportedFile = dir.absoluteFilePath("notes.txt");
+    ASSERT_TRUE(QFile::copy(testFile, unsupportedFile));
+    filesToImport.insert(filesToImport.begin() + 1, QFileInfo(unsupportedFile));
+
+    ScannerGlobalPointer scannerGlobal = newScannerGlobal();
+    // Leave room for only two parsed tracks
+    for (int i = 0; i < ScannerGlobal::kMaxPendingTracks - 2; ++i) {
+        ASSERT_TRUE(scannerGlobal->tryAcquirePendingTrack());
+    }
+
+    scannerGlobal->getTaskWatcher().watchTask();
+    ImportFilesTask* pTask = new ImportFilesTask(&m_libraryScanner,
+            scannerGlobal, dir.path(), false, 1, 0, filesToImport,
+            QLinkedList<QFileInfo>(), SecurityTokenPointer());
+    pTask->setAutoDelete(false);
+    QSignalSpy addSpy(pTask, SIGNAL(addNewTracks(QList<TrackPointer>)));
+    QSignalSpy skipSpy(pTask, SIGNAL(trackSkipped(QString)));
+    QSignalSpy scannedSpy(pTask,
+            SIGNAL(directoryHashedAndScanned(QString, bool, int, qint64)));
+
+    std::atomic<bool> finished(false);
+    std::thread parser([pTask, &finished]() {
+        pTask->run();
+        finished = true;
+    });
+    // The parser hands over the tracks parsed so far before it waits
+    // for the database
+    QElapsedTimer timer;
+    timer.start();
+    while (scannerGlobal->numParsedTracks() < 2 && timer.elapsed() < 10000) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_FALSE(finished);
+    EXPECT_EQ(1, addSpy.count());
+    scannerGlobal->releasePendingTracks(2);
+    parser.join();
+
+    // The remaining track is handed over in a second batch
+    EXPECT_EQ(3, scannerGlobal->numParsedTracks());
+    EXPECT_EQ(2, addSpy.count());
+    // The unsupported file is acknowledged without being parsed
+    ASSERT_EQ(1, skipSpy.count());
+    EXPECT_EQ(unsupportedFile, skipSpy.at(0).at(0).toString());
+    EXPECT_EQ(1, scannedSpy.count());
+    delete pTask;
+}
+
+TEST_F(LibraryScannerTest, SkippedTracksAreNotAdded) {
+    ScannerGlobalPointer scannerGlobal = newScannerGlobal();
+    m_libraryScanner.m_scannerGlobal = scannerGlobal;
+
+    m_libraryScanner.slotTrackSkipped(getTestDataDir().filePath("cover.txt"));
+    EXPECT_EQ(1, scannerGlobal->numSkippedTracks());
+    // Only added tracks are considered when detecting moved tracks
+    EXPECT_TRUE(scannerGlobal->addedTracks().isEmpty());
+
+    m_libraryScanner.m_scannerGlobal.clear();
+}
+
+namespace {
+
+QVector<TrackDAO::NewTrack> syntheticTracks(const QString& dirPath, int count) {
+    QVector<TrackDAO::NewTrack> newTracks;
+    newTracks.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        mixxx::TrackMetadata trackMetadata;
+        trackMetadata.setArtist(QString("Artist %1").arg(i % 997));
+        trackMetadata.setTitle(QString("Title %1").arg(i));
+        trackMetadata.setAlbum(QString("Album %1").arg(i / 12));
+        trackMetadata.setGenre("Techno");
+        trackMetadata.setKey("Am");
+        trackMetadata.setDuration(180.0 + i % 240);
+        trackMetadata.setBpm(mixxx::Bpm(120.0 + i % 20));
+        newTracks.append(TrackDAO::NewTrack(
+                QFileInfo(QString("%1/%2/track%3.mp3").arg(dirPath).arg(i / 100).arg(i)),
+                trackMetadata, true));
+    }
+    return newTracks;
+}
+
+}  // anonymous namespace
+
+TEST_F(LibraryScannerTest, AddTracksBulk) {
+    TrackDAO& trackDao = collection()->getTrackDAO();
+    const QString dirPath = QDir::tempPath() + "/mixxx-bulk-insert";
+
+    // Enough tracks to defer updating the search index
+    QVector<TrackDAO::NewTrack> newTracks = syntheticTracks(dirPath, 300);
+    QVector<TrackDAO::NewTrack> existingTracks;
+    existingTracks.append(TrackDAO::NewTrack(
+            QFileInfo(dirPath + "/existing.mp3"), mixxx::TrackMetadata(), false));
+    const QList<TrackId> existingTrackIds =
+            trackDao.addTracksBulk(existingTracks, false);
+    ASSERT_EQ(1, existingTrackIds.size());
+    ASSERT_TRUE(existingTrackIds[0].isValid());
+    newTracks.insert(1, existingTracks[0]);
+    // Files that are listed twice are only added once
+    newTracks.append(newTracks[0]);
+
+    const QList<TrackId> trackIds = trackDao.addTracksBulk(newTracks, true);
+    ASSERT_EQ(newTracks.size(), trackIds.size());
+    EXPECT_EQ(existingTrackIds[0], trackIds[1]);
+    EXPECT_EQ(trackIds.first(), trackIds.last());
+    QSet<TrackId> uniqueTrackIds;
+    for (const auto& trackId: trackIds) {
+        EXPECT_TRUE(trackId.isValid());
+        uniqueTrackIds.insert(trackId);
+    }
+    EXPECT_EQ(newTracks.size() - 1, uniqueTrackIds.size());
+
+    for (int i = 0; i < newTracks.size(); ++i) {
+        EXPECT_QSTRING_EQ(newTracks[i].fileInfo.absoluteFilePath(),
+                          trackDao.getTrackLocation(trackIds[i]));
+    }
+
+    QSqlQuery query(dbConnection());
+    ASSERT_TRUE(query.exec(QString(
+            "SELECT artist,title,bpm,key,header_parsed FROM library WHERE id=%1")
+            .arg(trackIds[2].toString())));
+    ASSERT_TRUE(query.next());
+    EXPECT_QSTRING_EQ("Artist 1", query.value(0).toString());
+    EXPECT_QSTRING_EQ("Title 1", query.value(1).toString());
+    EXPECT_DOUBLE_EQ(121.0, query.value(2).toDouble());
+    EXPECT_FALSE(query.value(3).toString().isEmpty());
+    EXPECT_TRUE(query.value(4).toBool());
+
+    // The search index contains the new tracks and is still maintained
+    // for tracks that are added later.
+    if (collection()->getSearchIndexDAO().isAvailable()) {
+        ASSERT_TRUE(query.exec(QString(
+                "SELECT COUNT(*) FROM %1 WHERE docid IN "
+                "(SELECT id FROM library)").arg(SearchIndexDAO::kTableName)));
+        ASSERT_TRUE(query.next());
+        EXPECT_EQ(uniqueTrackIds.size(), query.value(0).toInt());
+
+        TrackPointer pLaterTrack(Track::newTemporary(
+                QFileInfo(dirPath + "/later.mp3")));
+        trackDao.addTracksPrepare();
+        const TrackId laterTrackId = trackDao.addTracksAddTrack(pLaterTrack, false);
+        trackDao.addTracksFinish();
+        ASSERT_TRUE(laterTrackId.isValid());
+        ASSERT_TRUE(query.exec(QString("SELECT COUNT(*) FROM %1 WHERE docid=%2")
+                .arg(SearchIndexDAO::kTableName, laterTrackId.toString())));
+        ASSERT_TRUE(query.next());
+        EXPECT_EQ(1, query.value(0).toInt());
+    }
+}
+
+// Compares adding a synthetic library of 100k tracks in bulk with adding
+// tracks one by one. Run with --gtest_also_run_disabled_tests.
+TEST_F(LibraryScannerTest, DISABLED_AddTracksBulkBenchmark) {
+    TrackDAO& trackDao = collection()->getTrackDAO();
+    const int kNumTracks = 100000;
+    // Adding tracks one by one takes too long for the whole set
+    const int kNumSingleTracks = 10000;
+
+    const QVector<TrackDAO::NewTrack> newTracks =
+            syntheticTracks(QDir::tempPath() + "/mixxx-bulk-insert", kNumTracks);
+    PerformanceTimer timer;
+    timer.start();
+    const QList<TrackId> trackIds = trackDao.addTracksBulk(newTracks, false);
+    const mixxx::Duration bulkDuration = timer.elapsed();
+    ASSERT_EQ(kNumTracks, trackIds.size());
+
+    const QVector<TrackDAO::NewTrack> singleTracks =
+            syntheticTracks(QDir::tempPath() + "/mixxx-single-insert", kNumSingleTracks);
+    timer.start();
+    trackDao.addTracksPrepare();
+    for (const auto& newTrack: singleTracks) {
+        TrackPointer pTrack(Track::newTemporary(newTrack.fileInfo));
+        pTrack->setTrackMetadata(newTrack.trackMetadata, newTrack.headerParsed);
+        trackDao.addTracksAddTrack(pTrack, false);
+    }
+    trackDao.addTracksFinish();
+    const mixxx::Duration singleDuration = timer.elapsed();
+
+    qDebug() << "Bulk insert:" << kNumTracks / bulkDuration.toDoubleSeconds()
+             << "tracks/s";
+    qDebug() << "Single inserts:" << kNumSingleTracks / singleDuration.toDoubleSeconds()
+             << "tracks/s";
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <QtSql>
+
+#include "library/dao/playlistdao.h"
+
+#include "test/librarytest.h"
+
+using ::testing::ElementsAre;
+
+namespace {
+
+class PlaylistDAOTest : public LibraryTest {
+  protected:
+    void SetUp() override {
+        m_playlistId = playlistDao().createPlaylist("PlaylistDAOTest");
+        ASSERT_LE(0, m_playlistId);
+        QList<TrackId> trackIds;
+        for (int i = 1; i <= 6; ++i) {
+            trackIds.append(TrackId(i));
+        }
+        ASSERT_TRUE(playlistDao().appendTracksToPlaylist(trackIds, m_playlistId));
+    }
+
+    PlaylistDAO& playlistDao() {
+        return collection()->getPlaylistDAO();
+    }
+
+    // Returns the track ids in playlist order and checks that the
+    // positions are 1..n without gaps.
+    std::vector<int> trackIdsInOrder() {
+        QSqlQuery query(dbConnection());
+        query.prepare("SELECT track_id, position FROM PlaylistTracks "
+                      "WHERE playlist_id=:id ORDER BY position");
+        query.bindValue(":id", m_playlistId);
+        EXPECT_TRUE(query.exec());
+        std::vector<int> trackIds;
+        int expectedPosition = 1;
+        while (query.next()) {
+            trackIds.push_back(query.value(0).toInt());
+            EXPECT_EQ(expectedPosition++, query.value(1).toInt());
+        }
+        return trackIds;
+    }
+
+    int m_playlistId;
+};
+
+TEST_F(PlaylistDAOTest, RemoveTracks) {
+    QList<int> positions;
+    positions << 5 << 2 << 3;
+    playlistDao().removeTracksFromPlaylist(m_playlistId, positions);
+    EXPECT_THAT(trackIdsInOrder(), ElementsAre(1, 4, 6));
+    EXPECT_FALSE(playlistDao().isTrackInPlaylist(TrackId(2), m_playlistId));
+    EXPECT_TRUE(playlistDao().isTrackInPlaylist(TrackId(4), m_playlistId));
+}
+
+TEST_F(PlaylistDAOTest, RemoveAdjacentAndMissingTracks) {
+    // Position 9 doesn't exist and must not shift anything
+    QList<int> positions;
+    positions << 1 << 9 << 4 << 5;
+    playlistDao().removeTracksFromPlaylist(m_playlistId, positions);
+    EXPECT_THAT(trackIdsInOrder(), ElementsAre(2, 3, 6));
+
+    playlistDao().removeTrackFromPlaylist(m_playlistId, 1);
+    EXPECT_THAT(trackIdsInOrder(), ElementsAre(3, 6));
+}
+
+TEST_F(PlaylistDAOTest, RemoveTrackById) {
+    // The track is in the playlist twice
+    ASSERT_TRUE(playlistDao().appendTrackToPlaylist(TrackId(2), m_playlistId));
+    playlistDao().removeTrackFromPlaylist(m_playlistId, TrackId(2));
+    EXPECT_THAT(trackIdsInOrder(), ElementsAre(1, 3, 4, 5, 6));
+}
+
+TEST_F(PlaylistDAOTest, InsertTracks) {
+    QList<TrackId> trackIds;
+    trackIds << TrackId(7) << TrackId() << TrackId(8);
+    EXPECT_EQ(2, playlistDao().insertTracksIntoPlaylist(trackIds, m_playlistId, 3));
+    EXPECT_THAT(trackIdsInOrder(), ElementsAre(1, 2, 7, 8, 3, 4, 5, 6));
+}
+
+TEST_F(PlaylistDAOTest, MoveTrack) {
+    playlistDao().moveTrack(m_playlistId, 2, 5);
+    EXPECT_THAT(trackIdsInOrder(), ElementsAre(1, 3, 4, 5, 2, 6));
+    playlistDao().moveTrack(m_playlistId, 5, 1);
+    EXPECT_THAT(trackIdsInOrder(), ElementsAre(2, 1, 3, 4, 5, 6));
+}
+
+TEST_F(PlaylistDAOTest, MoveTracks) {
+    QList<int> positions;
+    positions << 5 << 2;
+    // Down, in front of the last track
+    playlistDao().moveTracks(m_playlistId, positions, 6);
+    EXPECT_THAT(trackIdsInOrder(), ElementsAre(1, 3, 4, 2, 5, 6));
+    // Up, to the top
+    positions.clear();
+    positions << 4 << 6;
+    playlistDao().moveTracks(m_playlistId, positions, 1);
+    EXPECT_THAT(trackIdsInOrder(), ElementsAre(2, 6, 1, 3, 4, 5));
+    // To the end
+    positions.clear();
+    positions << 1;
+    playlistDao().moveTracks(m_playlistId, positions, 7);
+    EXPECT_THAT(trackIdsInOrder(), ElementsAre(6, 1, 3, 4, 5, 2));
+}
+
+}  // anonymous namespace
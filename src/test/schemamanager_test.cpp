@@ -126,3 +126,27 @@ TEST_F(SchemaManagerTest, FailedUpgrade) {
             MixxxDb::kDefaultSchemaFile, MixxxDb::kRequiredSchemaVersion);
     EXPECT_EQ(SchemaManager::Result::UpgradeFailed, result);
 }
+
+TEST_F(SchemaManagerTest, UpgradeToDirectoryModificationTimes) {
+    {
+        SchemaManager schemaManager(dbConnection());
+        SchemaManager::Result result = schemaManager.upgradeToSchemaVersion(
+                MixxxDb::kDefaultSchemaFile, 27);
+        EXPECT_EQ(SchemaManager::Result::UpgradeSucceeded, result);
+    }
+    QSqlQuery query(dbConnection());
+    ASSERT_TRUE(query.exec(
+            "INSERT INTO LibraryHashes (directory_path, hash, directory_deleted) "
+            "VALUES ('/music', 1, 0)"));
+
+    SchemaManager schemaManager(dbConnection());
+    SchemaManager::Result result = schemaManager.upgradeToSchemaVersion(
+            MixxxDb::kDefaultSchemaFile, 28);
+    EXPECT_EQ(SchemaManager::Result::UpgradeSucceeded, result);
+
+    // Existing directories are rescanned once by the next incremental scan
+    ASSERT_TRUE(query.exec(
+            "SELECT mtime FROM LibraryHashes WHERE directory_path='/music'"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(0, query.value(0).toLongLong());
+}
@@ -1,4 +1,6 @@
 #include <gtest/gtest.h>
+
+#include <algorithm>
 #include <QtDebug>
 #include <QDir>
 #include <QTemporaryFile>
@@ -25,9 +27,14 @@ class SearchQueryParserTest : public LibraryTest {
     SearchQueryParser m_parser;
 
     // The expected query to be returned by CrateFilterNode
-    const QString m_crateFilterQuery =
-        "id IN (SELECT DISTINCT track_id FROM crate_tracks"
-        " JOIN crates ON crate_id=id WHERE name LIKE '%%1%' ORDER BY track_id)";
+    static QString crateFilterQuery(QList<TrackId> trackIds) {
+        std::sort(trackIds.begin(), trackIds.end());
+        QStringList values;
+        for (const auto& trackId : trackIds) {
+            values << trackId.toString();
+        }
+        return QString("id IN (%1)").arg(values.join(","));
+    }
 };
 
 TEST_F(SearchQueryParserTest, EmptySearch) {
@@ -706,7 +713,7 @@ TEST_F(SearchQueryParserTest, CrateFilter) {
     EXPECT_FALSE(pQuery->match(pTrackB));
 
     EXPECT_STREQ(
-                 qPrintable(m_crateFilterQuery.arg(searchTerm)),
+                 qPrintable(crateFilterQuery(trackIds)),
                  qPrintable(pQuery->toSql()));
 }
 
@@ -759,7 +766,7 @@ TEST_F(SearchQueryParserTest, CrateFilterQuote){
     EXPECT_FALSE(pQuery->match(pTrackB));
 
     EXPECT_STREQ(
-                 qPrintable(m_crateFilterQuery.arg(searchTerm)),
+                 qPrintable(crateFilterQuery(trackIds)),
                  qPrintable(pQuery->toSql()));
 }
 
@@ -806,7 +813,7 @@ TEST_F(SearchQueryParserTest, CrateFilterWithOther){
     EXPECT_FALSE(pQuery->match(pTrackB));
 
     EXPECT_STREQ(
-                 qPrintable("(" + m_crateFilterQuery.arg(searchTerm) +
+                 qPrintable("(" + crateFilterQuery(trackIds) +
                             ") AND ((artist LIKE '%asdf%') OR (album_artist LIKE '%asdf%'))"),
                  qPrintable(pQuery->toSql()));
 }
@@ -856,8 +863,8 @@ TEST_F(SearchQueryParserTest, CrateFilterWithCrateFilterAndNegation){
     EXPECT_FALSE(pQueryA->match(pTrackB));
 
     EXPECT_STREQ(
-                 qPrintable("(" + m_crateFilterQuery.arg(searchTermA) +
-                            ") AND (" + m_crateFilterQuery.arg(searchTermB) + ")"),
+                 qPrintable("(" + crateFilterQuery(trackIdsA) +
+                            ") AND (" + crateFilterQuery(trackIdsB) + ")"),
                  qPrintable(pQueryA->toSql()));
 
     // parse again to test negation
@@ -868,7 +875,139 @@ TEST_F(SearchQueryParserTest, CrateFilterWithCrateFilterAndNegation){
     EXPECT_TRUE(pQueryB->match(pTrackB));
 
     EXPECT_STREQ(
-                 qPrintable("(" + m_crateFilterQuery.arg(searchTermA) +
-                            ") AND (NOT (" + m_crateFilterQuery.arg(searchTermB) + "))"),
+                 qPrintable("(" + crateFilterQuery(trackIdsA) +
+                            ") AND (NOT (" + crateFilterQuery(trackIdsB) + "))"),
                  qPrintable(pQueryB->toSql()));
 }
+
+TEST_F(SearchQueryParserTest, FullTextSearch) {
+    const SearchIndexDAO& searchIndex = collection()->getSearchIndexDAO();
+    if (!searchIndex.isAvailable()) {
+        qWarning() << "Skipping test: full-text search is not supported by SQLite";
+        return;
+    }
+    m_parser.setSearchIndex(&searchIndex);
+
+    QStringList searchColumns;
+    searchColumns << "artist"
+                  << "title";
+
+    // Plain terms are looked up in the index
+    auto pQuery(
+        m_parser.parseQuery("Beyonce", searchColumns, ""));
+    EXPECT_STREQ(
+        qPrintable(QString("id IN (SELECT docid FROM library_fts WHERE library_fts "
+                           "MATCH 'artist:\"beyonce*\" OR title:\"beyonce*\"')")),
+        qPrintable(pQuery->toSql()));
+    TrackPointer pTrack(Track::newTemporary());
+    pTrack->setArtist("Jay-Z feat. Beyoncé Knowles");
+    EXPECT_TRUE(pQuery->match(pTrack));
+    // Only prefixes of words match.
+    pTrack->setArtist("NotBeyonce");
+    EXPECT_FALSE(pQuery->match(pTrack));
+
+    // Negated terms are looked up in the index, too
+    pQuery = m_parser.parseQuery("-beyonce", searchColumns, "");
+    EXPECT_STREQ(
+        qPrintable(QString("NOT (id IN (SELECT docid FROM library_fts WHERE library_fts "
+                           "MATCH 'artist:\"beyonce*\" OR title:\"beyonce*\"'))")),
+        qPrintable(pQuery->toSql()));
+
+    // Terms without letters or digits can't be looked up in the index.
+    pQuery = m_parser.parseQuery("&", searchColumns, "");
+    EXPECT_STREQ(
+        qPrintable(QString("(artist LIKE '%&%') OR (title LIKE '%&%')")),
+        qPrintable(pQuery->toSql()));
+
+    // Columns that are not indexed fall back to LIKE.
+    searchColumns << "bpm";
+    pQuery = m_parser.parseQuery("asdf", searchColumns, "");
+    EXPECT_STREQ(
+        qPrintable(QString("(artist LIKE '%asdf%') OR (title LIKE '%asdf%') OR (bpm LIKE '%asdf%')")),
+        qPrintable(pQuery->toSql()));
+}
+
+TEST_F(SearchQueryParserTest, FullTextSearchIndexUpdated) {
+    const SearchIndexDAO& searchIndex = collection()->getSearchIndexDAO();
+    if (!searchIndex.isAvailable()) {
+        qWarning() << "Skipping test: full-text search is not supported by SQLite";
+        return;
+    }
+    m_parser.setSearchIndex(&searchIndex);
+
+    const QString trackLocation(QDir::currentPath() %
+                  "/src/test/id3-test-data/cover-test-jpg.mp3");
+    TrackId trackId(addTrackToCollection(trackLocation));
+    ASSERT_TRUE(trackId.isValid());
+
+    auto pQuery(m_parser.parseQuery("cover-te",
+            SearchIndexDAO::indexedColumns(), ""));
+    QSqlQuery query(dbConnection());
+    ASSERT_TRUE(query.exec(QString("SELECT id FROM library WHERE %1")
+            .arg(pQuery->toSql())));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(trackId, TrackId(query.value(0)));
+
+    // Purging the track removes it from the index.
+    ASSERT_TRUE(collection()->purgeTracks(QList<TrackId>() << trackId));
+    query.prepare("SELECT docid FROM library_fts WHERE docid=:id");
+    query.bindValue(":id", trackId.toVariant());
+    ASSERT_TRUE(query.exec());
+    EXPECT_FALSE(query.next());
+}
+
+TEST_F(SearchQueryParserTest, MatchValues) {
+    QStringList searchColumns;
+    searchColumns << "artist"
+                  << "title";
+
+    auto pQuery(
+        m_parser.parseQuery("beyonce bpm:>120", searchColumns, ""));
+
+    QHash<QString, QVariant> values;
+    auto lookup = [&values](const QString& column) {
+        return values.value(column);
+    };
+    values.insert("artist", "Jay-Z feat. Beyoncé Knowles");
+    values.insert("bpm", 121.0);
+    // Diacritics are ignored like by the LIKE operator of the database.
+    EXPECT_TRUE(pQuery->matchValues(lookup));
+    values.insert("bpm", QVariant(QVariant::Double));
+    EXPECT_FALSE(pQuery->matchValues(lookup));
+}
+
+TEST_F(SearchQueryParserTest, Refinement) {
+    QString refinement;
+
+    // Appended terms
+    EXPECT_TRUE(SearchQueryParser::isRefinement("daft", "daft p", &refinement));
+    EXPECT_QSTRING_EQ(" p", refinement);
+    EXPECT_TRUE(SearchQueryParser::isRefinement("daft ", "daft -punk", &refinement));
+    EXPECT_QSTRING_EQ("-punk", refinement);
+    EXPECT_TRUE(SearchQueryParser::isRefinement(
+            "artist:\"daft punk\"", "artist:\"daft punk\" bpm:>120", &refinement));
+    EXPECT_QSTRING_EQ(" bpm:>120", refinement);
+
+    // Extended plain terms
+    EXPECT_TRUE(SearchQueryParser::isRefinement("daft p", "daft pu", &refinement));
+    EXPECT_QSTRING_EQ("pu", refinement);
+    EXPECT_TRUE(SearchQueryParser::isRefinement("hip", "hip-h", &refinement));
+    EXPECT_QSTRING_EQ("hip-h", refinement);
+    EXPECT_TRUE(SearchQueryParser::isRefinement("&", "&&", &refinement));
+    EXPECT_QSTRING_EQ("&&", refinement);
+
+    // Broadening or unrelated changes
+    EXPECT_FALSE(SearchQueryParser::isRefinement("daft pu", "daft p", &refinement));
+    EXPECT_FALSE(SearchQueryParser::isRefinement("daft", "draft", &refinement));
+    EXPECT_FALSE(SearchQueryParser::isRefinement("", "daft", &refinement));
+    // Terms with a meaning other than a substring match
+    EXPECT_FALSE(SearchQueryParser::isRefinement("-daft", "-dafty", &refinement));
+    EXPECT_FALSE(SearchQueryParser::isRefinement("bpm:12", "bpm:120", &refinement));
+    EXPECT_FALSE(SearchQueryParser::isRefinement("daft", "daft:", &refinement));
+    // Switches from a substring to a full-text match
+    EXPECT_FALSE(SearchQueryParser::isRefinement("&", "&d", &refinement));
+    // Filters that take the next term as argument or open quotes
+    EXPECT_FALSE(SearchQueryParser::isRefinement("artist:", "artist: daft", &refinement));
+    EXPECT_FALSE(SearchQueryParser::isRefinement(
+            "artist:\"daft", "artist:\"daft punk", &refinement));
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <QSemaphore>
+#include <QVector>
+
+#include <chrono>
+#include <thread>
+
+#include "engine/sidechain/enginesidechain.h"
+#include "engine/sidechain/sidechainworker.h"
+#include "engine/sidechain/sidechainworkerthread.h"
+
+namespace {
+
+const int kQueueSize = 1024;
+
+// Blocks in the first call of process() until it is released
+class BlockingWorker : public SideChainWorker {
+  public:
+    void process(const CSAMPLE* pBuffer, const int iBufferSize) override {
+        Q_UNUSED(pBuffer);
+        Q_UNUSED(iBufferSize);
+        m_entered.release();
+        m_released.acquire();
+        m_released.release();
+    }
+
+    void shutdown() override {
+    }
+
+    void waitUntilEntered() {
+        m_entered.acquire();
+    }
+
+    void release() {
+        m_released.release();
+    }
+
+  private:
+    QSemaphore m_entered;
+    QSemaphore m_released;
+};
+
+TEST(SideChainWorkerThreadTest, DropSamplesIfQueueIsFull) {
+    BlockingWorker worker;
+    SideChainWorkerThread workerThread(&worker, kQueueSize, 1);
+    const QVector<CSAMPLE> samples(kQueueSize, CSAMPLE_ZERO);
+
+    EXPECT_EQ(0, workerThread.writeSamples(samples.constData(), kQueueSize));
+    workerThread.wake();
+    // The worker has taken all queued samples and is stuck
+    worker.waitUntilEntered();
+    EXPECT_EQ(0, workerThread.droppedSamples());
+
+    // Fill the queue while the worker is blocked
+    EXPECT_EQ(0, workerThread.writeSamples(samples.constData(), kQueueSize));
+    EXPECT_EQ(0, workerThread.droppedSamples());
+    EXPECT_EQ(kQueueSize / 2,
+            workerThread.writeSamples(samples.constData(), kQueueSize / 2));
+    EXPECT_EQ(kQueueSize / 2, workerThread.droppedSamples());
+    EXPECT_EQ(kQueueSize,
+            workerThread.writeSamples(samples.constData(), kQueueSize));
+    EXPECT_EQ(kQueueSize + kQueueSize / 2, workerThread.droppedSamples());
+
+    worker.release();
+    workerThread.stop();
+    // Samples are only dropped while the queue is full
+    EXPECT_EQ(kQueueSize + kQueueSize / 2, workerThread.droppedSamples());
+}
+
+TEST(SideChainWorkerThreadTest, DroppedSamplesOfSlowWorkerWhileRunning) {
+    EngineSideChain sideChain((UserSettingsPointer()));
+    // Owned by sideChain
+    BlockingWorker* pWorker = new BlockingWorker();
+    BlockingWorker unknownWorker;
+    EXPECT_EQ(-1, sideChain.droppedSamples(pWorker));
+    sideChain.addSideChainWorker(pWorker);
+    EXPECT_EQ(0, sideChain.droppedSamples(pWorker));
+    EXPECT_EQ(-1, sideChain.droppedSamples(&unknownWorker));
+
+    // Feed the engine until the queue of the stuck worker overflows
+    const int kChunkSize = 4096;
+    const QVector<CSAMPLE> samples(kChunkSize, CSAMPLE_ZERO);
+    int droppedSamples = 0;
+    for (int i = 0; i < 10000 && droppedSamples == 0; ++i) {
+        sideChain.writeSamples(samples.constData(), kChunkSize);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        droppedSamples = sideChain.droppedSamples(pWorker);
+    }
+    EXPECT_LT(0, droppedSamples);
+
+    // The count keeps rising while the worker is stuck
+    int moreDroppedSamples = droppedSamples;
+    for (int i = 0; i < 10000 && moreDroppedSamples == droppedSamples; ++i) {
+        sideChain.writeSamples(samples.constData(), kChunkSize);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        moreDroppedSamples = sideChain.droppedSamples(pWorker);
+    }
+    EXPECT_LT(droppedSamples, moreDroppedSamples);
+
+    pWorker->release();
+}
+
+}  // anonymous namespace
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include <QFile>
+#include <QFuture>
+#include <QTemporaryDir>
+#include <QtDebug>
+
+#include "skin/skintemplatecache.h"
+#include "test/mixxxtest.h"
+
+namespace {
+
+class SkinTemplateCacheTest : public MixxxTest {
+  protected:
+    void writeFile(const QString& path, const QByteArray& content) {
+        QFile file(path);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(content);
+        file.close();
+    }
+
+    QTemporaryDir m_skinDir;
+};
+
+TEST_F(SkinTemplateCacheTest, PreloadAndLookup) {
+    ASSERT_TRUE(m_skinDir.isValid());
+    const QString path = m_skinDir.path() + "/button.xml";
+    writeFile(path, "<Template><PushButton/></Template>");
+    writeFile(m_skinDir.path() + "/knob.xml", "<Template><Knob/></Template>");
+
+    QFuture<void> preloaded = SkinTemplateCache::preload(m_skinDir.path());
+    preloaded.waitForFinished();
+
+    QDomElement element = SkinTemplateCache::documentElement(path);
+    ASSERT_FALSE(element.isNull());
+    EXPECT_QSTRING_EQ("Template", element.tagName());
+    EXPECT_QSTRING_EQ("PushButton", element.firstChildElement().tagName());
+}
+
+TEST_F(SkinTemplateCacheTest, ReparseChangedFile) {
+    ASSERT_TRUE(m_skinDir.isValid());
+    const QString path = m_skinDir.path() + "/changed.xml";
+    writeFile(path, "<Template><PushButton/></Template>");
+    EXPECT_QSTRING_EQ("PushButton",
+            SkinTemplateCache::documentElement(path).firstChildElement().tagName());
+
+    writeFile(path, "<Template><Knob/></Template>");
+    EXPECT_QSTRING_EQ("Knob",
+            SkinTemplateCache::documentElement(path).firstChildElement().tagName());
+}
+
+TEST_F(SkinTemplateCacheTest, InvalidFile) {
+    ASSERT_TRUE(m_skinDir.isValid());
+    const QString path = m_skinDir.path() + "/broken.xml";
+    writeFile(path, "<Template><PushButton></Template>");
+    EXPECT_TRUE(SkinTemplateCache::documentElement(path).isNull());
+    EXPECT_TRUE(SkinTemplateCache::documentElement(
+            m_skinDir.path() + "/missing.xml").isNull());
+}
+
+}  // namespace
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <QSqlQuery>
+#include <QStringList>
+
+#include "test/librarytest.h"
+
+#include "util/db/fwdsqlquery.h"
+#include "util/db/sqlquerycache.h"
+
+
+namespace {
+
+const QString kInsertCrate = "INSERT INTO crates (name) VALUES (:name)";
+
+class SqlQueryCacheTest : public LibraryTest {
+  protected:
+    SqlQueryCacheTest() {
+        m_queryCache.setDatabase(dbConnection());
+    }
+    ~SqlQueryCacheTest() override {
+        m_queryCache.setDatabase(QSqlDatabase());
+    }
+
+    bool insertCrate(const QString& name) {
+        QSqlQuery query(m_queryCache.prepare(kInsertCrate));
+        query.bindValue(":name", name);
+        return m_queryCache.exec(&query);
+    }
+
+    SqlQueryCache m_queryCache;
+};
+
+TEST_F(SqlQueryCacheTest, ReuseStatements) {
+    EXPECT_TRUE(insertCrate("a"));
+    EXPECT_TRUE(insertCrate("b"));
+    EXPECT_TRUE(insertCrate("c"));
+
+    EXPECT_EQ(1, m_queryCache.statistics().preparedQueries);
+    EXPECT_EQ(2, m_queryCache.statistics().reusedQueries);
+    EXPECT_EQ(3, m_queryCache.statistics().executedQueries);
+
+    // All rows have been inserted with the values bound to
+    // the shared query
+    QSqlQuery query(dbConnection());
+    ASSERT_TRUE(query.exec("SELECT name FROM crates ORDER BY name"));
+    QStringList names;
+    while (query.next()) {
+        names.append(query.value(0).toString());
+    }
+    EXPECT_EQ(QStringList() << "a" << "b" << "c", names);
+}
+
+TEST_F(SqlQueryCacheTest, PrepareAgainAfterFailure) {
+    EXPECT_TRUE(insertCrate("a"));
+    // Violates the unique constraint
+    EXPECT_FALSE(insertCrate("a"));
+    // The failed query is not reused, so that its error is not
+    // reported again
+    EXPECT_TRUE(insertCrate("b"));
+
+    EXPECT_EQ(2, m_queryCache.statistics().preparedQueries);
+    EXPECT_EQ(1, m_queryCache.statistics().reusedQueries);
+}
+
+TEST_F(SqlQueryCacheTest, FinishUnfinishedQuery) {
+    EXPECT_TRUE(insertCrate("a"));
+    EXPECT_TRUE(insertCrate("b"));
+
+    const QString statement = "SELECT name FROM crates ORDER BY name";
+    QSqlQuery query(m_queryCache.prepare(statement));
+    ASSERT_TRUE(m_queryCache.exec(&query));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ("a", query.value(0).toString());
+
+    // The previous execution that has not been iterated until the
+    // end is finished and the query starts from the beginning
+    query = m_queryCache.prepare(statement);
+    ASSERT_TRUE(m_queryCache.exec(&query));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ("a", query.value(0).toString());
+    EXPECT_EQ(2, m_queryCache.statistics().preparedQueries);
+    EXPECT_EQ(2, m_queryCache.statistics().reusedQueries);
+}
+
+TEST_F(SqlQueryCacheTest, FwdSqlQuery) {
+    for (int i = 0; i < 2; ++i) {
+        FwdSqlQuery query(&m_queryCache, kInsertCrate);
+        ASSERT_TRUE(query.isPrepared());
+        query.bindValue(":name", QString::number(i));
+        EXPECT_TRUE(query.execPrepared());
+        EXPECT_EQ(1, query.numRowsAffected());
+    }
+    EXPECT_EQ(1, m_queryCache.statistics().preparedQueries);
+    EXPECT_EQ(2, m_queryCache.statistics().executedQueries);
+}
+
+TEST_F(SqlQueryCacheTest, SetDatabase) {
+    EXPECT_TRUE(insertCrate("a"));
+    // Discards the cached queries
+    m_queryCache.setDatabase(dbConnection());
+    EXPECT_TRUE(insertCrate("b"));
+    EXPECT_EQ(2, m_queryCache.statistics().preparedQueries);
+    EXPECT_EQ(0, m_queryCache.statistics().reusedQueries);
+}
+
+} // anonymous namespace
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QSignalSpy>
+#include <QSqlQuery>
+#include <QTest>
+#include <QtDebug>
+
+#include "library/sqlselectthread.h"
+#include "test/librarytest.h"
+
+namespace {
+
+class SqlSelectThreadTest : public LibraryTest {
+  protected:
+    SqlSelectThreadTest()
+            : m_selectThread(dbConnectionPool()) {
+        m_selectThread.start();
+    }
+
+    ~SqlSelectThreadTest() override {
+        m_selectThread.stop();
+    }
+
+    TrackId addTrackToCollection(const QString& trackLocation) {
+        TrackPointer pTrack(collection()->getTrackDAO().addSingleTrack(trackLocation, false));
+        return pTrack ? pTrack->getId() : TrackId();
+    }
+
+    SqlSelectThread m_selectThread;
+};
+
+TEST_F(SqlSelectThreadTest, SelectFromTemporaryView) {
+    const TrackId trackId(addTrackToCollection(QDir::currentPath() +
+            "/src/test/id3-test-data/cover-test-jpg.mp3"));
+    ASSERT_TRUE(trackId.isValid());
+
+    // Temporary views only exist on the connection that created them
+    QSqlQuery query(dbConnection());
+    ASSERT_TRUE(query.exec(
+            "CREATE TEMPORARY VIEW IF NOT EXISTS select_test_view AS "
+            "SELECT id, title FROM library"));
+
+    QSignalSpy spy(&m_selectThread,
+            SIGNAL(selectFinished(int, SqlSelectThread::ResultPointer)));
+    const int requestId = m_selectThread.submit(
+            this, dbConnection(), "SELECT id, title FROM select_test_view");
+    for (int i = 0; i < 100 && spy.count() == 0; ++i) {
+        QTest::qWait(50);
+    }
+    ASSERT_EQ(1, spy.count());
+    EXPECT_EQ(requestId, spy.at(0).at(0).toInt());
+
+    auto pResult = spy.at(0).at(1).value<SqlSelectThread::ResultPointer>();
+    ASSERT_TRUE(pResult);
+    EXPECT_TRUE(pResult->ok);
+    ASSERT_EQ(1, pResult->rows.size());
+    EXPECT_EQ(trackId, TrackId(pResult->rows[0].value(0)));
+}
+
+TEST_F(SqlSelectThreadTest, SelectFilteredTrackIds) {
+    const TrackId firstTrackId(addTrackToCollection(QDir::currentPath() +
+            "/src/test/id3-test-data/cover-test-jpg.mp3"));
+    const TrackId secondTrackId(addTrackToCollection(QDir::currentPath() +
+            "/src/test/id3-test-data/cover-test-png.mp3"));
+    ASSERT_TRUE(firstTrackId.isValid());
+    ASSERT_TRUE(secondTrackId.isValid());
+
+    QSignalSpy spy(&m_selectThread,
+            SIGNAL(selectFinished(int, SqlSelectThread::ResultPointer)));
+    const int requestId = m_selectThread.submit(
+            this, dbConnection(), "SELECT id FROM library",
+            QString("SELECT id FROM library WHERE id IN (SELECT id FROM library) "
+                    "AND id=%1").arg(secondTrackId.toString()));
+    for (int i = 0; i < 100 && spy.count() == 0; ++i) {
+        QTest::qWait(50);
+    }
+    ASSERT_EQ(1, spy.count());
+    EXPECT_EQ(requestId, spy.at(0).at(0).toInt());
+
+    auto pResult = spy.at(0).at(1).value<SqlSelectThread::ResultPointer>();
+    ASSERT_TRUE(pResult);
+    EXPECT_TRUE(pResult->ok);
+    EXPECT_EQ(2, pResult->rows.size());
+    ASSERT_TRUE(pResult->filtered);
+    ASSERT_EQ(1, pResult->filteredTrackIds.size());
+    EXPECT_EQ(secondTrackId, pResult->filteredTrackIds[0]);
+}
+
+TEST_F(SqlSelectThreadTest, SupersededRequestIsDiscarded) {
+    QSignalSpy spy(&m_selectThread,
+            SIGNAL(selectFinished(int, SqlSelectThread::ResultPointer)));
+    // Queue many queries of the same client. At least the last one finishes
+    // and none of the superseded queries is reported after it.
+    int requestId = -1;
+    for (int i = 0; i < 10; ++i) {
+        requestId = m_selectThread.submit(this, dbConnection(),
+                "SELECT id FROM library");
+    }
+    for (int i = 0; i < 100; ++i) {
+        if (spy.count() > 0 && spy.last().at(0).toInt() == requestId) {
+            break;
+        }
+        QTest::qWait(50);
+    }
+    ASSERT_GT(spy.count(), 0);
+    EXPECT_EQ(requestId, spy.last().at(0).toInt());
+    EXPECT_LT(spy.count(), 10);
+}
+
+}  // namespace
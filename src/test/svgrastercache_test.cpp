@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include <QColor>
+#include <QDir>
+#include <QFile>
+#include <QFuture>
+#include <QImage>
+#include <QStringList>
+#include <QTemporaryDir>
+
+#include "test/mixxxtest.h"
+#include "widget/svgrastercache.h"
+
+namespace {
+
+const QByteArray kSvgData =
+        "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"20\" height=\"10\">"
+        "<rect width=\"20\" height=\"10\" fill=\"#0000ff\"/>"
+        "</svg>";
+
+class SvgRasterCacheTest : public MixxxTest {
+  protected:
+    SvgRasterCacheTest() {
+        SvgRasterCache::clear();
+        SvgRasterCache::setCacheDirectory(m_cacheDir.path());
+    }
+
+    ~SvgRasterCacheTest() override {
+        SvgRasterCache::cancelPrefetch();
+        SvgRasterCache::clear();
+    }
+
+    void writeFile(const QString& path, const QByteArray& content) {
+        QFile file(path);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(content);
+        file.close();
+    }
+
+    QStringList cachedFiles() const {
+        return QDir(m_cacheDir.path()).entryList(QDir::Files);
+    }
+
+    QTemporaryDir m_skinDir;
+    QTemporaryDir m_cacheDir;
+};
+
+TEST_F(SvgRasterCacheTest, RasterizeAtScaleFactor) {
+    ASSERT_TRUE(m_skinDir.isValid());
+    const QString path = m_skinDir.path() + "/rect.svg";
+    writeFile(path, kSvgData);
+
+    QImage image = SvgRasterCache::rasterize(PixmapSource(path), 2.0);
+    ASSERT_FALSE(image.isNull());
+    EXPECT_EQ(QSize(40, 20), image.size());
+    EXPECT_EQ(QColor(Qt::blue).rgb(), image.pixel(20, 10));
+
+    // The image has been persisted without leaving a temporary file behind
+    const QStringList files = cachedFiles();
+    ASSERT_EQ(1, files.size());
+    EXPECT_TRUE(files.first().endsWith(".png"));
+
+    // Other scale factors are cached separately
+    EXPECT_EQ(QSize(20, 10),
+            SvgRasterCache::rasterize(PixmapSource(path), 1.0).size());
+    EXPECT_EQ(2, cachedFiles().size());
+}
+
+TEST_F(SvgRasterCacheTest, LoadFromDisk) {
+    ASSERT_TRUE(m_skinDir.isValid());
+    const QString path = m_skinDir.path() + "/rect.svg";
+    writeFile(path, kSvgData);
+    ASSERT_FALSE(SvgRasterCache::rasterize(PixmapSource(path), 1.0).isNull());
+    const QStringList files = cachedFiles();
+    ASSERT_EQ(1, files.size());
+
+    // Replace the persisted image to tell it apart from a rendered one
+    QImage marker(3, 3, QImage::Format_ARGB32);
+    marker.fill(QColor(Qt::red).rgba());
+    ASSERT_TRUE(marker.save(QDir(m_cacheDir.path()).filePath(files.first()), "PNG"));
+
+    // Still served from memory
+    EXPECT_EQ(QSize(20, 10),
+            SvgRasterCache::rasterize(PixmapSource(path), 1.0).size());
+
+    SvgRasterCache::clear();
+    QImage image = SvgRasterCache::rasterize(PixmapSource(path), 1.0);
+    EXPECT_EQ(QSize(3, 3), image.size());
+    EXPECT_EQ(QColor(Qt::red).rgb(), image.pixel(1, 1));
+}
+
+TEST_F(SvgRasterCacheTest, InvalidSvg) {
+    ASSERT_TRUE(m_skinDir.isValid());
+    const QString path = m_skinDir.path() + "/broken.svg";
+    writeFile(path, "<svg");
+    EXPECT_TRUE(SvgRasterCache::rasterize(PixmapSource(path), 1.0).isNull());
+    EXPECT_TRUE(SvgRasterCache::rasterize(
+            PixmapSource(m_skinDir.path() + "/missing.svg"), 1.0).isNull());
+    EXPECT_TRUE(cachedFiles().isEmpty());
+}
+
+TEST_F(SvgRasterCacheTest, Prefetch) {
+    ASSERT_TRUE(m_skinDir.isValid());
+    ASSERT_TRUE(QDir(m_skinDir.path()).mkdir("sub"));
+    writeFile(m_skinDir.path() + "/rect.svg", kSvgData);
+    // Identical content is rasterized only once, even if both files are
+    // processed concurrently
+    writeFile(m_skinDir.path() + "/sub/copy.svg", kSvgData);
+    writeFile(m_skinDir.path() + "/sub/small.svg", QByteArray(kSvgData)
+            .replace("width=\"20\" height=\"10\">", "width=\"4\" height=\"2\">"));
+
+    QFuture<void> prefetched = SvgRasterCache::prefetch(m_skinDir.path(), 1.0);
+    prefetched.waitForFinished();
+    EXPECT_FALSE(prefetched.isCanceled());
+
+    const QStringList files = cachedFiles();
+    EXPECT_EQ(2, files.size());
+    for (const auto& file : files) {
+        EXPECT_TRUE(file.endsWith(".png"));
+    }
+}
+
+TEST_F(SvgRasterCacheTest, CancelPrefetch) {
+    ASSERT_TRUE(m_skinDir.isValid());
+    for (int i = 0; i < 20; ++i) {
+        writeFile(m_skinDir.path() + QString("/rect%1.svg").arg(i), kSvgData);
+    }
+    QFuture<void> first = SvgRasterCache::prefetch(m_skinDir.path(), 1.0);
+    // Starting another prefetch cancels and waits for the first one
+    QFuture<void> second = SvgRasterCache::prefetch(m_skinDir.path(), 2.0);
+    EXPECT_TRUE(first.isFinished());
+
+    SvgRasterCache::cancelPrefetch();
+    EXPECT_TRUE(second.isFinished());
+    // No partially written files are left behind
+    for (const auto& file : cachedFiles()) {
+        EXPECT_TRUE(file.endsWith(".png"));
+    }
+}
+
+}  // namespace
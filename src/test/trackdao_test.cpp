@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSqlQuery>
+
+#include "test/librarytest.h"
+
+#include "mixer/playerinfo.h"
+#include "sources/soundsourceproxy.h"
+#include "track/track.h"
+
+namespace {
+
+const QDir kTestDir(QDir::current().absoluteFilePath("src/test/id3-test-data"));
+
+const QString kGroup = "[Channel1]";
+
+class TrackDAOTest : public LibraryTest {
+  protected:
+    ~TrackDAOTest() override {
+        PlayerInfo::instance().setTrackInfo(kGroup, TrackPointer());
+    }
+
+    TrackDAO& trackDao() {
+        return collection()->getTrackDAO();
+    }
+
+    // The tags might be modified, so every test needs its own copy
+    TrackPointer addTrack(const QString& fileName) {
+        const QString location = getTestDataDir().filePath(fileName);
+        EXPECT_TRUE(QFile::copy(kTestDir.absoluteFilePath(fileName), location));
+        return trackDao().getOrAddTrack(location, false, nullptr);
+    }
+
+    QString titleInDatabase(TrackId trackId) {
+        QSqlQuery query(dbConnection());
+        query.prepare("SELECT title FROM library WHERE id=:id");
+        query.bindValue(":id", trackId.toVariant());
+        if (!query.exec() || !query.next()) {
+            return QString();
+        }
+        return query.value(0).toString();
+    }
+
+    QString titleInFile(const TrackPointer& pTrack) {
+        auto pReloadedTrack = Track::newTemporary(pTrack->getLocation());
+        SoundSourceProxy(pReloadedTrack).updateTrack();
+        return pReloadedTrack->getTitle();
+    }
+
+    // Processes events until the pending saves have been executed
+    bool waitUntilClean(const TrackPointer& pTrack) {
+        QElapsedTimer timer;
+        timer.start();
+        while (pTrack->isDirty() && timer.elapsed() < 5000) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            application()->processEvents();
+        }
+        return !pTrack->isDirty();
+    }
+};
+
+TEST_F(TrackDAOTest, SaveDirtyTracksInBatches) {
+    TrackPointer pFirstTrack = addTrack("TOAL_TPE2.mp3");
+    TrackPointer pSecondTrack = addTrack("artist.mp3");
+    ASSERT_TRUE(pFirstTrack);
+    ASSERT_TRUE(pSecondTrack);
+
+    pFirstTrack->setTitle("First title");
+    trackDao().saveTrack(pFirstTrack);
+    pSecondTrack->setTitle("Other title");
+    trackDao().saveTrack(pSecondTrack);
+    pFirstTrack->setTitle("Second title");
+    trackDao().saveTrack(pFirstTrack);
+
+    // Nothing is saved before the delay has elapsed
+    EXPECT_TRUE(pFirstTrack->isDirty());
+    EXPECT_TRUE(pSecondTrack->isDirty());
+    EXPECT_NE("First title", titleInDatabase(pFirstTrack->getId()));
+    EXPECT_NE("Second title", titleInDatabase(pFirstTrack->getId()));
+
+    // Both tracks are saved together with their latest modifications
+    ASSERT_TRUE(waitUntilClean(pFirstTrack));
+    EXPECT_FALSE(pSecondTrack->isDirty());
+    EXPECT_EQ("Second title", titleInDatabase(pFirstTrack->getId()));
+    EXPECT_EQ("Other title", titleInDatabase(pSecondTrack->getId()));
+}
+
+TEST_F(TrackDAOTest, PostponeTagsOfLoadedTrack) {
+    config()->set(ConfigKey("[Library]", "WriteAudioTags"), QString("1"));
+    TrackPointer pTrack = addTrack("TOAL_TPE2.mp3");
+    ASSERT_TRUE(pTrack);
+    const QString originalTitle = titleInFile(pTrack);
+
+    PlayerInfo::instance().setTrackInfo(kGroup, pTrack);
+    pTrack->setTitle("Loaded title");
+    trackDao().saveTrack(pTrack);
+    ASSERT_TRUE(waitUntilClean(pTrack));
+    EXPECT_EQ("Loaded title", titleInDatabase(pTrack->getId()));
+
+    // The file is not touched while the track is loaded
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(originalTitle, titleInFile(pTrack));
+
+    // Unloading the track writes the tags in the background
+    PlayerInfo::instance().setTrackInfo(kGroup, TrackPointer());
+    QElapsedTimer timer;
+    timer.start();
+    while (titleInFile(pTrack) != "Loaded title" && timer.elapsed() < 5000) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ("Loaded title", titleInFile(pTrack));
+}
+
+}  // anonymous namespace
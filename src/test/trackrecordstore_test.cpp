@@ -0,0 +1,185 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+
+#include "library/trackrecordstore.h"
+
+namespace {
+
+class TrackRecordStoreTest : public testing::Test {
+  protected:
+    TrackRecordStoreTest()
+            : m_store(3) {
+    }
+
+    static QVector<QVariant> makeRecord(QVariant value0, QVariant value1,
+                                        QVariant value2) {
+        QVector<QVariant> record;
+        record << value0 << value1 << value2;
+        return record;
+    }
+
+    TrackRecordStore m_store;
+};
+
+TEST_F(TrackRecordStoreTest, ValueTypes) {
+    const QVector<QVariant> record1 = makeRecord(
+            QVariant(42), QVariant(Q_INT64_C(1234567890123)), QVariant(128.5));
+    const QVector<QVariant> record2 = makeRecord(
+            QVariant(true), QVariant(QString("Artist")), QVariant(QByteArray("blob")));
+    // Invalid and null values with and without a type
+    const QVector<QVariant> record3 = makeRecord(
+            QVariant(), QVariant(QVariant::String), QVariant(QVariant::LongLong));
+    m_store.setRecord(TrackId(1), record1);
+    m_store.setRecord(TrackId(2), record2);
+    m_store.setRecord(TrackId(3), record3);
+
+    EXPECT_EQ(3, m_store.rowCount());
+    for (int column = 0; column < 3; ++column) {
+        EXPECT_EQ(record1[column], m_store.value(TrackId(1), column));
+        EXPECT_EQ(record1[column].type(), m_store.value(TrackId(1), column).type());
+        EXPECT_EQ(record2[column], m_store.value(TrackId(2), column));
+        EXPECT_EQ(record2[column].type(), m_store.value(TrackId(2), column).type());
+        const QVariant value3 = m_store.value(TrackId(3), column);
+        EXPECT_EQ(record3[column].isValid(), value3.isValid());
+        EXPECT_EQ(record3[column].type(), value3.type());
+        EXPECT_TRUE(value3.isNull());
+    }
+    EXPECT_EQ(record2, m_store.record(TrackId(2)));
+
+    // Unknown tracks and columns
+    EXPECT_TRUE(m_store.record(TrackId(4)).isEmpty());
+    EXPECT_FALSE(m_store.value(TrackId(4), 0).isValid());
+    EXPECT_EQ(QVariant(7), m_store.value(TrackId(1), 3, QVariant(7)));
+}
+
+TEST_F(TrackRecordStoreTest, MissingValues) {
+    QVector<QVariant> record;
+    record << QVariant(1);
+    m_store.setRecord(TrackId(1), record);
+    EXPECT_EQ(QVariant(1), m_store.value(TrackId(1), 0));
+    EXPECT_FALSE(m_store.value(TrackId(1), 1).isValid());
+    EXPECT_FALSE(m_store.value(TrackId(1), 2).isValid());
+}
+
+TEST_F(TrackRecordStoreTest, InternStrings) {
+    m_store.setRecord(TrackId(1), makeRecord("Artist", "Album", "Title 1"));
+    m_store.setRecord(TrackId(2), makeRecord("Artist", "Album", "Title 2"));
+    // The same string in different columns
+    m_store.setRecord(TrackId(3), makeRecord("Album", "Album", "Title 3"));
+    EXPECT_EQ(5, m_store.stringCount());
+
+    // Strings that are no longer referenced are released
+    m_store.setRecord(TrackId(3), makeRecord("Artist", "Album", "Title 1"));
+    EXPECT_EQ(4, m_store.stringCount());
+    m_store.removeRecord(TrackId(1));
+    EXPECT_EQ(4, m_store.stringCount());
+    m_store.removeRecord(TrackId(3));
+    EXPECT_EQ(3, m_store.stringCount());
+    EXPECT_EQ(QVariant("Title 2"), m_store.value(TrackId(2), 2));
+
+    // Released codes are reused
+    m_store.setRecord(TrackId(4), makeRecord("Other", "Album", "Title 4"));
+    EXPECT_EQ(5, m_store.stringCount());
+    EXPECT_EQ(QVariant("Other"), m_store.value(TrackId(4), 0));
+    EXPECT_EQ(QVariant("Title 4"), m_store.value(TrackId(4), 2));
+
+    m_store.clear();
+    EXPECT_EQ(0, m_store.rowCount());
+    EXPECT_EQ(0, m_store.stringCount());
+}
+
+TEST_F(TrackRecordStoreTest, RemoveRecord) {
+    m_store.setRecord(TrackId(1), makeRecord(1, "a", QByteArray("1")));
+    m_store.setRecord(TrackId(2), makeRecord(2, "b", QByteArray("2")));
+    m_store.setRecord(TrackId(3), makeRecord(3, "c", QByteArray("3")));
+
+    // The last row fills the gap
+    m_store.removeRecord(TrackId(1));
+    EXPECT_EQ(2, m_store.rowCount());
+    EXPECT_FALSE(m_store.contains(TrackId(1)));
+    EXPECT_EQ(makeRecord(3, "c", QByteArray("3")), m_store.record(TrackId(3)));
+    EXPECT_EQ(makeRecord(2, "b", QByteArray("2")), m_store.record(TrackId(2)));
+
+    m_store.removeRecord(TrackId(1));
+    EXPECT_EQ(2, m_store.rowCount());
+    m_store.removeRecord(TrackId(3));
+    m_store.removeRecord(TrackId(2));
+    EXPECT_EQ(0, m_store.rowCount());
+    EXPECT_EQ(0, m_store.stringCount());
+}
+
+const int kLibraryColumnCount = 12;
+
+// A row of the library table with the typical number of distinct values
+// per column
+QVector<QVariant> makeLibraryRecord(int i, int numTracks) {
+    const int numArtists = numTracks / 10 + 1;
+    const int artist = (i * 7919) % numArtists;
+    QVector<QVariant> record;
+    record.reserve(kLibraryColumnCount);
+    record << QVariant(qlonglong(i))
+           << QVariant(QString("Artist %1").arg(artist))
+           << QVariant(QString("Title %1").arg(i))
+           << QVariant(QString("Album %1 of artist %2").arg(i % 3).arg(artist))
+           << QVariant(QString("Genre %1").arg(i % 30))
+           << QVariant(QString::number(1970 + i % 50))
+           << QVariant(60.0 + (i * 104729) % 12000 / 100.0)
+           << QVariant(qlonglong(120 + i % 400))
+           << QVariant(QString(i % 4 ? "mp3" : "flac"))
+           << QVariant(QString("/home/user/Music/Artist %1/Track %2.mp3").arg(artist).arg(i))
+           << QVariant(QString())
+           << QVariant(qlonglong(i % 6));
+    return record;
+}
+
+// An estimate of the heap memory of the QHash of QVariant records that
+// was used by BaseTrackCache before
+qint64 variantRecordsMemoryUsage(const QHash<TrackId, QVector<QVariant>>& records) {
+    const qint64 kHashNodeSize = 2 * sizeof(void*) + sizeof(TrackId) + sizeof(void*);
+    const qint64 kArrayHeaderSize = 3 * sizeof(int) + sizeof(void*);
+    qint64 result = 0;
+    for (const auto& record: records) {
+        result += kHashNodeSize + kArrayHeaderSize + record.capacity() * sizeof(QVariant);
+        for (const auto& value: record) {
+            if (value.type() == QVariant::String && !value.isNull()) {
+                result += kArrayHeaderSize + (value.toString().capacity() + 1) * sizeof(QChar);
+            }
+        }
+    }
+    return result;
+}
+
+// Stores the rows of a large library. Reports the estimated memory of both
+// representations. Run with --benchmark.
+static void BM_StoreLibraryRecords(benchmark::State& state) {
+    const int numTracks = state.range_x();
+    QVector<QVector<QVariant>> records;
+    records.reserve(numTracks);
+    for (int i = 0; i < numTracks; ++i) {
+        records.append(makeLibraryRecord(i, numTracks));
+    }
+
+    qint64 memoryUsage = 0;
+    while (state.KeepRunning()) {
+        TrackRecordStore store(kLibraryColumnCount);
+        for (int i = 0; i < numTracks; ++i) {
+            store.setRecord(TrackId(i + 1), records[i]);
+        }
+        memoryUsage = store.memoryUsage();
+    }
+    state.SetItemsProcessed(state.iterations() * numTracks);
+
+    QHash<TrackId, QVector<QVariant>> variantRecords;
+    for (int i = 0; i < numTracks; ++i) {
+        variantRecords[TrackId(i + 1)] = makeLibraryRecord(i, numTracks);
+    }
+    const QString label = QString("%1 MiB (QVariant records: %2 MiB)")
+            .arg(memoryUsage / (1024.0 * 1024.0), 0, 'f', 1)
+            .arg(variantRecordsMemoryUsage(variantRecords) / (1024.0 * 1024.0), 0, 'f', 1);
+    state.SetLabel(label.toStdString());
+}
+BENCHMARK(BM_StoreLibraryRecords)->Arg(200000);
+
+}  // namespace
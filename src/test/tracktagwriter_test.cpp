@@ -0,0 +1,54 @@
+#include <QFile>
+
+#include "test/mixxxtest.h"
+
+#include "library/tracktagwriter.h"
+#include "sources/soundsourceproxy.h"
+#include "track/track.h"
+
+namespace {
+
+const QDir kTestDir(QDir::current().absoluteFilePath("src/test/id3-test-data"));
+
+class TrackTagWriterTest : public MixxxTest {
+  protected:
+    // The tags are modified, so every test needs its own copy of the file
+    QString copyTestFile(const QString& fileName) {
+        const QString location = getTestDataDir().filePath(fileName);
+        EXPECT_TRUE(QFile::copy(kTestDir.absoluteFilePath(fileName), location));
+        return location;
+    }
+};
+
+TEST_F(TrackTagWriterTest, CoalesceAndWrite) {
+    auto pTrack = Track::newTemporary(copyTestFile("TOAL_TPE2.mp3"));
+    SoundSourceProxy(pTrack).updateTrack();
+
+    TrackTagWriter tagWriter;
+    pTrack->setTitle("First title");
+    EXPECT_TRUE(tagWriter.enqueue(*pTrack));
+    pTrack->setTitle("Second title");
+    EXPECT_TRUE(tagWriter.enqueue(*pTrack));
+    // Both writes into the same file have been coalesced
+    EXPECT_EQ(1, tagWriter.backlog());
+
+    // Stopping the writer drains the backlog
+    tagWriter.start();
+    tagWriter.stop();
+    EXPECT_EQ(0, tagWriter.backlog());
+
+    auto pReloadedTrack = Track::newTemporary(pTrack->getLocation());
+    SoundSourceProxy(pReloadedTrack).updateTrack();
+    EXPECT_EQ("Second title", pReloadedTrack->getTitle());
+}
+
+TEST_F(TrackTagWriterTest, SkipUnparsedTrack) {
+    auto pTrack = Track::newTemporary(copyTestFile("TOAL_TPE2.mp3"));
+    pTrack->setTitle("Title");
+
+    TrackTagWriter tagWriter;
+    EXPECT_TRUE(tagWriter.enqueue(*pTrack));
+    EXPECT_EQ(0, tagWriter.backlog());
+}
+
+}  // anonymous namespace
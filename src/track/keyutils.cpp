@@ -546,6 +546,22 @@ QList<mixxx::track::io::key::ChromaticKey> KeyUtils::getCompatibleKeys(
     return compatible;
 }
 
+// static
+int KeyUtils::circleOfFifthsDistance(mixxx::track::io::key::ChromaticKey key1,
+                                     mixxx::track::io::key::ChromaticKey key2) {
+    if (!ChromaticKey_IsValid(key1) || key1 == mixxx::track::io::key::INVALID ||
+            !ChromaticKey_IsValid(key2) || key2 == mixxx::track::io::key::INVALID) {
+        return -1;
+    }
+    // The OpenKey number is the radial on the Circle of Fifths
+    int radialSteps = std::abs(keyToOpenKeyNumber(key1) - keyToOpenKeyNumber(key2));
+    radialSteps = math_min(radialSteps, 12 - radialSteps);
+    if (keyIsMajor(key1) != keyIsMajor(key2)) {
+        ++radialSteps;
+    }
+    return radialSteps;
+}
+
 int KeyUtils::keyToCircleOfFifthsOrder(mixxx::track::io::key::ChromaticKey key,
                                        KeyNotation notation) {
     if (!ChromaticKey_IsValid(key)) {
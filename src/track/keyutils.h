@@ -75,6 +75,13 @@ class KeyUtils {
     static QList<mixxx::track::io::key::ChromaticKey> getCompatibleKeys(
         mixxx::track::io::key::ChromaticKey key);
 
+    // Returns the number of steps on the Circle of Fifths between key1 and
+    // key2, counting a change between major and minor as one more step.
+    // Compatible keys are at most 1 step apart. Returns -1 if either key is
+    // invalid.
+    static int circleOfFifthsDistance(mixxx::track::io::key::ChromaticKey key1,
+                                      mixxx::track::io::key::ChromaticKey key2);
+
     static mixxx::track::io::key::ChromaticKey guessKeyFromText(const QString& text);
 
     static mixxx::track::io::key::ChromaticKey calculateGlobalKey(
@@ -0,0 +1,318 @@
+#include "util/compressedbitmap.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "util/assert.h"
+
+namespace {
+
+// Array chunks with more values are converted into bitsets, which need
+// the same 8 KiB of memory as an array of this size.
+const int kMaxArrayCardinality = 4096;
+
+const int kBitsPerWord = 64;
+const int kBitsetWords = (1 << 16) / kBitsPerWord;
+
+inline quint16 highBits(quint32 value) {
+    return static_cast<quint16>(value >> 16);
+}
+
+inline quint16 lowBits(quint32 value) {
+    return static_cast<quint16>(value & 0xFFFF);
+}
+
+inline quint64 bitMask(quint16 low) {
+    return quint64(1) << (low % kBitsPerWord);
+}
+
+// Qt 4 doesn't provide qPopulationCount()
+inline int countBits(quint64 word) {
+    word = word - ((word >> 1) & Q_UINT64_C(0x5555555555555555));
+    word = (word & Q_UINT64_C(0x3333333333333333)) +
+            ((word >> 2) & Q_UINT64_C(0x3333333333333333));
+    word = (word + (word >> 4)) & Q_UINT64_C(0x0F0F0F0F0F0F0F0F);
+    return static_cast<int>((word * Q_UINT64_C(0x0101010101010101)) >> 56);
+}
+
+} // anonymous namespace
+
+bool CompressedBitmap::Chunk::contains(quint16 low) const {
+    if (isBitset()) {
+        return (bits[low / kBitsPerWord] & bitMask(low)) != 0;
+    }
+    return std::binary_search(values.constBegin(), values.constEnd(), low);
+}
+
+bool CompressedBitmap::Chunk::add(quint16 low) {
+    if (isBitset()) {
+        quint64& word = bits[low / kBitsPerWord];
+        if (word & bitMask(low)) {
+            return false;
+        }
+        word |= bitMask(low);
+    } else {
+        auto it = std::lower_bound(values.begin(), values.end(), low);
+        if (it != values.end() && *it == low) {
+            return false;
+        }
+        values.insert(it, low);
+    }
+    ++cardinality;
+    normalize();
+    return true;
+}
+
+bool CompressedBitmap::Chunk::remove(quint16 low) {
+    if (isBitset()) {
+        quint64& word = bits[low / kBitsPerWord];
+        if (!(word & bitMask(low))) {
+            return false;
+        }
+        word &= ~bitMask(low);
+    } else {
+        auto it = std::lower_bound(values.begin(), values.end(), low);
+        if (it == values.end() || *it != low) {
+            return false;
+        }
+        values.erase(it);
+    }
+    --cardinality;
+    normalize();
+    return true;
+}
+
+void CompressedBitmap::Chunk::normalize() {
+    if (isBitset()) {
+        if (cardinality > kMaxArrayCardinality) {
+            return;
+        }
+        QVector<quint16> array;
+        array.reserve(cardinality);
+        for (int i = 0; i < kBitsetWords; ++i) {
+            quint64 word = bits[i];
+            while (word != 0) {
+                const int bit = countBits((word & (~word + 1)) - 1);
+                array.append(static_cast<quint16>(i * kBitsPerWord + bit));
+                word &= word - 1;
+            }
+        }
+        values = array;
+        bits.clear();
+    } else {
+        if (cardinality <= kMaxArrayCardinality) {
+            return;
+        }
+        bits.fill(0, kBitsetWords);
+        for (const auto low: values) {
+            bits[low / kBitsPerWord] |= bitMask(low);
+        }
+        values.clear();
+    }
+    DEBUG_ASSERT(values.isEmpty() || bits.isEmpty());
+}
+
+void CompressedBitmap::Chunk::unite(const Chunk& other) {
+    if (isBitset() || other.isBitset()) {
+        if (!isBitset()) {
+            Chunk copy(other);
+            copy.unite(*this);
+            *this = copy;
+            return;
+        }
+        if (other.isBitset()) {
+            cardinality = 0;
+            for (int i = 0; i < kBitsetWords; ++i) {
+                bits[i] |= other.bits[i];
+                cardinality += countBits(bits[i]);
+            }
+        } else {
+            for (const auto low: other.values) {
+                quint64& word = bits[low / kBitsPerWord];
+                if (!(word & bitMask(low))) {
+                    word |= bitMask(low);
+                    ++cardinality;
+                }
+            }
+        }
+        return;
+    }
+    QVector<quint16> merged;
+    merged.reserve(cardinality + other.cardinality);
+    std::set_union(values.constBegin(), values.constEnd(),
+            other.values.constBegin(), other.values.constEnd(),
+            std::back_inserter(merged));
+    values = merged;
+    cardinality = values.size();
+    normalize();
+}
+
+void CompressedBitmap::Chunk::intersect(const Chunk& other) {
+    if (isBitset() && other.isBitset()) {
+        cardinality = 0;
+        for (int i = 0; i < kBitsetWords; ++i) {
+            bits[i] &= other.bits[i];
+            cardinality += countBits(bits[i]);
+        }
+        normalize();
+        return;
+    }
+    if (isBitset()) {
+        Chunk copy(other);
+        copy.intersect(*this);
+        *this = copy;
+        return;
+    }
+    QVector<quint16> intersection;
+    intersection.reserve(std::min(cardinality, other.cardinality));
+    if (other.isBitset()) {
+        for (const auto low: values) {
+            if (other.contains(low)) {
+                intersection.append(low);
+            }
+        }
+    } else {
+        std::set_intersection(values.constBegin(), values.constEnd(),
+                other.values.constBegin(), other.values.constEnd(),
+                std::back_inserter(intersection));
+    }
+    values = intersection;
+    cardinality = values.size();
+}
+
+int CompressedBitmap::findChunk(quint16 key, bool* pFound) const {
+    int first = 0;
+    int last = m_chunks.size();
+    while (first < last) {
+        const int mid = first + (last - first) / 2;
+        if (m_chunks[mid].key < key) {
+            first = mid + 1;
+        } else {
+            last = mid;
+        }
+    }
+    *pFound = first < m_chunks.size() && m_chunks[first].key == key;
+    return first;
+}
+
+int CompressedBitmap::cardinality() const {
+    int result = 0;
+    for (const auto& chunk: m_chunks) {
+        result += chunk.cardinality;
+    }
+    return result;
+}
+
+bool CompressedBitmap::contains(quint32 value) const {
+    bool found = false;
+    const int index = findChunk(highBits(value), &found);
+    return found && m_chunks[index].contains(lowBits(value));
+}
+
+bool CompressedBitmap::add(quint32 value) {
+    bool found = false;
+    const int index = findChunk(highBits(value), &found);
+    if (!found) {
+        m_chunks.insert(index, Chunk(highBits(value)));
+    }
+    return m_chunks[index].add(lowBits(value));
+}
+
+bool CompressedBitmap::remove(quint32 value) {
+    bool found = false;
+    const int index = findChunk(highBits(value), &found);
+    if (!found || !m_chunks[index].remove(lowBits(value))) {
+        return false;
+    }
+    if (m_chunks[index].cardinality == 0) {
+        m_chunks.remove(index);
+    }
+    return true;
+}
+
+CompressedBitmap& CompressedBitmap::operator|=(const CompressedBitmap& other) {
+    if (isEmpty()) {
+        m_chunks = other.m_chunks;
+        return *this;
+    }
+    QVector<Chunk> chunks;
+    chunks.reserve(m_chunks.size() + other.m_chunks.size());
+    int i = 0;
+    int j = 0;
+    while (i < m_chunks.size() || j < other.m_chunks.size()) {
+        if (j >= other.m_chunks.size() ||
+                (i < m_chunks.size() && m_chunks[i].key < other.m_chunks[j].key)) {
+            chunks.append(m_chunks[i++]);
+        } else if (i >= m_chunks.size() ||
+                other.m_chunks[j].key < m_chunks[i].key) {
+            chunks.append(other.m_chunks[j++]);
+        } else {
+            chunks.append(m_chunks[i++]);
+            chunks.last().unite(other.m_chunks[j++]);
+        }
+    }
+    m_chunks = chunks;
+    return *this;
+}
+
+CompressedBitmap& CompressedBitmap::operator&=(const CompressedBitmap& other) {
+    QVector<Chunk> chunks;
+    int i = 0;
+    int j = 0;
+    while (i < m_chunks.size() && j < other.m_chunks.size()) {
+        if (m_chunks[i].key < other.m_chunks[j].key) {
+            ++i;
+        } else if (other.m_chunks[j].key < m_chunks[i].key) {
+            ++j;
+        } else {
+            Chunk chunk(m_chunks[i++]);
+            chunk.intersect(other.m_chunks[j++]);
+            if (chunk.cardinality > 0) {
+                chunks.append(chunk);
+            }
+        }
+    }
+    m_chunks = chunks;
+    return *this;
+}
+
+QVector<quint32> CompressedBitmap::toVector() const {
+    QVector<quint32> result;
+    result.reserve(cardinality());
+    for (const auto& chunk: m_chunks) {
+        const quint32 high = quint32(chunk.key) << 16;
+        if (chunk.isBitset()) {
+            for (int i = 0; i < kBitsetWords; ++i) {
+                quint64 word = chunk.bits[i];
+                while (word != 0) {
+                    const int bit = countBits((word & (~word + 1)) - 1);
+                    result.append(high | quint32(i * kBitsPerWord + bit));
+                    word &= word - 1;
+                }
+            }
+        } else {
+            for (const auto low: chunk.values) {
+                result.append(high | low);
+            }
+        }
+    }
+    return result;
+}
+
+bool CompressedBitmap::operator==(const CompressedBitmap& other) const {
+    // The representation of each chunk only depends on its cardinality
+    if (m_chunks.size() != other.m_chunks.size()) {
+        return false;
+    }
+    for (int i = 0; i < m_chunks.size(); ++i) {
+        const Chunk& lhs = m_chunks[i];
+        const Chunk& rhs = other.m_chunks[i];
+        if (lhs.key != rhs.key ||
+                lhs.cardinality != rhs.cardinality ||
+                lhs.values != rhs.values ||
+                lhs.bits != rhs.bits) {
+            return false;
+        }
+    }
+    return true;
+}
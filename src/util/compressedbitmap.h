@@ -0,0 +1,96 @@
+#ifndef MIXXX_UTIL_COMPRESSEDBITMAP_H
+#define MIXXX_UTIL_COMPRESSEDBITMAP_H
+
+#include <QVector>
+#include <QtGlobal>
+
+// A set of unsigned 32-bit integers, e.g. database ids, with the layout of
+// a Roaring bitmap. The values are partitioned into chunks of 2^16 values
+// by their upper 16 bits. A chunk stores the lower 16 bits of its values
+// either in a sorted array, if it contains at most 4096 values, or in a
+// bitset of 8 KiB otherwise. Sparse sets only need 2 bytes per value and
+// dense sets 1 bit per value, while lookups, unions and intersections
+// work chunk by chunk.
+//
+// Bitmaps are implicitly shared and cheap to copy.
+class CompressedBitmap {
+  public:
+    CompressedBitmap() = default;
+
+    bool isEmpty() const {
+        return m_chunks.isEmpty();
+    }
+    int cardinality() const;
+
+    bool contains(quint32 value) const;
+
+    // Returns false if the value is already contained
+    bool add(quint32 value);
+    // Returns false if the value is not contained
+    bool remove(quint32 value);
+    void clear() {
+        m_chunks.clear();
+    }
+
+    // Set union
+    CompressedBitmap& operator|=(const CompressedBitmap& other);
+    // Set intersection
+    CompressedBitmap& operator&=(const CompressedBitmap& other);
+
+    // All values in ascending order
+    QVector<quint32> toVector() const;
+
+    bool operator==(const CompressedBitmap& other) const;
+    bool operator!=(const CompressedBitmap& other) const {
+        return !(*this == other);
+    }
+
+  private:
+    struct Chunk {
+        Chunk()
+                : key(0),
+                  cardinality(0) {
+        }
+        explicit Chunk(quint16 key)
+                : key(key),
+                  cardinality(0) {
+        }
+
+        bool isBitset() const {
+            return !bits.isEmpty();
+        }
+        bool contains(quint16 low) const;
+        bool add(quint16 low);
+        bool remove(quint16 low);
+        // Converts between array and bitset after the cardinality has
+        // changed.
+        void normalize();
+        void unite(const Chunk& other);
+        void intersect(const Chunk& other);
+
+        // The upper 16 bits of all values in this chunk
+        quint16 key;
+        int cardinality;
+        // The sorted lower 16 bits if this is an array chunk
+        QVector<quint16> values;
+        // The bits of all 2^16 values if this is a bitset chunk
+        QVector<quint64> bits;
+    };
+
+    // Returns the index of the chunk with the given key or the
+    // insertion position if there is no such chunk.
+    int findChunk(quint16 key, bool* pFound) const;
+
+    // Sorted by key, no empty chunks
+    QVector<Chunk> m_chunks;
+};
+
+inline CompressedBitmap operator|(CompressedBitmap lhs, const CompressedBitmap& rhs) {
+    return lhs |= rhs;
+}
+
+inline CompressedBitmap operator&(CompressedBitmap lhs, const CompressedBitmap& rhs) {
+    return lhs &= rhs;
+}
+
+#endif // MIXXX_UTIL_COMPRESSEDBITMAP_H
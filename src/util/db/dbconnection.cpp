@@ -1,5 +1,6 @@
 #include <QSqlDriver>
 #include <QSqlError>
+#include <QSqlQuery>
 
 #ifdef __SQLITE3__
 #include <sqlite3.h>
@@ -11,6 +12,7 @@
 #include "util/memory.h"
 #include "util/logger.h"
 #include "util/assert.h"
+#include "util/math.h"
 
 
 // Originally from public domain code:
@@ -22,6 +24,26 @@ namespace {
 
 const mixxx::Logger kLogger("DbConnection");
 
+// The size of the page cache of each connection in KiB and the maximum
+// size of the memory-mapped database file in bytes.
+const int kSqliteCacheSizeKiB = 16 * 1024;
+const qint64 kSqliteMmapSize = 256 * 1024 * 1024;
+
+#ifdef __SQLITE3__
+// Give up waiting for a database that is locked by another connection
+// after this time. The same as the default of the Qt SQLite driver.
+const int kBusyTimeoutMillis = 5000;
+
+// The delays between retries while the database is locked. The last
+// one is repeated.
+const int kBusyDelaysMillis[] = { 1, 2, 5, 10, 15, 20, 25, 25, 25, 50, 50, 100 };
+const int kBusyDelaysCount = sizeof(kBusyDelaysMillis) / sizeof(kBusyDelaysMillis[0]);
+
+inline int busyDelayMillis(int retry) {
+    return kBusyDelaysMillis[math_min(retry, kBusyDelaysCount - 1)];
+}
+#endif // __SQLITE3__
+
 QSqlDatabase createDatabase(
         const DbConnection::Params& params,
         const QString connectionName) {
@@ -40,9 +62,15 @@ QSqlDatabase createDatabase(
 
 QSqlDatabase cloneDatabase(
         const QSqlDatabase& database,
-        const QString connectionName) {
+        const QString connectionName,
+        bool readOnly) {
     DEBUG_ASSERT(!database.isOpen());
-    return QSqlDatabase::cloneDatabase(database, connectionName);
+    QSqlDatabase clonedDatabase =
+            QSqlDatabase::cloneDatabase(database, connectionName);
+    if (readOnly && (clonedDatabase.driverName() == "QSQLITE")) {
+        clonedDatabase.setConnectOptions("QSQLITE_OPEN_READONLY");
+    }
+    return clonedDatabase;
 }
 
 void removeDatabase(
@@ -213,9 +241,72 @@ void sqliteLike(sqlite3_context *context,
     return;
 }
 
+// Invoked by SQLite3 while the database is locked by another connection.
+// Returns 0 to give up and fail with SQLITE_BUSY or 1 to retry.
+int sqliteBusyHandler(void* pArg, int retry) {
+    auto pBusyStats = static_cast<DbConnection::BusyStats*>(pArg);
+    int waitedMillis = 0;
+    for (int i = 0; i < retry; ++i) {
+        waitedMillis += busyDelayMillis(i);
+    }
+    const int delayMillis = busyDelayMillis(retry);
+    if (waitedMillis + delayMillis > kBusyTimeoutMillis) {
+        if (pBusyStats) {
+            pBusyStats->timeouts.ref();
+        }
+        return 0;
+    }
+    sqlite3_sleep(delayMillis);
+    if (pBusyStats) {
+        pBusyStats->retries.ref();
+        pBusyStats->waitMillis.fetchAndAddRelaxed(delayMillis);
+    }
+    return 1;
+}
+
 #endif // __SQLITE3__
 
-bool initDatabase(QSqlDatabase database) {
+// Write-ahead logging allows readers to proceed while another connection
+// writes and reduces the number of fsync calls. The journal mode is stored
+// persistently in the database file and can only be changed by writers.
+void configureSqliteDatabase(QSqlDatabase database, bool readOnly) {
+    if (database.driverName() != "QSQLITE") {
+        return;
+    }
+    QSqlQuery query(database);
+    if (!readOnly) {
+        if (!query.exec("PRAGMA journal_mode=WAL")) {
+            kLogger.warning()
+                    << "Failed to enable write-ahead logging:"
+                    << query.lastError();
+        } else if (query.next() &&
+                (query.value(0).toString().toLower() != "wal")) {
+            // E.g. for in-memory databases
+            kLogger.info()
+                    << "Write-ahead logging is not available, using journal mode"
+                    << query.value(0).toString();
+        }
+        // Safe in WAL mode, only the last transactions might be lost
+        // on a power failure
+        if (!query.exec("PRAGMA synchronous=NORMAL")) {
+            kLogger.warning()
+                    << "Failed to set synchronous mode:"
+                    << query.lastError();
+        }
+    }
+    if (!query.exec(QString("PRAGMA cache_size=-%1").arg(kSqliteCacheSizeKiB))) {
+        kLogger.warning()
+                << "Failed to set page cache size:"
+                << query.lastError();
+    }
+    if (!query.exec(QString("PRAGMA mmap_size=%1").arg(kSqliteMmapSize))) {
+        kLogger.warning()
+                << "Failed to set memory-mapped I/O size:"
+                << query.lastError();
+    }
+}
+
+bool initDatabase(QSqlDatabase database, DbConnection::BusyStats* pBusyStats) {
     DEBUG_ASSERT(database.isOpen());
 #ifdef __SQLITE3__
     QVariant v = database.driver()->handle();
@@ -237,7 +328,18 @@ bool initDatabase(QSqlDatabase database) {
         return false; // abort
     }
 
-    int result = sqlite3_create_collation(
+    // Replaces the busy timeout of the Qt SQLite driver
+    int result = sqlite3_busy_handler(
+                    handle,
+                    sqliteBusyHandler,
+                    pBusyStats);
+    VERIFY_OR_DEBUG_ASSERT(result == SQLITE_OK) {
+        kLogger.warning()
+                << "Failed to install busy handler for SQLite3:"
+                << result;
+    }
+
+    result = sqlite3_create_collation(
                     handle,
                     kLexicographicalCollationFunc,
                     SQLITE_UTF16,
@@ -276,6 +378,8 @@ bool initDatabase(QSqlDatabase database) {
                 << "Failed to install custom 3-arg LIKE function for SQLite3:"
                 << result;
     }
+#else
+    Q_UNUSED(pBusyStats);
 #endif // __SQLITE3__
     return true;
 }
@@ -284,14 +388,20 @@ bool initDatabase(QSqlDatabase database) {
 
 DbConnection::DbConnection(
         const Params& params,
-        const QString& connectionName)
-    : m_sqlDatabase(createDatabase(params, connectionName)) {
+        const QString& connectionName,
+        BusyStats* pBusyStats)
+    : m_sqlDatabase(createDatabase(params, connectionName)),
+      m_readOnly(false),
+      m_pBusyStats(pBusyStats) {
 }
 
 DbConnection::DbConnection(
         const DbConnection& prototype,
-        const QString& connectionName)
-    : m_sqlDatabase(cloneDatabase(prototype.m_sqlDatabase, connectionName)) {
+        const QString& connectionName,
+        bool readOnly)
+    : m_sqlDatabase(cloneDatabase(prototype.m_sqlDatabase, connectionName, readOnly)),
+      m_readOnly(readOnly),
+      m_pBusyStats(prototype.m_pBusyStats) {
 }
 
 DbConnection::~DbConnection() {
@@ -310,13 +420,14 @@ bool DbConnection::open() {
                 << m_sqlDatabase.lastError();
         return false; // abort
     }
-    if (!initDatabase(m_sqlDatabase)) {
+    if (!initDatabase(m_sqlDatabase, m_pBusyStats)) {
         kLogger.warning()
                 << "Failed to initialize database connection"
                 << *this;
         m_sqlDatabase.close();
         return false; // abort
     }
+    configureSqliteDatabase(m_sqlDatabase, m_readOnly);
     return true;
 }
 
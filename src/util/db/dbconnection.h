@@ -2,6 +2,7 @@
 #define MIXXX_DBCONNECTION_H
 
 
+#include <QAtomicInt>
 #include <QSqlDatabase>
 
 #include <QtDebug>
@@ -30,13 +31,25 @@ class DbConnection final {
         QString password;
     };
 
+    // Counts the waits of connections for a database that is locked
+    // by another connection. Shared by all connections of a pool.
+    struct BusyStats {
+        QAtomicInt retries;
+        QAtomicInt timeouts;
+        QAtomicInt waitMillis;
+    };
+
     // All constructors are reserved for DbConnectionPool!!
     DbConnection(
             const Params& params,
-            const QString& connectionName);
+            const QString& connectionName,
+            BusyStats* pBusyStats = nullptr);
+    // Read-only connections never block or wait for writers (SQLite3
+    // in WAL mode).
     DbConnection(
             const DbConnection& prototype,
-            const QString& connectionName);
+            const QString& connectionName,
+            bool readOnly = false);
     ~DbConnection();
 
     QString name() const {
@@ -50,6 +63,10 @@ class DbConnection final {
         return m_sqlDatabase.isOpen();
     }
 
+    bool isReadOnly() const {
+        return m_readOnly;
+    }
+
     operator QSqlDatabase() const {
         return m_sqlDatabase;
     }
@@ -61,6 +78,8 @@ class DbConnection final {
     DbConnection(const DbConnection&&) = delete;
 
     QSqlDatabase m_sqlDatabase;
+    bool m_readOnly;
+    BusyStats* m_pBusyStats;
 };
 
 } // namespace mixxx
@@ -1,5 +1,6 @@
 #include "util/db/dbconnectionpool.h"
 
+#include "util/compatibility.h"
 #include "util/logger.h"
 
 
@@ -11,7 +12,8 @@ const Logger kLogger("DbConnectionPool");
 
 } // anonymous namespace
 
-bool DbConnectionPool::createThreadLocalConnection() {
+bool DbConnectionPool::createThreadLocalConnection(
+        AccessMode accessMode) {
     VERIFY_OR_DEBUG_ASSERT(!m_threadLocalConnections.hasLocalData()) {
         DEBUG_ASSERT(m_threadLocalConnections.localData());
         kLogger.critical()
@@ -25,7 +27,10 @@ bool DbConnectionPool::createThreadLocalConnection() {
             QString("%1-%2").arg(
                     m_prototypeConnection.name(),
                     QString::number(connectionIndex));
-    auto pConnection = std::make_unique<DbConnection>(m_prototypeConnection, indexedConnectionName);
+    auto pConnection = std::make_unique<DbConnection>(
+            m_prototypeConnection,
+            indexedConnectionName,
+            accessMode == AccessMode::ReadOnly);
     if (!pConnection->open()) {
         kLogger.critical()
                 << "Failed to open thread-local database connection"
@@ -34,6 +39,7 @@ bool DbConnectionPool::createThreadLocalConnection() {
     }
     m_threadLocalConnections.setLocalData(pConnection.get()); // transfer ownership
     pConnection.release(); // release ownership
+    m_openConnections.ref();
     DEBUG_ASSERT(m_threadLocalConnections.hasLocalData());
     DEBUG_ASSERT(m_threadLocalConnections.localData());
     kLogger.info()
@@ -46,15 +52,39 @@ void DbConnectionPool::destroyThreadLocalConnection() {
     VERIFY_OR_DEBUG_ASSERT(m_threadLocalConnections.hasLocalData()) {
         kLogger.critical()
                 << "Thread-local database connection not found";
+        return;
     }
     m_threadLocalConnections.setLocalData(nullptr);
+    m_openConnections.deref();
 }
 
 DbConnectionPool::DbConnectionPool(
         const DbConnection::Params& params,
         const QString& connectionName)
-    : m_prototypeConnection(params, connectionName),
-      m_connectionCounter(0) {
+    : m_prototypeConnection(params, connectionName, &m_busyStats),
+      m_connectionCounter(0),
+      m_openConnections(0) {
+}
+
+DbConnectionPool::~DbConnectionPool() {
+    const Statistics stats = statistics();
+    kLogger.info()
+            << "Database connections waited"
+            << stats.busyWaitMillis
+            << "ms for locks with"
+            << stats.busyRetries
+            << "retries and"
+            << stats.busyTimeouts
+            << "timeouts";
+}
+
+DbConnectionPool::Statistics DbConnectionPool::statistics() const {
+    Statistics stats;
+    stats.openConnections = load_atomic(m_openConnections);
+    stats.busyRetries = load_atomic(m_busyStats.retries);
+    stats.busyTimeouts = load_atomic(m_busyStats.timeouts);
+    stats.busyWaitMillis = load_atomic(m_busyStats.waitMillis);
+    return stats;
 }
 
 } // namespace mixxx
@@ -17,6 +17,29 @@ typedef std::shared_ptr<DbConnectionPool> DbConnectionPoolPtr;
 
 class DbConnectionPool final {
   public:
+    enum class AccessMode {
+        ReadWrite,
+        // Read-only connections are never blocked by writers, e.g.
+        // for browsing the library while it is scanned.
+        ReadOnly,
+    };
+
+    struct Statistics {
+        Statistics()
+            : openConnections(0),
+              busyRetries(0),
+              busyTimeouts(0),
+              busyWaitMillis(0) {
+        }
+        int openConnections;
+        // How often and how long connections waited for the database
+        // while it was locked by another connection, and how often they
+        // gave up.
+        int busyRetries;
+        int busyTimeouts;
+        int busyWaitMillis;
+    };
+
     // Creates a new pool of database connections (one per thread) that
     // all use the same connection parameters. Unique connection names
     // will be  generated based on the given connection name that serves
@@ -32,11 +55,15 @@ class DbConnectionPool final {
     DbConnectionPool(
             const DbConnection::Params& params,
             const QString& connectionName);
+    ~DbConnectionPool();
+
+    Statistics statistics() const;
 
     // Prefer to use DbConnectionPooler instead of the
     // following functions. Only if there is no appropriate
     // scoping possible then use these functions directly.
-    bool createThreadLocalConnection();
+    bool createThreadLocalConnection(
+            AccessMode accessMode = AccessMode::ReadWrite);
     void destroyThreadLocalConnection();
 
   private:
@@ -56,10 +83,15 @@ class DbConnectionPool final {
         return m_threadLocalConnections.localData();
     }
 
+    // Shared by all connections and must outlive them
+    DbConnection::BusyStats m_busyStats;
+
     const DbConnection m_prototypeConnection;
 
     QAtomicInt m_connectionCounter;
 
+    QAtomicInt m_openConnections;
+
     QThreadStorage<DbConnection*> m_threadLocalConnections;
 
 };
@@ -12,8 +12,10 @@ const Logger kLogger("DbConnectionPooler");
 } // anonymous namespace
 
 DbConnectionPooler::DbConnectionPooler(
-        DbConnectionPoolPtr pDbConnectionPool) {
-    if (pDbConnectionPool && pDbConnectionPool->createThreadLocalConnection()) {
+        DbConnectionPoolPtr pDbConnectionPool,
+        DbConnectionPool::AccessMode accessMode) {
+    if (pDbConnectionPool &&
+            pDbConnectionPool->createThreadLocalConnection(accessMode)) {
         // m_pDbConnectionPool indicates if the thread-local connection has actually
         // been created during construction. Otherwise this instance does not store
         // any reference to the connection pool and is non-functional.
@@ -20,7 +20,9 @@ namespace mixxx {
 class DbConnectionPooler final {
   public:
     explicit DbConnectionPooler(
-            DbConnectionPoolPtr pDbConnectionPool = DbConnectionPoolPtr());
+            DbConnectionPoolPtr pDbConnectionPool = DbConnectionPoolPtr(),
+            DbConnectionPool::AccessMode accessMode =
+                    DbConnectionPool::AccessMode::ReadWrite);
     DbConnectionPooler(const DbConnectionPooler&) = delete;
 #if !defined(_MSC_VER) || _MSC_VER > 1900
     DbConnectionPooler(DbConnectionPooler&&) = default;
@@ -2,6 +2,7 @@
 
 #include <QSqlRecord>
 
+#include "util/db/sqlquerycache.h"
 #include "util/performancetimer.h"
 #include "util/logger.h"
 #include "util/assert.h"
@@ -36,7 +37,8 @@ FwdSqlQuery::FwdSqlQuery(
         QSqlDatabase database,
         const QString& statement)
     : QSqlQuery(database),
-      m_prepared(prepareQuery(*this, statement)) {
+      m_prepared(prepareQuery(*this, statement)),
+      m_pQueryCache(nullptr) {
     if (!m_prepared) {
         DEBUG_ASSERT(!database.isOpen() || hasError());
         kLogger.critical()
@@ -47,6 +49,22 @@ FwdSqlQuery::FwdSqlQuery(
     }
 }
 
+FwdSqlQuery::FwdSqlQuery(
+        SqlQueryCache* pQueryCache,
+        const QString& statement)
+    : QSqlQuery(pQueryCache->prepare(statement)), // implicitly shared
+      m_prepared(!hasError()),
+      m_pQueryCache(pQueryCache) {
+    DEBUG_ASSERT(isForwardOnly());
+    if (!m_prepared) {
+        kLogger.critical()
+                << "Failed to prepare"
+                << statement
+                << ":"
+                << lastError();
+    }
+}
+
 bool FwdSqlQuery::execPrepared() {
     DEBUG_ASSERT(isPrepared());
     DEBUG_ASSERT(!hasError());
@@ -54,7 +72,7 @@ bool FwdSqlQuery::execPrepared() {
     if (kLogger.traceEnabled()) {
         timer.start();
     }
-    if (exec()) {
+    if (m_pQueryCache ? m_pQueryCache->exec(this) : exec()) {
         if (kLogger.traceEnabled()) {
             if (kLogger.traceEnabled()) {
                 kLogger.tracePerformance(
@@ -12,6 +12,7 @@
 #include "util/assert.h"
 
 // forward declarations
+class SqlQueryCache;
 class SqlQueryFinisher;
 class FwdSqlQuerySelectResult;
 
@@ -39,6 +40,12 @@ class FwdSqlQuery: protected QSqlQuery {
     FwdSqlQuery(
             QSqlDatabase database,
             const QString& statement);
+    // Reuses the prepared query for the statement from the cache. The
+    // time spent for preparing and executing the query is accounted
+    // by the cache.
+    FwdSqlQuery(
+            SqlQueryCache* pQueryCache,
+            const QString& statement);
 
     bool isPrepared() const {
         return m_prepared;
@@ -108,9 +115,13 @@ class FwdSqlQuery: protected QSqlQuery {
     bool fieldValueBoolean(DbFieldIndex fieldIndex) const;
 
   private:
-    FwdSqlQuery() = default; // hidden
+    FwdSqlQuery() // hidden
+        : m_prepared(false),
+          m_pQueryCache(nullptr) {
+    }
 
     bool m_prepared;
+    SqlQueryCache* m_pQueryCache;
 };
 
 
@@ -0,0 +1,82 @@
+#include "util/db/sqlquerycache.h"
+
+#include <QSqlError>
+
+#include "util/performancetimer.h"
+#include "util/logger.h"
+#include "util/assert.h"
+
+
+namespace {
+
+const mixxx::Logger kLogger("SqlQueryCache");
+
+// Each DAO only executes a few dozen different statements. Statements
+// with inlined values would exceed this limit and are not cached.
+const int kMaxCachedQueries = 100;
+
+} // anonymous namespace
+
+SqlQueryCache::~SqlQueryCache() {
+    if (m_statistics.preparedQueries > 0) {
+        kLogger.debug()
+                << "Prepared" << m_statistics.preparedQueries
+                << "and reused" << m_statistics.reusedQueries
+                << "queries in"
+                << m_statistics.prepareNanos / 1000 << "us,"
+                << "executed" << m_statistics.executedQueries
+                << "queries in"
+                << m_statistics.execNanos / 1000 << "us";
+    }
+}
+
+void SqlQueryCache::setDatabase(QSqlDatabase database) {
+    // The prepared statements must be released before the
+    // current connection is closed
+    m_queries.clear();
+    m_database = database;
+}
+
+QSqlQuery SqlQueryCache::prepare(const QString& statement) {
+    const auto i = m_queries.find(statement);
+    if (i != m_queries.end()) {
+        QSqlQuery& query = i.value();
+        // A query that failed to execute is prepared again, because
+        // the error would be reported for the next execution
+        if (!query.lastError().isValid()) {
+            // Free the resources of a previous execution that has not
+            // iterated the whole result set
+            query.finish();
+            ++m_statistics.reusedQueries;
+            return query;
+        }
+        m_queries.erase(i);
+    }
+
+    PerformanceTimer timer;
+    timer.start();
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    const bool prepared = query.prepare(statement);
+    m_statistics.prepareNanos += timer.elapsed().toIntegerNanos();
+    ++m_statistics.preparedQueries;
+    if (prepared) {
+        if (m_queries.size() < kMaxCachedQueries) {
+            m_queries.insert(statement, query);
+        } else {
+            kLogger.debug()
+                    << "Not caching" << statement;
+        }
+    }
+    return query;
+}
+
+bool SqlQueryCache::exec(QSqlQuery* pQuery) {
+    DEBUG_ASSERT(pQuery);
+    PerformanceTimer timer;
+    timer.start();
+    const bool result = pQuery->exec();
+    m_statistics.execNanos += timer.elapsed().toIntegerNanos();
+    ++m_statistics.executedQueries;
+    return result;
+}
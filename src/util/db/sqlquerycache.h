@@ -0,0 +1,83 @@
+#ifndef MIXXX_SQLQUERYCACHE_H
+#define MIXXX_SQLQUERYCACHE_H
+
+
+#include <QHash>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+
+
+// Caches the prepared queries of a single database connection, so that
+// frequently executed statements are parsed only once by SQLite instead
+// of each time they are used.
+//
+// Only statements with a constant text should be prepared through the
+// cache. Values must be passed as bound parameters, otherwise each
+// distinct value would occupy another entry.
+//
+// The cached queries are implicitly shared with the queries returned
+// by prepare(). A returned query must not be used any longer after the
+// same statement has been prepared again, i.e. the cache must not be
+// used for nested executions of the same statement. Queries that are
+// not iterated until the end of their result set should be finished
+// explicitly (see SqlQueryFinisher) to free the resources of the
+// prepared statement until its next execution.
+//
+// Like the storage classes that own them, instances of this class will
+// always be accessed by the same thread.
+class SqlQueryCache final {
+  public:
+    struct Statistics {
+        Statistics()
+            : preparedQueries(0),
+              reusedQueries(0),
+              executedQueries(0),
+              prepareNanos(0),
+              execNanos(0) {
+        }
+        // Statements that have been parsed by SQLite and those that
+        // have been reused from the cache instead
+        int preparedQueries;
+        int reusedQueries;
+        // Executions through exec()
+        int executedQueries;
+        // The accumulated time spent in prepare() and exec()
+        qint64 prepareNanos;
+        qint64 execNanos;
+    };
+
+    SqlQueryCache() = default;
+    ~SqlQueryCache();
+
+    // Discards all cached queries and attaches the cache to another
+    // database connection. Pass an invalid database to detach the cache
+    // before the current connection is closed.
+    void setDatabase(QSqlDatabase database);
+
+    // Returns a forward-only query that has been prepared for the given
+    // statement. All placeholders must be bound again before executing
+    // the query. If preparing fails the error is reported when executing
+    // the returned query.
+    QSqlQuery prepare(const QString& statement);
+
+    // Executes a query that has been returned by prepare() and
+    // accounts for the time spent.
+    bool exec(QSqlQuery* pQuery);
+
+    const Statistics& statistics() const {
+        return m_statistics;
+    }
+
+  private:
+    // Disable copying
+    SqlQueryCache(const SqlQueryCache&) = delete;
+    SqlQueryCache& operator=(const SqlQueryCache&) = delete;
+
+    QSqlDatabase m_database;
+    QHash<QString, QSqlQuery> m_queries;
+    Statistics m_statistics;
+};
+
+
+#endif // MIXXX_SQLQUERYCACHE_H
@@ -49,7 +49,7 @@ class WaveformMark {
     bool isValid() const { return m_pPointCos && m_pPointCos->valid(); }
     void connectSamplePositionChanged(const QObject *, const char *) const;
     double getSamplePosition() const { return m_pPointCos->get(); }
-    QString getItem() const { return m_pPointCos->getKey().item; }
+    QString getItem() const { return m_pPointCos->getKey().item(); }
 
   private:
     std::unique_ptr<ControlProxy> m_pPointCos;
@@ -55,7 +55,7 @@ void ControlParameterWidgetConnection::Init() {
 QString ControlParameterWidgetConnection::toDebugString() const {
     const ConfigKey& key = getKey();
     return QString("%1,%2 Parameter: %3 Value: %4 Direction: %5 Emit: %6")
-            .arg(key.group, key.item,
+            .arg(key.group(), key.item(),
                  QString::number(m_pControl->getParameter()),
                  QString::number(m_pControl->get()),
                  directionOptionToString(m_directionOption),
@@ -104,8 +104,8 @@ ControlWidgetPropertyConnection::ControlWidgetPropertyConnection(
 QString ControlWidgetPropertyConnection::toDebugString() const {
     const ConfigKey& key = getKey();
     return QString("%1,%2 Parameter: %3 Property: %4 Value: %5").arg(
-            key.group,
-            key.item,
+            key.group(),
+            key.item(),
             QString::number(m_pControl->getParameter()),
             m_propertyName,
             m_pWidget->toQWidget()->property(m_propertyName.constData()).toString());
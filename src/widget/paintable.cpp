@@ -7,6 +7,7 @@
 
 #include "util/math.h"
 #include "skin/imgloader.h"
+#include "widget/svgrastercache.h"
 
 // static
 Paintable::DrawMode Paintable::DrawModeFromString(const QString& str) {
@@ -50,12 +51,6 @@ Paintable::Paintable(const PixmapSource& source, DrawMode mode, double scaleFact
     if (!source.isSVG()) {
         m_pPixmap.reset(WPixmapStore::getPixmapNoCache(source.getPath(), scaleFactor));
     } else {
-        m_pSvg.reset(new QSvgRenderer());
-        if (source.getData().isEmpty()) {
-            m_pSvg->load(source.getPath());
-        } else {
-            m_pSvg->load(source.getData());
-        }
 #ifdef __APPLE__
         // Apple does Retina scaling behind the sceens, so we also pass a
         // Paintable::FIXED image. On the other targets, it is better to
@@ -67,15 +62,21 @@ Paintable::Paintable(const PixmapSource& source, DrawMode mode, double scaleFact
         if (mode == TILE || mode == Paintable::FIXED || WPixmapStore::willCorrectColors()) {
 #endif
             // The SVG renderer doesn't directly support tiling, so we render
-            // it to a pixmap which will then get tiled.
-            QImage copy_buffer(m_pSvg->defaultSize() * scaleFactor, QImage::Format_ARGB32);
-            copy_buffer.fill(0x00000000);  // Transparent black.
-            QPainter painter(&copy_buffer);
-            m_pSvg->render(&painter);
+            // it to a pixmap which will then get tiled. The image is usually
+            // already rasterized by SvgRasterCache::prefetch() on a worker
+            // thread or loaded from the on-disk cache.
+            QImage copy_buffer = SvgRasterCache::rasterize(source, scaleFactor);
             WPixmapStore::correctImageColors(&copy_buffer);
 
             m_pPixmap.reset(new QPixmap(copy_buffer.size()));
             m_pPixmap->convertFromImage(copy_buffer);
+        } else {
+            m_pSvg.reset(new QSvgRenderer());
+            if (source.getData().isEmpty()) {
+                m_pSvg->load(source.getPath());
+            } else {
+                m_pSvg->load(source.getData());
+            }
         }
     }
 }
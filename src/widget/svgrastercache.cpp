@@ -0,0 +1,170 @@
+#include "widget/svgrastercache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QPainter>
+#include <QStringList>
+#include <QSvgRenderer>
+#include <QTemporaryFile>
+#include <QtConcurrentMap>
+#include <QtDebug>
+
+namespace {
+
+// Limits the memory that is occupied by the rasterized images. This is
+// enough for all images of the bundled skins at scale factor 2.
+const int kMaxCacheCostKiB = 64 * 1024;
+
+int imageCostKiB(const QImage& image) {
+    return image.byteCount() / 1024 + 1;
+}
+
+// Writes the image to a temporary file in the same directory first and
+// renames it afterwards, so that concurrent workers and readers never see
+// a partially written file.
+bool saveImageAtomically(const QImage& image, const QString& filePath) {
+    QTemporaryFile file(filePath + ".XXXXXX.tmp");
+    if (!file.open() || !image.save(&file, "PNG")) {
+        return false;
+    }
+    file.close();
+    // The renamed file must not be deleted together with QTemporaryFile
+    file.setAutoRemove(false);
+    if (!file.rename(filePath)) {
+        file.remove();
+        // Another worker might have rasterized the same SVG concurrently.
+        // Its file has the same content.
+        return QFile::exists(filePath);
+    }
+    return true;
+}
+
+class RasterizeFile {
+  public:
+    typedef bool result_type;
+
+    explicit RasterizeFile(double scaleFactor)
+            : m_scaleFactor(scaleFactor) {
+    }
+
+    bool operator()(const QString& path) const {
+        return !SvgRasterCache::rasterize(
+                PixmapSource(path), m_scaleFactor).isNull();
+    }
+
+  private:
+    double m_scaleFactor;
+};
+
+}  // anonymous namespace
+
+// static
+QMutex SvgRasterCache::s_mutex;
+// static
+QString SvgRasterCache::s_cacheDirectory;
+// static
+QCache<QString, QImage> SvgRasterCache::s_images(kMaxCacheCostKiB);
+// static
+QFuture<void> SvgRasterCache::s_prefetch;
+
+// static
+void SvgRasterCache::setCacheDirectory(const QString& path) {
+    if (!QDir().mkpath(path)) {
+        qWarning() << "SvgRasterCache: Failed to create cache directory" << path;
+        return;
+    }
+    QMutexLocker locker(&s_mutex);
+    s_cacheDirectory = path;
+}
+
+// static
+QImage SvgRasterCache::rasterize(const PixmapSource& source, double scaleFactor) {
+    if (!source.isSVG()) {
+        return QImage();
+    }
+    QByteArray svgData = source.getData();
+    if (svgData.isEmpty()) {
+        QFile file(source.getPath());
+        if (!file.open(QIODevice::ReadOnly)) {
+            return QImage();
+        }
+        svgData = file.readAll();
+    }
+    return rasterizeData(svgData, scaleFactor);
+}
+
+// static
+QImage SvgRasterCache::rasterizeData(const QByteArray& svgData, double scaleFactor) {
+    const QString key = QString::fromLatin1(QCryptographicHash::hash(
+            svgData, QCryptographicHash::Sha1).toHex()) +
+            QChar('_') + QString::number(scaleFactor);
+
+    QString cacheFilePath;
+    {
+        QMutexLocker locker(&s_mutex);
+        const QImage* pCached = s_images.object(key);
+        if (pCached) {
+            return *pCached;
+        }
+        if (!s_cacheDirectory.isEmpty()) {
+            cacheFilePath = QDir(s_cacheDirectory).filePath(key + ".png");
+        }
+    }
+
+    QImage image;
+    if (!cacheFilePath.isEmpty() && QFile::exists(cacheFilePath)) {
+        image.load(cacheFilePath, "PNG");
+    }
+
+    if (image.isNull()) {
+        QSvgRenderer renderer(svgData);
+        if (!renderer.isValid()) {
+            return QImage();
+        }
+        image = QImage(renderer.defaultSize() * scaleFactor,
+                       QImage::Format_ARGB32);
+        image.fill(0x00000000);  // Transparent black.
+        QPainter painter(&image);
+        renderer.render(&painter);
+        painter.end();
+
+        if (!cacheFilePath.isEmpty() &&
+                !saveImageAtomically(image, cacheFilePath)) {
+            qWarning() << "SvgRasterCache: Failed to write" << cacheFilePath;
+        }
+    }
+
+    QMutexLocker locker(&s_mutex);
+    // Images that exceed the limit on their own are not kept in memory
+    s_images.insert(key, new QImage(image), imageCostKiB(image));
+    return image;
+}
+
+// static
+QFuture<void> SvgRasterCache::prefetch(const QString& skinPath, double scaleFactor) {
+    cancelPrefetch();
+    QStringList paths;
+    QDirIterator it(skinPath, QStringList() << "*.svg", QDir::Files,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        paths.append(it.next());
+    }
+    // mapped() keeps its own copy of the paths, unlike map() which would
+    // modify the local list in place after it went out of scope.
+    s_prefetch = QtConcurrent::mapped(paths, RasterizeFile(scaleFactor));
+    return s_prefetch;
+}
+
+// static
+void SvgRasterCache::cancelPrefetch() {
+    s_prefetch.cancel();
+    s_prefetch.waitForFinished();
+}
+
+// static
+void SvgRasterCache::clear() {
+    QMutexLocker locker(&s_mutex);
+    s_images.clear();
+}
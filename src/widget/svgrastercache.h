@@ -0,0 +1,58 @@
+#ifndef SVGRASTERCACHE_H
+#define SVGRASTERCACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QFuture>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+
+#include "skin/pixmapsource.h"
+
+// Cache of SVG skin images rasterized at a given scale factor.
+//
+// Paintable rasterizes SVGs that are tiled, drawn FIXED or color corrected.
+// Doing that on the GUI thread for every image of a skin made skin loading
+// and scale factor changes slow. SvgRasterCache keeps the rasterized images
+// in memory and in a directory on disk, keyed by a hash of the SVG content
+// and the scale factor, and prefetch() rasterizes all SVGs of a skin on the
+// global thread pool while the skin is being parsed.
+//
+// The cached images are not color corrected, so the cache is valid for all
+// color schemes of a skin. The in-memory cache is limited in size, least
+// recently used images are reloaded from disk when needed again.
+class SvgRasterCache {
+  public:
+    // Sets the directory in which rasterized images are persisted. Images are
+    // only cached in memory while no directory is set.
+    static void setCacheDirectory(const QString& path);
+
+    // Returns the SVG rendered at its default size multiplied by scaleFactor.
+    // Returns a null image if the source is not a valid SVG. Thread-safe.
+    static QImage rasterize(const PixmapSource& source, double scaleFactor);
+
+    // Starts rasterizing all SVG files in skinPath (recursively) on the
+    // global thread pool. A prefetch that is still running for a previously
+    // loaded skin is canceled first. Must be called from the GUI thread.
+    static QFuture<void> prefetch(const QString& skinPath, double scaleFactor);
+
+    // Cancels a running prefetch and waits until the images that are
+    // currently being rasterized are done. Called when the skin is unloaded
+    // so that no worker outlives the cache on shutdown.
+    static void cancelPrefetch();
+
+    // Drops all images from the in-memory cache.
+    static void clear();
+
+  private:
+    static QImage rasterizeData(const QByteArray& svgData, double scaleFactor);
+
+    static QMutex s_mutex;
+    static QString s_cacheDirectory;
+    // The cost of each image is its size in KiB
+    static QCache<QString, QImage> s_images;
+    static QFuture<void> s_prefetch;
+};
+
+#endif /* SVGRASTERCACHE_H */
@@ -1019,6 +1019,22 @@ void WTrackTableView::onSearchCleared() {
 void WTrackTableView::onShow() {
 }
 
+void WTrackTableView::paintEvent(QPaintEvent* pEvent) {
+    TrackModel* trackModel = getTrackModel();
+    if (trackModel) {
+        const int firstRow = rowAt(0);
+        if (firstRow >= 0) {
+            int lastRow = rowAt(viewport()->height() - 1);
+            if (lastRow < 0) {
+                // The table ends above the bottom of the viewport
+                lastRow = model()->rowCount() - 1;
+            }
+            trackModel->prefetchRows(firstRow, lastRow);
+        }
+    }
+    QTableView::paintEvent(pEvent);
+}
+
 void WTrackTableView::mouseMoveEvent(QMouseEvent* pEvent) {
     // Only use this for drag and drop if the LeftButton is pressed we need to
     // check for this because mousetracking is activated and this function is
@@ -1134,29 +1150,12 @@ void WTrackTableView::dropEvent(QDropEvent * event) {
 
         //qDebug() << "track reordering" << __FILE__ << __LINE__;
 
-        // Save a list of row (just plain ints) so we don't get screwed over
-        // when the QModelIndexes all become invalid (eg. after moveTrack()
-        // or addTrack())
         QModelIndexList indices = selectionModel()->selectedRows();
 
         QList<int> selectedRows;
         for (const QModelIndex& idx : indices) {
             selectedRows.append(idx.row());
         }
-
-        // Note: The biggest subtlety in the way I've done this track reordering code
-        // is that as soon as we've moved ANY track, all of our QModelIndexes probably
-        // get screwed up. The starting point for the logic below is to say screw it to
-        // the QModelIndexes, and just keep a list of row numbers to work from. That
-        // ends up making the logic simpler and the behavior totally predictable,
-        // which lets us do nice things like "restore" the selection model.
-
-        // The model indices are sorted so that we remove the tracks from the table
-        // in ascending order. This is necessary because if track A is above track B in
-        // the table, and you remove track A, the model index for track B will change.
-        // Sorting the indices first means we don't have to worry about this.
-        //qSort(m_selectedIndices);
-        //qSort(m_selectedIndices.begin(), m_selectedIndices.end(), qGreater<QModelIndex>());
         qSort(selectedRows);
         int maxRow = 0;
         int minRow = 0;
@@ -1176,44 +1175,16 @@ void WTrackTableView::dropEvent(QDropEvent * event) {
             // If you drag a contiguous selection of multiple tracks and drop
             // them somewhere inside that same selection, do nothing.
             return;
-        } else {
-            if (destRow < minRow) {
-                // If we're moving the tracks _up_,
-                // then reverse the order of the row selection
-                // to make the algorithm below work as it is
-                qSort(selectedRows.begin(),
-                      selectedRows.end(),
-                      qGreater<int>());
-            } else {
-               if (destRow > maxRow) {
-                   // If we're moving the tracks _down_,
-                   // adjust the first row to reselect
-                   selectionRestoreStartRow =
-                        selectionRestoreStartRow - selectedRowCount;
-                }
-            }
-        }
-
-        // For each row that needs to be moved...
-        while (!selectedRows.isEmpty()) {
-            int movedRow = selectedRows.takeFirst(); // Remember it's row index
-            // Move it
-            trackModel->moveTrack(model()->index(movedRow, 0), destIndex);
-
-            // Move the row indices for rows that got bumped up
-            // into the void we left, or down because of the new spot
-            // we're taking.
-            for (int i = 0; i < selectedRows.count(); i++) {
-                if ((selectedRows[i] > movedRow) && (
-                    (destRow > selectedRows[i]) )) {
-                    selectedRows[i] = selectedRows[i] - 1;
-                } else if ((selectedRows[i] < movedRow) &&
-                            (destRow < selectedRows[i])) {
-                    selectedRows[i] = selectedRows[i] + 1;
-                }
-            }
+        } else if (destRow > maxRow) {
+            // If we're moving the tracks _down_,
+            // adjust the first row to reselect
+            selectionRestoreStartRow =
+                    selectionRestoreStartRow - selectedRowCount;
         }
 
+        // The model moves all tracks at once in front of the destination,
+        // keeping their order. The QModelIndexes become invalid afterwards.
+        trackModel->moveTracks(indices, destIndex);
 
         // Highlight the moved rows again (restoring the selection)
         //QModelIndex newSelectedIndex = destIndex;
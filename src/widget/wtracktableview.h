@@ -100,6 +100,10 @@ class WTrackTableView : public WLibraryTableView {
     // when dragging.
     void mouseMoveEvent(QMouseEvent *pEvent) override;
 
+    // Lets the model load the visible rows at once before they are painted
+    // cell by cell.
+    void paintEvent(QPaintEvent* pEvent) override;
+
     // Returns the current TrackModel, or returns NULL if none is set.
     TrackModel* getTrackModel() const;
     bool modelHasCapabilities(TrackModel::CapabilitiesFlags capabilities) const;